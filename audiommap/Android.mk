@@ -0,0 +1,66 @@
+# Copyright (C) 2012 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+
+LOCAL_CFLAGS := -D_POSIX_C_SOURCE=200809
+
+LOCAL_SRC_FILES := \
+        audio_mmap.c
+
+LOCAL_C_INCLUDES += \
+        $(call include-path-for, tinyalsa)
+
+LOCAL_MODULE := libaudio_mmap_intel
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_STATIC_LIBRARY)
+
+# plays through a snd-dummy or snd-aloop card on the device
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+        audio_mmap_test.c \
+        audio_mmap.c
+
+LOCAL_C_INCLUDES += \
+        $(call include-path-for, tinyalsa)
+
+LOCAL_SHARED_LIBRARIES := liblog libtinyalsa
+LOCAL_MODULE := audio_mmap_test
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_EXECUTABLE)
+
+# same test against a simulated PCM on the build host
+include $(CLEAR_VARS)
+
+LOCAL_CFLAGS := -DFAKE_PCM
+
+LOCAL_SRC_FILES := \
+        audio_mmap_test.c \
+        audio_mmap.c \
+        fake_pcm.c
+
+LOCAL_C_INCLUDES += \
+        $(call include-path-for, tinyalsa)
+
+LOCAL_STATIC_LIBRARIES := liblog
+LOCAL_LDLIBS := -lrt
+LOCAL_MODULE := audio_mmap_test
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_HOST_EXECUTABLE)
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "audio_mmap"
+//#define LOG_NDEBUG 0
+
+#include <errno.h>
+#include <string.h>
+
+#include <cutils/log.h>
+
+#include "audio_mmap.h"
+
+void audio_mmap_init(struct audio_mmap *mmap, unsigned int wait_ms,
+                     audio_mmap_xrun_cb xrun_cb, void *cookie)
+{
+    memset(mmap, 0, sizeof(*mmap));
+    mmap->wait_ms = wait_ms;
+    mmap->xrun_cb = xrun_cb;
+    mmap->cookie = cookie;
+}
+
+void audio_mmap_set_pcm(struct audio_mmap *mmap, struct pcm *pcm,
+                        unsigned int start_threshold)
+{
+    mmap->pcm = pcm;
+    mmap->start_threshold = start_threshold;
+    mmap->started = false;
+    mmap->queued = 0;
+}
+
+static int handle_xrun(struct audio_mmap *mmap)
+{
+    int ret;
+
+    mmap->xruns++;
+    mmap->started = false;
+    mmap->queued = 0;
+
+    if (mmap->xrun_cb)
+        ret = mmap->xrun_cb(mmap, mmap->cookie);
+    else
+        ret = pcm_prepare(mmap->pcm);
+
+    if (ret == 0 && !mmap->pcm)
+        ret = -ENODEV;
+    if (ret < 0)
+        ALOGE("%s: underrun #%u not recovered: %d", __func__, mmap->xruns, ret);
+    return ret;
+}
+
+int audio_mmap_write(struct audio_mmap *mmap, const void *buffer, size_t bytes)
+{
+    const char *src = buffer;
+    unsigned int frames;
+    int ret;
+
+    if (!mmap->pcm)
+        return -ENODEV;
+
+    /*the frame size survives a reopen, only the period changes*/
+    frames = pcm_bytes_to_frames(mmap->pcm, bytes);
+
+    while (frames > 0) {
+        void *area;
+        unsigned int offset, count;
+        int avail;
+
+        avail = pcm_avail_update(mmap->pcm);
+        if (avail < 0 ||
+            (mmap->started && (unsigned int)avail > pcm_get_buffer_size(mmap->pcm))) {
+            ret = handle_xrun(mmap);
+            if (ret < 0)
+                return ret;
+            continue;
+        }
+
+        if (avail == 0) {
+            if (!mmap->started) {
+                /*ring full before start threshold, kick it off*/
+                ret = pcm_start(mmap->pcm);
+                if (ret < 0)
+                    return ret;
+                mmap->started = true;
+            }
+            ret = pcm_wait(mmap->pcm, mmap->wait_ms);
+            if (ret == -EPIPE) {
+                ret = handle_xrun(mmap);
+                if (ret < 0)
+                    return ret;
+            } else if (ret < 0) {
+                ALOGE("%s: wait failed: %d", __func__, ret);
+                return ret;
+            } else if (ret == 0) {
+                ALOGE("%s: timeout waiting for room", __func__);
+                return -ETIMEDOUT;
+            }
+            continue;
+        }
+
+        count = frames;
+        ret = pcm_mmap_begin(mmap->pcm, &area, &offset, &count);
+        if (ret < 0)
+            return ret;
+        if (count == 0)
+            return -EIO;
+
+        memcpy((char *)area + pcm_frames_to_bytes(mmap->pcm, offset), src,
+               pcm_frames_to_bytes(mmap->pcm, count));
+
+        ret = pcm_mmap_commit(mmap->pcm, offset, count);
+        if (ret < 0)
+            return ret;
+
+        src += pcm_frames_to_bytes(mmap->pcm, count);
+        frames -= count;
+        mmap->queued += count;
+
+        if (!mmap->started && mmap->queued >= mmap->start_threshold) {
+            if (pcm_start(mmap->pcm) == 0)
+                mmap->started = true;
+        }
+    }
+
+    return 0;
+}
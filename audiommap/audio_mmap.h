@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AUDIO_MMAP_H
+#define AUDIO_MMAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <tinyalsa/asoundlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Playback through the DMA area of a tinyalsa PCM opened with PCM_MMAP,
+ * shared by the tinyalsa based HALs.
+ *
+ * The PCM is started once start_threshold frames are queued, or as soon
+ * as the ring buffer fills up. On underrun the xrun callback gets to
+ * recover the PCM, typically by reopening it with a larger period and
+ * handing the new PCM over with audio_mmap_set_pcm(); the rest of the
+ * write then goes to the new PCM. Without a callback the PCM is just
+ * prepared again.
+ */
+struct audio_mmap;
+
+/*returns 0 once mmap->pcm can take frames again, negative errno otherwise*/
+typedef int (*audio_mmap_xrun_cb)(struct audio_mmap *mmap, void *cookie);
+
+struct audio_mmap {
+    struct pcm          *pcm;
+    unsigned int        start_threshold;
+    unsigned int        wait_ms;
+    bool                started;
+    unsigned int        queued;     /*frames committed since the last (re)start*/
+    unsigned int        xruns;
+    audio_mmap_xrun_cb  xrun_cb;
+    void                *cookie;
+};
+
+void audio_mmap_init(struct audio_mmap *mmap, unsigned int wait_ms,
+                     audio_mmap_xrun_cb xrun_cb, void *cookie);
+
+/*attach a newly opened PCM, NULL detaches it*/
+void audio_mmap_set_pcm(struct audio_mmap *mmap, struct pcm *pcm,
+                        unsigned int start_threshold);
+
+/* Copy the whole buffer into the DMA area, waiting for room when the
+ * ring buffer is full. Returns 0 on success or the negative errno of
+ * the first unrecoverable error.
+ */
+int audio_mmap_write(struct audio_mmap *mmap, const void *buffer, size_t bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*AUDIO_MMAP_H*/
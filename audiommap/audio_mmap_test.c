@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Test for the MMAP playback helper.
+ *
+ * Plays a ramp in HAL sized writes with and without stalls long enough
+ * to underrun, recovering the way the HALs do (period doubled and PCM
+ * reopened, or a plain prepare), and checks that every write completes.
+ *
+ * On the build host it runs against fake_pcm.c, which also checks that
+ * every frame written was committed and that wait errors come back as
+ * they are. On a device, point it at a snd-dummy or snd-aloop card:
+ *
+ * usage: audio_mmap_test [-c card] [-d device]
+ */
+#define LOG_TAG "audio_mmap_test"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "audio_mmap.h"
+#ifdef FAKE_PCM
+#include "fake_pcm.h"
+#endif
+
+#define TEST_RATE                   48000
+#define TEST_CHANNELS               2
+#define PERIOD_SIZE_MIN             256
+#define PERIOD_SIZE_MAX             1024
+#define PERIOD_COUNT                4
+#define WRITE_FRAMES                1024
+#define WAIT_TIMEOUT_MS             100
+
+struct player {
+    unsigned int card;
+    unsigned int device;
+    struct pcm_config config;
+    struct pcm *pcm;
+    struct audio_mmap mmap;
+    int16_t sample;
+};
+
+static int failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+static int player_open(struct player *p)
+{
+    p->config.start_threshold = p->config.period_size * 2;
+    p->config.avail_min = p->config.period_size;
+
+    p->pcm = pcm_open(p->card, p->device, PCM_OUT | PCM_MMAP, &p->config);
+    if (!p->pcm || !pcm_is_ready(p->pcm)) {
+        fprintf(stderr, "pcm_open(%u, %u) failed: %s\n", p->card, p->device,
+                p->pcm ? pcm_get_error(p->pcm) : "");
+        pcm_close(p->pcm);
+        p->pcm = NULL;
+        return -ENODEV;
+    }
+    audio_mmap_set_pcm(&p->mmap, p->pcm, p->config.start_threshold);
+    return 0;
+}
+
+/*what the HALs do: double the period and reopen, then just prepare*/
+static int grow_and_reopen(struct audio_mmap *mmap, void *cookie)
+{
+    struct player *p = cookie;
+
+    if (p->config.period_size >= PERIOD_SIZE_MAX)
+        return pcm_prepare(p->pcm);
+
+    p->config.period_size *= 2;
+    pcm_close(p->pcm);
+    p->pcm = NULL;
+    audio_mmap_set_pcm(mmap, NULL, 0);
+    return player_open(p);
+}
+
+static int fail_recovery(struct audio_mmap *mmap, void *cookie)
+{
+    return -ENODEV;
+}
+
+static void player_init(struct player *p, unsigned int card, unsigned int device,
+                        audio_mmap_xrun_cb xrun_cb)
+{
+    memset(p, 0, sizeof(*p));
+    p->card = card;
+    p->device = device;
+    p->config.channels = TEST_CHANNELS;
+    p->config.rate = TEST_RATE;
+    p->config.period_size = PERIOD_SIZE_MIN;
+    p->config.period_count = PERIOD_COUNT;
+    p->config.format = PCM_FORMAT_S16_LE;
+    audio_mmap_init(&p->mmap, WAIT_TIMEOUT_MS, xrun_cb, p);
+}
+
+static int player_write(struct player *p)
+{
+    int16_t buf[WRITE_FRAMES * TEST_CHANNELS];
+    unsigned int f, ch;
+
+    for (f = 0; f < WRITE_FRAMES; f++) {
+        p->sample++;
+        for (ch = 0; ch < TEST_CHANNELS; ch++)
+            buf[f * TEST_CHANNELS + ch] = p->sample;
+    }
+    return audio_mmap_write(&p->mmap, buf, sizeof(buf));
+}
+
+static void player_close(struct player *p)
+{
+    pcm_close(p->pcm);
+    p->pcm = NULL;
+}
+
+/*writes spaced by stall_ms, which underruns when longer than the buffer*/
+static void test_playback(unsigned int card, unsigned int device,
+                          audio_mmap_xrun_cb xrun_cb, unsigned int stall_ms,
+                          unsigned int writes)
+{
+    struct player p;
+    unsigned int w;
+#ifdef FAKE_PCM
+    struct fake_pcm_stats before = fake_pcm_stats;
+#endif
+
+    player_init(&p, card, device, xrun_cb);
+    if (player_open(&p)) {
+        failures++;
+        return;
+    }
+
+    for (w = 0; w < writes; w++) {
+        if (stall_ms && w % 4 == 3)
+            usleep(stall_ms * 1000);
+        CHECK(player_write(&p) == 0);
+    }
+
+    printf("%-16s stall %3u ms: %u writes, %u underruns, period %u\n",
+           xrun_cb ? "reopen" : "prepare", stall_ms, writes, p.mmap.xruns,
+           p.config.period_size);
+
+    if (stall_ms) {
+        CHECK(p.mmap.xruns > 0);
+        if (xrun_cb)
+            CHECK(p.config.period_size > PERIOD_SIZE_MIN);
+    } else {
+        CHECK(p.mmap.xruns == 0);
+    }
+
+#ifdef FAKE_PCM
+    /*nothing dropped across the reopens*/
+    CHECK(fake_pcm_stats.committed - before.committed ==
+          (uint64_t)writes * WRITE_FRAMES);
+    CHECK(fake_pcm_stats.last_sample == p.sample);
+    if (stall_ms && xrun_cb)
+        CHECK(fake_pcm_stats.opens - before.opens > 1);
+#endif
+
+    player_close(&p);
+}
+
+#ifdef FAKE_PCM
+static void test_errors(void)
+{
+    struct player p;
+    int ret;
+
+    /*a failing wait is reported as is, not as a timeout*/
+    player_init(&p, 0, 0, grow_and_reopen);
+    player_open(&p);
+    fake_pcm_set_wait_error(-EIO);
+    do {
+        ret = player_write(&p);
+    } while (ret == 0);
+    CHECK(ret == -EIO);
+    fake_pcm_set_wait_error(0);
+    player_close(&p);
+
+    /*a device that stops draining times out*/
+    player_init(&p, 0, 0, grow_and_reopen);
+    player_open(&p);
+    fake_pcm_set_stalled(1);
+    do {
+        ret = player_write(&p);
+    } while (ret == 0);
+    CHECK(ret == -ETIMEDOUT);
+    fake_pcm_set_stalled(0);
+    player_close(&p);
+
+    /*a failed recovery ends the write with its error*/
+    player_init(&p, 0, 0, fail_recovery);
+    player_open(&p);
+    CHECK(player_write(&p) == 0);
+    CHECK(player_write(&p) == 0);
+    usleep(100 * 1000);
+    CHECK(player_write(&p) == -ENODEV);
+    player_close(&p);
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    unsigned int card = 0, device = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:d:")) != -1) {
+        switch (opt) {
+        case 'c':
+            card = strtoul(optarg, NULL, 0);
+            break;
+        case 'd':
+            device = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-c card] [-d device]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    /*a buffer of 4 x 256 frames at 48 kHz lasts 21 ms*/
+    test_playback(card, device, grow_and_reopen, 0, 24);
+    test_playback(card, device, grow_and_reopen, 60, 48);
+    test_playback(card, device, NULL, 60, 24);
+#ifdef FAKE_PCM
+    test_errors();
+#endif
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("audio_mmap_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Stand-in for the tinyalsa mmap playback calls on the build host. The
+ * hardware pointer advances in real time at the configured rate once
+ * the PCM is started, like snd-dummy does, and the PCM goes to XRUN
+ * when it catches up with the application pointer.
+ */
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <tinyalsa/asoundlib.h>
+
+#include "fake_pcm.h"
+
+struct pcm {
+    struct pcm_config config;
+    unsigned int buffer_frames;
+    int16_t *area;
+    uint64_t appl;          /*frames committed*/
+    uint64_t hw;            /*frames consumed*/
+    uint64_t hw_base;
+    double start_ms;
+    int running;
+    int xrun;
+};
+
+struct fake_pcm_stats fake_pcm_stats;
+static int wait_error;
+static int stalled;
+
+static double now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void update(struct pcm *pcm)
+{
+    if (!pcm->running || stalled)
+        return;
+
+    pcm->hw = pcm->hw_base +
+              (uint64_t)((now_ms() - pcm->start_ms) * pcm->config.rate / 1000.0);
+    if (pcm->hw >= pcm->appl) {
+        pcm->hw = pcm->appl;
+        pcm->running = 0;
+        pcm->xrun = 1;
+        fake_pcm_stats.xruns++;
+    }
+}
+
+static unsigned int avail(struct pcm *pcm)
+{
+    return pcm->buffer_frames - (unsigned int)(pcm->appl - pcm->hw);
+}
+
+void fake_pcm_set_wait_error(int err)
+{
+    wait_error = err;
+}
+
+void fake_pcm_set_stalled(int stall)
+{
+    stalled = stall;
+}
+
+struct pcm *pcm_open(unsigned int card, unsigned int device,
+                     unsigned int flags, struct pcm_config *config)
+{
+    struct pcm *pcm = calloc(1, sizeof(*pcm));
+
+    if (!pcm)
+        return NULL;
+    pcm->config = *config;
+    pcm->buffer_frames = config->period_size * config->period_count;
+    pcm->area = calloc(pcm->buffer_frames, config->channels * sizeof(int16_t));
+    fake_pcm_stats.opens++;
+    fake_pcm_stats.period_size = config->period_size;
+    return pcm;
+}
+
+int pcm_close(struct pcm *pcm)
+{
+    if (pcm) {
+        free(pcm->area);
+        free(pcm);
+    }
+    return 0;
+}
+
+int pcm_is_ready(struct pcm *pcm)
+{
+    return pcm && pcm->area;
+}
+
+const char *pcm_get_error(struct pcm *pcm)
+{
+    return "";
+}
+
+unsigned int pcm_get_buffer_size(struct pcm *pcm)
+{
+    return pcm->buffer_frames;
+}
+
+unsigned int pcm_frames_to_bytes(struct pcm *pcm, unsigned int frames)
+{
+    return frames * pcm->config.channels * sizeof(int16_t);
+}
+
+unsigned int pcm_bytes_to_frames(struct pcm *pcm, unsigned int bytes)
+{
+    return bytes / (pcm->config.channels * sizeof(int16_t));
+}
+
+int pcm_prepare(struct pcm *pcm)
+{
+    pcm->running = 0;
+    pcm->xrun = 0;
+    pcm->hw = pcm->appl;
+    return 0;
+}
+
+int pcm_start(struct pcm *pcm)
+{
+    if (pcm->xrun)
+        return -EPIPE;
+    pcm->running = 1;
+    pcm->hw_base = pcm->hw;
+    pcm->start_ms = now_ms();
+    return 0;
+}
+
+int pcm_avail_update(struct pcm *pcm)
+{
+    update(pcm);
+    if (pcm->xrun)
+        return -EPIPE;
+    return avail(pcm);
+}
+
+int pcm_wait(struct pcm *pcm, int timeout)
+{
+    unsigned int min = pcm->config.avail_min ? pcm->config.avail_min : 1;
+    double deadline = now_ms() + timeout;
+
+    if (wait_error)
+        return wait_error;
+
+    for (;;) {
+        update(pcm);
+        if (pcm->xrun)
+            return -EPIPE;
+        if (avail(pcm) >= min)
+            return 1;
+        if (now_ms() >= deadline)
+            return 0;
+        usleep(500);
+    }
+}
+
+int pcm_mmap_begin(struct pcm *pcm, void **areas, unsigned int *offset,
+                   unsigned int *frames)
+{
+    unsigned int room;
+
+    update(pcm);
+    if (pcm->xrun)
+        return -EPIPE;
+
+    *offset = pcm->appl % pcm->buffer_frames;
+    room = pcm->buffer_frames - *offset;
+    if (*frames > room)
+        *frames = room;
+    if (*frames > avail(pcm))
+        *frames = avail(pcm);
+    *areas = pcm->area;
+    return 0;
+}
+
+int pcm_mmap_commit(struct pcm *pcm, unsigned int offset, unsigned int frames)
+{
+    const int16_t *last = pcm->area + (offset + frames - 1) * pcm->config.channels;
+
+    if (frames) {
+        fake_pcm_stats.last_sample = last[0];
+        fake_pcm_stats.committed += frames;
+    }
+    pcm->appl += frames;
+    return frames;
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FAKE_PCM_H
+#define FAKE_PCM_H
+
+#include <stdint.h>
+
+/*what the fake PCMs saw, across all of them*/
+struct fake_pcm_stats {
+    unsigned int opens;
+    unsigned int xruns;
+    unsigned int period_size;   /*of the last PCM opened*/
+    uint64_t     committed;     /*frames*/
+    int16_t      last_sample;   /*first channel of the last frame committed*/
+};
+
+extern struct fake_pcm_stats fake_pcm_stats;
+
+/*make pcm_wait() fail with err, 0 restores normal operation*/
+void fake_pcm_set_wait_error(int err);
+
+/*freeze the hardware pointer, pcm_wait() then times out*/
+void fake_pcm_set_stalled(int stall);
+
+#endif /*FAKE_PCM_H*/
@@ -0,0 +1,41 @@
+# Copyright (C) 2012 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+
+LOCAL_CFLAGS := -D_POSIX_C_SOURCE=200809
+
+LOCAL_SRC_FILES := \
+        audio_src.c
+
+LOCAL_MODULE := libaudio_src_intel
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_STATIC_LIBRARY)
+
+# THD+N and throughput of the converter on the build host
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+        audio_src_test.c \
+        audio_src.c
+
+LOCAL_STATIC_LIBRARIES := liblog
+LOCAL_LDLIBS := -lm -lrt
+LOCAL_MODULE := audio_src_test
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_HOST_EXECUTABLE)
@@ -0,0 +1,346 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "audio_src"
+//#define LOG_NDEBUG 0
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cutils/log.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "audio_src.h"
+
+/*input frames deinterleaved per pass*/
+#define SRC_CHUNK_FRAMES            512
+
+struct src_quality_params {
+    unsigned int taps;
+    double beta;        /*kaiser window shape*/
+    double rolloff;     /*cutoff relative to the lower nyquist*/
+};
+
+static const struct src_quality_params quality_params[] = {
+    [AUDIO_SRC_QUALITY_LOW]       = {  8, 5.0, 0.80 },
+    [AUDIO_SRC_QUALITY_MEDIUM]    = { 16, 7.0, 0.88 },
+    [AUDIO_SRC_QUALITY_HIGH]      = { 32, 9.0, 0.93 },
+    [AUDIO_SRC_QUALITY_VERY_HIGH] = { 64, 11.0, 0.96 },
+};
+
+struct audio_src {
+    unsigned int in_rate;
+    unsigned int out_rate;
+    unsigned int channels;
+    unsigned int taps;
+
+    /*ratio out/in reduced to L/M*/
+    unsigned int L;
+    unsigned int M;
+    unsigned int step_int;      /*M / L*/
+    unsigned int step_frac;     /*M % L*/
+
+    /*L phases of taps coefficients, reversed for a forward dot product*/
+    int16_t *coefs;
+
+    /*per channel history + current chunk, in input frames*/
+    int16_t *planar[AUDIO_SRC_MAX_CHANNELS];
+    size_t buf_frames;
+
+    /*next output position: window start in planar + phase*/
+    size_t index;
+    unsigned int phase;
+};
+
+static unsigned int gcd(unsigned int a, unsigned int b)
+{
+    while (b) {
+        unsigned int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/*zeroth order modified bessel function of the first kind*/
+static double bessel_i0(double x)
+{
+    double sum = 1.0, term = 1.0, half = x / 2.0;
+    int k;
+
+    for (k = 1; k < 50; k++) {
+        term *= (half / k) * (half / k);
+        sum += term;
+        if (term < sum * 1e-12)
+            break;
+    }
+    return sum;
+}
+
+static int design_filter(struct audio_src *src,
+                         const struct src_quality_params *params)
+{
+    const unsigned int L = src->L, taps = src->taps;
+    const size_t length = (size_t)taps * L;
+    const double center = (length - 1) / 2.0;
+    const double ratio = src->M > L ? (double)L / src->M : 1.0;
+    /*cutoff in cycles per sample of the L times upsampled signal*/
+    const double fc = params->rolloff * ratio / (2.0 * L);
+    const double i0_beta = bessel_i0(params->beta);
+    unsigned int p, j;
+    double *proto;
+
+    proto = malloc(length * sizeof(double));
+    if (!proto)
+        return -ENOMEM;
+
+    for (j = 0; j < length; j++) {
+        double x = j - center;
+        double r = 2.0 * j / (length - 1) - 1.0;
+        double sinc = x == 0.0 ? 2.0 * fc :
+                      sin(2.0 * M_PI * fc * x) / (M_PI * x);
+        double w = bessel_i0(params->beta * sqrt(1.0 - r * r)) / i0_beta;
+        /*gain L compensates for the zeros stuffed by upsampling*/
+        proto[j] = sinc * w * L;
+    }
+
+    for (p = 0; p < L; p++) {
+        int16_t *c = src->coefs + (size_t)p * taps;
+        for (j = 0; j < taps; j++) {
+            long q = lround(proto[(size_t)(taps - 1 - j) * L + p] * 32768.0);
+            if (q > 32767)
+                q = 32767;
+            else if (q < -32768)
+                q = -32768;
+            c[j] = q;
+        }
+    }
+
+    free(proto);
+    return 0;
+}
+
+struct audio_src *audio_src_create(unsigned int in_rate, unsigned int out_rate,
+                                   unsigned int channels,
+                                   enum audio_src_quality quality)
+{
+    const struct src_quality_params *params;
+    struct audio_src *src;
+    unsigned int g, ch;
+    void *mem;
+
+    if (!in_rate || !out_rate || !channels ||
+        channels > AUDIO_SRC_MAX_CHANNELS ||
+        quality > AUDIO_SRC_QUALITY_VERY_HIGH)
+        return NULL;
+
+    g = gcd(in_rate, out_rate);
+    if (out_rate / g > AUDIO_SRC_MAX_PHASES) {
+        ALOGE("%s: %u -> %u needs %u phases", __func__,
+              in_rate, out_rate, out_rate / g);
+        return NULL;
+    }
+
+    src = calloc(1, sizeof(*src));
+    if (!src)
+        return NULL;
+
+    params = &quality_params[quality];
+    src->in_rate   = in_rate;
+    src->out_rate  = out_rate;
+    src->channels  = channels;
+    src->taps      = params->taps;
+    src->L         = out_rate / g;
+    src->M         = in_rate / g;
+    src->step_int  = src->M / src->L;
+    src->step_frac = src->M % src->L;
+
+    if (posix_memalign(&mem, 16, (size_t)src->L * src->taps * sizeof(int16_t)))
+        goto err;
+    src->coefs = mem;
+
+    for (ch = 0; ch < channels; ch++) {
+        src->planar[ch] = calloc(src->taps + SRC_CHUNK_FRAMES, sizeof(int16_t));
+        if (!src->planar[ch])
+            goto err;
+    }
+
+    if (design_filter(src, params))
+        goto err;
+
+    audio_src_reset(src);
+
+    ALOGD("%s: %u -> %u Hz, %u channels, L/M %u/%u, %u taps", __func__,
+          in_rate, out_rate, channels, src->L, src->M, src->taps);
+    return src;
+
+err:
+    audio_src_destroy(src);
+    return NULL;
+}
+
+void audio_src_destroy(struct audio_src *src)
+{
+    unsigned int ch;
+
+    if (!src)
+        return;
+
+    for (ch = 0; ch < src->channels; ch++)
+        free(src->planar[ch]);
+    free(src->coefs);
+    free(src);
+}
+
+void audio_src_reset(struct audio_src *src)
+{
+    unsigned int ch;
+
+    /*taps - 1 frames of silence so the first window is complete*/
+    for (ch = 0; ch < src->channels; ch++)
+        memset(src->planar[ch], 0, (src->taps - 1) * sizeof(int16_t));
+    src->buf_frames = src->taps - 1;
+    src->index = 0;
+    src->phase = 0;
+}
+
+unsigned int audio_src_get_latency(const struct audio_src *src)
+{
+    return src->taps / 2;
+}
+
+/*outputs whose window ends before buffered frame `avail`*/
+static size_t frames_ready(const struct audio_src *src, size_t avail)
+{
+    uint64_t end, pos;
+
+    if (avail < src->taps)
+        return 0;
+    end = (uint64_t)(avail - src->taps + 1) * src->L;
+    pos = (uint64_t)src->index * src->L + src->phase;
+    if (end <= pos)
+        return 0;
+    return (end - pos + src->M - 1) / src->M;
+}
+
+size_t audio_src_get_out_frames(const struct audio_src *src, size_t in_frames)
+{
+    return frames_ready(src, src->buf_frames + in_frames);
+}
+
+static inline int32_t dot_product(const int16_t *x, const int16_t *c,
+                                  unsigned int taps)
+{
+#ifdef __SSE2__
+    /*taps is always a multiple of 8, coefficients are 16 byte aligned*/
+    __m128i acc = _mm_setzero_si128();
+    unsigned int j;
+
+    for (j = 0; j < taps; j += 8) {
+        __m128i vx = _mm_loadu_si128((const __m128i *)(x + j));
+        __m128i vc = _mm_load_si128((const __m128i *)(c + j));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(vx, vc));
+    }
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(acc);
+#else
+    int32_t acc = 0;
+    unsigned int j;
+
+    for (j = 0; j < taps; j++)
+        acc += (int32_t)x[j] * c[j];
+    return acc;
+#endif
+}
+
+static inline int16_t clamp16(int32_t sample)
+{
+    if (sample > 32767)
+        return 32767;
+    if (sample < -32768)
+        return -32768;
+    return sample;
+}
+
+size_t audio_src_process(struct audio_src *src, const int16_t *in,
+                         size_t in_frames, int16_t *out, size_t out_frames)
+{
+    const unsigned int channels = src->channels;
+    const unsigned int taps = src->taps;
+    size_t written = 0;
+    unsigned int ch;
+
+    while (in_frames) {
+        size_t n = taps + SRC_CHUNK_FRAMES - src->buf_frames;
+        size_t f;
+
+        if (n > in_frames)
+            n = in_frames;
+
+        for (f = 0; f < n; f++) {
+            for (ch = 0; ch < channels; ch++)
+                src->planar[ch][src->buf_frames + f] = in[ch];
+            in += channels;
+        }
+        src->buf_frames += n;
+        in_frames -= n;
+
+        while (src->index + taps <= src->buf_frames) {
+            const int16_t *c = src->coefs + (size_t)src->phase * taps;
+
+            if (written == out_frames) {
+                ALOGE("%s: output buffer too small, dropping frames", __func__);
+                src->index = src->buf_frames - (taps - 1);
+                break;
+            }
+            for (ch = 0; ch < channels; ch++) {
+                int32_t acc = dot_product(src->planar[ch] + src->index, c, taps);
+                out[ch] = clamp16((acc + (1 << 14)) >> 15);
+            }
+            out += channels;
+            written++;
+
+            src->index += src->step_int;
+            src->phase += src->step_frac;
+            if (src->phase >= src->L) {
+                src->phase -= src->L;
+                src->index++;
+            }
+        }
+
+        /*decimation may step past the frames buffered so far*/
+        if (src->index > src->buf_frames) {
+            src->index -= src->buf_frames;
+            src->buf_frames = 0;
+            continue;
+        }
+
+        /*keep the frames the next windows still need*/
+        for (ch = 0; ch < channels; ch++)
+            memmove(src->planar[ch], src->planar[ch] + src->index,
+                    (src->buf_frames - src->index) * sizeof(int16_t));
+        src->buf_frames -= src->index;
+        src->index = 0;
+    }
+
+    return written;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AUDIO_SRC_H
+#define AUDIO_SRC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Polyphase sample rate converter for 16 bit interleaved PCM.
+ *
+ * The conversion ratio is reduced to out_rate/in_rate = L/M and a
+ * windowed sinc prototype of (taps * L) coefficients is split into L
+ * phases of taps coefficients each. The group delay, and therefore the
+ * latency added by the converter, is taps/2 input frames.
+ */
+enum audio_src_quality {
+    AUDIO_SRC_QUALITY_LOW,          /*8 taps per phase*/
+    AUDIO_SRC_QUALITY_MEDIUM,       /*16 taps per phase*/
+    AUDIO_SRC_QUALITY_HIGH,         /*32 taps per phase*/
+    AUDIO_SRC_QUALITY_VERY_HIGH,    /*64 taps per phase*/
+};
+
+#define AUDIO_SRC_MAX_CHANNELS      8
+/*largest L supported, enough for any pair of the common audio rates*/
+#define AUDIO_SRC_MAX_PHASES        1024
+
+struct audio_src;
+
+/* Returns NULL if the ratio needs more than AUDIO_SRC_MAX_PHASES
+ * phases, the channel count is out of range or on allocation failure.
+ */
+struct audio_src *audio_src_create(unsigned int in_rate, unsigned int out_rate,
+                                   unsigned int channels,
+                                   enum audio_src_quality quality);
+
+void audio_src_destroy(struct audio_src *src);
+
+/*drop the filter history, e.g. on standby*/
+void audio_src_reset(struct audio_src *src);
+
+/*upper bound of the frames produced by the next audio_src_process() call*/
+size_t audio_src_get_out_frames(const struct audio_src *src, size_t in_frames);
+
+/*filter delay in input frames*/
+unsigned int audio_src_get_latency(const struct audio_src *src);
+
+/* Consume all of in_frames and write the converted frames to out,
+ * which must hold at least audio_src_get_out_frames(in_frames) frames.
+ * Returns the number of frames written.
+ */
+size_t audio_src_process(struct audio_src *src, const int16_t *in,
+                         size_t in_frames, int16_t *out, size_t out_frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*AUDIO_SRC_H*/
@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Host test for the sample rate converter.
+ *
+ * Converts a full scale sine, fits a sine at the expected output
+ * frequency to one second of output and reports everything else as
+ * THD+N, which has to stay under a per quality limit. Then measures the
+ * conversion throughput.
+ *
+ * usage: audio_src_test [-b seconds]   (-b 0 skips the benchmark)
+ */
+#define LOG_TAG "audio_src_test"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "audio_src.h"
+
+#define TEST_CHANNELS               2
+#define TONE_AMPLITUDE              (32767 * 0.891)   /*-1 dBFS*/
+/*audio buffers the HALs convert per write*/
+#define WRITE_FRAMES                1024
+#define BENCH_SECONDS               60
+
+struct rate_pair {
+    unsigned int in_rate;
+    unsigned int out_rate;
+};
+
+static const struct rate_pair rate_pairs[] = {
+    { 44100, 48000 },
+    { 48000, 44100 },
+    { 32000, 48000 },
+    { 22050, 48000 },
+    { 48000, 96000 },
+    { 96000, 48000 },
+};
+
+static const unsigned int tones[] = { 997, 7993 };
+
+/* THD+N limits in dB. The 16 bit noise floor sits around -98 dB, the
+ * Q15 coefficients keep the two best settings a little above -85 dB.
+ */
+static const double thdn_limit[] = {
+    [AUDIO_SRC_QUALITY_LOW]       = -45.0,
+    [AUDIO_SRC_QUALITY_MEDIUM]    = -70.0,
+    [AUDIO_SRC_QUALITY_HIGH]      = -80.0,
+    [AUDIO_SRC_QUALITY_VERY_HIGH] = -80.0,
+};
+
+static const char *const quality_names[] = {
+    "low", "medium", "high", "very high",
+};
+
+static int failures;
+
+static void make_tone(int16_t *buf, size_t frames, unsigned int rate,
+                      unsigned int freq)
+{
+    size_t f;
+    unsigned int ch;
+
+    for (f = 0; f < frames; f++) {
+        int16_t s = lround(TONE_AMPLITUDE * sin(2.0 * M_PI * freq * f / rate));
+        for (ch = 0; ch < TEST_CHANNELS; ch++)
+            buf[f * TEST_CHANNELS + ch] = s;
+    }
+}
+
+/* Fit a*sin + b*cos + dc at freq to one second of a channel and return
+ * the residual over the fitted tone power, in dB. One second holds a
+ * whole number of periods so the projections are exact.
+ */
+static double measure_thdn(const int16_t *buf, unsigned int rate,
+                           unsigned int freq, unsigned int ch)
+{
+    double a = 0.0, b = 0.0, dc = 0.0, signal, noise = 0.0;
+    unsigned int n;
+
+    for (n = 0; n < rate; n++) {
+        double x = buf[n * TEST_CHANNELS + ch];
+        double w = 2.0 * M_PI * freq * n / rate;
+
+        a += x * sin(w);
+        b += x * cos(w);
+        dc += x;
+    }
+    a *= 2.0 / rate;
+    b *= 2.0 / rate;
+    dc /= rate;
+
+    for (n = 0; n < rate; n++) {
+        double w = 2.0 * M_PI * freq * n / rate;
+        double e = buf[n * TEST_CHANNELS + ch] - (a * sin(w) + b * cos(w) + dc);
+        noise += e * e;
+    }
+    signal = (a * a + b * b) / 2.0 * rate;
+
+    return 10.0 * log10(noise / signal);
+}
+
+static void check_thdn(const struct rate_pair *pair, unsigned int freq,
+                       enum audio_src_quality quality)
+{
+    /*skip the filter start up, then analyse one second*/
+    const size_t in_frames = pair->in_rate * 2 + 4096;
+    int16_t *in = malloc(in_frames * TEST_CHANNELS * sizeof(int16_t));
+    int16_t *out = NULL;
+    struct audio_src *src;
+    size_t produced = 0, pos, skip;
+    double thdn;
+    unsigned int ch;
+
+    src = audio_src_create(pair->in_rate, pair->out_rate, TEST_CHANNELS, quality);
+    if (!src || !in) {
+        fprintf(stderr, "%u -> %u: create failed\n", pair->in_rate, pair->out_rate);
+        failures++;
+        goto done;
+    }
+
+    out = malloc(audio_src_get_out_frames(src, in_frames) * TEST_CHANNELS *
+                 sizeof(int16_t));
+    if (!out)
+        goto done;
+
+    make_tone(in, in_frames, pair->in_rate, freq);
+
+    /*feed it the way the HALs do, one write at a time*/
+    for (pos = 0; pos < in_frames; pos += WRITE_FRAMES) {
+        size_t n = in_frames - pos < WRITE_FRAMES ? in_frames - pos : WRITE_FRAMES;
+
+        produced += audio_src_process(src, in + pos * TEST_CHANNELS, n,
+                                      out + produced * TEST_CHANNELS,
+                                      audio_src_get_out_frames(src, n));
+    }
+
+    skip = pair->out_rate / 2;
+    if (produced < skip + pair->out_rate) {
+        fprintf(stderr, "%u -> %u: only %zu frames produced\n",
+                pair->in_rate, pair->out_rate, produced);
+        failures++;
+        goto done;
+    }
+
+    for (ch = 0; ch < TEST_CHANNELS; ch++) {
+        thdn = measure_thdn(out + skip * TEST_CHANNELS, pair->out_rate, freq, ch);
+        if (ch == 0)
+            printf("%6u -> %6u  %5u Hz  %-9s  THD+N %7.1f dB\n", pair->in_rate,
+                   pair->out_rate, freq, quality_names[quality], thdn);
+        if (thdn > thdn_limit[quality]) {
+            fprintf(stderr, "%u -> %u %u Hz %s: THD+N %.1f dB above %.1f dB\n",
+                    pair->in_rate, pair->out_rate, freq, quality_names[quality],
+                    thdn, thdn_limit[quality]);
+            failures++;
+        }
+    }
+
+done:
+    audio_src_destroy(src);
+    free(in);
+    free(out);
+}
+
+static double now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void bench(const struct rate_pair *pair, enum audio_src_quality quality,
+                  unsigned int seconds)
+{
+    int16_t in[WRITE_FRAMES * TEST_CHANNELS];
+    int16_t *out;
+    struct audio_src *src;
+    size_t writes = (size_t)pair->in_rate * seconds / WRITE_FRAMES, w;
+    double t0, ms;
+
+    src = audio_src_create(pair->in_rate, pair->out_rate, TEST_CHANNELS, quality);
+    if (!src)
+        return;
+    out = malloc(audio_src_get_out_frames(src, WRITE_FRAMES) * TEST_CHANNELS *
+                 sizeof(int16_t));
+    if (!out) {
+        audio_src_destroy(src);
+        return;
+    }
+    make_tone(in, WRITE_FRAMES, pair->in_rate, tones[0]);
+
+    t0 = now_ms();
+    for (w = 0; w < writes; w++)
+        audio_src_process(src, in, WRITE_FRAMES, out,
+                          audio_src_get_out_frames(src, WRITE_FRAMES));
+    ms = now_ms() - t0;
+
+    printf("%6u -> %6u  %-9s  %7.1f Mframes/s  %6.0fx realtime\n",
+           pair->in_rate, pair->out_rate, quality_names[quality],
+           writes * WRITE_FRAMES / ms / 1000.0, seconds * 1000.0 / ms);
+
+    free(out);
+    audio_src_destroy(src);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int seconds = BENCH_SECONDS;
+    unsigned int p, t;
+    int q, opt;
+
+    while ((opt = getopt(argc, argv, "b:")) != -1) {
+        switch (opt) {
+        case 'b':
+            seconds = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-b seconds]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    for (p = 0; p < sizeof(rate_pairs) / sizeof(rate_pairs[0]); p++)
+        for (t = 0; t < sizeof(tones) / sizeof(tones[0]); t++)
+            for (q = AUDIO_SRC_QUALITY_LOW; q <= AUDIO_SRC_QUALITY_VERY_HIGH; q++)
+                check_thdn(&rate_pairs[p], tones[t], q);
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("audio_src_test: all checks passed\n");
+
+    if (seconds) {
+        for (q = AUDIO_SRC_QUALITY_LOW; q <= AUDIO_SRC_QUALITY_VERY_HIGH; q++)
+            bench(&rate_pairs[0], q, seconds);
+    }
+    return 0;
+}
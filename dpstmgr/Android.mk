@@ -4,15 +4,38 @@ LOCAL_PATH:= $(call my-dir)
 include $(CLEAR_VARS)
 
 LOCAL_SRC_FILES:= \
-	dpstmgr.c
+	dpstmgr.c \
+	dpst_engine.c \
+	dpst_loop.c
 
 LOCAL_SHARED_LIBRARIES := \
 	liblog \
-	libdm_dpst
+	libcutils
+ifneq ($(INTEL_DPST_NETLINK),)
+LOCAL_CFLAGS += -DNETLINK_DISPMGR=$(INTEL_DPST_NETLINK)
+endif
+ifneq ($(INTEL_DPST_CMD_HDR_SIZE),)
+LOCAL_CFLAGS += -DDPSTMGR_CMD_HDR_SIZE=$(INTEL_DPST_CMD_HDR_SIZE)
+endif
 LOCAL_MODULE:= dpstmgr
 LOCAL_MODULE_TAGS := optional
 
 include $(BUILD_EXECUTABLE)
-include $(LOCAL_PATH)/lib/Android.mk
+
+# replays recorded histograms through the engine on the build host
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	dpst_sim.c \
+	dpst_engine.c \
+	dpst_loop.c
+
+LOCAL_STATIC_LIBRARIES := \
+	liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE:= dpst_sim
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_HOST_EXECUTABLE)
 
 endif
@@ -0,0 +1,152 @@
+#define LOG_TAG "dpstmgr"
+
+#include <cutils/log.h>
+#include <string.h>
+
+#include "dpst_engine.h"
+
+#define FIX_ONE			(1 << 16)
+#define BIN_SHIFT		11	/* FIX_ONE / DPST_HIST_BINS */
+#define MAX_REDUCTION		90
+
+/* per aggressiveness level */
+static const struct dpst_params default_params[] = {
+	{  0,  0, 3, 1, 2, 3, 100 },
+	{ 10,  2, 3, 1, 2, 3, 100 },
+	{ 20,  5, 3, 1, 2, 3, 100 },
+	{ 30, 10, 4, 1, 2, 4, 100 },
+	{ 40, 20, 4, 1, 2, 5, 100 },
+};
+
+void dpst_engine_default_params(struct dpst_params *params, unsigned int level)
+{
+	unsigned int max = sizeof(default_params) / sizeof(default_params[0]) - 1;
+
+	*params = default_params[level > max ? max : level];
+}
+
+void dpst_engine_init(struct dpst_engine *engine, const struct dpst_params *params)
+{
+	memset(engine, 0, sizeof(*engine));
+	engine->params = *params;
+	if (engine->params.max_reduction > MAX_REDUCTION)
+		engine->params.max_reduction = MAX_REDUCTION;
+	engine->filtered = FIX_ONE;
+	engine->percent = 100;
+}
+
+/* backlight scale the histogram content allows, 16.16 */
+static int32_t hist_target(const struct dpst_engine *engine,
+			   const struct dpst_hist_data *hist)
+{
+	uint64_t total = 0, clip, acc = 0;
+	int32_t floor;
+	int b;
+
+	for (b = 0; b < DPST_HIST_BINS; b++)
+		total += hist->bins[b];
+
+	floor = FIX_ONE - (int32_t)(engine->params.max_reduction * FIX_ONE / 100);
+	if (!total)
+		return FIX_ONE;
+
+	/* brightest bin that has to stay unclipped */
+	clip = total * engine->params.clip_permille / 1000;
+	for (b = DPST_HIST_BINS - 1; b > 0; b--) {
+		if (acc + hist->bins[b] > clip)
+			break;
+		acc += hist->bins[b];
+	}
+
+	return ((b + 1) << BIN_SHIFT) < floor ? floor : (b + 1) << BIN_SHIFT;
+}
+
+static enum dpst_action step(struct dpst_engine *engine,
+			     uint64_t now_ms, uint64_t *deadline_ms)
+{
+	const struct dpst_params *p = &engine->params;
+	int want, diff;
+
+	want = (int)(((int64_t)engine->filtered * 100 + FIX_ONE / 2) >> 16);
+	if (want > 100)
+		want = 100;
+	diff = want - (int)engine->percent;
+
+	/* small changes are not worth a gamma upload, except going back to full */
+	if (!diff || ((diff < 0 ? -diff : diff) < (int)p->hysteresis && want != 100)) {
+		engine->pending = false;
+		return DPST_ACTION_NONE;
+	}
+
+	if (engine->applied_once &&
+	    now_ms < engine->last_apply_ms + p->min_interval_ms) {
+		engine->pending = true;
+		*deadline_ms = engine->last_apply_ms + p->min_interval_ms;
+		return DPST_ACTION_DEFER;
+	}
+
+	/* dimming is spread over several steps, brightening is immediate
+	 * so that content is not clipped */
+	if (diff < 0 && -diff > (int)p->max_dim_step)
+		want = engine->percent - p->max_dim_step;
+
+	engine->percent = want;
+	engine->last_apply_ms = now_ms;
+	engine->applied_once = true;
+	engine->pending = false;
+	engine->gamma_updates++;
+	return DPST_ACTION_APPLY;
+}
+
+enum dpst_action dpst_engine_process(struct dpst_engine *engine,
+				     const struct dpst_hist_data *hist,
+				     uint64_t now_ms, uint64_t *deadline_ms)
+{
+	int32_t delta, inc;
+	unsigned int shift;
+
+	engine->histograms++;
+	if (!engine->params.max_reduction)
+		return DPST_ACTION_NONE;
+
+	delta = hist_target(engine, hist) - engine->filtered;
+	shift = delta > 0 ? engine->params.brighten_shift : engine->params.dim_shift;
+	inc = delta / (1 << shift);
+	if (!inc && delta)
+		inc = delta > 0 ? 1 : -1;
+	engine->filtered += inc;
+
+	return step(engine, now_ms, deadline_ms);
+}
+
+enum dpst_action dpst_engine_poll(struct dpst_engine *engine,
+				  uint64_t now_ms, uint64_t *deadline_ms)
+{
+	return step(engine, now_ms, deadline_ms);
+}
+
+void dpst_engine_reset(struct dpst_engine *engine)
+{
+	engine->filtered = FIX_ONE;
+	engine->percent = 100;
+	engine->pending = false;
+	engine->gamma_updates++;
+}
+
+void dpst_engine_get_bl(const struct dpst_engine *engine, struct dpst_bl_data *bl)
+{
+	bl->percent = engine->percent;
+}
+
+void dpst_engine_get_gamma(const struct dpst_engine *engine, struct dpst_gamma_data *gamma)
+{
+	uint32_t gain = FIX_ONE * 100 / engine->percent;
+	uint32_t i, v;
+
+	for (i = 0; i < DPST_GAMMA_SIZE; i++) {
+		v = (i * gain + FIX_ONE / 2) >> 16;
+		if (v > 255)
+			v = 255;
+		gamma->lut[i] = (v << 16) | (v << 8) | v;
+	}
+}
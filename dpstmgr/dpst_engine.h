@@ -0,0 +1,69 @@
+#ifndef H_DPST_ENGINE_H
+#define H_DPST_ENGINE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dpstmgr.h"
+
+/*
+ * Histogram to backlight engine.
+ *
+ * For every histogram the engine finds the luma level below which all
+ * but clip_permille of the pixels lie, and dims the backlight to that
+ * level while boosting the gamma by the inverse so the picture keeps
+ * its brightness. All math is 16.16 fixed point.
+ *
+ * The target is smoothed over histograms (fast when brightening, slow
+ * when dimming), changes smaller than the hysteresis are ignored and a
+ * backlight + gamma pair is applied at most once per min_interval_ms.
+ */
+struct dpst_params {
+	unsigned int	max_reduction;		/* percent of backlight that may be removed */
+	unsigned int	clip_permille;		/* pixels allowed to saturate */
+	unsigned int	dim_shift;		/* smoothing when dimming, 1/2^n per histogram */
+	unsigned int	brighten_shift;		/* smoothing when brightening */
+	unsigned int	hysteresis;		/* percent */
+	unsigned int	max_dim_step;		/* percent per applied step */
+	unsigned int	min_interval_ms;	/* between two gamma uploads */
+};
+
+struct dpst_engine {
+	struct dpst_params	params;
+	int32_t			filtered;	/* 16.16 backlight scale */
+	unsigned int		percent;	/* applied backlight */
+	uint64_t		last_apply_ms;
+	bool			applied_once;
+	bool			pending;	/* a step is waiting for the rate limit */
+
+	unsigned int		histograms;
+	unsigned int		gamma_updates;
+};
+
+enum dpst_action {
+	DPST_ACTION_NONE,
+	DPST_ACTION_APPLY,	/* send bl and gamma */
+	DPST_ACTION_DEFER,	/* call dpst_engine_poll() at *deadline_ms */
+};
+
+void dpst_engine_init(struct dpst_engine *engine, const struct dpst_params *params);
+
+/* aggressiveness 0 (off) to 4 */
+void dpst_engine_default_params(struct dpst_params *params, unsigned int level);
+
+enum dpst_action dpst_engine_process(struct dpst_engine *engine,
+				     const struct dpst_hist_data *hist,
+				     uint64_t now_ms, uint64_t *deadline_ms);
+
+/* re-evaluate a deferred step */
+enum dpst_action dpst_engine_poll(struct dpst_engine *engine,
+				  uint64_t now_ms, uint64_t *deadline_ms);
+
+/* back to full backlight and identity gamma, applied immediately */
+void dpst_engine_reset(struct dpst_engine *engine);
+
+/* payloads for the last DPST_ACTION_APPLY */
+void dpst_engine_get_bl(const struct dpst_engine *engine, struct dpst_bl_data *bl);
+void dpst_engine_get_gamma(const struct dpst_engine *engine, struct dpst_gamma_data *gamma);
+
+#endif
@@ -0,0 +1,225 @@
+#define LOG_TAG "dpstmgr"
+
+#include <cutils/log.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/netlink.h>
+
+#include "dpst_loop.h"
+
+#define MAX_PAYLOAD		sizeof(struct dpst_gamma_data)
+#define MAX_MSG			(NLMSG_SPACE(DPSTMGR_CMD_HDR_SIZE + MAX_PAYLOAD))
+
+uint64_t dpst_now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+int dpst_send(struct dpst_transport *t, unsigned int cmd,
+	      const void *data, unsigned int size)
+{
+	uint8_t buf[MAX_MSG];
+	struct dpstmgr_cmd_hdr *hdr;
+	size_t len = DPSTMGR_CMD_HDR_SIZE + size;
+	ssize_t ret;
+
+	if (size > MAX_PAYLOAD)
+		return -EINVAL;
+
+	memset(buf, 0, sizeof(buf));
+	if (t->netlink) {
+		struct nlmsghdr *nlh = (struct nlmsghdr *)buf;
+
+		nlh->nlmsg_len = NLMSG_LENGTH(len);
+		nlh->nlmsg_pid = getpid();
+		hdr = NLMSG_DATA(nlh);
+		len = nlh->nlmsg_len;
+	} else {
+		hdr = (struct dpstmgr_cmd_hdr *)buf;
+	}
+
+	hdr->module = DISPMGR_MOD_DPST;
+	hdr->cmd = cmd;
+	hdr->data_size = size;
+	if (size)
+		memcpy((uint8_t *)hdr + DPSTMGR_CMD_HDR_SIZE, data, size);
+
+	if (t->netlink) {
+		struct sockaddr_nl dst;
+
+		memset(&dst, 0, sizeof(dst));
+		dst.nl_family = AF_NETLINK;
+		ret = sendto(t->fd, buf, len, 0, (struct sockaddr *)&dst, sizeof(dst));
+	} else {
+		ret = send(t->fd, buf, len, 0);
+	}
+
+	if (ret < 0) {
+		ALOGE("%s: cmd %u failed: %s", __func__, cmd, strerror(errno));
+		return -errno;
+	}
+	return 0;
+}
+
+int dpst_apply(struct dpst_transport *t, const struct dpst_engine *engine,
+	       unsigned int prev_percent)
+{
+	struct dpst_bl_data bl;
+	struct dpst_gamma_data gamma;
+	int ret;
+
+	dpst_engine_get_bl(engine, &bl);
+	dpst_engine_get_gamma(engine, &gamma);
+	ALOGV("%s: backlight %u%%", __func__, bl.percent);
+
+	/* boost the picture before dimming and brighten before un-boosting,
+	 * so the transition never shows a darker frame */
+	if (bl.percent < prev_percent) {
+		ret = dpst_send(t, DISPMGR_DPST_GAMMA_SET, &gamma, sizeof(gamma));
+		if (!ret)
+			ret = dpst_send(t, DISPMGR_DPST_BL_SET, &bl, sizeof(bl));
+	} else {
+		ret = dpst_send(t, DISPMGR_DPST_BL_SET, &bl, sizeof(bl));
+		if (!ret)
+			ret = dpst_send(t, DISPMGR_DPST_GAMMA_SET, &gamma, sizeof(gamma));
+	}
+	return ret;
+}
+
+/* returns the payload of a DPST command, NULL for anything else */
+static const struct dpstmgr_cmd_hdr *parse_msg(struct dpst_transport *t,
+					       const uint8_t *buf, ssize_t len)
+{
+	const struct dpstmgr_cmd_hdr *hdr;
+	size_t size = len;
+
+	if (t->netlink) {
+		const struct nlmsghdr *nlh = (const struct nlmsghdr *)buf;
+
+		if (!NLMSG_OK(nlh, size))
+			return NULL;
+		hdr = NLMSG_DATA(nlh);
+		size = NLMSG_PAYLOAD(nlh, 0);
+	} else {
+		hdr = (const struct dpstmgr_cmd_hdr *)buf;
+	}
+
+	if (size < DPSTMGR_CMD_HDR_SIZE || size - DPSTMGR_CMD_HDR_SIZE < hdr->data_size)
+		return NULL;
+	if (hdr->module != DISPMGR_MOD_DPST)
+		return NULL;
+	return hdr;
+}
+
+static void handle_action(struct dpst_transport *t, struct dpst_engine *engine,
+			  enum dpst_action action, unsigned int prev_percent,
+			  uint64_t now, uint64_t *deadline, bool *pending)
+{
+	if (action == DPST_ACTION_APPLY) {
+		dpst_apply(t, engine, prev_percent);
+		/* more steps may be needed to reach the target */
+		action = dpst_engine_poll(engine, now, deadline);
+	}
+	*pending = action == DPST_ACTION_DEFER;
+}
+
+int dpst_loop_run(struct dpst_transport *t, struct dpst_engine *engine, int stop_fd)
+{
+	struct epoll_event ev, events[2];
+	uint8_t buf[MAX_MSG];
+	uint64_t deadline = 0, now;
+	bool pending = false;
+	int ep, n, i, ret = 0;
+
+	ep = epoll_create(2);
+	if (ep < 0) {
+		ALOGE("%s: epoll_create failed: %s", __func__, strerror(errno));
+		return -errno;
+	}
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.fd = t->fd;
+	epoll_ctl(ep, EPOLL_CTL_ADD, t->fd, &ev);
+	if (stop_fd >= 0) {
+		ev.data.fd = stop_fd;
+		epoll_ctl(ep, EPOLL_CTL_ADD, stop_fd, &ev);
+	}
+
+	for (;;) {
+		int timeout = -1;
+
+		if (pending) {
+			now = dpst_now_ms();
+			timeout = deadline > now ? (int)(deadline - now) : 0;
+		}
+
+		n = epoll_wait(ep, events, 2, timeout);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			ALOGE("%s: epoll_wait failed: %s", __func__, strerror(errno));
+			ret = -errno;
+			break;
+		}
+
+		now = dpst_now_ms();
+		if (!n) {
+			unsigned int prev = engine->percent;
+			handle_action(t, engine, dpst_engine_poll(engine, now, &deadline),
+				      prev, now, &deadline, &pending);
+			continue;
+		}
+
+		for (i = 0; i < n; i++) {
+			const struct dpstmgr_cmd_hdr *hdr;
+			unsigned int prev;
+			ssize_t len;
+
+			if (events[i].data.fd == stop_fd)
+				goto out;
+			if (!(events[i].events & EPOLLIN))
+				goto out;
+
+			len = recv(t->fd, buf, sizeof(buf), 0);
+			if (len <= 0) {
+				if (len < 0 && errno == EINTR)
+					continue;
+				goto out;
+			}
+
+			hdr = parse_msg(t, buf, len);
+			if (!hdr) {
+				ALOGW("%s: dropped malformed message", __func__);
+				continue;
+			}
+
+			switch (hdr->cmd) {
+			case DISPMGR_DPST_HIST_DATA:
+				if (hdr->data_size < sizeof(struct dpst_hist_data))
+					break;
+				prev = engine->percent;
+				handle_action(t, engine,
+					      dpst_engine_process(engine,
+						      (const struct dpst_hist_data *)DPSTMGR_CMD_PAYLOAD(hdr),
+						      now, &deadline),
+					      prev, now, &deadline, &pending);
+				break;
+			default:
+				ALOGV("%s: ignored cmd %u", __func__, hdr->cmd);
+				break;
+			}
+		}
+	}
+
+out:
+	close(ep);
+	return ret;
+}
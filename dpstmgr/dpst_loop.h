@@ -0,0 +1,30 @@
+#ifndef H_DPST_LOOP_H
+#define H_DPST_LOOP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dpst_engine.h"
+
+/* Channel to the kernel display manager. The daemon uses a netlink
+ * socket, the simulator one end of a socketpair carrying the same
+ * commands without the netlink header. */
+struct dpst_transport {
+	int		fd;
+	bool		netlink;
+};
+
+int dpst_send(struct dpst_transport *t, unsigned int cmd,
+	      const void *data, unsigned int size);
+
+/* send the engine's current backlight and gamma */
+int dpst_apply(struct dpst_transport *t, const struct dpst_engine *engine,
+	       unsigned int prev_percent);
+
+/* Process histograms until stop_fd becomes readable or the transport
+ * is closed. stop_fd may be -1. */
+int dpst_loop_run(struct dpst_transport *t, struct dpst_engine *engine, int stop_fd);
+
+uint64_t dpst_now_ms(void);
+
+#endif
@@ -0,0 +1,209 @@
+/*
+ * Host simulator for the DPST engine.
+ *
+ * Replays recorded histograms (one line of DPST_HIST_BINS counts per
+ * histogram event, '#' starts a comment) through the same event loop
+ * the daemon runs, over a socketpair standing in for the kernel
+ * netlink socket, and reports the backlight the engine asked for.
+ *
+ * tests/video_session.txt is a video playback session in that format.
+ *
+ * usage: dpst_sim [-a level] [-i interval_ms] [-s speed] histograms.txt
+ */
+#define LOG_TAG "dpst_sim"
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "dpstmgr.h"
+#include "dpst_engine.h"
+#include "dpst_loop.h"
+
+struct sim_daemon {
+	struct dpst_transport	transport;
+	struct dpst_engine	engine;
+};
+
+struct sim_stats {
+	unsigned int	percent;
+	uint64_t	last_change_ms;
+	double		level_ms;	/* integral of backlight percent over time */
+	unsigned int	bl_updates;
+	unsigned int	gamma_updates;
+	unsigned int	min_percent;
+};
+
+static void *daemon_thread(void *data)
+{
+	struct sim_daemon *d = data;
+
+	dpst_loop_run(&d->transport, &d->engine, -1);
+	return NULL;
+}
+
+static int read_histogram(FILE *fp, struct dpst_hist_data *hist)
+{
+	char line[1024];
+
+	while (fgets(line, sizeof(line), fp)) {
+		char *p = line, *end;
+		int b;
+
+		if (line[strspn(line, " \t")] == '#' || line[strspn(line, " \t\r\n")] == '\0')
+			continue;
+
+		for (b = 0; b < DPST_HIST_BINS; b++) {
+			hist->bins[b] = strtoul(p, &end, 0);
+			if (end == p)
+				break;
+			p = end;
+		}
+		if (b == DPST_HIST_BINS)
+			return 0;
+		fprintf(stderr, "skipping histogram with %d bins\n", b);
+	}
+	return -1;
+}
+
+static void account(struct sim_stats *st, unsigned int speed, uint64_t now)
+{
+	st->level_ms += (double)st->percent * (now - st->last_change_ms) * speed;
+	st->last_change_ms = now;
+}
+
+/* consume what the daemon sent until the deadline */
+static void drain(int fd, struct sim_stats *st, unsigned int speed, uint64_t deadline)
+{
+	uint8_t buf[DPSTMGR_CMD_HDR_SIZE + sizeof(struct dpst_gamma_data)];
+	const struct dpstmgr_cmd_hdr *hdr = (const struct dpstmgr_cmd_hdr *)buf;
+
+	for (;;) {
+		uint64_t now = dpst_now_ms();
+		struct pollfd pfd;
+		ssize_t len;
+
+		pfd.fd = fd;
+		pfd.events = POLLIN;
+		if (poll(&pfd, 1, deadline > now ? (int)(deadline - now) : 0) <= 0)
+			return;
+
+		len = recv(fd, buf, sizeof(buf), 0);
+		if (len < DPSTMGR_CMD_HDR_SIZE)
+			return;
+
+		if (hdr->cmd == DISPMGR_DPST_BL_SET) {
+			const struct dpst_bl_data *bl = DPSTMGR_CMD_PAYLOAD(hdr);
+
+			account(st, speed, dpst_now_ms());
+			st->percent = bl->percent;
+			if (bl->percent < st->min_percent)
+				st->min_percent = bl->percent;
+			st->bl_updates++;
+		} else if (hdr->cmd == DISPMGR_DPST_GAMMA_SET) {
+			st->gamma_updates++;
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	unsigned int level = 2, interval = 33, speed = 1, frames = 0;
+	struct sim_daemon daemon;
+	struct dpst_params params;
+	struct dpst_transport sim;
+	struct dpst_hist_data hist;
+	struct sim_stats st;
+	uint64_t start, end;
+	pthread_t thread;
+	int fds[2], opt;
+	FILE *fp;
+
+	while ((opt = getopt(argc, argv, "a:i:s:")) != -1) {
+		switch (opt) {
+		case 'a':
+			level = atoi(optarg);
+			break;
+		case 'i':
+			interval = atoi(optarg);
+			break;
+		case 's':
+			speed = atoi(optarg);
+			break;
+		default:
+			goto usage;
+		}
+	}
+	if (optind != argc - 1 || !interval || !speed)
+		goto usage;
+
+	fp = fopen(argv[optind], "r");
+	if (!fp) {
+		perror(argv[optind]);
+		return 1;
+	}
+
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) < 0) {
+		perror("socketpair");
+		return 1;
+	}
+
+	/* running faster than real time shrinks the rate limit accordingly */
+	dpst_engine_default_params(&params, level);
+	params.min_interval_ms /= speed;
+	dpst_engine_init(&daemon.engine, &params);
+	daemon.transport.fd = fds[0];
+	daemon.transport.netlink = false;
+	sim.fd = fds[1];
+	sim.netlink = false;
+
+	if (pthread_create(&thread, NULL, daemon_thread, &daemon)) {
+		perror("pthread_create");
+		return 1;
+	}
+
+	memset(&st, 0, sizeof(st));
+	st.percent = st.min_percent = 100;
+	start = st.last_change_ms = dpst_now_ms();
+
+	while (!read_histogram(fp, &hist)) {
+		uint64_t deadline = start + (uint64_t)(frames + 1) * interval / speed;
+
+		dpst_send(&sim, DISPMGR_DPST_HIST_DATA, &hist, sizeof(hist));
+		drain(sim.fd, &st, speed, deadline);
+		frames++;
+	}
+	end = dpst_now_ms();
+	account(&st, speed, end);
+	fclose(fp);
+
+	shutdown(sim.fd, SHUT_RDWR);
+	pthread_join(thread, NULL);
+	close(fds[0]);
+	close(fds[1]);
+
+	if (!frames) {
+		fprintf(stderr, "no histograms\n");
+		return 1;
+	}
+
+	/* backlight power taken as proportional to the PWM duty cycle */
+	printf("histograms:          %u (%u ms apart)\n", frames, interval);
+	printf("aggressiveness:      %u (max reduction %u%%)\n", level, params.max_reduction);
+	printf("average backlight:   %.1f%%\n", st.level_ms / ((end - start) * speed));
+	printf("minimum backlight:   %u%%\n", st.min_percent);
+	printf("estimated saving:    %.1f%%\n", 100.0 - st.level_ms / ((end - start) * speed));
+	printf("backlight updates:   %u\n", st.bl_updates);
+	printf("gamma updates:       %u\n", st.gamma_updates);
+	return 0;
+
+usage:
+	fprintf(stderr, "usage: %s [-a level] [-i interval_ms] [-s speed] histograms.txt\n",
+		argv[0]);
+	return 1;
+}
@@ -1,22 +1,104 @@
+#define LOG_TAG "dpstmgr"
+
 #include <cutils/log.h>
+#include <cutils/properties.h>
+#include <errno.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <linux/netlink.h>
 #include "dpstmgr.h"
+#include "dpst_engine.h"
+#include "dpst_loop.h"
+
+#define AGGRESSIVENESS_PROPERTY		"dpst.aggressiveness"
+#define DEFAULT_AGGRESSIVENESS		2
+#define DEFAULT_GUARDBAND		4
+
+static int dpst_netlink_init(struct dpst_transport *t)
+{
+	struct sockaddr_nl src;
+	uint32_t pid = getpid();
+
+	t->netlink = true;
+	t->fd = socket(PF_NETLINK, SOCK_RAW, NETLINK_DISPMGR);
+	if (t->fd < 0)
+		return -errno;
+
+	memset(&src, 0, sizeof(src));
+	src.nl_family = AF_NETLINK;
+	src.nl_pid = pid;
+	if (bind(t->fd, (struct sockaddr *)&src, sizeof(src)) < 0) {
+		close(t->fd);
+		return -errno;
+	}
+
+	/* the kernel sends histogram events to the registered pid */
+	return dpst_send(t, DISPMGR_DPST_INIT_COMM, &pid, sizeof(pid));
+}
+
+static int stop_signals_fd(void)
+{
+	sigset_t mask;
+
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGTERM);
+	sigaddset(&mask, SIGINT);
+	if (sigprocmask(SIG_BLOCK, &mask, NULL) < 0)
+		return -1;
+	return signalfd(-1, &mask, 0);
+}
 
 int main(int argc, char** argv)
 {
 	int ret = 0;
-	struct dpstmgr_cmd_hdr cmd_hdr;
+	struct dpst_transport transport;
+	struct dpst_engine engine;
+	struct dpst_params params;
+	struct dpst_guard_data guard;
+	char value[PROPERTY_VALUE_MAX];
+	uint32_t enable;
+	int stop_fd;
 
-	ret = dpst_netlink_init();
+	property_get(AGGRESSIVENESS_PROPERTY, value, "");
+	dpst_engine_default_params(&params,
+			value[0] ? (unsigned int)atoi(value) : DEFAULT_AGGRESSIVENESS);
+	dpst_engine_init(&engine, &params);
+
+	ret = dpst_netlink_init(&transport);
 	if (ret) {
-		LOGE("Init netlink socket FAILD!\n");
+		ALOGE("Init netlink socket FAILD! (unit %d: %s)\n",
+		      NETLINK_DISPMGR, strerror(-ret));
 		return -EFAULT;
 	}
 
-	while (1) {
-		dpst_recv_from_kernel(&cmd_hdr);
-	}
+	stop_fd = stop_signals_fd();
+
+	guard.guardband = DEFAULT_GUARDBAND;
+	dpst_send(&transport, DISPMGR_DPST_UPDATE_GUARD, &guard, sizeof(guard));
+	enable = 1;
+	dpst_send(&transport, DISPMGR_DPST_HIST_ENABLE, &enable, sizeof(enable));
+
+	ALOGD("max reduction %u%%, clip %u/1000, %u ms between gamma updates",
+	      params.max_reduction, params.clip_permille, params.min_interval_ms);
+
+	ret = dpst_loop_run(&transport, &engine, stop_fd);
+
+	/* leave the panel at full backlight with identity gamma */
+	enable = 0;
+	dpst_send(&transport, DISPMGR_DPST_HIST_ENABLE, &enable, sizeof(enable));
+	dpst_engine_reset(&engine);
+	dpst_apply(&transport, &engine, 0);
+
+	ALOGD("exit: %u histograms, %u gamma updates",
+	      engine.histograms, engine.gamma_updates);
 
-	return 0;
+	close(transport.fd);
+	if (stop_fd >= 0)
+		close(stop_fd);
+	return ret;
 }
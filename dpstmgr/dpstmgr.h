@@ -1,12 +1,43 @@
 #ifndef H_DPSTMGR_HEADER_H
 #define H_DPSTMGR_HEADER_H
 
+#include <stdint.h>
+
+/*
+ * Netlink unit the display driver registers its display manager on
+ * (NETLINK_DISPMGR in the driver's dispmgrnl.h, not exported through
+ * the kernel UAPI headers). Boards whose kernel uses another unit set
+ * INTEL_DPST_NETLINK in BoardConfig.mk.
+ */
+#ifndef NETLINK_DISPMGR
+#define NETLINK_DISPMGR		20
+#endif
+
+/*
+ * Command header as the kernel lays out its dispmgr_command_hdr: three
+ * 32 bit fields followed by a pointer sized data field, which the
+ * kernel ignores. Spelled with fixed width types so the payload lands
+ * DPSTMGR_CMD_HDR_SIZE bytes into the message whatever the userspace
+ * word size. That is 24 against a 64 bit kernel; boards running a 32
+ * bit kernel set INTEL_DPST_CMD_HDR_SIZE := 16 in BoardConfig.mk.
+ */
+#ifndef DPSTMGR_CMD_HDR_SIZE
+#define DPSTMGR_CMD_HDR_SIZE	24
+#endif
+
 struct dpstmgr_cmd_hdr {
-        unsigned int   	module;		/* module to receive the command */
-        unsigned int   	cmd;		/* command from userspace */
-        unsigned int   	data_size;	/* data size of command_data by bytes */
-        void* 		data;		/* command data */
-};
+	uint32_t	module;		/* module to receive the command */
+	uint32_t	cmd;		/* command from userspace */
+	uint32_t	data_size;	/* data size of command_data by bytes */
+	/* alignment and the data pointer, unused, the payload follows */
+	uint8_t		data[DPSTMGR_CMD_HDR_SIZE - 3 * sizeof(uint32_t)];
+} __attribute__((packed));
+
+typedef char dpstmgr_cmd_hdr_size_check[
+	sizeof(struct dpstmgr_cmd_hdr) == DPSTMGR_CMD_HDR_SIZE ? 1 : -1];
+
+#define DPSTMGR_CMD_PAYLOAD(hdr) \
+	((const void *)((const uint8_t *)(hdr) + DPSTMGR_CMD_HDR_SIZE))
 
 enum dispmgr_dpst_event_enum {
 	DISPMGR_DPST_UNKNOWN,
@@ -27,7 +58,32 @@ enum dispmgr_module_enum {
 	DISPMGR_MOD_DPST,
 };
 
-int dpst_netlink_init(void);
-void dpst_recv_from_kernel(void* cmd_hdr);
+/*
+ * Command payloads. On the wire a message is the dpstmgr_cmd_hdr
+ * followed by data_size bytes of payload at DPSTMGR_CMD_HDR_SIZE.
+ */
+#define DPST_HIST_BINS		32
+#define DPST_GAMMA_SIZE		256
+
+/* DISPMGR_DPST_HIST_DATA, kernel -> dpstmgr */
+struct dpst_hist_data {
+	uint32_t	bins[DPST_HIST_BINS];	/* pixel count per luma bin */
+};
+
+/* DISPMGR_DPST_BL_SET, percent of the user selected backlight */
+struct dpst_bl_data {
+	uint32_t	percent;
+};
+
+/* DISPMGR_DPST_GAMMA_SET, 0x00RRGGBB per palette entry */
+struct dpst_gamma_data {
+	uint32_t	lut[DPST_GAMMA_SIZE];
+};
+
+/* DISPMGR_DPST_UPDATE_GUARD, histogram change in percent that raises
+ * the next interrupt */
+struct dpst_guard_data {
+	uint32_t	guardband;
+};
 
 #endif
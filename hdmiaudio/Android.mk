@@ -27,21 +27,28 @@ LOCAL_CFLAGS := -D_POSIX_C_SOURCE=200809
 ifeq ($(BOARD_USES_TINY_ALSA_AUDIO), true)
 
 LOCAL_SRC_FILES := \
-        tinyaudio_hw.c
+        tinyaudio_hw.c \
+        hdmi_eld.c
 
 LOCAL_C_INCLUDES += \
-	$(call include-path-for, tinyalsa)
+	$(call include-path-for, tinyalsa) \
+	$(LOCAL_PATH)/../audiommap
 
+LOCAL_STATIC_LIBRARIES := libaudio_mmap_intel
 LOCAL_SHARED_LIBRARIES := liblog libcutils libtinyalsa
 
 else
 
 LOCAL_SRC_FILES := \
-        audio_hw.c
+        audio_hw.c \
+        hdmi_chmix.c \
+        hdmi_eld.c
 
 LOCAL_C_INCLUDES += \
-        $(call include-path-for, alsa-lib)
+        $(call include-path-for, alsa-lib) \
+        $(LOCAL_PATH)/../audiosrc
 
+LOCAL_STATIC_LIBRARIES := libaudio_src_intel
 LOCAL_SHARED_LIBRARIES := liblog libcutils libasound
 
 endif #BOARD_USES_TINY_ALSA_AUDIO
@@ -51,3 +58,30 @@ LOCAL_MODULE_TAGS := optional
 
 include $(BUILD_SHARED_LIBRARY)
 endif
+
+# parses canned ELDs on the build host
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+        hdmi_eld_test.c \
+        hdmi_eld.c
+
+LOCAL_STATIC_LIBRARIES := liblog
+LOCAL_MODULE := hdmi_eld_test
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_HOST_EXECUTABLE)
+
+# checks the SSE2 mixer against the C path and times both on the build host
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+        hdmi_chmix_test.c \
+        hdmi_chmix.c
+
+LOCAL_STATIC_LIBRARIES := liblog
+LOCAL_LDLIBS := -lrt
+LOCAL_MODULE := hdmi_chmix_test
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_HOST_EXECUTABLE)
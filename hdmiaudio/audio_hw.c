@@ -33,6 +33,10 @@
 
 #include <alsa/asoundlib.h>
 
+#include "hdmi_eld.h"
+#include "hdmi_chmix.h"
+#include "audio_src.h"
+
 #define PLATFORM_ID_PATH  "/sys/spid/platform_family_id"
 #define HARDWARE_ID_PATH  "/sys/spid/hardware_id"
 /**device variants*/
@@ -65,6 +69,10 @@ enum{
 #define INTEL_HDMI_CARD          "hw:IntelHDMI"
 #define CHANNEL_MAP_REQUEST      3
 
+/*quality of the in-HAL rate conversion to the sink rate (0 - 3)*/
+#define SRC_QUALITY_PROPERTY     "hdmi.audio.src.quality"
+#define DEFAULT_SRC_QUALITY      AUDIO_SRC_QUALITY_HIGH
+
 /* Configuration for a stream */
 struct pcm_config {
     unsigned int channels;
@@ -102,6 +110,11 @@ struct audio_device {
     struct audio_hw_device hw_device;
     int sink_sup_channels;
     pthread_mutex_t lock;
+    /*sink capabilities, read once per hotplug*/
+    bool sink_caps_cached;
+    struct hdmi_sink_caps sink_caps;
+    /*channels in the playback channel map, 0 if unknown*/
+    unsigned int mixer_channels;
 };
 
 struct hdmi_stream_out {
@@ -123,6 +136,21 @@ struct hdmi_stream_out {
     uint32_t   latency;
     bool       display_connected;
 
+/* Channel conversion done in the HAL when the sink (or the platform)
+ * needs a different channel count than the stream provides */
+    unsigned int hw_channels;
+    bool       use_chmix;
+    struct hdmi_chmix chmix;
+    int16_t   *mix_buf;
+    size_t     mix_buf_size;
+
+/* Rate conversion done in the HAL when the sink does not support the
+ * stream rate */
+    uint32_t   hw_rate;
+    struct audio_src *src;
+    int16_t   *src_buf;
+    size_t     src_buf_frames;
+
     struct audio_device *dev;
 };
 
@@ -149,14 +177,43 @@ static int close_device(struct hdmi_stream_out *stream)
     return err;
 }
 
+static enum audio_src_quality get_src_quality();
+
+/* The device may settle on another rate than the one asked for, convert
+ * to the negotiated rate instead of playing at the wrong speed.
+ * must be called with hw device and output stream mutexes locked
+ */
+static int set_negotiated_rate(struct hdmi_stream_out *out, unsigned int hw_rate)
+{
+    if (hw_rate == out->hw_rate)
+        return 0;
+
+    ALOGW("%s: device runs at %u instead of %u", __func__, hw_rate, out->hw_rate);
+    audio_src_destroy(out->src);
+    out->src = NULL;
+    out->hw_rate = hw_rate;
+
+    if (hw_rate == out->pcm_config.rate)
+        return 0;
+
+    out->src = audio_src_create(out->pcm_config.rate, hw_rate,
+                                out->pcm_config.channels, get_src_quality());
+    if (!out->src) {
+        ALOGE("%s: no rate conversion %d -> %d", __func__,
+              out->pcm_config.rate, hw_rate);
+        return -EINVAL;
+    }
+    return 0;
+}
+
 static int set_hardware_params(struct hdmi_stream_out *out)
 {
     snd_pcm_hw_params_t *hardware_params;
 
     int err                       = 0;
     snd_pcm_uframes_t buffer_size = out->buffer_size;
-    unsigned int requested_rate   = out->pcm_config.rate;
-    unsigned int channels         = out->pcm_config.channels;
+    unsigned int requested_rate   = out->hw_rate;
+    unsigned int channels         = out->hw_channels;
 
     ALOGV("%s: Entered", __func__);
 
@@ -194,12 +251,16 @@ static int set_hardware_params(struct hdmi_stream_out *out)
        err = snd_pcm_hw_params_set_rate_near(out->handle, hardware_params,
                                           &requested_rate, 0);
        if (err < 0) {
-           ALOGE("Unable to set sample rate to %u: %s", out->pcm_config.rate,
+           ALOGE("Unable to set sample rate to %u: %s", out->hw_rate,
                         snd_strerror(err));
-           out->sample_rate = requested_rate;
+           goto error_exit;
        }
        ALOGV("sampling rate : %d\n", requested_rate);
 
+       err = set_negotiated_rate(out, requested_rate);
+       if (err < 0)
+           goto error_exit;
+
        // Setup buffers for latency
        buffer_size = out->pcm_config.period_size * out->pcm_config.period_count;
 
@@ -322,6 +383,165 @@ error_exit:
     return err;
 }
 
+static const struct hdmi_sink_caps *get_sink_caps(struct audio_device *adev);
+
+/* Pick the channel count the hw device is opened with and set up the
+ * in-HAL conversion to it. This replaces the Upmix_AndroidPlayback_HDMI
+ * plugin that used to pad multichannel streams on Medfield. Multichannel
+ * streams always go through the conversion, if only to be reordered to
+ * the ALSA channel order.
+ * must be called with hw device and output stream mutexes locked
+ */
+static void setup_channel_mix(struct hdmi_stream_out *out, int platform_id)
+{
+    const struct hdmi_sink_caps *caps = get_sink_caps(out->dev);
+    unsigned int channels = out->pcm_config.channels;
+    unsigned int max_channels;
+    uint32_t speaker_alloc;
+
+    out->hw_channels = channels;
+    out->use_chmix = false;
+
+    /*without an ELD trust the channel map, and the stream if there is none*/
+    if (caps->valid) {
+        max_channels = caps->max_channels;
+        speaker_alloc = caps->speaker_alloc;
+    } else {
+        max_channels = out->dev->mixer_channels;
+        speaker_alloc = HDMI_ELD_SPK_FL_FR | HDMI_ELD_SPK_LFE | HDMI_ELD_SPK_FC |
+                        HDMI_ELD_SPK_RL_RR | HDMI_ELD_SPK_RLC_RRC;
+    }
+
+    /*sink can not render the stream layout, fold it down. The speakers
+     *past the folded layout are dropped from the allocation so they stay
+     *silent if the layout is padded below*/
+    if (channels > 2 && max_channels && max_channels < channels) {
+        if (max_channels >= 6) {
+            out->hw_channels = 6;
+            speaker_alloc &= ~HDMI_ELD_SPK_RLC_RRC;
+        } else {
+            out->hw_channels = 2;
+            speaker_alloc &= HDMI_ELD_SPK_FL_FR;
+        }
+    }
+    /*PR 3.3/4.0 device needs the channel masks to be powers of 2 (1,2,4,8),
+     *pad the (folded) layout to 8 with silent channels*/
+    if ((channels > 2) &&
+        (platform_id == MFLD_PHONE || platform_id == MFLD_TABLET))
+        out->hw_channels = 8;
+
+    if (out->hw_channels == channels && channels <= 2)
+        return;
+
+    if (hdmi_chmix_init(&out->chmix, channels, out->hw_channels,
+                        speaker_alloc) != 0) {
+        ALOGE("%s: no conversion from %d to %d channels", __func__,
+              channels, out->hw_channels);
+        out->hw_channels = channels;
+        return;
+    }
+    out->use_chmix = true;
+}
+
+/* Convert one write worth of frames into out->mix_buf.
+ * Returns the number of bytes to send to the hw device.
+ */
+static ssize_t apply_channel_mix(struct hdmi_stream_out *out,
+                                 const void *buffer, size_t bytes)
+{
+    size_t frames = bytes / (out->pcm_config.channels * sizeof(int16_t));
+    size_t needed = frames * out->hw_channels * sizeof(int16_t);
+
+    if (needed > out->mix_buf_size) {
+        int16_t *buf = realloc(out->mix_buf, needed);
+        if (!buf) {
+            ALOGE("%s: memory allocation failed", __func__);
+            return -ENOMEM;
+        }
+        out->mix_buf = buf;
+        out->mix_buf_size = needed;
+    }
+
+    hdmi_chmix_process(&out->chmix, (const int16_t *)buffer, out->mix_buf, frames);
+    return needed;
+}
+
+static enum audio_src_quality get_src_quality()
+{
+    char value[PROPERTY_VALUE_MAX];
+    int quality;
+
+    property_get(SRC_QUALITY_PROPERTY, value, "");
+    if (!value[0])
+        return DEFAULT_SRC_QUALITY;
+
+    quality = atoi(value);
+    if (quality < AUDIO_SRC_QUALITY_LOW || quality > AUDIO_SRC_QUALITY_VERY_HIGH)
+        return DEFAULT_SRC_QUALITY;
+    return (enum audio_src_quality)quality;
+}
+
+/* Open the sink at the stream rate when it supports it, otherwise at
+ * its preferred rate with the conversion done in the HAL.
+ * must be called with hw device and output stream mutexes locked
+ */
+static void setup_rate_conversion(struct hdmi_stream_out *out)
+{
+    const struct hdmi_sink_caps *caps = get_sink_caps(out->dev);
+    unsigned int rate = out->pcm_config.rate;
+    unsigned int hw_rate = rate;
+
+    if (caps->valid && !hdmi_eld_supports_rate(caps, rate)) {
+        if (hdmi_eld_supports_rate(caps, 48000))
+            hw_rate = 48000;
+        else if (hdmi_eld_supports_rate(caps, 44100))
+            hw_rate = 44100;
+    }
+
+    if (out->src && out->hw_rate == hw_rate)
+        return;
+
+    audio_src_destroy(out->src);
+    out->src = NULL;
+    out->hw_rate = hw_rate;
+
+    if (hw_rate == rate)
+        return;
+
+    out->src = audio_src_create(rate, hw_rate, out->pcm_config.channels,
+                                get_src_quality());
+    if (!out->src) {
+        ALOGW("%s: no rate conversion %d -> %d, using stream rate", __func__,
+              rate, hw_rate);
+        out->hw_rate = rate;
+    }
+}
+
+/* Convert one write worth of frames to the sink rate into out->src_buf.
+ * Returns the number of bytes produced.
+ */
+static ssize_t apply_rate_conversion(struct hdmi_stream_out *out,
+                                     const void *buffer, size_t bytes)
+{
+    size_t frame_size = out->pcm_config.channels * sizeof(int16_t);
+    size_t in_frames = bytes / frame_size;
+    size_t out_frames = audio_src_get_out_frames(out->src, in_frames);
+
+    if (out_frames > out->src_buf_frames) {
+        int16_t *buf = realloc(out->src_buf, out_frames * frame_size);
+        if (!buf) {
+            ALOGE("%s: memory allocation failed", __func__);
+            return -ENOMEM;
+        }
+        out->src_buf = buf;
+        out->src_buf_frames = out_frames;
+    }
+
+    out_frames = audio_src_process(out->src, (const int16_t *)buffer, in_frames,
+                                   out->src_buf, out_frames);
+    return out_frames * frame_size;
+}
+
 static int open_device(struct hdmi_stream_out *out)
 {
     int err = 0;
@@ -349,12 +569,12 @@ static int open_device(struct hdmi_stream_out *out)
 
     ALOGD("platform id = %d hardware id = %d",platform_id,hw_id);
 
-    /*PR 3.3/4.0 device needs the channel masks to be powers of 2 (1,2,4,8)*/
-    if((out->pcm_config.channels > 2) &&
-        (platform_id == MFLD_PHONE || platform_id == MFLD_TABLET))
-       ALOGD("%s: opening Upmix_AndroidPlayback_HDMI for %d channels", __func__, out->pcm_config.channels);
-    else
-       ALOGD("%s: opening AndroidPlayback_HDMI for %d channels", __func__, out->pcm_config.channels);
+    setup_channel_mix(out, platform_id);
+    setup_rate_conversion(out);
+
+    ALOGD("%s: opening AndroidPlayback_HDMI for %d channels at %d (stream %d at %d)",
+          __func__, out->hw_channels, out->hw_rate,
+          out->pcm_config.channels, out->pcm_config.rate);
 
 
     // The PCM stream is opened in blocking mode, per ALSA defaults.  The
@@ -376,15 +596,8 @@ static int open_device(struct hdmi_stream_out *out)
        active_stream_out->handle = NULL;
     }
 
-    if((out->pcm_config.channels > 2) &&
-        (platform_id == MFLD_PHONE || platform_id == MFLD_TABLET)) {
-       err = snd_pcm_open(&out->handle, "Upmix_AndroidPlayback_HDMI", SND_PCM_STREAM_PLAYBACK,
-                           SND_PCM_ASYNC);
-    }
-    else{
-       err = snd_pcm_open(&out->handle, "AndroidPlayback_HDMI", SND_PCM_STREAM_PLAYBACK,
-                           SND_PCM_ASYNC);
-    }
+    err = snd_pcm_open(&out->handle, "AndroidPlayback_HDMI", SND_PCM_STREAM_PLAYBACK,
+                        SND_PCM_ASYNC);
 
     if (err < 0) {
         ALOGE("%s: Failed to open any ALSA device: %s", __func__, (char*)strerror(err));
@@ -523,6 +736,8 @@ static int out_standby(struct audio_stream *stream)
 
     if (!out->standby) {
         close_device(out);
+        if (out->src)
+            audio_src_reset(out->src);
         out->standby = true;
     }
 
@@ -546,25 +761,53 @@ static int out_set_parameters(struct audio_stream *stream, const char *kvpairs)
     return 0;
 }
 
-static int parse_channel_map()
+static int read_eld(snd_ctl_t *hndl, struct hdmi_sink_caps *caps)
 {
-  snd_ctl_t *hndl = NULL;
   snd_ctl_elem_id_t *id;
   snd_ctl_elem_info_t *info;
-  snd_ctl_elem_type_t type;
   snd_ctl_elem_value_t *control;
-  int count=0,idx=0,numid=0,chmap=0,chcount=0;
+  unsigned int count = 0;
   int err = 0;
 
-  ALOGV("%s entered",__func__);
+  snd_ctl_elem_id_alloca(&id);
+  snd_ctl_elem_info_alloca(&info);
+  snd_ctl_elem_value_alloca(&control);
 
-  err = snd_ctl_open(&hndl,INTEL_HDMI_CARD,0);
-  if(err < 0){
-    ALOGE("[EDID]unable to open alsa mixer control %d",err);
-    ALOGW("[EDID]error !! returning default channel count");
-    return AUDIO_CHANNEL_OUT_STEREO;
+  snd_ctl_elem_id_set_interface(id,SND_CTL_ELEM_IFACE_PCM);
+  snd_ctl_elem_id_set_name(id,HDMI_ELD_CTL_NAME);
+  snd_ctl_elem_info_set_id(info,id);
+
+  if((err = snd_ctl_elem_info(hndl,info)) < 0){
+    ALOGV("%s: [EDID]no ELD control exposed by the driver",__func__);
+    return err;
   }
 
+  if(snd_ctl_elem_info_get_type(info) != SND_CTL_ELEM_TYPE_BYTES)
+    return -EINVAL;
+
+  count = snd_ctl_elem_info_get_count(info);
+  if(count > HDMI_ELD_MAX_SIZE)
+    count = HDMI_ELD_MAX_SIZE;
+
+  snd_ctl_elem_value_set_id(control,id);
+  if((err = snd_ctl_elem_read(hndl,control)) < 0){
+     ALOGE("[EDID]can't read ELD %d",err);
+     return err;
+  }
+
+  return hdmi_eld_parse((const uint8_t *)snd_ctl_elem_value_get_bytes(control),
+                        count, caps);
+}
+
+static int read_channel_map(snd_ctl_t *hndl)
+{
+  snd_ctl_elem_id_t *id;
+  snd_ctl_elem_info_t *info;
+  snd_ctl_elem_type_t type;
+  snd_ctl_elem_value_t *control;
+  int count=0,idx=0,numid=0,chmap=0,chcount=0;
+  int err = 0;
+
   snd_ctl_elem_id_alloca(&id);
   snd_ctl_elem_info_alloca(&info);
   snd_ctl_elem_value_alloca(&control);
@@ -577,9 +820,7 @@ static int parse_channel_map()
 
   if((err = snd_ctl_elem_info(hndl,info)) < 0){
     ALOGE("%s: [EDID]cannot find the control element",__func__);
-    snd_ctl_close(hndl);
-    ALOGW("[EDID]error !! returning default channel count");
-    return AUDIO_CHANNEL_OUT_STEREO;
+    return 0;
   }
 
   numid = snd_ctl_elem_info_get_numid(info);
@@ -594,13 +835,9 @@ static int parse_channel_map()
 
   if((err = snd_ctl_elem_read(hndl,control)) < 0){
      ALOGE("[EDID]can't read channel map %d",err);
-     snd_ctl_close(hndl);
-     return AUDIO_CHANNEL_OUT_STEREO;
+     return 0;
   }
 
-  type = snd_ctl_elem_info_get_type(info);
-  count = snd_ctl_elem_info_get_count(info);
-
   for(idx = 0;idx<count;idx++){
      chmap = snd_ctl_elem_value_get_integer(control,idx);
      if(chmap > 0)  ++chcount;
@@ -608,15 +845,52 @@ static int parse_channel_map()
   }
 
   ALOGD("[EDID]valid number of channels supported by sink = %d",chcount);
+  return chcount;
+}
+
+/* Read the sink capabilities from the ELD control of the HDMI card.
+ * Older drivers do not expose the ELD, fall back to counting the
+ * valid entries of the playback channel map in that case.
+ */
+static void read_sink_caps(struct audio_device *adev)
+{
+  struct hdmi_sink_caps *caps = &adev->sink_caps;
+  snd_ctl_t *hndl = NULL;
+  int chcount = 0;
+  int err = 0;
+
+  ALOGV("%s entered",__func__);
+
+  hdmi_eld_default_caps(caps);
+  adev->mixer_channels = 0;
+
+  err = snd_ctl_open(&hndl,INTEL_HDMI_CARD,0);
+  if(err < 0){
+    ALOGE("[EDID]unable to open alsa mixer control %d",err);
+    ALOGW("[EDID]error !! returning default channel count");
+    return;
+  }
+
+  if(read_eld(hndl, caps) < 0){
+    chcount = read_channel_map(hndl);
+    adev->mixer_channels = chcount;
+    if(chcount > 2)
+      caps->max_channels = chcount;
+  }
 
   snd_ctl_close(hndl);
 
   ALOGV("%s exit",__func__);
+}
 
-  if(chcount > 2)
-    return AUDIO_CHANNEL_OUT_5POINT1;
-  else
-    return AUDIO_CHANNEL_OUT_STEREO;
+/* must be called with hw device mutex locked */
+static const struct hdmi_sink_caps *get_sink_caps(struct audio_device *adev)
+{
+    if (!adev->sink_caps_cached) {
+        read_sink_caps(adev);
+        adev->sink_caps_cached = true;
+    }
+    return &adev->sink_caps;
 }
 
 static int out_read_edid(const struct hdmi_stream_out *stream)
@@ -625,7 +899,12 @@ static int out_read_edid(const struct hdmi_stream_out *stream)
     struct audio_device *adev = out->dev;
 
     /**read the channel max param from the sink*/
-    adev->sink_sup_channels = parse_channel_map();
+    pthread_mutex_lock(&adev->lock);
+    if(get_sink_caps(adev)->max_channels > 2)
+      adev->sink_sup_channels = AUDIO_CHANNEL_OUT_5POINT1;
+    else
+      adev->sink_sup_channels = AUDIO_CHANNEL_OUT_STEREO;
+    pthread_mutex_unlock(&adev->lock);
 
     ALOGV("%s sink supports 0x%x max channels", __func__,adev->sink_sup_channels);
     return 0;
@@ -682,7 +961,7 @@ static uint32_t out_get_latency(const struct audio_stream_out *stream)
     uint32_t latency;
 
     latency =  (out->pcm_config.period_size * out->pcm_config.period_count * 1000) /
-            out_get_sample_rate(&stream->common);
+            (out->hw_rate ? out->hw_rate : out->pcm_config.rate);
 
     ALOGV("%s: latency : %d", __func__, latency);
     out->latency = latency;
@@ -707,6 +986,8 @@ static ssize_t out_write(struct audio_stream_out *stream, const void* buffer,
     snd_pcm_sframes_t frames = 0;
     int it = 0;
     unsigned int totalSleepTime;
+    const void *hw_buffer = buffer;
+    size_t hw_bytes = ip_bytes;
 
     ALOGV("%s out->standby = %d", __func__,out->standby);
 
@@ -737,16 +1018,34 @@ static ssize_t out_write(struct audio_stream_out *stream, const void* buffer,
 
     ALOGV("write data : channels : %d", out->channel_mask);
 
+    if (out->src) {
+        ret = apply_rate_conversion(out, hw_buffer, hw_bytes);
+        if (ret < 0)
+            goto err;
+        hw_buffer = out->src_buf;
+        hw_bytes = ret;
+        ret = 0;
+    }
+
+    if (out->use_chmix) {
+        ret = apply_channel_mix(out, hw_buffer, hw_bytes);
+        if (ret < 0)
+            goto err;
+        hw_buffer = out->mix_buf;
+        hw_bytes = ret;
+        ret = 0;
+    }
+
     frames = 0;
 
     do {
         frames = snd_pcm_writei(out->handle,
-                           (char *)buffer + sent_bytes,
-                           snd_pcm_bytes_to_frames(out->handle, ip_bytes - sent_bytes));
+                           (char *)hw_buffer + sent_bytes,
+                           snd_pcm_bytes_to_frames(out->handle, hw_bytes - sent_bytes));
 
         if ((frames == -EAGAIN) ||
            ((frames >= 0) &&
-           ((snd_pcm_frames_to_bytes(out->handle, frames) + sent_bytes) < ip_bytes))) {
+           ((snd_pcm_frames_to_bytes(out->handle, frames) + sent_bytes) < hw_bytes))) {
             it++;
             if (it > MAX_AGAIN_RETRY){
                 ALOGE("write err: EAGAIN breaking...");
@@ -788,7 +1087,7 @@ static ssize_t out_write(struct audio_stream_out *stream, const void* buffer,
             sent_bytes += snd_pcm_frames_to_bytes(out->handle, frames);
         }
 
-    } while (sent_bytes < ip_bytes);
+    } while (sent_bytes < hw_bytes);
 
     ALOGV("%s: frames %ld to bytes %ld",
         __func__,
@@ -811,6 +1110,9 @@ err:
         ALOGV("%s : silence written", __func__);
         usleep(duration_ms * 1000);
     }
+    /*report the stream side byte count when converting channels*/
+    if (ret == 0 && sent_bytes == hw_bytes)
+        sent_bytes = ip_bytes;
     return ret == 0 ? (ssize_t) sent_bytes : ret;
 }
 
@@ -946,6 +1248,9 @@ err_open:
     ALOGE("%s: Failed", __func__);
     pthread_mutex_unlock(&out->lock);
     pthread_mutex_unlock(&out->dev->lock);
+    audio_src_destroy(out->src);
+    free(out->src_buf);
+    free(out->mix_buf);
     free(out);
     *stream_out = NULL;
     return ret;
@@ -959,13 +1264,38 @@ static void hdmi_dev_close_output_stream(struct audio_hw_device *dev,
 
     out->standby = false;
     out_standby(&stream->common);
+    free(out->mix_buf);
+    audio_src_destroy(out->src);
+    free(out->src_buf);
     free(stream);
     ALOGV("%s Exit",__func__);
 }
 
 static int hdmi_dev_set_parameters(struct audio_hw_device *dev, const char *kvpairs)
 {
-    ALOGV("%s unsupported", __func__);
+    struct audio_device *hdmi_dev = (struct audio_device *)dev;
+    struct str_parms *parms;
+    char value[32];
+
+    ALOGV("%s: %s", __func__, kvpairs);
+
+    parms = str_parms_create_str(kvpairs);
+    if (parms == NULL)
+        return 0;
+
+    /*a new sink may advertise different capabilities*/
+    if ((str_parms_get_str(parms, AUDIO_PARAMETER_DEVICE_CONNECT,
+                           value, sizeof(value)) >= 0) ||
+        (str_parms_get_str(parms, AUDIO_PARAMETER_DEVICE_DISCONNECT,
+                           value, sizeof(value)) >= 0)) {
+        if (atoi(value) & AUDIO_DEVICE_OUT_AUX_DIGITAL) {
+            pthread_mutex_lock(&hdmi_dev->lock);
+            hdmi_dev->sink_caps_cached = false;
+            pthread_mutex_unlock(&hdmi_dev->lock);
+        }
+    }
+
+    str_parms_destroy(parms);
     return 0;
 }
 
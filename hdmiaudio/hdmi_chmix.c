@@ -0,0 +1,356 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "hdmi_chmix"
+//#define LOG_NDEBUG 0
+
+#include <errno.h>
+#include <string.h>
+
+#include <cutils/log.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "hdmi_eld.h"
+#include "hdmi_chmix.h"
+
+#define Q15_ONE                     32767
+#define MINUS_3DB                   0.7071f
+
+enum {
+    POS_FL,
+    POS_FR,
+    POS_FC,
+    POS_LFE,
+    POS_RL,
+    POS_RR,
+    POS_SL,
+    POS_SR,
+    POS_NONE,
+};
+
+/*interleave order of the audio flinger buffers*/
+static const int android_order[CHMIX_MAX_CHANNELS] = {
+    POS_FL, POS_FR, POS_FC, POS_LFE, POS_RL, POS_RR, POS_SL, POS_SR,
+};
+
+/*interleave order expected by the ALSA HDMI device*/
+static const int alsa_order[CHMIX_MAX_CHANNELS] = {
+    POS_FL, POS_FR, POS_RL, POS_RR, POS_FC, POS_LFE, POS_SL, POS_SR,
+};
+
+static bool valid_channel_count(unsigned int channels)
+{
+    return channels == 2 || channels == 6 || channels == 8;
+}
+
+static bool sink_has_speaker(uint32_t speaker_alloc, int pos)
+{
+    switch (pos) {
+    case POS_FL:
+    case POS_FR:
+        return true;
+    case POS_FC:
+        return speaker_alloc & HDMI_ELD_SPK_FC;
+    case POS_LFE:
+        return speaker_alloc & HDMI_ELD_SPK_LFE;
+    case POS_RL:
+    case POS_RR:
+        return speaker_alloc & HDMI_ELD_SPK_RL_RR;
+    case POS_SL:
+    case POS_SR:
+        return speaker_alloc & HDMI_ELD_SPK_RLC_RRC;
+    default:
+        return false;
+    }
+}
+
+/*speakers a missing output position is folded into, with their gain*/
+static void fold_down(float m[POS_NONE][POS_NONE], const bool *out_pos,
+                      int src)
+{
+    switch (src) {
+    case POS_FC:
+        m[POS_FL][POS_FC] += MINUS_3DB;
+        m[POS_FR][POS_FC] += MINUS_3DB;
+        break;
+    case POS_RL:
+        m[POS_FL][POS_RL] += MINUS_3DB;
+        break;
+    case POS_RR:
+        m[POS_FR][POS_RR] += MINUS_3DB;
+        break;
+    case POS_SL:
+        if (out_pos[POS_RL])
+            m[POS_RL][POS_SL] += 1.0f;
+        else
+            m[POS_FL][POS_SL] += MINUS_3DB;
+        break;
+    case POS_SR:
+        if (out_pos[POS_RR])
+            m[POS_RR][POS_SR] += 1.0f;
+        else
+            m[POS_FR][POS_SR] += MINUS_3DB;
+        break;
+    default:
+        /*LFE is dropped rather than smeared over full range speakers*/
+        break;
+    }
+}
+
+int hdmi_chmix_init(struct hdmi_chmix *mix, unsigned int in_channels,
+                    unsigned int out_channels, uint32_t speaker_alloc)
+{
+    float m[POS_NONE][POS_NONE];
+    bool in_pos[POS_NONE], out_pos[POS_NONE];
+    unsigned int i, o;
+    int p, q;
+
+    if (!valid_channel_count(in_channels) || !valid_channel_count(out_channels))
+        return -EINVAL;
+
+    memset(mix, 0, sizeof(*mix));
+    memset(m, 0, sizeof(m));
+    memset(in_pos, 0, sizeof(in_pos));
+    memset(out_pos, 0, sizeof(out_pos));
+
+    mix->in_channels = in_channels;
+    mix->out_channels = out_channels;
+
+    for (i = 0; i < in_channels; i++)
+        in_pos[android_order[i]] = true;
+    for (o = 0; o < out_channels; o++)
+        out_pos[alsa_order[o]] = sink_has_speaker(speaker_alloc, alsa_order[o]);
+
+    for (p = 0; p < POS_NONE; p++) {
+        if (!in_pos[p])
+            continue;
+        if (out_pos[p])
+            m[p][p] = 1.0f;
+        else
+            fold_down(m, out_pos, p);
+    }
+
+    /*stereo content on a multichannel sink*/
+    if (in_channels == 2) {
+        if (out_pos[POS_FC]) {
+            m[POS_FC][POS_FL] = 0.5f;
+            m[POS_FC][POS_FR] = 0.5f;
+        }
+        if (out_pos[POS_RL])
+            m[POS_RL][POS_FL] = MINUS_3DB;
+        if (out_pos[POS_RR])
+            m[POS_RR][POS_FR] = MINUS_3DB;
+    }
+
+    /*normalize folded rows so a full scale input can not clip*/
+    for (p = 0; p < POS_NONE; p++) {
+        float sum = 0.0f;
+        for (q = 0; q < POS_NONE; q++)
+            sum += m[p][q];
+        if (sum > 1.0f) {
+            for (q = 0; q < POS_NONE; q++)
+                m[p][q] /= sum;
+        }
+    }
+
+    mix->remap_only = true;
+    for (o = 0; o < out_channels; o++) {
+        int ones = 0, others = 0;
+
+        mix->map[o] = -1;
+        for (i = 0; i < in_channels; i++) {
+            float c = m[alsa_order[o]][android_order[i]];
+            int q15 = (int)(c * 32768.0f + 0.5f);
+
+            mix->coef[o][i] = q15 > Q15_ONE ? Q15_ONE : q15;
+            if (c == 1.0f) {
+                ones++;
+                mix->map[o] = i;
+            } else if (c != 0.0f) {
+                others++;
+            }
+        }
+        if (ones > 1 || others)
+            mix->remap_only = false;
+    }
+
+    ALOGD("%s: %d -> %d channels, speakers 0x%x, %s", __func__,
+          in_channels, out_channels, speaker_alloc,
+          mix->remap_only ? "remap" : "mix");
+    return 0;
+}
+
+static inline int16_t clamp16(int32_t sample)
+{
+    if (sample > 32767)
+        return 32767;
+    if (sample < -32768)
+        return -32768;
+    return sample;
+}
+
+static void process_remap(const struct hdmi_chmix *mix, const int16_t *in,
+                          int16_t *out, size_t frames)
+{
+    const unsigned int ich = mix->in_channels;
+    const unsigned int och = mix->out_channels;
+    unsigned int o;
+
+    while (frames--) {
+        for (o = 0; o < och; o++)
+            out[o] = mix->map[o] >= 0 ? in[mix->map[o]] : 0;
+        in += ich;
+        out += och;
+    }
+}
+
+static void process_generic(const struct hdmi_chmix *mix, const int16_t *in,
+                            int16_t *out, size_t frames)
+{
+    const unsigned int ich = mix->in_channels;
+    const unsigned int och = mix->out_channels;
+    unsigned int i, o;
+
+    while (frames--) {
+        for (o = 0; o < och; o++) {
+            int32_t acc = 1 << 14;
+            for (i = 0; i < ich; i++)
+                acc += (int32_t)mix->coef[o][i] * in[i];
+            out[o] = clamp16(acc >> 15);
+        }
+        in += ich;
+        out += och;
+    }
+}
+
+#ifdef __SSE2__
+/*2 -> 6/8: every output lane is coef_l * L + coef_r * R*/
+static void process_upmix_sse2(const struct hdmi_chmix *mix, const int16_t *in,
+                               int16_t *out, size_t frames)
+{
+    const unsigned int och = mix->out_channels;
+    const __m128i round = _mm_set1_epi32(1 << 14);
+    int16_t pairs[2 * CHMIX_MAX_CHANNELS];
+    __m128i c_lo, c_hi;
+    unsigned int o;
+
+    memset(pairs, 0, sizeof(pairs));
+    for (o = 0; o < och; o++) {
+        pairs[2 * o] = mix->coef[o][0];
+        pairs[2 * o + 1] = mix->coef[o][1];
+    }
+    c_lo = _mm_loadu_si128((const __m128i *)pairs);
+    c_hi = _mm_loadu_si128((const __m128i *)(pairs + 8));
+
+    while (frames--) {
+        int32_t lr;
+        __m128i frame, lo, hi, res;
+
+        memcpy(&lr, in, sizeof(lr));
+        frame = _mm_set1_epi32(lr);
+        lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(frame, c_lo), round), 15);
+        hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(frame, c_hi), round), 15);
+        res = _mm_packs_epi32(lo, hi);
+
+        if (och == 8) {
+            _mm_storeu_si128((__m128i *)out, res);
+        } else {
+            int32_t last = _mm_cvtsi128_si32(_mm_srli_si128(res, 8));
+            _mm_storel_epi64((__m128i *)out, res);
+            memcpy(out + 4, &last, sizeof(last));
+        }
+        in += 2;
+        out += och;
+    }
+}
+
+/*6/8 -> 2: one madd per output, then a horizontal add of both sums*/
+static void process_downmix_sse2(const struct hdmi_chmix *mix, const int16_t *in,
+                                 int16_t *out, size_t frames)
+{
+    const unsigned int ich = mix->in_channels;
+    const __m128i round = _mm_set1_epi32(1 << 14);
+    int16_t row[2][CHMIX_MAX_CHANNELS];
+    __m128i c_l, c_r;
+
+    memset(row, 0, sizeof(row));
+    memcpy(row[0], mix->coef[0], ich * sizeof(int16_t));
+    memcpy(row[1], mix->coef[1], ich * sizeof(int16_t));
+    c_l = _mm_loadu_si128((const __m128i *)row[0]);
+    c_r = _mm_loadu_si128((const __m128i *)row[1]);
+
+    while (frames--) {
+        __m128i frame, l, r, t;
+        int32_t lr;
+
+        if (ich == 8) {
+            frame = _mm_loadu_si128((const __m128i *)in);
+        } else {
+            int32_t tail;
+            memcpy(&tail, in + 4, sizeof(tail));
+            frame = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)in),
+                                       _mm_cvtsi32_si128(tail));
+        }
+
+        l = _mm_madd_epi16(frame, c_l);
+        r = _mm_madd_epi16(frame, c_r);
+        /*[l0+l2, r0+r2, l1+l3, r1+r3]*/
+        t = _mm_add_epi32(_mm_unpacklo_epi32(l, r), _mm_unpackhi_epi32(l, r));
+        /*[L, R, L, R]*/
+        t = _mm_add_epi32(t, _mm_shuffle_epi32(t, _MM_SHUFFLE(1, 0, 3, 2)));
+        t = _mm_srai_epi32(_mm_add_epi32(t, round), 15);
+        lr = _mm_cvtsi128_si32(_mm_packs_epi32(t, t));
+        memcpy(out, &lr, sizeof(lr));
+
+        in += ich;
+        out += 2;
+    }
+}
+#endif
+
+void hdmi_chmix_process(const struct hdmi_chmix *mix, const int16_t *in,
+                        int16_t *out, size_t frames)
+{
+    if (mix->remap_only) {
+        process_remap(mix, in, out, frames);
+        return;
+    }
+
+#ifdef __SSE2__
+    if (mix->in_channels == 2 && mix->out_channels > 2) {
+        process_upmix_sse2(mix, in, out, frames);
+        return;
+    }
+    if (mix->out_channels == 2 && mix->in_channels > 2) {
+        process_downmix_sse2(mix, in, out, frames);
+        return;
+    }
+#endif
+
+    process_generic(mix, in, out, frames);
+}
+
+void hdmi_chmix_process_c(const struct hdmi_chmix *mix, const int16_t *in,
+                          int16_t *out, size_t frames)
+{
+    if (mix->remap_only)
+        process_remap(mix, in, out, frames);
+    else
+        process_generic(mix, in, out, frames);
+}
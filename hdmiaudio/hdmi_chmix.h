@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HDMI_CHMIX_H
+#define HDMI_CHMIX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define CHMIX_MAX_CHANNELS          8
+
+/* Channel remapping / mixing engine for 16 bit interleaved PCM.
+ *
+ * Input frames are in Android channel order (FL FR FC LFE BL BR SL SR),
+ * output frames are in ALSA order (FL FR RL RR FC LFE SL SR) so they can
+ * be written to the HDMI hw device without going through the
+ * Upmix_AndroidPlayback_HDMI plugin.
+ *
+ * The matrix is built once per stream from the sink speaker allocation
+ * (HDMI_ELD_SPK_* mask) and applied in Q15 fixed point.
+ */
+struct hdmi_chmix {
+    unsigned int in_channels;
+    unsigned int out_channels;
+    /*pure copy, out[o] = in[map[o]] or silence if map[o] < 0*/
+    bool         remap_only;
+    int          map[CHMIX_MAX_CHANNELS];
+    /*Q15 coefficients, coef[out][in]*/
+    int16_t      coef[CHMIX_MAX_CHANNELS][CHMIX_MAX_CHANNELS];
+};
+
+/* Build the mixing matrix for in_channels (2, 6 or 8) to out_channels
+ * (2, 6 or 8). Speakers missing from speaker_alloc are folded down into
+ * the remaining ones. Returns 0 on success, -EINVAL on unsupported
+ * channel counts.
+ */
+int hdmi_chmix_init(struct hdmi_chmix *mix, unsigned int in_channels,
+                    unsigned int out_channels, uint32_t speaker_alloc);
+
+/*in and out must not overlap*/
+void hdmi_chmix_process(const struct hdmi_chmix *mix, const int16_t *in,
+                        int16_t *out, size_t frames);
+
+/*same as hdmi_chmix_process without the SIMD paths, which have to match it bit for bit*/
+void hdmi_chmix_process_c(const struct hdmi_chmix *mix, const int16_t *in,
+                          int16_t *out, size_t frames);
+
+#endif /*HDMI_CHMIX_H*/
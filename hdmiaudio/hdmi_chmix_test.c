@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Host test for the channel mixer: checks that hdmi_chmix_process (SSE2
+ * paths included) is bit exact with the portable C path for every
+ * supported layout, checks the passthrough reordering, then times both.
+ *
+ * usage: hdmi_chmix_test [-b frames]   (-b 0 skips the benchmark)
+ */
+#define LOG_TAG "hdmi_chmix_test"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "hdmi_eld.h"
+#include "hdmi_chmix.h"
+
+#define TEST_FRAMES                 4096
+#define BENCH_FRAMES                (1 << 20)
+#define BENCH_LOOPS                 8
+
+#define SPK_ALL                     (HDMI_ELD_SPK_FL_FR | HDMI_ELD_SPK_LFE | \
+                                     HDMI_ELD_SPK_FC | HDMI_ELD_SPK_RL_RR | \
+                                     HDMI_ELD_SPK_RLC_RRC)
+
+static const unsigned int layouts[] = { 2, 6, 8 };
+
+static const uint32_t speaker_allocs[] = {
+    HDMI_ELD_SPK_FL_FR,
+    HDMI_ELD_SPK_FL_FR | HDMI_ELD_SPK_FC,
+    HDMI_ELD_SPK_FL_FR | HDMI_ELD_SPK_LFE | HDMI_ELD_SPK_RL_RR,
+    HDMI_ELD_SPK_FL_FR | HDMI_ELD_SPK_LFE | HDMI_ELD_SPK_FC | HDMI_ELD_SPK_RL_RR,
+    SPK_ALL,
+};
+
+static int failures;
+
+/*random samples with runs of full scale values to exercise saturation*/
+static void fill(int16_t *buf, size_t samples, unsigned int seed)
+{
+    size_t i;
+
+    srand(seed);
+    for (i = 0; i < samples; i++) {
+        switch (rand() % 8) {
+        case 0:
+            buf[i] = 32767;
+            break;
+        case 1:
+            buf[i] = -32768;
+            break;
+        default:
+            buf[i] = (int16_t)(rand() & 0xffff);
+            break;
+        }
+    }
+}
+
+static void check_bit_exact(unsigned int in_ch, unsigned int out_ch,
+                            uint32_t speaker_alloc)
+{
+    static int16_t in[TEST_FRAMES * CHMIX_MAX_CHANNELS];
+    static int16_t out[TEST_FRAMES * CHMIX_MAX_CHANNELS];
+    static int16_t ref[TEST_FRAMES * CHMIX_MAX_CHANNELS];
+    struct hdmi_chmix mix;
+    size_t frames, i;
+
+    if (hdmi_chmix_init(&mix, in_ch, out_ch, speaker_alloc)) {
+        fprintf(stderr, "init %u -> %u failed\n", in_ch, out_ch);
+        failures++;
+        return;
+    }
+
+    /*odd frame counts catch tail handling*/
+    for (frames = 1; frames <= TEST_FRAMES; frames = frames * 3 + 1) {
+        fill(in, frames * in_ch, frames);
+        memset(out, 0x55, sizeof(out));
+        memset(ref, 0x55, sizeof(ref));
+
+        hdmi_chmix_process(&mix, in, out, frames);
+        hdmi_chmix_process_c(&mix, in, ref, frames);
+
+        /*compare one frame past the end to catch overruns*/
+        for (i = 0; i < (frames + 1) * out_ch; i++) {
+            if (out[i] != ref[i]) {
+                fprintf(stderr, "%u -> %u spk 0x%x: sample %zu of %zu frames: %d != %d\n",
+                        in_ch, out_ch, speaker_alloc, i, frames, out[i], ref[i]);
+                failures++;
+                return;
+            }
+        }
+    }
+}
+
+static void check_passthrough_order(void)
+{
+    /*Android FL FR FC LFE BL BR, ALSA FL FR RL RR FC LFE*/
+    static const int16_t in6[6] = { 1, 2, 3, 4, 5, 6 };
+    static const int16_t want6[6] = { 1, 2, 5, 6, 3, 4 };
+    /*Android FL FR FC LFE BL BR SL SR, ALSA FL FR RL RR FC LFE SL SR*/
+    static const int16_t in8[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    static const int16_t want8[8] = { 1, 2, 5, 6, 3, 4, 7, 8 };
+    struct hdmi_chmix mix;
+    int16_t out[8];
+
+    hdmi_chmix_init(&mix, 6, 6, SPK_ALL);
+    hdmi_chmix_process(&mix, in6, out, 1);
+    if (!mix.remap_only || memcmp(out, want6, sizeof(want6))) {
+        fprintf(stderr, "6ch passthrough not reordered to ALSA order\n");
+        failures++;
+    }
+
+    hdmi_chmix_init(&mix, 8, 8, SPK_ALL);
+    hdmi_chmix_process(&mix, in8, out, 1);
+    if (!mix.remap_only || memcmp(out, want8, sizeof(want8))) {
+        fprintf(stderr, "8ch passthrough not reordered to ALSA order\n");
+        failures++;
+    }
+}
+
+/*Medfield opens the device with 8 channels, a stream folded down for a
+ *smaller sink is padded with silent channels*/
+static void check_fold_and_pad(void)
+{
+    static const int16_t in8[8] = { 100, 200, 300, 400, 500, 600, 700, 800 };
+    struct hdmi_chmix mix;
+    int16_t out[8];
+    unsigned int o;
+
+    /*6 speaker sink: SL/SR go into RL/RR, their own lanes are silent*/
+    hdmi_chmix_init(&mix, 8, 8, SPK_ALL & ~HDMI_ELD_SPK_RLC_RRC);
+    hdmi_chmix_process(&mix, in8, out, 1);
+    if (out[0] != 100 || out[1] != 200 || out[2] != (500 + 700) / 2 ||
+        out[3] != (600 + 800) / 2 || out[4] != 300 || out[5] != 400 ||
+        out[6] || out[7]) {
+        fprintf(stderr, "8ch folded to 6 not padded to 8\n");
+        failures++;
+    }
+
+    /*stereo sink: everything in FL/FR, the 6 other lanes are silent*/
+    hdmi_chmix_init(&mix, 8, 8, HDMI_ELD_SPK_FL_FR);
+    hdmi_chmix_process(&mix, in8, out, 1);
+    for (o = 2; o < 8; o++) {
+        if (out[o]) {
+            fprintf(stderr, "8ch folded to 2: lane %u not silent\n", o);
+            failures++;
+        }
+    }
+    if (out[0] <= 100 || out[1] <= 200) {
+        fprintf(stderr, "8ch folded to 2: front not mixed down\n");
+        failures++;
+    }
+}
+
+static double now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void bench(unsigned int in_ch, unsigned int out_ch, size_t frames)
+{
+    int16_t *in = malloc(frames * in_ch * sizeof(int16_t));
+    int16_t *out = malloc(frames * out_ch * sizeof(int16_t));
+    struct hdmi_chmix mix;
+    double t0, simd, ref;
+    int loop;
+
+    if (!in || !out)
+        goto done;
+
+    hdmi_chmix_init(&mix, in_ch, out_ch, SPK_ALL);
+    fill(in, frames * in_ch, 1);
+
+    t0 = now_ms();
+    for (loop = 0; loop < BENCH_LOOPS; loop++)
+        hdmi_chmix_process(&mix, in, out, frames);
+    simd = now_ms() - t0;
+
+    t0 = now_ms();
+    for (loop = 0; loop < BENCH_LOOPS; loop++)
+        hdmi_chmix_process_c(&mix, in, out, frames);
+    ref = now_ms() - t0;
+
+    printf("%u -> %u %-6s  %8.1f Mframes/s  C %8.1f Mframes/s  x%.2f\n",
+           in_ch, out_ch, mix.remap_only ? "remap" : "mix",
+           frames * BENCH_LOOPS / simd / 1000.0,
+           frames * BENCH_LOOPS / ref / 1000.0, ref / simd);
+done:
+    free(in);
+    free(out);
+}
+
+int main(int argc, char **argv)
+{
+    size_t bench_frames = BENCH_FRAMES;
+    unsigned int i, o, s;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:")) != -1) {
+        switch (opt) {
+        case 'b':
+            bench_frames = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-b frames]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    for (i = 0; i < sizeof(layouts) / sizeof(layouts[0]); i++)
+        for (o = 0; o < sizeof(layouts) / sizeof(layouts[0]); o++)
+            for (s = 0; s < sizeof(speaker_allocs) / sizeof(speaker_allocs[0]); s++)
+                check_bit_exact(layouts[i], layouts[o], speaker_allocs[s]);
+    check_passthrough_order();
+    check_fold_and_pad();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("hdmi_chmix_test: all checks passed\n");
+
+    if (bench_frames) {
+        bench(2, 6, bench_frames);
+        bench(2, 8, bench_frames);
+        bench(6, 2, bench_frames);
+        bench(8, 2, bench_frames);
+        bench(6, 6, bench_frames);
+    }
+    return 0;
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "hdmi_eld"
+//#define LOG_NDEBUG 0
+
+#include <errno.h>
+#include <string.h>
+
+#include <cutils/log.h>
+
+#include "hdmi_eld.h"
+
+/*ELD layout, see HDA specification 7.3.3.34*/
+#define ELD_HEADER_SIZE             4
+#define ELD_VER_CEA_861D            2
+/*header + fixed baseline fields, the monitor name starts right after*/
+#define ELD_FIXED_BYTES             20
+#define ELD_MNL_MASK                0x1f
+#define ELD_SAD_SIZE                3
+
+#define SAD_CODING_LPCM             1
+
+static const struct {
+    unsigned int rate;
+    uint32_t mask;
+} eld_rates[] = {
+    { 32000,  HDMI_ELD_RATE_32000  },
+    { 44100,  HDMI_ELD_RATE_44100  },
+    { 48000,  HDMI_ELD_RATE_48000  },
+    { 88200,  HDMI_ELD_RATE_88200  },
+    { 96000,  HDMI_ELD_RATE_96000  },
+    { 176400, HDMI_ELD_RATE_176400 },
+    { 192000, HDMI_ELD_RATE_192000 },
+};
+
+void hdmi_eld_default_caps(struct hdmi_sink_caps *caps)
+{
+    memset(caps, 0, sizeof(*caps));
+    caps->max_channels  = 2;
+    caps->rates         = HDMI_ELD_RATE_32000 | HDMI_ELD_RATE_44100 |
+                          HDMI_ELD_RATE_48000;
+    caps->formats       = HDMI_ELD_FMT_16BIT;
+    caps->speaker_alloc = HDMI_ELD_SPK_FL_FR;
+}
+
+uint32_t hdmi_eld_rate_to_mask(unsigned int rate)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(eld_rates) / sizeof(eld_rates[0]); i++) {
+        if (eld_rates[i].rate == rate)
+            return eld_rates[i].mask;
+    }
+    return 0;
+}
+
+bool hdmi_eld_supports_rate(const struct hdmi_sink_caps *caps,
+                            unsigned int rate)
+{
+    return (caps->rates & hdmi_eld_rate_to_mask(rate)) != 0;
+}
+
+int hdmi_eld_parse(const uint8_t *eld, size_t size,
+                   struct hdmi_sink_caps *caps)
+{
+    size_t baseline_len, mnl, sad_count, sad_offset, i;
+    struct hdmi_sink_caps parsed;
+    bool lpcm_found = false;
+
+    hdmi_eld_default_caps(caps);
+
+    if (!eld || size < ELD_FIXED_BYTES) {
+        ALOGE("[EDID] ELD too short (%d bytes)", (int)size);
+        return -EINVAL;
+    }
+
+    if ((eld[0] >> 3) != ELD_VER_CEA_861D) {
+        ALOGE("[EDID] unsupported ELD version %d", eld[0] >> 3);
+        return -EINVAL;
+    }
+
+    /*baseline block length is expressed in dwords*/
+    baseline_len = eld[2] * 4;
+    if (ELD_HEADER_SIZE + baseline_len > size) {
+        ALOGE("[EDID] baseline block (%d) exceeds ELD size (%d)",
+              (int)baseline_len, (int)size);
+        return -EINVAL;
+    }
+
+    mnl = eld[4] & ELD_MNL_MASK;
+    sad_count = eld[5] >> 4;
+    sad_offset = ELD_FIXED_BYTES + mnl;
+
+    if (sad_offset + sad_count * ELD_SAD_SIZE > size ||
+        sad_offset + sad_count * ELD_SAD_SIZE > ELD_HEADER_SIZE + baseline_len) {
+        ALOGE("[EDID] %d SADs do not fit in baseline block", (int)sad_count);
+        return -EINVAL;
+    }
+
+    memset(&parsed, 0, sizeof(parsed));
+    parsed.speaker_alloc = eld[7] & 0x7f;
+
+    for (i = 0; i < sad_count; i++) {
+        const uint8_t *sad = eld + sad_offset + i * ELD_SAD_SIZE;
+        unsigned int coding = (sad[0] >> 3) & 0x0f;
+        unsigned int channels = (sad[0] & 0x07) + 1;
+
+        ALOGV("[EDID] SAD %d: coding %d channels %d rates 0x%x bits 0x%x",
+              (int)i, coding, channels, sad[1], sad[2]);
+
+        if (coding != SAD_CODING_LPCM)
+            continue;
+
+        lpcm_found = true;
+        if (channels > parsed.max_channels)
+            parsed.max_channels = channels;
+        parsed.rates |= sad[1] & 0x7f;
+        parsed.formats |= sad[2] & 0x07;
+    }
+
+    if (!lpcm_found) {
+        ALOGW("[EDID] no LPCM descriptor in ELD");
+        return -EINVAL;
+    }
+
+    /*basic audio is mandatory for every HDMI sink*/
+    if (!parsed.formats)
+        parsed.formats = HDMI_ELD_FMT_16BIT;
+    if (!parsed.speaker_alloc)
+        parsed.speaker_alloc = HDMI_ELD_SPK_FL_FR;
+
+    parsed.valid = true;
+    *caps = parsed;
+
+    ALOGD("[EDID] sink caps: %d channels rates 0x%x formats 0x%x speakers 0x%x",
+          caps->max_channels, caps->rates, caps->formats, caps->speaker_alloc);
+    return 0;
+}
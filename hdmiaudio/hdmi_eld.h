@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HDMI_ELD_H
+#define HDMI_ELD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*ALSA control exposing the raw ELD of the connected sink*/
+#define HDMI_ELD_CTL_NAME           "ELD"
+#define HDMI_ELD_MAX_SIZE           256
+
+/*LPCM sample rates (CEA-861 short audio descriptor byte 1)*/
+#define HDMI_ELD_RATE_32000         (1 << 0)
+#define HDMI_ELD_RATE_44100         (1 << 1)
+#define HDMI_ELD_RATE_48000         (1 << 2)
+#define HDMI_ELD_RATE_88200         (1 << 3)
+#define HDMI_ELD_RATE_96000         (1 << 4)
+#define HDMI_ELD_RATE_176400        (1 << 5)
+#define HDMI_ELD_RATE_192000        (1 << 6)
+
+/*LPCM sample sizes (CEA-861 short audio descriptor byte 2)*/
+#define HDMI_ELD_FMT_16BIT          (1 << 0)
+#define HDMI_ELD_FMT_20BIT          (1 << 1)
+#define HDMI_ELD_FMT_24BIT          (1 << 2)
+
+/*speaker allocation bits (CEA-861 speaker allocation data block)*/
+#define HDMI_ELD_SPK_FL_FR          (1 << 0)
+#define HDMI_ELD_SPK_LFE            (1 << 1)
+#define HDMI_ELD_SPK_FC             (1 << 2)
+#define HDMI_ELD_SPK_RL_RR          (1 << 3)
+#define HDMI_ELD_SPK_RC             (1 << 4)
+#define HDMI_ELD_SPK_FLC_FRC        (1 << 5)
+#define HDMI_ELD_SPK_RLC_RRC        (1 << 6)
+
+/* Audio capabilities of the HDMI sink, as advertised in its ELD.
+ * Only LPCM descriptors are taken into account since the HAL never
+ * passes compressed streams through.
+ */
+struct hdmi_sink_caps {
+    bool         valid;
+    unsigned int max_channels;
+    uint32_t     rates;          /*HDMI_ELD_RATE_* mask*/
+    uint32_t     formats;        /*HDMI_ELD_FMT_* mask*/
+    uint32_t     speaker_alloc;  /*HDMI_ELD_SPK_* mask*/
+};
+
+/* Parse a raw ELD blob into sink capabilities.
+ * Returns 0 on success, -EINVAL if the blob is malformed or carries
+ * no LPCM descriptor. caps is left in the stereo default on failure.
+ */
+int hdmi_eld_parse(const uint8_t *eld, size_t size,
+                   struct hdmi_sink_caps *caps);
+
+/*fill caps with the basic audio every HDMI sink has to support*/
+void hdmi_eld_default_caps(struct hdmi_sink_caps *caps);
+
+/*sample rate in Hz to HDMI_ELD_RATE_* bit, 0 if not an HDMI rate*/
+uint32_t hdmi_eld_rate_to_mask(unsigned int rate);
+
+bool hdmi_eld_supports_rate(const struct hdmi_sink_caps *caps,
+                            unsigned int rate);
+
+#endif /*HDMI_ELD_H*/
@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Host test for the ELD parser: parses canned ELDs of the kind real
+ * sinks report and checks the resulting capabilities.
+ * Exits non-zero on the first mismatch.
+ */
+#define LOG_TAG "hdmi_eld_test"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "hdmi_eld.h"
+
+#define SAD(coding, ch, rates, bits)    (((coding) << 3) | ((ch) - 1)), (rates), (bits)
+#define SAD_LPCM                        1
+#define SAD_AC3                         2
+#define SAD_DTS                         7
+
+static int failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+/*lay out a CEA-861-D ELD the way the HDA codec reports it*/
+static size_t build_eld(uint8_t *eld, const char *name, uint8_t spk,
+                        const uint8_t *sads, size_t sad_count)
+{
+    size_t mnl = strlen(name);
+    size_t len = 20 + mnl + sad_count * 3;
+    size_t baseline = (len - 4 + 3) / 4;
+
+    memset(eld, 0, HDMI_ELD_MAX_SIZE);
+    eld[0] = 2 << 3;
+    eld[2] = baseline;
+    eld[4] = (3 << 5) | mnl;
+    eld[5] = sad_count << 4;
+    eld[7] = spk;
+    memcpy(eld + 20, name, mnl);
+    memcpy(eld + 20 + mnl, sads, sad_count * 3);
+    return 4 + baseline * 4;
+}
+
+static void test_stereo(void)
+{
+    static const uint8_t sads[] = { SAD(SAD_LPCM, 2, 0x07, 0x07) };
+    uint8_t eld[HDMI_ELD_MAX_SIZE];
+    struct hdmi_sink_caps caps;
+    size_t size = build_eld(eld, "TV", 0x01, sads, 1);
+
+    CHECK(hdmi_eld_parse(eld, size, &caps) == 0);
+    CHECK(caps.valid);
+    CHECK(caps.max_channels == 2);
+    CHECK(caps.rates == (HDMI_ELD_RATE_32000 | HDMI_ELD_RATE_44100 |
+                         HDMI_ELD_RATE_48000));
+    CHECK(caps.formats == (HDMI_ELD_FMT_16BIT | HDMI_ELD_FMT_20BIT |
+                           HDMI_ELD_FMT_24BIT));
+    CHECK(caps.speaker_alloc == HDMI_ELD_SPK_FL_FR);
+    CHECK(hdmi_eld_supports_rate(&caps, 48000));
+    CHECK(!hdmi_eld_supports_rate(&caps, 96000));
+}
+
+static void test_lpcm_8ch(void)
+{
+    /*AV receiver: stereo up to 192k plus 7.1 up to 96k, long monitor name*/
+    static const uint8_t sads[] = {
+        SAD(SAD_LPCM, 2, 0x7f, 0x07),
+        SAD(SAD_LPCM, 8, 0x1f, 0x05),
+    };
+    uint8_t eld[HDMI_ELD_MAX_SIZE];
+    struct hdmi_sink_caps caps;
+    size_t size = build_eld(eld, "AV-RECEIVER 7.1", 0x4f, sads, 2);
+
+    CHECK(hdmi_eld_parse(eld, size, &caps) == 0);
+    CHECK(caps.valid);
+    CHECK(caps.max_channels == 8);
+    CHECK(caps.rates == 0x7f);
+    CHECK(hdmi_eld_supports_rate(&caps, 192000));
+    CHECK(caps.formats == 0x07);
+    CHECK(caps.speaker_alloc == 0x4f);
+}
+
+static void test_compressed_only(void)
+{
+    /*AC3 and DTS only: nothing the HAL can play*/
+    static const uint8_t sads[] = {
+        SAD(SAD_AC3, 6, 0x07, 0x50),
+        SAD(SAD_DTS, 6, 0x06, 0xc0),
+    };
+    uint8_t eld[HDMI_ELD_MAX_SIZE];
+    struct hdmi_sink_caps caps;
+    size_t size = build_eld(eld, "SOUNDBAR", 0x0b, sads, 2);
+
+    CHECK(hdmi_eld_parse(eld, size, &caps) == -EINVAL);
+    CHECK(!caps.valid);
+    CHECK(caps.max_channels == 2);
+}
+
+static void test_compressed_and_lpcm(void)
+{
+    /*compressed descriptors must not leak into the LPCM caps*/
+    static const uint8_t sads[] = {
+        SAD(SAD_AC3, 6, 0x07, 0x50),
+        SAD(SAD_LPCM, 2, 0x06, 0x01),
+        SAD(SAD_DTS, 8, 0x7f, 0xc0),
+    };
+    uint8_t eld[HDMI_ELD_MAX_SIZE];
+    struct hdmi_sink_caps caps;
+    size_t size = build_eld(eld, "HTIB", 0x0b, sads, 3);
+
+    CHECK(hdmi_eld_parse(eld, size, &caps) == 0);
+    CHECK(caps.max_channels == 2);
+    CHECK(caps.rates == (HDMI_ELD_RATE_44100 | HDMI_ELD_RATE_48000));
+    CHECK(caps.formats == HDMI_ELD_FMT_16BIT);
+}
+
+static void test_truncated(void)
+{
+    static const uint8_t sads[] = {
+        SAD(SAD_LPCM, 2, 0x07, 0x01),
+        SAD(SAD_LPCM, 8, 0x07, 0x01),
+    };
+    uint8_t eld[HDMI_ELD_MAX_SIZE];
+    struct hdmi_sink_caps caps;
+    size_t size = build_eld(eld, "TRUNCATED", 0x01, sads, 2);
+
+    /*blob cut inside the last SAD*/
+    CHECK(hdmi_eld_parse(eld, 20 + 9 + 4, &caps) == -EINVAL);
+    CHECK(!caps.valid);
+
+    /*blob shorter than the fixed part*/
+    CHECK(hdmi_eld_parse(eld, 16, &caps) == -EINVAL);
+
+    /*baseline block claims more than was read*/
+    CHECK(hdmi_eld_parse(eld, size - 4, &caps) == -EINVAL);
+
+    /*SAD count runs past the baseline block*/
+    eld[5] = 15 << 4;
+    CHECK(hdmi_eld_parse(eld, size, &caps) == -EINVAL);
+
+    CHECK(hdmi_eld_parse(NULL, size, &caps) == -EINVAL);
+}
+
+static void test_bad_version(void)
+{
+    static const uint8_t sads[] = { SAD(SAD_LPCM, 2, 0x07, 0x01) };
+    uint8_t eld[HDMI_ELD_MAX_SIZE];
+    struct hdmi_sink_caps caps;
+    size_t size = build_eld(eld, "TV", 0x01, sads, 1);
+
+    eld[0] = 31 << 3;
+    CHECK(hdmi_eld_parse(eld, size, &caps) == -EINVAL);
+}
+
+int main(void)
+{
+    test_stereo();
+    test_lpcm_8ch();
+    test_compressed_only();
+    test_compressed_and_lpcm();
+    test_truncated();
+    test_bad_version();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("hdmi_eld_test: all checks passed\n");
+    return 0;
+}
@@ -41,6 +41,9 @@
 #include <sound/asound.h>
 #include <tinyalsa/asoundlib.h>
 
+#include "audio_mmap.h"
+#include "hdmi_eld.h"
+
 #define DEFAULT_CARD               0
 #define DEFAULT_DEVICE             0
 
@@ -50,6 +53,15 @@
 /*Playback Channel Map*/
 #define CHANNEL_MAP_REQUEST      2
 
+/* MMAP playback writes straight into the DMA buffer. It starts with
+ * short periods and doubles them on every underrun up to the default
+ * period size. */
+#define MMAP_PROPERTY            "hdmi.audio.mmap"
+#define MMAP_PERIOD_SIZE_MIN     256
+#define MMAP_PERIOD_COUNT        4
+#define MMAP_START_PERIODS       2
+#define MMAP_WAIT_TIMEOUT_MS     100
+
 /*global - keep track of the active device.
 This is needed since we are supporting more
 than one profile for HDMI. The Flinger
@@ -93,6 +105,9 @@ struct audio_device {
     bool standby;
     int sink_sup_channels;
     audio_channel_mask_t sup_channel_masks[CHANNEL_MASK_MAX];
+    /*sink capabilities, read once per hotplug*/
+    bool sink_caps_cached;
+    struct hdmi_sink_caps sink_caps;
 };
 
 struct stream_out {
@@ -112,6 +127,10 @@ struct stream_out {
     uint32_t   channels;
     uint32_t   latency;
 
+ /* MMAP mode */
+    bool       use_mmap;
+    struct audio_mmap mmap;
+
     struct audio_device *dev;
 };
 
@@ -147,10 +166,79 @@ static int get_card_number_by_name(const char* name)
     return atoi(number_filepath + 4);
 }
 
-static enum pcm_format Get_SinkSupported_format()
+/* Read the sink capabilities from the ELD control of the HDMI card.
+ * Older drivers do not expose the ELD, fall back to counting the
+ * valid entries of the playback channel map in that case.
+ */
+static void read_sink_caps(struct hdmi_sink_caps *caps)
+{
+    struct mixer *mixer;
+    struct mixer_ctl *ctl;
+    uint8_t eld[HDMI_ELD_MAX_SIZE];
+    unsigned int num_values;
+    unsigned int i;
+    int chcount = 0;
+
+    hdmi_eld_default_caps(caps);
+
+    mixer = mixer_open(get_card_number_by_name("IntelHDMI"));
+    if (!mixer) {
+        ALOGE("[EDID] Failed to open mixer");
+        return;
+    }
+
+    ctl = mixer_get_ctl_by_name(mixer, HDMI_ELD_CTL_NAME);
+    if (ctl && mixer_ctl_get_type(ctl) == MIXER_CTL_TYPE_BYTE) {
+        num_values = mixer_ctl_get_num_values(ctl);
+        if (num_values > sizeof(eld))
+            num_values = sizeof(eld);
+        if (mixer_ctl_get_array(ctl, eld, num_values) == 0 &&
+            hdmi_eld_parse(eld, num_values, caps) == 0) {
+            mixer_close(mixer);
+            return;
+        }
+    }
+
+    ctl = mixer_get_ctl_by_name(mixer, "Playback Channel Map");
+    if (ctl && mixer_ctl_get_type(ctl) == MIXER_CTL_TYPE_INT) {
+        num_values = mixer_ctl_get_num_values(ctl);
+        for (i = 0; i < num_values; i++) {
+            if (mixer_ctl_get_value(ctl, i) > 0)
+                ++chcount;
+        }
+    }
+    if (chcount > 2)
+        caps->max_channels = chcount;
+
+    ALOGD("[EDID]valid number of channels supported by sink = %d",chcount);
+    mixer_close(mixer);
+}
+
+/* must be called with hw device mutex locked */
+static const struct hdmi_sink_caps *get_sink_caps(struct audio_device *adev)
+{
+    if (!adev->sink_caps_cached) {
+        read_sink_caps(&adev->sink_caps);
+        adev->sink_caps_cached = true;
+    }
+    return &adev->sink_caps;
+}
+
+/* must be called with hw device mutex locked */
+static void invalidate_sink_caps(struct audio_device *adev)
 {
-   /*TODO : query sink supported formats*/
-   return PCM_FORMAT_S24_LE;
+    ALOGV("%s",__func__);
+    adev->sink_caps_cached = false;
+}
+
+/* must be called with hw device mutex locked */
+static enum pcm_format Get_SinkSupported_format(struct audio_device *adev)
+{
+   const struct hdmi_sink_caps *caps = get_sink_caps(adev);
+
+   if (caps->formats & HDMI_ELD_FMT_24BIT)
+      return PCM_FORMAT_S24_LE;
+   return PCM_FORMAT_S16_LE;
 }
 
 static int format_to_bits(enum pcm_format pcmformat)
@@ -166,18 +254,17 @@ static int format_to_bits(enum pcm_format pcmformat)
   };
 }
 
-static int make_sinkcompliant_buffers(void* input, void *output, int ipbytes)
+static int make_sinkcompliant_buffers(void* input, void *output, int ipbytes,
+                                      enum pcm_format out_pcmformat)
 {
   int i = 0,outbytes = 0;
   enum pcm_format in_pcmformat;
-  enum pcm_format out_pcmformat;
   int *src = (int*)input;
   int *dst = (int*)output;
 
   /*by default android currently support only
     16 bit signed PCM*/
   in_pcmformat = PCM_FORMAT_S16_LE;
-  out_pcmformat = Get_SinkSupported_format();
 
   switch (out_pcmformat) {
     default:
@@ -354,31 +441,78 @@ static int start_output_stream(struct stream_out *out)
     int result = mixer_ctl_get_value(ctl, 0);
 
     adev->card = get_card_number_by_name("IntelHDMI");
-    out->pcm_config.format = 3;
+    out->pcm_config.format = Get_SinkSupported_format(adev);
     out->pcm_config.start_threshold = 0;
     out->pcm_config.stop_threshold = 0;
-    out->pcm_config.period_size = 1024;
+    if (out->use_mmap) {
+        /*start as soon as a couple of periods are queued*/
+        out->pcm_config.start_threshold = out->pcm_config.period_size * MMAP_START_PERIODS;
+        out->pcm_config.avail_min = out->pcm_config.period_size;
+    } else {
+        out->pcm_config.period_size = 1024;
+    }
     ALOGD("%s: HDMI card number = %d, device = %d",__func__,adev->card,adev->device);
 
     mixer_close(mixer);
 
-    out->pcm = pcm_open(adev->card, adev->device, PCM_OUT, &out->pcm_config);
+    out->pcm = pcm_open(adev->card, adev->device,
+                        out->use_mmap ? PCM_OUT | PCM_MMAP : PCM_OUT,
+                        &out->pcm_config);
 
     if (out->pcm && !pcm_is_ready(out->pcm)) {
         ALOGE("pcm_open() failed: %s", pcm_get_error(out->pcm));
         pcm_close(out->pcm);
+        out->pcm = NULL;
         activePcm = NULL;
         return -ENOMEM;
     }
 
     activePcm = out->pcm;
     activeChannel = out->pcm_config.channels;
+    if (out->use_mmap)
+        audio_mmap_set_pcm(&out->mmap, out->pcm, out->pcm_config.start_threshold);
 
     ALOGV("Initialized PCM device for channels %d handle = %d",out->pcm_config.channels, (int)activePcm);
     ALOGV("%s exit",__func__);
     return 0;
 }
 
+/* Underrun in MMAP mode: grow the period, up to the default one, and
+ * reopen the PCM with it so the rest of the write goes out right away.
+ * must be called with hw device and output stream mutexes locked
+ */
+static int out_mmap_xrun(struct audio_mmap *mmap, void *cookie)
+{
+    struct stream_out *out = cookie;
+    int ret;
+
+    if (out->pcm_config.period_size >= pcm_config_default.period_size) {
+        ALOGW("%s: underrun #%u", __func__, mmap->xruns);
+        return pcm_prepare(out->pcm);
+    }
+
+    out->pcm_config.period_size *= 2;
+    ALOGW("%s: underrun #%u, period size raised to %u", __func__,
+          mmap->xruns, out->pcm_config.period_size);
+    pcm_close(out->pcm);
+    out->pcm = NULL;
+    activePcm = NULL;
+    audio_mmap_set_pcm(mmap, NULL, 0);
+
+    ret = start_output_stream(out);
+    if (ret != 0)
+        out->standby = true;
+    return ret;
+}
+
+static bool mmap_enabled()
+{
+    char value[PROPERTY_VALUE_MAX];
+
+    property_get(MMAP_PROPERTY, value, "0");
+    return atoi(value) != 0;
+}
+
 /* API functions */
 
 static uint32_t out_get_sample_rate(const struct audio_stream *stream)
@@ -489,12 +623,16 @@ static int out_set_parameters(struct audio_stream *stream, const char *kvpairs)
     }
 
     ret = str_parms_get_str(parms, "card", value, sizeof(value));
-    if (ret >= 0)
+    if (ret >= 0 && adev->card != atoi(value)) {
         adev->card = atoi(value);
+        invalidate_sink_caps(adev);
+    }
 
     ret = str_parms_get_str(parms, "device", value, sizeof(value));
-    if (ret >= 0)
+    if (ret >= 0 && adev->device != atoi(value)) {
         adev->device = atoi(value);
+        invalidate_sink_caps(adev);
+    }
 
     pthread_mutex_unlock(&adev->lock);
     str_parms_destroy(parms);
@@ -503,73 +641,15 @@ static int out_set_parameters(struct audio_stream *stream, const char *kvpairs)
     return 0;
 }
 
-static int parse_channel_map()
-{
-    struct mixer *mixer;
-    int card = 0;
-    struct mixer_ctl *ctl;
-    enum mixer_ctl_type type;
-    unsigned int num_values;
-    unsigned int i,id;
-    int chcount=0, chmap=0;
-
-    card = get_card_number_by_name("IntelHDMI");
-    mixer = mixer_open(card);
-    if (!mixer) {
-        ALOGE("[EDID] Failed to open mixer\n");
-        goto chmap_error;
-    }
-
-    id = CHANNEL_MAP_REQUEST;
-    if (id >= mixer_get_num_ctls(mixer)) {
-        ALOGE("[EDID] Invalid request for channel map %d",id);
-        goto chmap_error;
-    }
-
-    ctl = mixer_get_ctl_by_name(mixer, "Playback Channel Map");
-
-    //ctl = mixer_get_ctl(mixer, id);
-
-    type = mixer_ctl_get_type(ctl);
-    num_values = mixer_ctl_get_num_values(ctl);
-
-    ALOGV("[EDID]id = %d",id);
-    ALOGV("[EDID]type = %d",type);
-    ALOGV("[EDID]count = %d",num_values);
-
-    for (i = 0; i < num_values; i++) {
-      switch (type)
-      {
-       case MIXER_CTL_TYPE_INT:
-            chmap = mixer_ctl_get_value(ctl, i);
-            ALOGD("[EDID]chmap = %d", chmap);
-            if(chmap > 0)  ++chcount;
-            break;
-       default:
-            printf(" unknown");
-            break;
-      };
-    }//for
-
-    ALOGD("[EDID]valid number of channels supported by sink = %d",chcount);
-
-    mixer_close(mixer);
-
-    return chcount;
-
-chmap_error:
-    mixer_close(mixer);
-    return 2;//stereo by default
-
-}
-
 static int out_read_edid(const struct stream_out *stream)
 {
     struct stream_out *out = (struct stream_out *)stream;
     struct audio_device *adev = out->dev;
 
     /**read the channel max param from the sink*/
-    adev->sink_sup_channels = parse_channel_map();
+    pthread_mutex_lock(&adev->lock);
+    adev->sink_sup_channels = get_sink_caps(adev)->max_channels;
+    pthread_mutex_unlock(&adev->lock);
 
     if(adev->sink_sup_channels == 8) {
       adev->sup_channel_masks[0] = AUDIO_CHANNEL_OUT_5POINT1;
@@ -684,7 +764,7 @@ static ssize_t out_write(struct audio_stream_out *stream, const void* buffer,
        goto err;
     }
 
-    if(Get_SinkSupported_format() == out->pcm_config.format){
+    if(out->pcm_config.format == PCM_FORMAT_S24_LE){
 
        /*16 bit data will be converted to 24 bit over 32 bit data type
        hence the multiplier 2*/
@@ -698,16 +778,24 @@ static ssize_t out_write(struct audio_stream_out *stream, const void* buffer,
 
        memset(dstbuff,0,bytes * 2);
 
-       outbytes = make_sinkcompliant_buffers((void*)buffer, (void*)dstbuff,bytes);
+       outbytes = make_sinkcompliant_buffers((void*)buffer, (void*)dstbuff,bytes,
+                                             out->pcm_config.format);
      } //if()for conversion
 
-    if(dstbuff){
+    if (out->use_mmap) {
+      if(dstbuff)
+        ret = audio_mmap_write(&out->mmap, (void *)dstbuff, outbytes);
+      else
+        ret = audio_mmap_write(&out->mmap, buffer, bytes);
+    }
+    else if(dstbuff){
       ret = pcm_write(out->pcm, (void *)dstbuff, outbytes);
     }
     else
       ret = pcm_write(out->pcm, (void *)buffer, bytes);
 
-    ALOGV("pcm_write: %s done for %d input bytes, output bytes = %d ", pcm_get_error(out->pcm),bytes,outbytes);
+    ALOGV("pcm_write: %s done for %d input bytes, output bytes = %d ",
+          out->pcm ? pcm_get_error(out->pcm) : "closed",bytes,outbytes);
 
     free(dstbuff);
 
@@ -796,6 +884,14 @@ static int adev_open_output_stream(struct audio_hw_device *dev,
     out->pcm_config.period_count           = pcm_config_default.period_count;
     out->pcm_config.format                 = pcm_config_default.format;
 
+    out->use_mmap                          = mmap_enabled();
+    if (out->use_mmap) {
+        out->pcm_config.period_size        = MMAP_PERIOD_SIZE_MIN;
+        out->pcm_config.period_count       = MMAP_PERIOD_COUNT;
+        ALOGD("%s: MMAP playback, period size %d", __func__, MMAP_PERIOD_SIZE_MIN);
+        audio_mmap_init(&out->mmap, MMAP_WAIT_TIMEOUT_MS, out_mmap_xrun, out);
+    }
+
     out->stream.common.get_sample_rate     = out_get_sample_rate;
     out->stream.common.set_sample_rate     = out_set_sample_rate;
     out->stream.common.get_buffer_size     = out_get_buffer_size;
@@ -870,6 +966,27 @@ static void adev_close_output_stream(struct audio_hw_device *dev,
 
 static int adev_set_parameters(struct audio_hw_device *dev, const char *kvpairs)
 {
+    struct audio_device *adev = (struct audio_device *)dev;
+    struct str_parms *parms;
+    char value[32];
+
+    parms = str_parms_create_str(kvpairs);
+    if (parms == NULL)
+        return 0;
+
+    /*a new sink may advertise different capabilities*/
+    if ((str_parms_get_str(parms, AUDIO_PARAMETER_DEVICE_CONNECT,
+                           value, sizeof(value)) >= 0) ||
+        (str_parms_get_str(parms, AUDIO_PARAMETER_DEVICE_DISCONNECT,
+                           value, sizeof(value)) >= 0)) {
+        if (atoi(value) & AUDIO_DEVICE_OUT_AUX_DIGITAL) {
+            pthread_mutex_lock(&adev->lock);
+            invalidate_sink_caps(adev);
+            pthread_mutex_unlock(&adev->lock);
+        }
+    }
+
+    str_parms_destroy(parms);
     return 0;
 }
 
@@ -26,11 +26,13 @@ LOCAL_COPY_HEADERS_TO := hwc
 LOCAL_COPY_HEADERS := \
     IntelBufferManager.h \
     IntelDisplayPlaneManager.h \
+    IntelDrmOutputCache.h \
     IntelHWCUEventObserver.h \
     IntelHWComposer.h \
     IntelHWComposerDrm.h \
     IntelHWComposerDump.h \
     IntelHWComposerLayer.h \
+    IntelBufferInfoCache.h \
     IntelOverlayContext.h \
     IntelOverlayHW.h \
     IntelOverlayPlane.h \
@@ -40,7 +42,8 @@ LOCAL_COPY_HEADERS := \
     IntelUtility.h \
     RotationBufferProvider.h
 ifeq ($(TARGET_HAS_MULTIPLE_DISPLAY),true)
-LOCAL_COPY_HEADERS += IntelExternalDisplayMonitor.h
+LOCAL_COPY_HEADERS += IntelExternalDisplayMonitor.h \
+                      IntelVideoInfoCache.h
 endif
 include $(BUILD_COPY_HEADERS)
 endif
@@ -60,14 +63,29 @@ LOCAL_SRC_FILES := IntelHWComposerModule.cpp \
                    IntelBufferManager.cpp \
                    IntelDisplayPlaneManager.cpp \
                    IntelHWComposerDrm.cpp \
+                   IntelDrmOutputCache.cpp \
                    IntelOverlayPlane.cpp \
                    IntelSpritePlane.cpp \
                    MedfieldSpritePlane.cpp \
+                   IntelCursorPlane.cpp \
                    IntelWsbm.cpp \
                    IntelWsbmWrapper.c \
                    IntelHWCUEventObserver.cpp \
                    IntelVsyncEventHandler.cpp \
                    IntelFakeVsyncEvent.cpp \
+                   IntelHotplugHandler.cpp \
+                   IntelFrameCadence.cpp \
+                   IntelFlipDeferral.cpp \
+                   IntelOverlayBackBufferSync.cpp \
+                   IntelOwnershipLock.cpp \
+                   IntelConfigSnapshot.cpp \
+                   IntelFormatTraits.cpp \
+                   IntelBufferInfoCache.cpp \
+                   IntelLayerGeometry.cpp \
+                   IntelBandwidthModel.cpp \
+                   IntelZOrderSolver.cpp \
+                   IntelCursorTracker.cpp \
+                   IntelCursorRegState.cpp \
                    IntelUtility.cpp \
                    RotationBufferProvider.cpp
 LOCAL_MODULE_TAGS := eng
@@ -98,13 +116,15 @@ LOCAL_C_INCLUDES := $(addprefix $(LOCAL_PATH)/../../, $(SGX_INCLUDES)) \
 ifeq ($(TARGET_HAS_MULTIPLE_DISPLAY),true)
     LOCAL_CFLAGS += -DTARGET_HAS_MULTIPLE_DISPLAY
     LOCAL_SHARED_LIBRARIES += libmultidisplay
-    LOCAL_SRC_FILES += IntelExternalDisplayMonitor.cpp
+    LOCAL_SRC_FILES += IntelExternalDisplayMonitor.cpp \
+                       IntelVideoInfoCache.cpp
 endif
 
 ifeq ($(INTEL_WIDI), true)
     LOCAL_SHARED_LIBRARIES += libhwcwidi
     LOCAL_CFLAGS += -DINTEL_WIDI
-    LOCAL_SRC_FILES += WidiDisplayDevice.cpp
+    LOCAL_SRC_FILES += WidiDisplayDevice.cpp \
+                       IntelWidiStreamState.cpp
 endif
 
 ifeq ($(BOARD_OVERLAY_USE_SECONDARY_GAMMA),true)
@@ -113,4 +133,248 @@ endif
 
 include $(BUILD_SHARED_LIBRARY)
 
+# host tests of the parts that do not need the display hardware, run
+# against fakes of the libraries they call into
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES := IntelDrmOutputCache.cpp \
+                   tests/fake_drm.c \
+                   tests/drm_output_cache_test.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH) \
+                    external/drm \
+                    external/drm/include/drm
+LOCAL_STATIC_LIBRARIES := libutils libcutils liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE := hwc_drm_output_cache_test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES := IntelHotplugHandler.cpp \
+                   IntelDrmOutputCache.cpp \
+                   tests/fake_drm.c \
+                   tests/hotplug_handler_test.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH) \
+                    external/drm \
+                    external/drm/include/drm
+LOCAL_STATIC_LIBRARIES := libutils libcutils liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE := hwc_hotplug_handler_test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES := IntelVideoInfoCache.cpp \
+                   tests/video_info_cache_test.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH)
+LOCAL_STATIC_LIBRARIES := libutils libcutils liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE := hwc_video_info_cache_test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES := tests/csc_buffer_pool_test.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH)
+LOCAL_STATIC_LIBRARIES := libutils libcutils liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE := hwc_csc_buffer_pool_test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES := tests/lru_cache_test.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH)
+LOCAL_STATIC_LIBRARIES := libutils libcutils liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE := hwc_lru_cache_test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES := IntelWidiStreamState.cpp \
+                   tests/widi_stream_state_test.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH) \
+                    $(call include-path-for, libhardware)
+LOCAL_STATIC_LIBRARIES := libutils libcutils liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE := hwc_widi_stream_state_test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES := IntelFrameCadence.cpp \
+                   tests/frame_cadence_test.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH)
+LOCAL_STATIC_LIBRARIES := libutils libcutils liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE := hwc_frame_cadence_test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES := IntelWsbm.cpp \
+                   IntelFlipDeferral.cpp \
+                   tests/fake_wsbm.c \
+                   tests/overlay_flip_deferral_test.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH)
+LOCAL_STATIC_LIBRARIES := libutils libcutils liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE := hwc_overlay_flip_deferral_test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES := IntelFormatTraits.cpp \
+                   tests/format_traits_test.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH) \
+                    $(call include-path-for, libhardware) \
+                    $(call include-path-for, frameworks-native)/media/openmax \
+                    $(TARGET_OUT_HEADERS)/pvr/hal
+LOCAL_STATIC_LIBRARIES := libutils libcutils liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE := hwc_format_traits_test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES := IntelBufferInfoCache.cpp \
+                   tests/buffer_info_cache_test.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH) \
+                    $(call include-path-for, libhardware) \
+                    $(call include-path-for, frameworks-native)/media/openmax \
+                    $(TARGET_OUT_HEADERS)/pvr/hal
+LOCAL_STATIC_LIBRARIES := libutils libcutils liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE := hwc_buffer_info_cache_test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES := IntelFormatTraits.cpp \
+                   tests/buffer_layout_test.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH) \
+                    $(call include-path-for, libhardware) \
+                    $(call include-path-for, frameworks-native)/media/openmax \
+                    $(TARGET_OUT_HEADERS)/pvr/hal
+LOCAL_STATIC_LIBRARIES := libutils libcutils liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE := hwc_buffer_layout_test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES := IntelOverlayBackBufferSync.cpp \
+                   tests/overlay_back_buffer_sync_test.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH)
+LOCAL_STATIC_LIBRARIES := libutils libcutils liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE := hwc_overlay_back_buffer_sync_test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES := IntelOwnershipLock.cpp \
+                   tests/ownership_lock_test.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH)
+LOCAL_STATIC_LIBRARIES := libutils libcutils liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE := hwc_ownership_lock_test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES := IntelLayerGeometry.cpp \
+                   IntelFormatTraits.cpp \
+                   tests/layer_geometry_test.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH) \
+                    $(call include-path-for, libhardware) \
+                    $(call include-path-for, frameworks-native)/media/openmax \
+                    $(TARGET_OUT_HEADERS)/pvr/hal
+LOCAL_STATIC_LIBRARIES := libutils libcutils liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE := hwc_layer_geometry_test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES := IntelZOrderSolver.cpp \
+                   IntelBandwidthModel.cpp \
+                   IntelLayerGeometry.cpp \
+                   IntelFormatTraits.cpp \
+                   tests/zorder_solver_test.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH) \
+                    $(call include-path-for, libhardware) \
+                    $(call include-path-for, frameworks-native)/media/openmax \
+                    $(TARGET_OUT_HEADERS)/pvr/hal
+LOCAL_STATIC_LIBRARIES := libutils libcutils liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE := hwc_zorder_solver_test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES := IntelBandwidthModel.cpp \
+                   IntelLayerGeometry.cpp \
+                   IntelFormatTraits.cpp \
+                   tests/bandwidth_model_test.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH) \
+                    $(call include-path-for, libhardware) \
+                    $(call include-path-for, frameworks-native)/media/openmax \
+                    $(TARGET_OUT_HEADERS)/pvr/hal
+LOCAL_STATIC_LIBRARIES := libutils libcutils liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE := hwc_bandwidth_model_test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES := IntelCursorTracker.cpp \
+                   IntelCursorRegState.cpp \
+                   tests/cursor_replay_test.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH) \
+                    $(call include-path-for, libhardware)
+LOCAL_STATIC_LIBRARIES := libutils libcutils liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE := hwc_cursor_replay_test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES := IntelConfigSnapshot.cpp \
+                   tests/config_snapshot_test.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH)
+LOCAL_STATIC_LIBRARIES := libutils libcutils liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE := hwc_config_snapshot_test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES := merrifield/Log.cpp \
+                   merrifield/HwcConfig.cpp \
+                   tests/log_level_test.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/merrifield
+LOCAL_CFLAGS := -DLOG_TAG=\"hwcomposer\"
+LOCAL_STATIC_LIBRARIES := libutils libcutils liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE := hwc_log_level_test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES := IntelZOrderSolver.cpp \
+                   IntelBandwidthModel.cpp \
+                   IntelLayerGeometry.cpp \
+                   IntelFormatTraits.cpp \
+                   tests/bandwidth_eval.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH) \
+                    $(call include-path-for, libhardware) \
+                    $(call include-path-for, frameworks-native)/media/openmax \
+                    $(TARGET_OUT_HEADERS)/pvr/hal
+LOCAL_STATIC_LIBRARIES := libutils libcutils liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE := hwc_bandwidth_eval
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
 endif
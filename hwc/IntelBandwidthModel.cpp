@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cutils/log.h>
+
+#include <IntelHWComposerCfg.h>
+#include <IntelFormatTraits.h>
+#include <IntelBandwidthModel.h>
+
+IntelBandwidthModel::IntelBandwidthModel()
+{
+    clear();
+}
+
+void IntelBandwidthModel::clear()
+{
+    mNumLayers = 0;
+    mValid = false;
+    mVisible = 0;
+    mScanoutBytes = 0;
+}
+
+uint64_t IntelBandwidthModel::area(const hwc_rect_t& r)
+{
+    if (r.right <= r.left || r.bottom <= r.top)
+        return 0;
+    return (uint64_t)(r.right - r.left) * (r.bottom - r.top);
+}
+
+void IntelBandwidthModel::update(hwc_display_contents_1_t *list,
+                                 int numLayers,
+                                 const IntelLayerGeometry& geometry)
+{
+    clear();
+
+    if (!list || numLayers <= 0 || numLayers > IntelLayerGeometry::MAX_LAYERS)
+        return;
+
+    for (int i = 0; i < numLayers; i++) {
+        hwc_layer_1_t *layer = &list->hwLayers[i];
+        IMG_native_handle_t *handle = (IMG_native_handle_t*)layer->handle;
+        const IntelFormatTraits *traits =
+            handle ? IntelFormatTraits::get(handle->iFormat) : 0;
+        uint64_t src = area(layer->sourceCrop);
+        uint64_t dst = area(layer->displayFrame);
+        // chroma of multi-planar formats is 4:2:0
+        uint64_t bits = traits ?
+            (traits->planes > 1 ? traits->bpp * 3 / 2 : traits->bpp) :
+            DEFAULT_BYTES_PER_PIXEL * 8;
+
+        mPlaneBytes[i] = 0;
+        mGlesBytes[i] = 0;
+        if (geometry.isOccluded(i) || !dst)
+            continue;
+
+        if (!src)
+            src = dst;
+
+        mPlaneBytes[i] = src * bits / 8;
+        mGlesBytes[i] = (src > dst ? src : dst) * bits / 8 +
+                        dst * FB_BYTES_PER_PIXEL;
+        if (layer->blending != HWC_BLENDING_NONE)
+            mGlesBytes[i] += dst * FB_BYTES_PER_PIXEL;
+        mVisible |= IntelLayerGeometry::bit(i);
+    }
+
+    if ((size_t)numLayers < list->numHwLayers &&
+        list->hwLayers[numLayers].compositionType == HWC_FRAMEBUFFER_TARGET)
+        mScanoutBytes = area(list->hwLayers[numLayers].displayFrame) *
+                        FB_BYTES_PER_PIXEL;
+
+    mNumLayers = numLayers;
+    mValid = true;
+}
+
+uint64_t IntelBandwidthModel::getFrameBytes(uint64_t overlays) const
+{
+    uint64_t bytes = 0;
+    bool composed = false;
+
+    for (int i = 0; i < mNumLayers; i++) {
+        if (!(mVisible & IntelLayerGeometry::bit(i)))
+            continue;
+        if (overlays & IntelLayerGeometry::bit(i)) {
+            bytes += mPlaneBytes[i];
+        } else {
+            bytes += mGlesBytes[i];
+            composed = true;
+        }
+    }
+
+    if (composed)
+        bytes += mScanoutBytes;
+    return bytes;
+}
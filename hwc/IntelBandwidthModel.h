@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __INTEL_BANDWIDTH_MODEL_H__
+#define __INTEL_BANDWIDTH_MODEL_H__
+
+#include <stdint.h>
+#include <hardware/hwcomposer.h>
+#include <IntelLayerGeometry.h>
+
+/*
+ * Memory traffic of one frame, in bytes, for each way a layer can be
+ * shown.
+ *
+ * A plane fetches the source crop of its buffer once. GLES reads the
+ * source too, but samples per destination pixel, so an upscaled layer
+ * costs its destination size in texels. It then writes the destination
+ * into the framebuffer target and also reads it back when blending.
+ * The primary plane scans out the whole framebuffer target whenever
+ * anything was composed into it.
+ *
+ * Hidden layers cost nothing either way. The numbers estimate DRAM
+ * traffic before caches and compression.
+ */
+class IntelBandwidthModel {
+public:
+    enum {
+        // bytes per framebuffer target pixel
+        FB_BYTES_PER_PIXEL = 4,
+        // assumed for formats without traits
+        DEFAULT_BYTES_PER_PIXEL = 4,
+    };
+
+private:
+    int mNumLayers;
+    bool mValid;
+    uint64_t mPlaneBytes[IntelLayerGeometry::MAX_LAYERS];
+    uint64_t mGlesBytes[IntelLayerGeometry::MAX_LAYERS];
+    uint64_t mVisible;
+    uint64_t mScanoutBytes;
+
+    static uint64_t area(const hwc_rect_t& r);
+public:
+    IntelBandwidthModel();
+
+    void update(hwc_display_contents_1_t *list, int numLayers,
+                const IntelLayerGeometry& geometry);
+    void clear();
+
+    bool isValid() const { return mValid; }
+    uint64_t getPlaneBytes(int index) const {
+        return isVisible(index) ? mPlaneBytes[index] : 0;
+    }
+    uint64_t getGlesBytes(int index) const {
+        return isVisible(index) ? mGlesBytes[index] : 0;
+    }
+    uint64_t getScanoutBytes() const { return mScanoutBytes; }
+    bool isVisible(int index) const {
+        return mValid && index >= 0 && index < mNumLayers &&
+               (mVisible & IntelLayerGeometry::bit(index));
+    }
+
+    // frame total with the layers in overlays on planes and the
+    // rest composed by GLES
+    uint64_t getFrameBytes(uint64_t overlays) const;
+};
+
+#endif /*__INTEL_BANDWIDTH_MODEL_H__*/
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <string.h>
+#include <cutils/log.h>
+#include <hardware/gralloc.h>
+
+#include <IntelBufferInfoCache.h>
+
+IntelBufferInfoCache::IntelBufferInfoCache()
+    : mHits(0), mMisses(0)
+{
+    clear();
+}
+
+void IntelBufferInfoCache::clear()
+{
+    memset(mInfo, 0, sizeof(mInfo));
+}
+
+const IntelBufferInfoCache::Info&
+IntelBufferInfoCache::lookup(IMG_native_handle_t *grallocHandle)
+{
+    unsigned long long stamp = grallocHandle->ui64Stamp;
+    Info& info = mInfo[stamp % CACHE_SIZE];
+
+    if (stamp && info.ui64Stamp == stamp) {
+        mHits++;
+        return info;
+    }
+
+    info.traits = IntelFormatTraits::get(grallocHandle->iFormat);
+    if (!info.traits)
+        ALOGW("%s: unknown format 0x%x", __func__, grallocHandle->iFormat);
+    info.ui64Stamp = stamp;
+    info.format = grallocHandle->iFormat;
+    info.isProtected = (grallocHandle->usage & GRALLOC_USAGE_PROTECTED) != 0;
+    mMisses++;
+    return info;
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __INTEL_BUFFER_INFO_CACHE_H__
+#define __INTEL_BUFFER_INFO_CACHE_H__
+
+#include <stdint.h>
+#include <hal_public.h>
+#include <IntelFormatTraits.h>
+
+/*
+ * Format and usage of a gralloc buffer never change, so layers are
+ * classified once per buffer, keyed by its stamp. The cache is direct
+ * mapped on the stamp; a buffer without a stamp is looked up every time.
+ */
+class IntelBufferInfoCache {
+public:
+    enum {
+        CACHE_SIZE = 16,
+    };
+
+    struct Info {
+        unsigned long long ui64Stamp;
+        int format;
+        const IntelFormatTraits *traits;
+        bool isProtected;
+    };
+
+private:
+    Info mInfo[CACHE_SIZE];
+    uint32_t mHits;
+    uint32_t mMisses;
+public:
+    IntelBufferInfoCache();
+    const Info& lookup(IMG_native_handle_t *grallocHandle);
+    void clear();
+    uint32_t getHits() const { return mHits; }
+    uint32_t getMisses() const { return mMisses; }
+};
+
+#endif /*__INTEL_BUFFER_INFO_CACHE_H__*/
@@ -58,7 +58,8 @@
 IntelDisplayDataBuffer::IntelDisplayDataBuffer(uint32_t format,
                                                uint32_t w,
                                                uint32_t h)
-        : mBobDeinterlace(0), mFormat(format), mWidth(w), mHeight(h), mBuffer(0)
+        : mBobDeinterlace(0), mFormat(format), mWidth(w), mHeight(h), mBuffer(0),
+          mLayout(0)
 {
     ALOGD_IF(ALLOW_BUFFER_PRINT, "%s: width %d, format 0x%x\n", __func__, w, format);
 
@@ -1342,12 +1343,7 @@ IntelDisplayBuffer* IntelGraphicBufferManager::wrap(void *addr, int size)
         return 0;
     }
 
-    ret = mWsbm->waitIdleTTMBuffer(wsbmBufferObject);
-    if (ret == false) {
-        ALOGE("%s: wait ttm buffer idle failed\n", __func__);
-        return 0;
-    }
-
+    // no wait here, users check isIdle() before scanning the buffer out
     void *virtAddr = mWsbm->getCPUAddress(wsbmBufferObject);
     uint32_t gttOffsetInPage = mWsbm->getGttOffset(wsbmBufferObject);
 
@@ -1405,6 +1401,24 @@ void IntelGraphicBufferManager::waitIdle(uint32_t khandle)
     return;
 }
 
+bool IntelGraphicBufferManager::isIdle(IntelDisplayBuffer *buffer)
+{
+    if (!mWsbm || !buffer || !buffer->getBufferObject())
+        return true;
+
+    return mWsbm->isIdleTTMBuffer(buffer->getBufferObject());
+}
+
+void IntelGraphicBufferManager::waitIdle(IntelDisplayBuffer *buffer)
+{
+    if (!mWsbm || !buffer || !buffer->getBufferObject())
+        return;
+
+    bool ret = mWsbm->waitIdleTTMBuffer(buffer->getBufferObject());
+    if (ret == false)
+        ALOGE("%s: wait ttm buffer idle failed\n", __func__);
+}
+
 bool IntelGraphicBufferManager::alloc(uint32_t size,
                           uint32_t* um_handle, uint32_t* km_handle)
 {
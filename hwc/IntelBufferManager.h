@@ -54,6 +54,7 @@
 #include <pvr2d.h>
 #include <pthread.h>
 #include <services.h>
+#include <IntelFormatTraits.h>
 
 class IntelDisplayBuffer
 {
@@ -85,17 +86,6 @@ public:
      uint32_t getStride() const { return mStride; }
 };
 
-// pixel format supported by HWC
-// TODO: share the extended pixel format with gralloc HAL
-enum {
-    HAL_PIXEL_FORMAT_INTEL_HWC_NV12_VED = OMX_INTEL_COLOR_FormatYUV420PackedSemiPlanar,
-    HAL_PIXEL_FORMAT_INTEL_HWC_NV12 = HAL_PIXEL_FORMAT_NV12,
-    HAL_PIXEL_FORMAT_INTEL_HWC_YUY2 = HAL_PIXEL_FORMAT_YUY2,
-    HAL_PIXEL_FORMAT_INTEL_HWC_UYVY = HAL_PIXEL_FORMAT_UYVY,
-    HAL_PIXEL_FORMAT_INTEL_HWC_I420 = HAL_PIXEL_FORMAT_I420,
-    HAL_PIXEL_FORMAT_INTEL_HWC_NV12_TILE = OMX_INTEL_COLOR_FormatYUV420PackedSemiPlanar_Tiled,
-};
-
 class IntelDisplayDataBuffer : public IntelDisplayBuffer
 {
 public:
@@ -117,6 +107,7 @@ private:
     uint32_t mSrcHeight;
     uint32_t mUpdateFlags;
     IntelDisplayBuffer *mBuffer;
+    const IntelBufferLayout *mLayout;
 public:
     IntelDisplayDataBuffer();
     IntelDisplayDataBuffer(uint32_t format, uint32_t w, uint32_t h);
@@ -124,6 +115,8 @@ public:
     void setFormat(int format) { mFormat = format; }
     void setBuffer(IntelDisplayBuffer *buffer);
     IntelDisplayBuffer* getBuffer() { return mBuffer; }
+    void setLayout(const IntelBufferLayout *layout) { mLayout = layout; }
+    const IntelBufferLayout* getLayout() const { return mLayout; }
     void setWidth(uint32_t w);
     void setHeight(uint32_t h);
     void setStride(uint32_t stride);
@@ -174,6 +167,9 @@ public:
     }
     virtual void unwrap(IntelDisplayBuffer *buffer) {}
     virtual void waitIdle(uint32_t khandle){}
+    // non-blocking, false while the GPU or decoder still writes the buffer
+    virtual bool isIdle(IntelDisplayBuffer *buffer) { return true; }
+    virtual void waitIdle(IntelDisplayBuffer *buffer) {}
     virtual bool alloc(uint32_t size, uint32_t* um_handle, uint32_t* km_handle) {
         return false;
     }
@@ -325,6 +321,8 @@ public:
     IntelDisplayBuffer* wrap(void *virt, int size);
     void unwrap(IntelDisplayBuffer *buffer);
     void waitIdle(uint32_t khandle);
+    bool isIdle(IntelDisplayBuffer *buffer);
+    void waitIdle(IntelDisplayBuffer *buffer);
     bool alloc(uint32_t size, uint32_t* um_handle, uint32_t* km_handle);
     bool dealloc(uint32_t um_handle);
 };
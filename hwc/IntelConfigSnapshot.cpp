@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <cutils/log.h>
+#include <cutils/properties.h>
+#include <IntelConfigSnapshot.h>
+
+static unsigned int hwc_get_prop_uint(const char *key, const char *def)
+{
+    char value[PROPERTY_VALUE_MAX];
+
+    property_get(key, value, def);
+    return atoi(value);
+}
+
+void hwc_load_prop_cfg(hwc_prop_cfg *cfg)
+{
+    cfg->dump_post2 = hwc_get_prop_uint(HWC_PROP_DUMP_POST2, "0");
+    cfg->dump_layers = hwc_get_prop_uint(HWC_PROP_DUMP_LAYERS, "0");
+    cfg->panel_width_mm = hwc_get_prop_uint(HWC_PROP_PANEL_WIDTH_MM, "47");
+    cfg->panel_height_mm = hwc_get_prop_uint(HWC_PROP_PANEL_HEIGHT_MM, "82");
+}
+
+IntelConfigSnapshot::IntelConfigSnapshot(loader_t loader)
+    : mLoader(loader), mCurrent(0), mRetired(0), mQuiescent(0),
+      mFrame(0), mPublished(0), mDeferred(0)
+{
+}
+
+IntelConfigSnapshot::~IntelConfigSnapshot()
+{
+    delete mCurrent;
+    delete mRetired;
+}
+
+void IntelConfigSnapshot::init()
+{
+    snapshot *first = new snapshot;
+
+    memset(first, 0, sizeof(snapshot));
+    mLoader(&first->cfg);
+    mFrame = first;
+    __atomic_store_n(&mCurrent, first, __ATOMIC_RELEASE);
+}
+
+const hwc_prop_cfg* IntelConfigSnapshot::beginFrame()
+{
+    // the previous frame is done, so is its snapshot if it differs
+    mFrame = __atomic_load_n(&mCurrent, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&mQuiescent, mFrame->generation, __ATOMIC_RELEASE);
+    return &mFrame->cfg;
+}
+
+bool IntelConfigSnapshot::reload()
+{
+    android::Mutex::Autolock _l(mLock);
+    snapshot *current = mCurrent;
+
+    if (mRetired) {
+        // the frame thread may still work on it until it takes a newer one
+        uint32_t quiescent = __atomic_load_n(&mQuiescent, __ATOMIC_ACQUIRE);
+        if (quiescent == mRetired->generation) {
+            mDeferred++;
+            return false;
+        }
+        delete mRetired;
+        mRetired = 0;
+    }
+
+    snapshot *next = new snapshot;
+    memset(next, 0, sizeof(snapshot));
+    mLoader(&next->cfg);
+    if (!memcmp(&next->cfg, &current->cfg, sizeof(hwc_prop_cfg))) {
+        delete next;
+        return false;
+    }
+
+    next->generation = current->generation + 1;
+    mRetired = current;
+    __atomic_store_n(&mCurrent, next, __ATOMIC_RELEASE);
+    mPublished++;
+
+    ALOGD("%s: published config %u\n", __func__, next->generation);
+    return true;
+}
+
+IntelConfigReloader::IntelConfigReloader(IntelConfigSnapshot *snapshot,
+                                         nsecs_t period) :
+    mExiting(false), mSnapshot(snapshot), mPeriod(period)
+{
+}
+
+IntelConfigReloader::~IntelConfigReloader()
+{
+
+}
+
+void IntelConfigReloader::requestExit()
+{
+    android::Mutex::Autolock _l(mLock);
+
+    mExiting = true;
+    android::Thread::requestExit();
+    mCondition.signal();
+}
+
+bool IntelConfigReloader::threadLoop()
+{
+    { // scope for lock
+        android::Mutex::Autolock _l(mLock);
+        if (!mExiting)
+            mCondition.waitRelative(mLock, mPeriod);
+        if (mExiting)
+            return false;
+    }
+
+    mSnapshot->reload();
+    return true;
+}
+
+android::status_t IntelConfigReloader::readyToRun()
+{
+    return android::NO_ERROR;
+}
+
+void IntelConfigReloader::onFirstRef()
+{
+    run("HWC Config Reloader", android::PRIORITY_BACKGROUND);
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __INTEL_CONFIG_SNAPSHOT_H__
+#define __INTEL_CONFIG_SNAPSHOT_H__
+
+#include <stdint.h>
+#include <utils/threads.h>
+#include <IntelHWComposerCfg.h>
+
+/*
+ * The property tunables as an immutable snapshot. A reload builds a
+ * new one and publishes it with a single release store; the frame
+ * thread takes it with a single acquire load at the start of each
+ * frame and keeps using it until the next one.
+ *
+ * The replaced snapshot is retired, and freed by a later reload once
+ * the frame thread has started a frame on a newer one. Until then no
+ * further snapshot is published, so at most two are ever alive.
+ */
+class IntelConfigSnapshot {
+public:
+    typedef void (*loader_t)(hwc_prop_cfg *cfg);
+
+    IntelConfigSnapshot(loader_t loader);
+    ~IntelConfigSnapshot();
+    // load the first snapshot, before any frame
+    void init();
+
+    // frame thread, at the start of prepare()
+    const hwc_prop_cfg* beginFrame();
+    // frame thread, the snapshot taken by the last beginFrame()
+    const hwc_prop_cfg* get() const { return &mFrame->cfg; }
+
+    // any thread but the frame thread. re-read the properties and
+    // publish them if they changed, true if a snapshot was published
+    bool reload();
+
+    uint32_t getPublishCount() const { return mPublished; }
+    uint32_t getDeferCount() const { return mDeferred; }
+private:
+    struct snapshot {
+        hwc_prop_cfg cfg;
+        uint32_t generation;
+    };
+
+    android::Mutex mLock;
+    loader_t mLoader;
+    snapshot *mCurrent;
+    snapshot *mRetired;
+    // generation of the snapshot the frame thread works on
+    uint32_t mQuiescent;
+    // frame thread only
+    const snapshot *mFrame;
+    uint32_t mPublished;
+    uint32_t mDeferred;
+};
+
+// re-reads the properties off the frame path, so that a changed
+// property applies within a period without a dumpsys
+class IntelConfigReloader : public android::Thread
+{
+public:
+    IntelConfigReloader(IntelConfigSnapshot *snapshot, nsecs_t period);
+    virtual ~IntelConfigReloader();
+    virtual void requestExit();
+private:
+    virtual bool threadLoop();
+    virtual android::status_t readyToRun();
+    virtual void onFirstRef();
+private:
+    mutable android::Mutex mLock;
+    android::Condition mCondition;
+    bool mExiting;
+    IntelConfigSnapshot *mSnapshot;
+    nsecs_t mPeriod;
+};
+
+extern IntelConfigSnapshot propCfg;
+
+#endif /*__INTEL_CONFIG_SNAPSHOT_H__*/
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __INTEL_CSC_BUFFER_POOL_H__
+#define __INTEL_CSC_BUFFER_POOL_H__
+
+#include <stdint.h>
+#include <utils/KeyedVector.h>
+#include <utils/Mutex.h>
+#include <utils/RefBase.h>
+#include <utils/Timers.h>
+#include <utils/Vector.h>
+#include <cutils/log.h>
+#include <IntelHWComposerCfg.h>
+
+/*
+ * Colorspace conversion buffers, one pool per size. A pool owns up to
+ * CAPACITY buffers, counting the ones handed out. Pools of other sizes
+ * than the one in use are dropped by trim() once idle for IDLE_MS.
+ *
+ * Every pool gets a new generation when it is created, and a buffer
+ * handed out carries the generation of its pool. A buffer coming back
+ * to a pool that was trimmed, or trimmed and created again, is freed
+ * instead of being added on top of the new pool's buffers.
+ *
+ * Buffers to free are handed back to the caller so that they are
+ * released outside the pool lock.
+ */
+template <class T>
+class IntelCscBufferPool {
+public:
+    enum {
+        CAPACITY = 4,
+        IDLE_MS = 2000,
+    };
+    typedef android::Vector< android::sp<T> > BufferList;
+private:
+    struct Pool {
+        BufferList available;
+        int outstanding;    // handed out or being allocated
+        uint32_t generation;
+        nsecs_t lastUsed;
+    };
+    android::Mutex mLock;
+    // keyed by width << 16 | height
+    android::KeyedVector<uint32_t, Pool> mPools;
+    uint32_t mCurrentKey;
+    uint32_t mNextGeneration;
+
+    Pool* getPool_l(uint32_t key, nsecs_t now) {
+        ssize_t index = mPools.indexOfKey(key);
+        if (index < 0) {
+            Pool pool;
+            pool.outstanding = 0;
+            pool.generation = ++mNextGeneration;
+            pool.lastUsed = now;
+            index = mPools.add(key, pool);
+        }
+        return &mPools.editValueAt(index);
+    }
+    void setCurrent_l(uint32_t key) {
+        if (key == mCurrentKey)
+            return;
+        ALOGI("CSC buffers changing from %dx%d to %dx%d%s",
+              mCurrentKey >> 16, mCurrentKey & 0xffff, key >> 16, key & 0xffff,
+              mPools.indexOfKey(key) >= 0 ? ", pool cached" : "");
+        mCurrentKey = key;
+    }
+public:
+    IntelCscBufferPool() : mCurrentKey(0), mNextGeneration(0) {}
+
+    static uint32_t key(uint32_t width, uint32_t height) {
+        return (width << 16) | (height & 0xffff);
+    }
+
+    // makes width x height the size in use and returns how many buffers
+    // its pool is missing, which the caller allocates and put()s
+    int reserve(uint32_t width, uint32_t height, nsecs_t now,
+                uint32_t *generation) {
+        android::Mutex::Autolock _l(mLock);
+        uint32_t k = key(width, height);
+        setCurrent_l(k);
+        Pool *pool = getPool_l(k, now);
+        int count = CAPACITY - pool->outstanding - (int)pool->available.size();
+        pool->outstanding += count;
+        pool->lastUsed = now;
+        *generation = pool->generation;
+        return count;
+    }
+
+    // a buffer of the size in use, NULL with *allocate set when the
+    // caller should allocate one and put() it back once done with it
+    android::sp<T> get(uint32_t width, uint32_t height, nsecs_t now,
+                       uint32_t *generation, bool *allocate) {
+        android::Mutex::Autolock _l(mLock);
+        uint32_t k = key(width, height);
+        android::sp<T> buffer;
+        setCurrent_l(k);
+        Pool *pool = getPool_l(k, now);
+        pool->lastUsed = now;
+        *generation = pool->generation;
+        *allocate = false;
+        if (!pool->available.isEmpty()) {
+            buffer = pool->available.top();
+            pool->available.pop();
+            pool->outstanding++;
+        } else if (pool->outstanding < CAPACITY) {
+            pool->outstanding++;
+            *allocate = true;
+        }
+        return buffer;
+    }
+
+    // returns a buffer from reserve() or get(), NULL for one that could
+    // not be allocated; false when the buffer has to be freed instead
+    bool put(uint32_t k, uint32_t generation, const android::sp<T>& buffer) {
+        android::Mutex::Autolock _l(mLock);
+        ssize_t index = mPools.indexOfKey(k);
+        if (index < 0 || mPools.valueAt(index).generation != generation)
+            return false;
+        Pool& pool = mPools.editValueAt(index);
+        if (pool.outstanding > 0)
+            pool.outstanding--;
+        if (buffer == NULL ||
+            pool.outstanding + (int)pool.available.size() >= CAPACITY)
+            return false;
+        pool.available.push(buffer);
+        return true;
+    }
+
+    // drops the pools of other sizes idle for IDLE_MS, their buffers
+    // are moved to freed
+    void trim(nsecs_t now, BufferList *freed) {
+        android::Mutex::Autolock _l(mLock);
+        for (size_t i = mPools.size(); i-- > 0; ) {
+            if (mPools.keyAt(i) == mCurrentKey ||
+                ns2ms(now - mPools.valueAt(i).lastUsed) <= IDLE_MS)
+                continue;
+            ALOGD_IF(ALLOW_WIDI_PRINT, "%s: trimming %dx%d CSC pool", __func__,
+                     mPools.keyAt(i) >> 16, mPools.keyAt(i) & 0xffff);
+            freed->appendVector(mPools.valueAt(i).available);
+            mPools.removeItemsAt(i);
+        }
+    }
+
+    size_t poolCount() {
+        android::Mutex::Autolock _l(mLock);
+        return mPools.size();
+    }
+
+    size_t available(uint32_t width, uint32_t height) {
+        android::Mutex::Autolock _l(mLock);
+        ssize_t index = mPools.indexOfKey(key(width, height));
+        return index < 0 ? 0 : mPools.valueAt(index).available.size();
+    }
+};
+
+#endif /*__INTEL_CSC_BUFFER_POOL_H__*/
@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <IntelDisplayPlaneManager.h>
+#include <IntelOverlayUtil.h>
+
+IntelCursorPlane::IntelCursorPlane(int fd, int index, IntelBufferManager *bm)
+    : IntelDisplayPlane(fd, IntelDisplayPlane::DISPLAY_PLANE_CURSOR, index, bm),
+      mImageBuffer(0), mImageStamp(0), mSlot(0), mSize(64),
+      mPendingBuffer(0), mPendingStamp(0), mPendingHandle(0),
+      mPendingWidth(0), mPendingHeight(0), mPendingFormat(0),
+      mUploads(0), mDeferredUploads(0), mMoves(0), mRegWrites(0)
+{
+    ALOGD_IF(ALLOW_PLANE_PRINT, "%s\n", __func__);
+
+    if (!mBufferManager) {
+        ALOGE("%s: invalid buffer manager\n", __func__);
+        return;
+    }
+
+    mImageBuffer = mBufferManager->get(CURSOR_SLOT_SIZE * CURSOR_SLOT_COUNT,
+                                       64 * 1024);
+    if (!mImageBuffer || !mImageBuffer->getCpuAddr()) {
+        ALOGE("%s: failed to allocate cursor buffer\n", __func__);
+        return;
+    }
+
+    memset(mImageBuffer->getCpuAddr(), 0,
+           CURSOR_SLOT_SIZE * CURSOR_SLOT_COUNT);
+    mInitialized = true;
+}
+
+IntelCursorPlane::~IntelCursorPlane()
+{
+    dropPending();
+    if (mImageBuffer) {
+        mBufferManager->put(mImageBuffer);
+        mImageBuffer = 0;
+    }
+    mInitialized = false;
+}
+
+// copy the image into the slot which isn't scanned out, the buffer
+// must be idle
+void IntelCursorPlane::upload(IntelDisplayBuffer *buffer, uint32_t handle,
+                              unsigned long long stamp,
+                              int width, int height, int format)
+{
+    // IMG alloc buffer has 32 pixel alignment on Width
+    uint32_t srcStride = align_to(width, 32) * 4;
+    int size = (width > 64 || height > 64) ? CURSOR_SIZE_MAX : 64;
+    int slot = mRegState.getFreeSlot(mImageBuffer->getGttOffsetInPage() << 12,
+                                     CURSOR_SLOT_SIZE, CURSOR_SLOT_COUNT);
+    uint8_t *src = (uint8_t*)buffer->getCpuAddr();
+    uint32_t *dst = (uint32_t*)((uint8_t*)mImageBuffer->getCpuAddr() +
+                                slot * CURSOR_SLOT_SIZE);
+
+    // cursor is ARGB8888 in memory order B, G, R, A, premultiplied
+    // like the layer
+    for (int y = 0; y < size; y++, dst += size) {
+        if (y >= height) {
+            memset(dst, 0, size * 4);
+            continue;
+        }
+
+        const uint32_t *row = (const uint32_t*)(src + y * srcStride);
+        if (format == HAL_PIXEL_FORMAT_BGRA_8888) {
+            memcpy(dst, row, width * 4);
+        } else {
+            for (int x = 0; x < width; x++) {
+                uint32_t p = row[x];
+                dst[x] = (p & 0xff00ff00) | ((p >> 16) & 0xff) |
+                         ((p & 0xff) << 16);
+            }
+        }
+        memset(dst + width, 0, (size - width) * 4);
+    }
+
+    mSlot = slot;
+    mSize = size;
+    mImageStamp = stamp;
+    mDataBufferHandle = handle;
+    mUploads++;
+
+    ALOGD_IF(ALLOW_PLANE_PRINT, "%s: uploaded %dx%d cursor to slot %d\n",
+             __func__, width, height, slot);
+}
+
+void IntelCursorPlane::dropPending()
+{
+    if (mPendingBuffer)
+        mBufferManager->unmap(mPendingBuffer);
+    mPendingBuffer = 0;
+    mPendingStamp = 0;
+}
+
+// a busy image is copied by flip(), prepare never waits for the GPU
+bool IntelCursorPlane::setDataBuffer(uint32_t handle, uint32_t flags,
+                                     IMG_native_handle_t* nHandle)
+{
+    if (!initCheck()) {
+        ALOGE("%s: cursor plane wasn't initialized\n", __func__);
+        return false;
+    }
+
+    if (!nHandle)
+        return false;
+
+    // same image, only the position can change
+    if (mPendingBuffer && nHandle->ui64Stamp == mPendingStamp) {
+        mPendingHandle = (uint32_t)nHandle;
+        return true;
+    }
+    if (!mPendingBuffer && mImageStamp && nHandle->ui64Stamp == mImageStamp) {
+        mDataBufferHandle = (uint32_t)nHandle;
+        return true;
+    }
+
+    int width = nHandle->iWidth;
+    int height = nHandle->iHeight;
+    int format = nHandle->iFormat;
+
+    if (!isCursorSize(width, height) ||
+        (format != HAL_PIXEL_FORMAT_RGBA_8888 &&
+         format != HAL_PIXEL_FORMAT_BGRA_8888))
+        return false;
+
+    IntelDisplayBuffer *buffer = mBufferManager->map(handle);
+    if (!buffer || !buffer->getCpuAddr()) {
+        ALOGE("%s: failed to map handle %d\n", __func__, handle);
+        if (buffer)
+            mBufferManager->unmap(buffer);
+        return false;
+    }
+
+    // a newer image replaces one still waiting for its flip
+    dropPending();
+
+    if (mBufferManager->isIdle(buffer)) {
+        upload(buffer, (uint32_t)nHandle, nHandle->ui64Stamp,
+               width, height, format);
+        mBufferManager->unmap(buffer);
+        return true;
+    }
+
+    mPendingBuffer = buffer;
+    mPendingStamp = nHandle->ui64Stamp;
+    mPendingHandle = (uint32_t)nHandle;
+    mPendingWidth = width;
+    mPendingHeight = height;
+    mPendingFormat = format;
+
+    ALOGD_IF(ALLOW_PLANE_PRINT, "%s: cursor buffer busy, upload in flip\n",
+             __func__);
+    return true;
+}
+
+IntelCursorRegState::Regs IntelCursorPlane::getRegs(bool enable) const
+{
+    IntelCursorRegState::Regs regs;
+
+    regs.enabled = enable;
+    regs.addr = (mImageBuffer->getGttOffsetInPage() << 12) +
+                mSlot * CURSOR_SLOT_SIZE;
+    regs.x = mPosition.left;
+    regs.y = mPosition.top;
+    regs.size = mSize;
+    return regs;
+}
+
+bool IntelCursorPlane::writeRegs(const IntelCursorRegState::Regs& regs)
+{
+    struct drm_psb_register_rw_arg arg;
+
+    memset(&arg, 0, sizeof(struct drm_psb_register_rw_arg));
+    arg.cursor_enable_mask = regs.enabled ? 1 : 0;
+    arg.cursor_disable_mask = regs.enabled ? 0 : 1;
+    arg.cursor.CursorADDR = regs.addr;
+    arg.cursor.xPos = regs.x;
+    arg.cursor.yPos = regs.y;
+    arg.cursor.CursorSize = (regs.size > 64) ? 1 : 0;
+
+    int ret = drmCommandWriteRead(mDrmFd, DRM_PSB_REGISTER_RW,
+                                  &arg, sizeof(arg));
+    if (ret) {
+        ALOGW("%s: failed to %s cursor, error %d\n", __func__,
+              regs.enabled ? "update" : "disable", ret);
+        return false;
+    }
+
+    mRegState.written(regs);
+    mRegWrites++;
+    return true;
+}
+
+// the registers are written only when something moved, a new image
+// address or size is latched together with the position
+bool IntelCursorPlane::flip(void *context, uint32_t flags)
+{
+    if (!initCheck())
+        return false;
+
+    // by set the GPU is usually done with the image
+    if (mPendingBuffer) {
+        mBufferManager->waitIdle(mPendingBuffer);
+        upload(mPendingBuffer, mPendingHandle, mPendingStamp,
+               mPendingWidth, mPendingHeight, mPendingFormat);
+        mDeferredUploads++;
+        dropPending();
+    }
+
+    if (!mImageStamp)
+        return false;
+
+    // the cursor position registers can't go negative
+    if (mPosition.left < 0 || mPosition.top < 0)
+        return false;
+
+    IntelCursorRegState::Regs regs = getRegs(true);
+    if (!mRegState.needsWrite(regs))
+        return true;
+
+    bool moved = mRegState.isMove(regs);
+    if (!writeRegs(regs))
+        return false;
+
+    if (moved)
+        mMoves++;
+    return true;
+}
+
+bool IntelCursorPlane::disable()
+{
+    if (!initCheck() || !mRegState.isEnabled())
+        return true;
+
+    return writeRegs(getRegs(false));
+}
+
+bool IntelCursorPlane::reset()
+{
+    disable();
+    dropPending();
+    mImageStamp = 0;
+    mDataBufferHandle = 0;
+    return true;
+}
+
+// the cursor is off after DPMS off and resume, whatever was written
+void IntelCursorPlane::onDpmsChange()
+{
+    mRegState.invalidate();
+}
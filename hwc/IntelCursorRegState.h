@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __INTEL_CURSOR_REG_STATE_H__
+#define __INTEL_CURSOR_REG_STATE_H__
+
+#include <stdint.h>
+
+/*
+ * Cursor registers last written to the hardware. The cursor plane only
+ * writes them when the image address, size or position changed, so a
+ * still pointer costs nothing and a move is one position write. New
+ * images go to the slot that isn't being scanned out.
+ *
+ * The registers don't survive DPMS off or suspend, after which the
+ * state is invalidated and the next flip writes all of them again.
+ */
+class IntelCursorRegState {
+public:
+    struct Regs {
+        bool enabled;
+        uint32_t addr;
+        int x;
+        int y;
+        int size;
+    };
+
+    IntelCursorRegState();
+    // the hardware no longer holds what was written
+    void invalidate();
+
+    // true if regs differ from what the hardware holds
+    bool needsWrite(const Regs& regs) const;
+    // true if only the position differs
+    bool isMove(const Regs& regs) const;
+    void written(const Regs& regs);
+
+    bool isEnabled() const { return mRegs.enabled; }
+    // slot a new image is copied to, out of count slots of slotSize
+    // bytes from base
+    int getFreeSlot(uint32_t base, uint32_t slotSize, int count) const;
+private:
+    Regs mRegs;
+};
+
+#endif /*__INTEL_CURSOR_REG_STATE_H__*/
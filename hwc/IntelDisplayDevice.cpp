@@ -51,6 +51,7 @@ IntelDisplayDevice::IntelDisplayDevice(IntelDisplayPlaneManager *pm,
    initializeRotationBufProvider();
    memset(mFBBuffers, 0, sizeof(mFBBuffers));
    mNextBuffer = 0;
+   mCursorLayer = -1;
 }
 
 IntelDisplayDevice::IntelDisplayDevice::~IntelDisplayDevice()
@@ -93,6 +94,29 @@ int IntelDisplayDevice::getMetaDataTransform(hwc_layer_1_t *layer,
     return 0;
 }
 
+int64_t IntelDisplayDevice::getVideoTimestamp(hwc_layer_1_t *layer)
+{
+    if (!layer || !mGrallocBufferManager)
+        return -1;
+
+    IMG_native_handle_t *grallocHandle =
+        (IMG_native_handle_t*)layer->handle;
+    if (!grallocHandle ||
+        (grallocHandle->iFormat != HAL_PIXEL_FORMAT_INTEL_HWC_NV12_VED &&
+         grallocHandle->iFormat != HAL_PIXEL_FORMAT_INTEL_HWC_NV12_TILE))
+        return -1;
+
+    // get payload buffer
+    IntelPayloadBuffer buffer(mGrallocBufferManager, grallocHandle->fd[1]);
+
+    intel_gralloc_payload_t *payload =
+            (intel_gralloc_payload_t*)buffer.getCpuAddr();
+    if (!payload)
+        return -1;
+
+    return payload->timestamp;
+}
+
 bool IntelDisplayDevice::isVideoPutInWindow(int output, hwc_layer_1_t *layer) {
     bool inWindow = false;
 
@@ -583,7 +607,26 @@ bool IntelDisplayDevice::isHWCLayer(hwc_layer_1_t *layer)
 bool IntelDisplayDevice::isLayerSandwiched(int index,
                                            hwc_display_contents_1_t *list)
 {
-    return false;
+    if (!mLayerList || !list)
+        return false;
+
+    return mLayerList->getGeometry().isSandwiched(index);
+}
+
+// A layer hidden by the opaque layers above it needs neither a plane
+// nor GLES composition
+bool IntelDisplayDevice::isOccludedLayer(hwc_display_contents_1_t *list,
+                                         int index,
+                                         hwc_layer_1_t *layer)
+{
+    if (!mLayerList || !list || !layer)
+        return false;
+
+    // surfaceflinger composes skip layers regardless
+    if (layer->flags & HWC_SKIP_LAYER)
+        return false;
+
+    return mLayerList->getGeometry().isOccluded(index);
 }
 
 // Check whehter two layers are intersect
@@ -663,6 +706,10 @@ bool IntelDisplayDevice::blank(int blank)
     if (mDrm)
         ret = mDrm->setDisplayDpms(mDisplayIndex, blank);
 
+    // registers are lost across DPMS off and suspend
+    if (mPlaneManager)
+        mPlaneManager->onDpmsChange();
+
     return ret;
 }
 
@@ -924,6 +971,14 @@ void IntelDisplayDevice::revisitLayerList(hwc_display_contents_1_t *list,
         if (!isHWCLayer(&list->hwLayers[i]))
             continue;
 
+        // hidden layers don't get the primary plane
+        if (isOccludedLayer(list, i, &list->hwLayers[i]))
+            continue;
+
+        // neither does the layer on the cursor plane
+        if ((int)i == mCursorLayer)
+            continue;
+
         // make sure all protected layers were marked as overlay
         if (mLayerList->isProtectedLayer(i))
             list->hwLayers[i].compositionType = HWC_OVERLAY;
@@ -1002,7 +1057,14 @@ void IntelDisplayDevice::updateZorderConfig()
 {
     int zOrderConfig = IntelDisplayPlaneManager::ZORDER_POaOc;
 
-    if (mLayerList->getAttachedOverlayCount()) {
+    if (mLayerList->getAttachedOverlayCount() && mZOrderSolver.isValid()) {
+        // overlays go on the side of the framebuffer the solver
+        // checked against the GLES layers
+        if (mZOrderSolver.isFbOnTop())
+            zOrderConfig = IntelDisplayPlaneManager::ZORDER_POcOa;
+        else
+            zOrderConfig = IntelDisplayPlaneManager::ZORDER_OcOaP;
+    } else if (mLayerList->getAttachedOverlayCount()) {
         IntelDisplayPlane* plane = mLayerList->getPlane(0);
         // If there is a blending to overlay, the overlay should be
         // the first layer always; other wise, we should put overlay
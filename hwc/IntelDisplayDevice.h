@@ -34,6 +34,9 @@
 #include <IntelBufferManager.h>
 #include <IntelHWComposerLayer.h>
 #include <IntelHWComposerDump.h>
+#include <IntelFrameCadence.h>
+#include <IntelZOrderSolver.h>
+#include <IntelCursorTracker.h>
 #include "RotationBufferProvider.h"
 
 class IntelDisplayConfig {
@@ -76,6 +79,8 @@ protected:
     IntelBufferManager *mBufferManager;
     IntelBufferManager *mGrallocBufferManager;
     IntelHWComposerLayerList *mLayerList;
+    // overlay layers and z-order picked on the last geometry change
+    IntelZOrderSolver mZOrderSolver;
     RotationBufferProvider *mRotationBufProvider;
     uint32_t mDisplayIndex;
     bool mForceSwapBuffer;
@@ -87,6 +92,8 @@ protected:
     bool mVideoSeekingActive;
         // detect fb layers state to bypass fb composition.
     int mYUVOverlay;
+    // layer shown by the cursor plane, -1 if none
+    int mCursorLayer;
 
     enum {
         NUM_FB_BUFFERS = 3,
@@ -105,6 +112,9 @@ protected:
     virtual bool isHWCLayer(hwc_layer_1_t *layer);
     virtual bool areLayersIntersecting(hwc_layer_1_t *top, hwc_layer_1_t* bottom);
     virtual bool isLayerSandwiched(int index, hwc_display_contents_1_t *list);
+    virtual bool isOccludedLayer(hwc_display_contents_1_t *list,
+                        int index,
+                        hwc_layer_1_t *layer);
 
     virtual bool isOverlayLayer(hwc_display_contents_1_t *list,
                         int index,
@@ -133,6 +143,8 @@ protected:
     virtual bool isVideoPutInWindow(int output, hwc_layer_1_t *layer);
     virtual int  getMetaDataTransform(hwc_layer_1_t *layer,
             uint32_t &transform);
+    // media timestamp of a decoder frame, -1 if unknown
+    int64_t getVideoTimestamp(hwc_layer_1_t *layer);
     virtual int checkTrickMode(hwc_display_contents_1_t *list,
             bool widiVideoActive);
     //*not virtual as not intend for override.Just for implemetation inheritence*/
@@ -186,10 +198,25 @@ protected:
 
     buffer_handle_t mPrevFlipHandles[10];
 
+    // layers left out of composition as fully hidden
+    uint32_t mCulledLayers;
+    uint32_t mCulledLayersTotal;
+
+    // frames where only the cursor changed reuse the framebuffer target,
+    // mCursorSkipLayers are the GLES layers turned to HWC_OVERLAY for it
+    IntelCursorTracker mCursorTracker;
+    uint32_t mCursorSkipLayers;
+    uint32_t mCursorSkippedCompositions;
+    bool isCursorLayer(hwc_display_contents_1_t *list,
+                       int index,
+                       hwc_layer_1_t *layer);
+    void handleCursor(hwc_display_contents_1_t *list);
+
 protected:
     bool isForceOverlay(hwc_layer_1_t *layer);
     void updateZorderConfig();
     bool shouldHide(hwc_layer_1_t *layer);
+    void solveZOrder(hwc_display_contents_1_t *list);
 
 protected:
     virtual bool isOverlayLayer(hwc_display_contents_1_t *list,
@@ -262,5 +289,7 @@ public:
             const uint32_t* attributes, int32_t* values);
 private:
     bool mGraphicPlaneVisible;
+    // video frames on the overlay, repeated frames are not flipped again
+    IntelFrameCadence mVideoCadence;
 };
 #endif /*__INTEL__DISPLAY_DEVICE__*/
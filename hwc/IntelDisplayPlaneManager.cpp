@@ -51,7 +51,7 @@ IntelDisplayPlaneManager::IntelDisplayPlaneManager(int fd,
       mTotalPlaneCount(0), mMaxPlaneCount(0),
       mFreeSpritePlanes(0), mFreePrimaryPlanes(0), mFreeOverlayPlanes(0),
       mReclaimedSpritePlanes(0), mReclaimedPrimaryPlanes(0),
-      mReclaimedOverlayPlanes(0),
+      mReclaimedOverlayPlanes(0), mCursorPlane(0),
       mDrmFd(fd), mBufferManager(bm), mGrallocBufferManager(gm),
       mInitialized(false)
 {
@@ -163,6 +163,16 @@ IntelDisplayPlaneManager::IntelDisplayPlaneManager(int fd,
         goto rgb_alloc_err;
     }
 
+    // cursor of pipe A, layers fall back to GLES without it
+    if (mPrimaryPlaneCount) {
+        mCursorPlane = new IntelCursorPlane(mDrmFd, 0, mGrallocBufferManager);
+        if (mCursorPlane && !mCursorPlane->initCheck()) {
+            ALOGW("%s: no cursor plane\n", __func__);
+            delete mCursorPlane;
+            mCursorPlane = 0;
+        }
+    }
+
     mInitialized = true;
     return;
 
@@ -220,6 +230,13 @@ IntelDisplayPlaneManager::~IntelDisplayPlaneManager()
     if (!initCheck())
         return;
 
+    // delete cursor plane
+    if (mCursorPlane) {
+        mCursorPlane->reset();
+        delete mCursorPlane;
+        mCursorPlane = 0;
+    }
+
     // delete sprite planes
     if (mSpritePlanes) {
         for (int i = 0; i < mSpritePlaneCount; i++) {
@@ -580,6 +597,22 @@ void IntelDisplayPlaneManager::resetPlaneContexts()
     memset(mPlaneContexts, 0, mContextLength);
 }
 
+void IntelDisplayPlaneManager::onDpmsChange()
+{
+    if (!initCheck())
+        return;
+
+    for (int i = 0; i < mOverlayPlaneCount; i++) {
+        if (mOverlayPlanes && mOverlayPlanes[i])
+            mOverlayPlanes[i]->onDpmsChange();
+        if (mRGBOverlayPlanes && mRGBOverlayPlanes[i])
+            mRGBOverlayPlanes[i]->onDpmsChange();
+    }
+
+    if (mCursorPlane)
+        mCursorPlane->onDpmsChange();
+}
+
 void* IntelDisplayPlaneManager::getPlaneContexts() const
 {
     return mPlaneContexts;
@@ -660,6 +693,30 @@ bool IntelDisplayPlaneManager::dump(char *buff,
     dumpPrintf("     free primary plane : 0x%x\n", mFreePrimaryPlanes);
     dumpPrintf("     free overlay count : 0x%x\n", mFreeOverlayPlanes);
     dumpPrintf("     plane zOrder: %d\n", mZOrderConfigs[0]);
+    for (int i = 0; i < mOverlayPlaneCount; i++) {
+        IntelDisplayPlane *plane = mOverlayPlanes[i];
+        if (!plane || !plane->getContext())
+            continue;
+        IntelOverlayContext *ctx =
+            reinterpret_cast<IntelOverlayContext*>(plane->getContext());
+        dumpPrintf("     overlay %d: syncs %d, dirty %d, regs written %d "
+                   "(last %d), coef loads %d\n", i,
+                   ctx->getSyncCount(), ctx->getDirtySyncCount(),
+                   ctx->getDirtyRegCount(), ctx->getLastDirtyRegCount(),
+                   ctx->getCoeffLoadCount());
+        dumpPrintf("     overlay %d: context locks %d, contended %d "
+                   "(max wait %lld us), takeovers %d\n", i,
+                   ctx->getLockAcquireCount(), ctx->getLockContendedCount(),
+                   (long long)(ctx->getLockMaxWait() / 1000),
+                   ctx->getLockTakeoverCount());
+    }
+    if (mCursorPlane)
+        dumpPrintf("     cursor: uploads %u (%u in flip), moves %u, "
+                   "regs written %u\n",
+                   mCursorPlane->getUploadCount(),
+                   mCursorPlane->getDeferredUploadCount(),
+                   mCursorPlane->getMoveCount(),
+                   mCursorPlane->getRegWriteCount());
     dumpPrintf("-------------End of Plane Infos-----------\n");
 
     *cur_len = mDumpLen;
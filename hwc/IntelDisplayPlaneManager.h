@@ -48,6 +48,7 @@
 #include <cutils/log.h>
 #include <cutils/atomic.h>
 #include <utils/KeyedVector.h>
+#include <utils/Timers.h>
 #include <hardware/hardware.h>
 #include <hardware/gralloc.h>
 #include <hal_public.h>
@@ -56,6 +57,11 @@
 #include <IntelBufferManager.h>
 #include <IntelOverlayHW.h>
 #include <IntelHWComposerCfg.h>
+#include <IntelFormatTraits.h>
+#include <IntelFlipDeferral.h>
+#include <IntelOverlayBackBufferSync.h>
+#include <IntelOwnershipLock.h>
+#include <IntelCursorRegState.h>
 
 #include <linux/psb_drm.h>
 
@@ -90,6 +96,7 @@ public:
             DISPLAY_PLANE_PRIMARY,
             DISPLAY_PLANE_OVERLAY,
             DISPLAY_PLANE_RGB_OVERLAY,
+            DISPLAY_PLANE_CURSOR,
     };
 
         // flush flags
@@ -162,6 +169,9 @@ public:
 
     // DRM mode change handler
     virtual uint32_t onDrmModeChange() { return 0; }
+    // the display was powered off or on, registers the plane doesn't
+    // rewrite when unchanged must be written again
+    virtual void onDpmsChange() {}
 
     friend class IntelDisplayPlaneManager;
 };
@@ -212,8 +222,10 @@ typedef struct {
     intel_overlay_state_t state;
 
     // ashmem related
-    pthread_mutex_t lock;
-    pthread_mutexattr_t attr;
+    // thread id of the writer updating the context, 0 if none
+    volatile int32_t owner;
+    // odd while an update is in progress
+    volatile int32_t generation;
     volatile int32_t refCount;
 } intel_overlay_context_t;
 
@@ -231,6 +243,12 @@ protected:
     int uvStride;
     bool mOnTop;
 
+    // register updates go to mOverlayBackBuffer, a copy in system memory,
+    // syncBackBuffer() writes what changed to the hardware back buffer
+    intel_overlay_back_buffer_t *mHwBackBuffer;
+    intel_overlay_back_buffer_t mShadowBackBuffer;
+    IntelOverlayBackBufferSync mSync;
+
     bool backBufferInit();
     bool bufferOffsetSetup(IntelDisplayDataBuffer& buf);
     uint32_t calculateSWidthSW(uint32_t offset, uint32_t width);
@@ -245,8 +263,18 @@ protected:
 
     intel_overlay_mode_t drmModeChanged(IntelOverlayContext& context);
 
-    void lock();
-    void unlock();
+    // the shared context is updated under an ownership word instead of a
+    // process-shared mutex, so a dead owner can be taken over. single
+    // fields are read without ownership, retried on a generation change
+    IntelOwnershipLock mOwnership;
+
+    void lock() { mOwnership.lock(); }
+    void unlock() { mOwnership.unlock(); }
+    // unlock, then wait for the flush to be latched if asked to, so that
+    // nobody spins on the ownership word for up to a frame
+    bool flushAndUnlock(uint32_t flags);
+    int32_t readBegin() { return mOwnership.readBegin(); }
+    bool readRetry(int32_t generation) { return mOwnership.readRetry(generation); }
 public:
     IntelOverlayContext(int drmFd, IntelBufferManager *bufferManager = NULL)
         :mHandle(0),
@@ -254,14 +282,16 @@ public:
          mOverlayBackBuffer(0),
          mBackBuffer(0),
          mSize(0), mDrmFd(drmFd),
-         mBufferManager(bufferManager) {}
+         mBufferManager(bufferManager),
+         mHwBackBuffer(0) {}
     IntelOverlayContext()
         :mHandle(0),
          mContext(0),
          mOverlayBackBuffer(0),
          mBackBuffer(0),
          mSize(0),
-         mOnTop(false) {}
+         mOnTop(false),
+         mHwBackBuffer(0) {}
 
     ~IntelOverlayContext();
 
@@ -286,6 +316,21 @@ public:
     void setRotation(int rotation);
     void setPosition(int x, int y, int w, int h);
 
+    // write pending register changes to the hardware back buffer, returns
+    // true if the coefficients must be reloaded with the next flip
+    bool syncBackBuffer();
+    // the overlay lost its state, the next sync rewrites all of it
+    void invalidateBackBuffer() { mSync.invalidate(); }
+    uint32_t getSyncCount() const { return mSync.getSyncCount(); }
+    uint32_t getDirtySyncCount() const { return mSync.getDirtySyncCount(); }
+    uint32_t getDirtyRegCount() const { return mSync.getDirtyRegCount(); }
+    uint32_t getLastDirtyRegCount() const { return mSync.getLastDirtyRegCount(); }
+    uint32_t getCoeffLoadCount() const { return mSync.getCoeffLoadCount(); }
+    uint32_t getLockAcquireCount() const { return mOwnership.getAcquireCount(); }
+    uint32_t getLockContendedCount() const { return mOwnership.getContendedCount(); }
+    nsecs_t getLockMaxWait() const { return mOwnership.getMaxWait(); }
+    uint32_t getLockTakeoverCount() const { return mOwnership.getTakeoverCount(); }
+
     // interfaces for both data & control devices
     bool flush(uint32_t flags);
     bool enable();
@@ -329,9 +374,14 @@ private:
         IntelDisplayBuffer *buffer;
         uint32_t bufferType;
         int grallocBuffFd;
+        bool idle;
+        IntelBufferLayout layout;
     } mDataBuffers[OVERLAY_DATA_BUFFER_NUM_MAX];
     int mNextBuffer;
 
+    // a newly mapped TTM buffer may still be written by the decoder
+    IntelFlipDeferral mFlipDeferral;
+
 public:
     IntelOverlayPlane(int fd, int index, IntelBufferManager *bufferManager);
     virtual ~IntelOverlayPlane();
@@ -348,6 +398,7 @@ public:
     virtual void setPipeByMode(intel_overlay_mode_t displayMode);
     virtual void forceBottom(bool bottom);
     virtual uint32_t onDrmModeChange();
+    virtual void onDpmsChange();
     virtual bool setOverlayOnTop(bool isOnTop);
 };
 
@@ -425,6 +476,7 @@ private:
         unsigned long long ui64Stamp;
         uint32_t handle;
         IntelDisplayBuffer *buffer;
+        IntelBufferLayout layout;
     } mDataBuffers[SPRITE_DATA_BUFFER_NUM_MAX];
     int mNextBuffer;
     int mPrevHitSlot;
@@ -443,6 +495,67 @@ public:
     virtual void forceBottom(bool bottom);
 };
 
+/*
+ * Hardware cursor of pipe A. The image is copied into a slot of its own
+ * buffer once per gralloc buffer stamp, so a pointer move only rewrites
+ * the position registers. It always sits on top of the other planes and
+ * is not part of the z-order configs.
+ */
+class IntelCursorPlane : public IntelDisplayPlane {
+public:
+    enum {
+        CURSOR_SIZE_MAX = 128,
+        // new images go to the slot which isn't scanned out
+        CURSOR_SLOT_COUNT = 2,
+        CURSOR_SLOT_SIZE = CURSOR_SIZE_MAX * CURSOR_SIZE_MAX * 4,
+    };
+private:
+    IntelDisplayBuffer *mImageBuffer;
+    unsigned long long mImageStamp;
+    int mSlot;
+    // 64 or 128 pixels square
+    int mSize;
+
+    // a new image still rendered to in prepare, copied in flip
+    IntelDisplayBuffer *mPendingBuffer;
+    unsigned long long mPendingStamp;
+    uint32_t mPendingHandle;
+    int mPendingWidth;
+    int mPendingHeight;
+    int mPendingFormat;
+
+    // last values written to the cursor registers
+    IntelCursorRegState mRegState;
+
+    uint32_t mUploads;
+    uint32_t mDeferredUploads;
+    uint32_t mMoves;
+    uint32_t mRegWrites;
+
+    void upload(IntelDisplayBuffer *buffer, uint32_t handle,
+                unsigned long long stamp, int width, int height, int format);
+    void dropPending();
+    IntelCursorRegState::Regs getRegs(bool enable) const;
+    bool writeRegs(const IntelCursorRegState::Regs& regs);
+public:
+    IntelCursorPlane(int fd, int index, IntelBufferManager *bufferManager);
+    virtual ~IntelCursorPlane();
+    virtual bool setDataBuffer(uint32_t handle, uint32_t flags, IMG_native_handle_t* nHandle);
+    virtual bool flip(void *context, uint32_t flags);
+    virtual bool disable();
+    virtual bool reset();
+    virtual void onDpmsChange();
+
+    static bool isCursorSize(int width, int height) {
+        return width > 0 && height > 0 &&
+               width <= CURSOR_SIZE_MAX && height <= CURSOR_SIZE_MAX;
+    }
+    uint32_t getUploadCount() const { return mUploads; }
+    uint32_t getDeferredUploadCount() const { return mDeferredUploads; }
+    uint32_t getMoveCount() const { return mMoves; }
+    uint32_t getRegWriteCount() const { return mRegWrites; }
+};
+
 class IntelDisplayPlaneManager : public IntelHWComposerDump {
 public:
     enum {
@@ -471,6 +584,8 @@ private:
     uint32_t mReclaimedPrimaryPlanes;
     uint32_t mReclaimedOverlayPlanes;
 
+    IntelCursorPlane *mCursorPlane;
+
     int mDrmFd;
     IntelBufferManager *mBufferManager;
     IntelBufferManager *mGrallocBufferManager;
@@ -506,9 +621,12 @@ public:
     IntelDisplayPlane* getPrimaryPlane(int pipe);
     IntelDisplayPlane* getOverlayPlane();
     IntelDisplayPlane* getRGBOverlayPlane();
+    // owned by the MIPI device, NULL without a primary plane
+    IntelCursorPlane* getCursorPlane() const { return mCursorPlane; }
 
     bool hasFreeSprites();
     bool hasFreeOverlays();
+    int getOverlayPlaneCount() const { return mOverlayPlaneCount; }
     bool hasReclaimedOverlays();
     bool hasFreeRGBOverlays();
     bool primaryAvailable(int index);
@@ -517,6 +635,8 @@ public:
     void disableReclaimedPlanes(int type);
     void *getPlaneContexts() const;
     void resetPlaneContexts();
+    // display powered off or on, planes write all their state again
+    void onDpmsChange();
     int getContextLength() const;
     int setZOrderConfig(int config, int pipe);
     int getZOrderConfig(int pipe);
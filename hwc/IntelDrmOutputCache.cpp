@@ -0,0 +1,377 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <IntelDrmOutputCache.h>
+#include <IntelHWComposerCfg.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cutils/log.h>
+
+static int outputForConnector(drmModeConnectorPtr connector)
+{
+    switch (connector->connector_type) {
+    case DRM_MODE_CONNECTOR_MIPI:
+        if (connector->connector_type_id == 1)
+            return OUTPUT_MIPI0;
+        if (connector->connector_type_id == 2)
+            return OUTPUT_MIPI1;
+        break;
+    case DRM_MODE_CONNECTOR_DVID:
+        if (connector->connector_type_id == 1)
+            return OUTPUT_HDMI;
+        break;
+    }
+    return -1;
+}
+
+static uint32_t encoderTypeForOutput(int disp)
+{
+    return (disp == OUTPUT_HDMI) ? DRM_MODE_ENCODER_TMDS : DRM_MODE_ENCODER_MIPI;
+}
+
+IntelDrmOutputCache::IntelDrmOutputCache()
+    : mDrmFd(-1), mLoaded(false)
+{
+    memset(mOutputs, 0, sizeof(mOutputs));
+}
+
+IntelDrmOutputCache::~IntelDrmOutputCache()
+{
+    release();
+}
+
+void IntelDrmOutputCache::setDrmFd(int fd)
+{
+    android::Mutex::Autolock _l(mLock);
+    release();
+    mDrmFd = fd;
+}
+
+void IntelDrmOutputCache::invalidate()
+{
+    android::Mutex::Autolock _l(mLock);
+    ALOGD_IF(ALLOW_MONITOR_PRINT && mLoaded, "%s\n", __func__);
+    release();
+}
+
+void IntelDrmOutputCache::releaseOutput(Output *output)
+{
+    if (output->connector)
+        drmModeFreeConnector(output->connector);
+    free(output->mode_rank);
+    memset(output, 0, sizeof(*output));
+}
+
+// must be called with mLock held
+void IntelDrmOutputCache::release()
+{
+    for (int i = 0; i < OUTPUT_MAX; i++)
+        releaseOutput(&mOutputs[i]);
+    mLoaded = false;
+}
+
+// preferred mode first, then larger, then faster modes
+void IntelDrmOutputCache::rankModes(Output *output)
+{
+    drmModeConnectorPtr connector = output->connector;
+    int count = connector->count_modes;
+
+    if (count <= 0 || !connector->modes)
+        return;
+
+    output->mode_rank = (int *)malloc(count * sizeof(int));
+    if (!output->mode_rank)
+        return;
+
+    for (int i = 0; i < count; i++) {
+        drmModeModeInfoPtr mode = &connector->modes[i];
+        int j = i;
+
+        while (j > 0) {
+            drmModeModeInfoPtr prev = &connector->modes[output->mode_rank[j - 1]];
+            bool prefMode = mode->type & DRM_MODE_TYPE_PREFERRED;
+            bool prefPrev = prev->type & DRM_MODE_TYPE_PREFERRED;
+            uint32_t area = mode->hdisplay * mode->vdisplay;
+            uint32_t areaPrev = prev->hdisplay * prev->vdisplay;
+
+            if (prefMode == prefPrev &&
+                (area < areaPrev ||
+                 (area == areaPrev && mode->vrefresh <= prev->vrefresh)))
+                break;
+            if (prefPrev && !prefMode)
+                break;
+
+            output->mode_rank[j] = output->mode_rank[j - 1];
+            j--;
+        }
+        output->mode_rank[j] = i;
+    }
+}
+
+// must be called with mLock held
+bool IntelDrmOutputCache::load()
+{
+    int ioctls = 1;
+
+    if (mLoaded)
+        return true;
+
+    if (mDrmFd < 0) {
+        ALOGE("%s: invalid drm FD\n", __func__);
+        return false;
+    }
+
+    drmModeResPtr resources = drmModeGetResources(mDrmFd);
+    if (!resources || !resources->connectors || !resources->encoders) {
+        ALOGE("%s: fail to get drm resources. %s\n", __func__, strerror(errno));
+        if (resources)
+            drmModeFreeResources(resources);
+        return false;
+    }
+
+    for (int i = 0; i < resources->count_connectors; i++) {
+        drmModeConnectorPtr connector =
+            drmModeGetConnector(mDrmFd, resources->connectors[i]);
+        ioctls++;
+        if (!connector) {
+            ALOGW("%s: fail to get drm connector\n", __func__);
+            continue;
+        }
+
+        int disp = outputForConnector(connector);
+        if (disp < 0 || mOutputs[disp].connector) {
+            drmModeFreeConnector(connector);
+            continue;
+        }
+
+        mOutputs[disp].connector = connector;
+        rankModes(&mOutputs[disp]);
+    }
+
+    for (int i = 0; i < resources->count_encoders; i++) {
+        drmModeEncoderPtr encoder =
+            drmModeGetEncoder(mDrmFd, resources->encoders[i]);
+        ioctls++;
+        if (!encoder) {
+            ALOGW("%s: Failed to get encoder\n", __func__);
+            continue;
+        }
+
+        for (int disp = 0; disp < OUTPUT_MAX; disp++) {
+            if (mOutputs[disp].encoder_type ||
+                encoder->encoder_type != encoderTypeForOutput(disp))
+                continue;
+            mOutputs[disp].encoder_type = encoder->encoder_type;
+            mOutputs[disp].crtc_id = encoder->crtc_id;
+        }
+        drmModeFreeEncoder(encoder);
+    }
+
+    drmModeFreeResources(resources);
+
+    mLoaded = true;
+    ALOGD_IF(ALLOW_MONITOR_PRINT, "%s: loaded with %d ioctls\n",
+             __func__, ioctls);
+    return true;
+}
+
+bool IntelDrmOutputCache::getConnector(int disp,
+                                       intel_drm_connector_info_t *info)
+{
+    if (disp < 0 || disp >= OUTPUT_MAX || !info) {
+        ALOGW("%s: invalid device number: %d\n", __func__, disp);
+        return false;
+    }
+
+    android::Mutex::Autolock _l(mLock);
+
+    if (!load())
+        return false;
+
+    drmModeConnectorPtr connector = mOutputs[disp].connector;
+    if (connector == NULL) {
+        ALOGW("%s: fail to get required connector\n", __func__);
+        return false;
+    }
+
+    info->connector_id = connector->connector_id;
+    info->connection = connector->connection;
+    info->count_modes = connector->modes ? connector->count_modes : 0;
+    return true;
+}
+
+uint32_t IntelDrmOutputCache::getCrtcId(int disp)
+{
+    if (disp < 0 || disp >= OUTPUT_MAX) {
+        ALOGW("%s: invalid device number: %d\n", __func__, disp);
+        return 0;
+    }
+
+    android::Mutex::Autolock _l(mLock);
+
+    if (!load())
+        return 0;
+
+    Output *output = &mOutputs[disp];
+    if (!output->encoder_type) {
+        ALOGW("%s: fail to get required encoder\n", __func__);
+        return 0;
+    }
+
+    if (output->crtc_id || output->crtc_resolved)
+        return output->crtc_id;
+
+    /* Query an available crtc to use */
+    drmModeResPtr resources = drmModeGetResources(mDrmFd);
+    if (resources == NULL)
+        return 0;
+
+    if (!resources->crtcs) {
+        drmModeFreeResources(resources);
+        return 0;
+    }
+
+    for (int i = 0; i < resources->count_crtcs; i++) {
+        drmModeCrtcPtr crtc = drmModeGetCrtc(mDrmFd, resources->crtcs[i]);
+        if (!crtc) {
+            ALOGE("%s: Failed to get crtc %d, error is %s",
+                  __func__, resources->crtcs[i], strerror(errno));
+            continue;
+        }
+        if (crtc->buffer_id == 0) {
+            output->crtc_id = crtc->crtc_id;
+            drmModeFreeCrtc(crtc);
+            break;
+        }
+        drmModeFreeCrtc(crtc);
+    }
+    drmModeFreeResources(resources);
+
+    output->crtc_resolved = true;
+    return output->crtc_id;
+}
+
+uint32_t IntelDrmOutputCache::getDpmsPropId(int disp)
+{
+    if (disp < 0 || disp >= OUTPUT_MAX)
+        return 0;
+
+    android::Mutex::Autolock _l(mLock);
+
+    if (!load())
+        return 0;
+
+    Output *output = &mOutputs[disp];
+    drmModeConnectorPtr connector = output->connector;
+    if (!connector || output->dpms_prop_id)
+        return output->dpms_prop_id;
+
+    for (int i = 0; i < connector->count_props; i++) {
+        drmModePropertyPtr props = drmModeGetProperty(mDrmFd, connector->props[i]);
+        if (!props)
+            continue;
+
+        if (!strcmp(props->name, "DPMS")) {
+            output->dpms_prop_id = props->prop_id;
+            drmModeFreeProperty(props);
+            break;
+        }
+        drmModeFreeProperty(props);
+    }
+
+    return output->dpms_prop_id;
+}
+
+bool IntelDrmOutputCache::getMode(int disp,
+                                  const intel_display_mode_t *requested,
+                                  drmModeModeInfo *mode)
+{
+    if (disp < 0 || disp >= OUTPUT_MAX || !mode)
+        return false;
+
+    android::Mutex::Autolock _l(mLock);
+
+    if (!load())
+        return false;
+
+    drmModeConnectorPtr connector = mOutputs[disp].connector;
+    int *rank = mOutputs[disp].mode_rank;
+
+    if (!connector || !rank)
+        return false;
+
+    // set to requested mode if found
+    for (int i = 0; requested && i < connector->count_modes; i++) {
+        drmModeModeInfoPtr m = &connector->modes[i];
+        if (requested->vrefresh == m->vrefresh &&
+            requested->hdisplay == m->hdisplay &&
+            requested->vdisplay == m->vdisplay &&
+            isModeFlagsMatched(m, requested)) {
+            ALOGD("Get the requested timing, %d", i);
+            *mode = *m;
+            return true;
+        }
+    }
+
+    // otherwise the preferred or the biggest mode
+    ALOGD("Get the best timing, %d", rank[0]);
+    *mode = connector->modes[rank[0]];
+    return true;
+}
+
+bool IntelDrmOutputCache::isModeFlagsMatched(const drmModeModeInfo *mode,
+                                             const intel_display_mode_t *displayMode)
+{
+    if (mode == NULL || displayMode == NULL)
+        return true;
+    uint32_t flags = 0;
+    if (displayMode->interlace)
+        flags |= DRM_MODE_FLAG_INTERLACE;
+    if (displayMode->ratio == 2)
+        flags |= DRM_MODE_FLAG_PAR16_9;
+    else if (displayMode->ratio == 1)
+        flags |= DRM_MODE_FLAG_PAR4_3;
+
+    if (flags == 0)
+        return true;
+
+    return (mode->flags & flags) == flags;
+}
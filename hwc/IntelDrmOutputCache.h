@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __INTEL_DRM_OUTPUT_CACHE_H__
+#define __INTEL_DRM_OUTPUT_CACHE_H__
+
+#include <stdint.h>
+#include <utils/threads.h>
+
+extern "C" {
+#include "xf86drm.h"
+#include "xf86drmMode.h"
+}
+
+#define DRM_MODE_CONNECTOR_MIPI 15
+
+typedef enum {
+    OUTPUT_MIPI0 = 0,
+    OUTPUT_HDMI,
+    OUTPUT_MIPI1,
+    OUTPUT_MAX,
+} intel_drm_output_t;
+
+// this structure must match MDSHDMITiming
+typedef struct {
+    uint32_t vrefresh;
+    uint32_t hdisplay;
+    uint32_t vdisplay;
+    uint32_t interlace;
+    uint32_t ratio;
+} intel_display_mode_t;
+
+// connector state of an output, copied out of the cache
+typedef struct {
+    uint32_t connector_id;
+    drmModeConnection connection;
+    int count_modes;
+} intel_drm_connector_info_t;
+
+/*
+ * Connector, encoder and CRTC state of each output, read from DRM in
+ * one pass and kept until invalidate(). Nothing cached is handed out,
+ * the getters copy what the caller needs under the cache lock, so a
+ * reload never frees anything a caller still uses.
+ */
+class IntelDrmOutputCache {
+private:
+    struct Output {
+        drmModeConnectorPtr connector;
+        uint32_t encoder_type;
+        uint32_t crtc_id;           // 0 until resolved by getCrtcId()
+        bool crtc_resolved;
+        uint32_t dpms_prop_id;      // 0 until resolved by getDpmsPropId()
+        int *mode_rank;             // connector mode indices, best first
+    };
+
+    android::Mutex mLock;
+    int mDrmFd;
+    bool mLoaded;
+    Output mOutputs[OUTPUT_MAX];
+private:
+    bool load();
+    void release();
+    static void releaseOutput(Output *output);
+    static void rankModes(Output *output);
+public:
+    IntelDrmOutputCache();
+    ~IntelDrmOutputCache();
+
+    // a new fd drops whatever was read from the previous one
+    void setDrmFd(int fd);
+    // drop everything, the next getter reloads. on hotplug or after
+    // a failed modeset
+    void invalidate();
+
+    bool getConnector(int disp, intel_drm_connector_info_t *info);
+    uint32_t getCrtcId(int disp);
+    uint32_t getDpmsPropId(int disp);
+    // the requested mode if the connector has it, otherwise the
+    // preferred or the biggest one
+    bool getMode(int disp, const intel_display_mode_t *requested,
+                 drmModeModeInfo *mode);
+
+    static bool isModeFlagsMatched(const drmModeModeInfo *mode,
+                                   const intel_display_mode_t *displayMode);
+};
+
+#endif /*__INTEL_DRM_OUTPUT_CACHE_H__*/
@@ -98,6 +98,11 @@ int IntelExternalDisplayMonitor::onMdsMessage(int msg, void *data, int size)
     if (msg == MDS_MODE_CHANGE) {
         int mode = *((int*)data);
 
+        // a video started or stopped
+        if (checkMode(mActiveDisplayMode, MDS_VIDEO_PLAYING) !=
+            checkMode(mode, MDS_VIDEO_PLAYING))
+            mVideoInfo.invalidate();
+
         if (checkMode(mActiveDisplayMode, MDS_HDMI_CONNECTED) &&
             !checkMode(mode, MDS_HDMI_CONNECTED)) {
             ALOGD_IF(ALLOW_MONITOR_PRINT, "%s: HDMI is plugged out %d", __func__, mode);
@@ -121,6 +126,7 @@ int IntelExternalDisplayMonitor::onMdsMessage(int msg, void *data, int size)
         return mComposer->onUEvent(mLastMsg, data, size);
     } else if (msg == MDS_SET_VIDEO_STATUS) {
         mVideoPrepareState = *((int *)data);
+        mVideoInfo.invalidate();
     }
 
     if (msg == MDS_MODE_CHANGE) {
@@ -205,13 +211,30 @@ bool IntelExternalDisplayMonitor::notifyMipi(bool on)
     return false;
 }
 
+bool IntelExternalDisplayMonitor::queryVideoInfo(intel_video_info_t *info)
+{
+    if (mMDClient == NULL)
+        return false;
+    return mMDClient->getVideoInfo(&info->displayW, &info->displayH,
+                                   &info->fps, &info->isInterlace) == MDS_NO_ERROR;
+}
+
+/*
+ * Called on the frame path. MDS is only queried once after each video
+ * state notification, every other call is served from the cached copy.
+ */
 bool IntelExternalDisplayMonitor::getVideoInfo(int *displayW, int *displayH, int *fps, int *isinterlace)
 {
-    if (mMDClient != NULL) {
-        int ret = mMDClient->getVideoInfo(displayW, displayH, fps, isinterlace);
-        return (ret == MDS_NO_ERROR);
-    }
-    return false;
+    intel_video_info_t info;
+
+    if (!mVideoInfo.get(mMDClient ? this : NULL, &info))
+        return false;
+
+    *displayW = info.displayW;
+    *displayH = info.displayH;
+    *fps = info.fps;
+    *isinterlace = info.isInterlace;
+    return true;
 }
 
 bool IntelExternalDisplayMonitor::threadLoop()
@@ -46,6 +46,7 @@
 #define __INTEL_EXTERNAL_DISPLAY_MONITOR_H__
 
 #include <utils/threads.h>
+#include <IntelVideoInfoCache.h>
 
 #include "display/IExtendDisplayListener.h"
 #include "display/IMultiDisplayComposer.h"
@@ -58,6 +59,7 @@ class IntelHWComposer;
 class IntelExternalDisplayMonitor :
     public BnExtendDisplayListener,
     public android::IBinder::DeathRecipient,
+    public IntelVideoInfoSource,
     protected android::Thread
 {
 public:
@@ -93,6 +95,8 @@ public:
 private:
     //DeathReipient interface
     virtual void binderDied(const android::wp<android::IBinder>& who);
+    // IntelVideoInfoSource interface
+    virtual bool queryVideoInfo(intel_video_info_t *info);
 private:
     virtual bool threadLoop();
     virtual android::status_t readyToRun();
@@ -115,6 +119,7 @@ private:
     char mUeventMessage[UEVENT_MSG_LEN];
     int mUeventFd;
     int mLastMsg;
+    IntelVideoInfoCache mVideoInfo;
 }; // IntelExternalDisplayMonitor
 
 #endif // __INTEL_EXTERNAL_DISPLAY_MONITOR_H__
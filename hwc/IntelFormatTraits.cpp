@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <string.h>
+#include <string.h>
+#include <cutils/log.h>
+#include <IntelFormatTraits.h>
+#include <IntelOverlayUtil.h>
+
+#define YUV_OVERLAY     (IntelFormatTraits::FORMAT_OVERLAY)
+#define YUV_NV12        (IntelFormatTraits::FORMAT_OVERLAY | \
+                         IntelFormatTraits::FORMAT_NV12)
+#define RGB_SPRITE      (IntelFormatTraits::FORMAT_SPRITE)
+#define RGBA_SPRITE     (IntelFormatTraits::FORMAT_SPRITE | \
+                         IntelFormatTraits::FORMAT_ALPHA)
+
+static const IntelFormatTraits sFormatTraits[] = {
+    // format, type, bpp, planes, flags, stride alignment
+    { HAL_PIXEL_FORMAT_INTEL_HWC_NV12_VED, IntelFormatTraits::FORMAT_YUV,
+      8, 2, YUV_NV12, 64 },
+    { HAL_PIXEL_FORMAT_INTEL_HWC_NV12_TILE, IntelFormatTraits::FORMAT_YUV,
+      8, 2, YUV_NV12, 64 },
+    { HAL_PIXEL_FORMAT_INTEL_HWC_NV12, IntelFormatTraits::FORMAT_YUV,
+      8, 2, YUV_NV12, 64 },
+    { HAL_PIXEL_FORMAT_YV12, IntelFormatTraits::FORMAT_YUV,
+      8, 3, YUV_OVERLAY, 64 },
+    { HAL_PIXEL_FORMAT_INTEL_HWC_I420, IntelFormatTraits::FORMAT_YUV,
+      8, 3, YUV_OVERLAY, 64 },
+    { HAL_PIXEL_FORMAT_INTEL_HWC_YUY2, IntelFormatTraits::FORMAT_YUV,
+      16, 1, YUV_OVERLAY, 64 },
+    { HAL_PIXEL_FORMAT_INTEL_HWC_UYVY, IntelFormatTraits::FORMAT_YUV,
+      16, 1, YUV_OVERLAY, 64 },
+    { HAL_PIXEL_FORMAT_RGBA_8888, IntelFormatTraits::FORMAT_RGB,
+      32, 1, RGBA_SPRITE, 64 },
+    { HAL_PIXEL_FORMAT_RGBX_8888, IntelFormatTraits::FORMAT_RGB,
+      32, 1, RGB_SPRITE, 64 },
+    { HAL_PIXEL_FORMAT_BGRA_8888, IntelFormatTraits::FORMAT_RGB,
+      32, 1, RGBA_SPRITE, 64 },
+    { HAL_PIXEL_FORMAT_BGRX_8888, IntelFormatTraits::FORMAT_RGB,
+      32, 1, RGB_SPRITE, 64 },
+    { HAL_PIXEL_FORMAT_RGB_565, IntelFormatTraits::FORMAT_RGB,
+      16, 1, RGB_SPRITE, 64 },
+};
+
+const IntelFormatTraits* IntelFormatTraits::get(int format)
+{
+    // video formats first, they're looked up on every video frame
+    for (size_t i = 0; i < sizeof(sFormatTraits) / sizeof(sFormatTraits[0]); i++) {
+        if (sFormatTraits[i].format == format)
+            return &sFormatTraits[i];
+    }
+
+    return 0;
+}
+
+bool IntelBufferLayout::setup(int format, uint32_t stride,
+                              uint32_t width, uint32_t height)
+{
+    const IntelFormatTraits *traits = IntelFormatTraits::get(format);
+
+    memset(this, 0, sizeof(*this));
+    if (!traits) {
+        ALOGE("%s: unsupported format 0x%x\n", __func__, format);
+        return false;
+    }
+
+    this->traits = traits;
+    this->format = format;
+    this->stride = stride;
+    this->width = width;
+    this->height = height;
+
+    yStride = align_to(stride * traits->bpp / 8, traits->strideAlign);
+    switch (traits->planes) {
+    case 3:
+        uvStride = align_to(yStride >> 1, traits->strideAlign);
+        break;
+    case 2:
+        uvStride = yStride;
+        break;
+    default:
+        uvStride = 0;
+        break;
+    }
+
+    switch (format) {
+    case HAL_PIXEL_FORMAT_YV12:
+        vOffset = yStride * height;
+        uOffset = vOffset + uvStride * (height / 2);
+        break;
+    case HAL_PIXEL_FORMAT_INTEL_HWC_I420:
+        uOffset = yStride * height;
+        vOffset = uOffset + uvStride * (height / 2);
+        break;
+    case HAL_PIXEL_FORMAT_INTEL_HWC_NV12:
+        uOffset = yStride * height;
+        break;
+    case HAL_PIXEL_FORMAT_INTEL_HWC_NV12_TILE:
+        flags |= LAYOUT_TILED;
+        // fall through
+    case HAL_PIXEL_FORMAT_INTEL_HWC_NV12_VED:
+        // the video driver aligns the height of decoded frames to 32
+        uOffset = yStride * align_to(height, 32);
+        break;
+    default:
+        break;
+    }
+
+    if (traits->isYUV() && traits->planes == 1)
+        flags |= LAYOUT_PACKED;
+
+    if (traits->has(IntelFormatTraits::FORMAT_OVERLAY) &&
+        yStride >= INTEL_OVERLAY_MIN_STRIDE &&
+        yStride <= (uint32_t)(has(LAYOUT_PACKED) ?
+                              INTEL_OVERLAY_MAX_STRIDE_PACKED :
+                              INTEL_OVERLAY_MAX_STRIDE_LINEAR))
+        flags |= LAYOUT_OVERLAY;
+
+    if (traits->has(IntelFormatTraits::FORMAT_SPRITE))
+        flags |= LAYOUT_SPRITE;
+
+    return true;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __INTEL_FORMAT_TRAITS_H__
+#define __INTEL_FORMAT_TRAITS_H__
+
+#include <stdint.h>
+#include <system/graphics.h>
+#include <OMX_IVCommon.h>
+#include <hal_public.h>
+
+// pixel format supported by HWC
+// TODO: share the extended pixel format with gralloc HAL
+enum {
+    HAL_PIXEL_FORMAT_INTEL_HWC_NV12_VED = OMX_INTEL_COLOR_FormatYUV420PackedSemiPlanar,
+    HAL_PIXEL_FORMAT_INTEL_HWC_NV12 = HAL_PIXEL_FORMAT_NV12,
+    HAL_PIXEL_FORMAT_INTEL_HWC_YUY2 = HAL_PIXEL_FORMAT_YUY2,
+    HAL_PIXEL_FORMAT_INTEL_HWC_UYVY = HAL_PIXEL_FORMAT_UYVY,
+    HAL_PIXEL_FORMAT_INTEL_HWC_I420 = HAL_PIXEL_FORMAT_I420,
+    HAL_PIXEL_FORMAT_INTEL_HWC_NV12_TILE = OMX_INTEL_COLOR_FormatYUV420PackedSemiPlanar_Tiled,
+};
+
+/*
+ * What the composer needs to know about a gralloc pixel format, looked
+ * up from a single table instead of comparing HAL_PIXEL_FORMAT_* values
+ * wherever a layer is classified.
+ */
+class IntelFormatTraits {
+public:
+    enum {
+        FORMAT_RGB,
+        FORMAT_YUV,
+    };
+
+    enum {
+        // can be scanned out by the overlay / a sprite plane
+        FORMAT_OVERLAY = 1 << 0,
+        FORMAT_SPRITE = 1 << 1,
+        // semi-planar NV12 as produced by the video decoder
+        FORMAT_NV12 = 1 << 2,
+        // carries per pixel alpha
+        FORMAT_ALPHA = 1 << 3,
+    };
+
+    int format;
+    int type;
+    // bits per pixel of the first plane
+    int bpp;
+    int planes;
+    uint32_t flags;
+    // stride alignment in bytes required by the planes the format can use
+    int strideAlign;
+
+    bool isYUV() const { return type == FORMAT_YUV; }
+    bool isRGB() const { return type == FORMAT_RGB; }
+    bool has(uint32_t flag) const { return (flags & flag) != 0; }
+
+    // NULL for a format the composer doesn't know
+    static const IntelFormatTraits* get(int format);
+};
+
+// overlay stride limits in bytes
+#define INTEL_OVERLAY_MIN_STRIDE        512
+#define INTEL_OVERLAY_MAX_STRIDE_PACKED (8 * 1024)
+#define INTEL_OVERLAY_MAX_STRIDE_LINEAR (4 * 1024)
+
+/*
+ * Memory layout of one buffer as the display planes see it. It only
+ * depends on the format and the buffer size, so planes compute it once
+ * when they map a buffer and keep it with the mapping.
+ */
+class IntelBufferLayout {
+public:
+    enum {
+        // strides are within the overlay limits
+        LAYOUT_OVERLAY = 1 << 0,
+        LAYOUT_SPRITE = 1 << 1,
+        LAYOUT_TILED = 1 << 2,
+        LAYOUT_PACKED = 1 << 3,
+    };
+
+    const IntelFormatTraits *traits;
+    int format;
+    uint32_t stride;
+    uint32_t width;
+    uint32_t height;
+
+    // in bytes, uvStride is 0 for single plane formats
+    uint32_t yStride;
+    uint32_t uvStride;
+    // offsets of the chroma planes from the start of the buffer
+    uint32_t uOffset;
+    uint32_t vOffset;
+    uint32_t flags;
+
+    // @stride is the buffer stride in pixels
+    bool setup(int format, uint32_t stride, uint32_t width, uint32_t height);
+    bool matches(int format, uint32_t stride,
+                 uint32_t width, uint32_t height) const {
+        return traits && this->format == format && this->stride == stride &&
+               this->width == width && this->height == height;
+    }
+    bool has(uint32_t flag) const { return (flags & flag) != 0; }
+};
+
+#endif /*__INTEL_FORMAT_TRAITS_H__*/
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <cutils/log.h>
+
+#include <IntelFrameCadence.h>
+
+IntelFrameCadence::IntelFrameCadence()
+{
+    reset();
+}
+
+void IntelFrameCadence::reset()
+{
+    mLastHandle = 0;
+    mLastTimestamp = -1;
+    mInterval = 0;
+    mFps = 0;
+    mFrames = 0;
+    mDuplicates = 0;
+}
+
+bool IntelFrameCadence::update(uint32_t handle, int64_t timestamp)
+{
+    static const int rates[] = { 24, 25, 30, 50, 60 };
+
+    if (handle == mLastHandle &&
+        (timestamp < 0 || timestamp == mLastTimestamp)) {
+        mDuplicates++;
+        return false;
+    }
+
+    int64_t delta = timestamp - mLastTimestamp;
+    bool timed = timestamp >= 0 && mLastTimestamp >= 0;
+
+    mLastHandle = handle;
+    mLastTimestamp = timestamp;
+    mFrames++;
+
+    // repeated timestamp, unknown, seek or pause: keep the detected rate
+    if (!timed || delta == 0)
+        return true;
+    if (delta < 0 || delta > 1000000) {
+        mInterval = 0;
+        return true;
+    }
+
+    if (mInterval)
+        mInterval += (delta - mInterval) / 8;
+    else
+        mInterval = delta;
+
+    int fps = (int)((1000000 + mInterval / 2) / mInterval);
+
+    // snap to the nearest standard rate within 5% so the result stays
+    // stable, 23.976 -> 24
+    int snapped = 0;
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        if (abs(fps - rates[i]) * 20 <= rates[i] &&
+            (!snapped || abs(fps - rates[i]) < abs(fps - snapped)))
+            snapped = rates[i];
+    }
+    if (snapped) {
+        if (mFps != snapped)
+            ALOGV("%s: content frame rate %d", __func__, snapped);
+        mFps = snapped;
+    }
+
+    return true;
+}
+
+void IntelFrameCadence::getPulldown(int refresh, int *first, int *second) const
+{
+    if (!mFps || refresh < mFps) {
+        *first = *second = 1;
+        return;
+    }
+
+    int hold = refresh / mFps;
+    *second = hold;
+    *first = (refresh % mFps) ? hold + 1 : hold;
+}
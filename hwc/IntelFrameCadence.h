@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __INTEL_FRAME_CADENCE_H__
+#define __INTEL_FRAME_CADENCE_H__
+
+#include <stdint.h>
+
+/*
+ * Tracks the buffers a video layer shows on consecutive composition
+ * cycles. A cycle showing the frame already shown is a duplicate which
+ * doesn't need an overlay flip or a widi send. When media timestamps
+ * are known the content frame rate is detected from them and snapped
+ * to a standard rate.
+ *
+ * Frames are not retimed: the player queues a new buffer on the
+ * refresh it is due, so suppressing duplicates keeps the pulldown it
+ * produced (3:2 for 24fps on a 60Hz output).
+ */
+class IntelFrameCadence {
+public:
+    IntelFrameCadence();
+    void reset();
+    // timestamp in us, negative if unknown; returns false for a duplicate
+    bool update(uint32_t handle, int64_t timestamp);
+    // detected content rate, 0 if unknown
+    int getFrameRate() const { return mFps; }
+    // refreshes a frame is held at the given refresh rate, the two
+    // values alternate, e.g. 3 and 2 for 24fps at 60Hz
+    void getPulldown(int refresh, int *first, int *second) const;
+    uint32_t getFrames() const { return mFrames; }
+    uint32_t getDuplicates() const { return mDuplicates; }
+private:
+    uint32_t mLastHandle;
+    int64_t mLastTimestamp;
+    int64_t mInterval;
+    int mFps;
+    uint32_t mFrames;
+    uint32_t mDuplicates;
+};
+
+#endif /*__INTEL_FRAME_CADENCE_H__*/
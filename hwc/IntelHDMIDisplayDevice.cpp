@@ -266,6 +266,9 @@ bool IntelHDMIDisplayDevice::commit(hwc_display_contents_1_t *list,
         flipFrameBufferTarget(context,list,bh,numBuffers,acquireFenceFd,releaseFenceFd);
     }
 
+    if (!list || (list->flags & HWC_GEOMETRY_CHANGED))
+        mVideoCadence.reset();
+
     //flip overlayer plan if any
     if(needFlipOverlay(list)){
         flipOverlayerPlane(context,list,bh,numBuffers,acquireFenceFd,releaseFenceFd);
@@ -341,12 +344,32 @@ bool IntelHDMIDisplayDevice::flipOverlayerPlane(void *context,hwc_display_conten
        if (list->hwLayers[i].compositionType != HWC_OVERLAY)
            continue;
 
+       // the video layer still shows the frame of the last flip, e.g. a
+       // 24fps video while the UI composes at 60fps; the overlay keeps
+       // scanning it out. The decoder may queue a new frame in the same
+       // buffer, the frame is told by its media timestamp
+       bool isVideo = plane->getPlaneType() == IntelDisplayPlane::DISPLAY_PLANE_OVERLAY &&
+                      mLayerList->getYUVLayerCount() == 1 &&
+                      !(flags & IntelDisplayPlane::DELAY_DISABLE);
+       if (isVideo &&
+           !mVideoCadence.update(plane->getDataBufferHandle(),
+                                 getVideoTimestamp(&list->hwLayers[i]))) {
+           ALOGD_IF(ALLOW_HWC_PRINT, "%s: same video frame on plane %d\n",
+               __func__, i);
+           // nothing is flushed, drop the flip flags as a flip would
+           mLayerList->setFlags(i, flags & IntelDisplayPlane::DELAY_DISABLE);
+           continue;
+       }
+
        ALOGD_IF(ALLOW_HWC_PRINT, "%s: flip plane %d, flags: 0x%x\n",
            __func__, i, flags);
 
        bool ret = plane->flip(context, flags);
        if (!ret) {
            ALOGW("%s: failed to flip plane %d context !\n", __func__, i);
+           // flip again next time even if the frame is the same
+           if (isVideo)
+               mVideoCadence.reset();
        } else if (plane->getDataBufferHandle() == 0) {
            // check if plane data buffer is NULL, which may
            // happen when updateLayerData failed.
@@ -407,6 +430,8 @@ bool IntelHDMIDisplayDevice::dump(char *buff,
        }
        dumpPrintf("-------------HDMI runtime parameters -------------\n");
        dumpPrintf("  + mHotplugEvent: %d \n", mHotplugEvent);
+       dumpPrintf("  + video frames flipped: %u, repeated frames skipped: %u \n",
+                  mVideoCadence.getFrames(), mVideoCadence.getDuplicates());
 
     }
 
@@ -25,6 +25,7 @@
 #include <utils/Log.h>
 #include "IntelHWCWrapper.h"
 #include "IntelBufferManager.h"
+#include "IntelFormatTraits.h"
 
 IntelHWCWrapper::IntelHWCWrapper():
                  mInitialized(false),
@@ -159,39 +160,31 @@ bool IntelHWCWrapper::isYUVLayer(hwc_layer_1_t* hwcl)
     IMG_native_handle_t* grallocHandle =
         (IMG_native_handle_t*)hwcl->handle;
 
-    return (grallocHandle &&
-            (grallocHandle->iFormat == HAL_PIXEL_FORMAT_YV12 ||
-             grallocHandle->iFormat == HAL_PIXEL_FORMAT_INTEL_HWC_NV12_VED ||
-             grallocHandle->iFormat == HAL_PIXEL_FORMAT_INTEL_HWC_NV12 ||
-             grallocHandle->iFormat == HAL_PIXEL_FORMAT_INTEL_HWC_YUY2 ||
-             grallocHandle->iFormat == HAL_PIXEL_FORMAT_INTEL_HWC_UYVY ||
-             grallocHandle->iFormat == HAL_PIXEL_FORMAT_INTEL_HWC_I420));
-}
+    if (!grallocHandle)
+        return false;
 
-bool IntelHWCWrapper::isIntersectRect(hwc_rect_t* r1, hwc_rect_t* r2)
-{
-    return !(r1->left >= r2->right ||
-             r1->right <= r2->left ||
-             r1->top >= r2->bottom ||
-             r1->bottom <= r2->top);
+    // tiled NV12 is not treated as a YUV layer here
+    const IntelFormatTraits *traits = IntelFormatTraits::get(grallocHandle->iFormat);
+    return traits && traits->isYUV() &&
+           grallocHandle->iFormat != HAL_PIXEL_FORMAT_INTEL_HWC_NV12_TILE;
 }
 
 bool IntelHWCWrapper::isOverlappedLayer(hwc_display_contents_1_t *list,
                                         hwc_layer_1_t* hwcl)
 {
     size_t i;
-    hwc_rect_t* rect = &hwcl->displayFrame;
+    uint64_t overlaps = mGeometry.getOverlaps(hwcl - list->hwLayers);
 
-    for (i = 0; i < list->numHwLayers; i++) {
-        if (hwcl == &list->hwLayers[i])
+    for (i = 0; overlaps && i < list->numHwLayers; i++) {
+        if (!(overlaps & IntelLayerGeometry::bit(i)))
             continue;
+        overlaps &= ~IntelLayerGeometry::bit(i);
 
         if (list->hwLayers[i].flags &
             (HWC_STATUS_BAR_LAYER | HWC_NAVIGATION_BAR_LAYER))
             continue;
 
-        if (isIntersectRect(&list->hwLayers[i].displayFrame, rect))
-            return true;
+        return true;
     }
 
     return false;
@@ -212,6 +205,8 @@ bool IntelHWCWrapper::checkLayersSupport(hwc_display_contents_1_t *list)
         if (mNumLayers > INTEL_HW_MAX_PLANE_COUNT)
             goto ret_false;
 
+        mGeometry.update(list, list->numHwLayers);
+
         for (i = 0; i < list->numHwLayers; i++) {
             hwcl = &list->hwLayers[i];
             if (hwcl->flags & HWC_SKIP_LAYER)
@@ -31,6 +31,7 @@
 #include <hardware/hardware.h>
 #include <system/graphics.h>
 #include <hal_public.h>
+#include "IntelLayerGeometry.h"
 
 #ifdef ENABLE_DISPLAY_PIPE_C
 #define INTEL_HW_OVERLAY_COUNT 2
@@ -80,8 +81,10 @@ private:
     bool mUseMergedLayer;
     sys_layer_t mMergedLayer;
 
+    // overlaps of the list, rebuilt on geometry change
+    IntelLayerGeometry mGeometry;
+
     bool isYUVLayer(hwc_layer_1_t* hwcl);
-    bool isIntersectRect(hwc_rect_t* r1, hwc_rect_t* r2);
     bool isOverlappedLayer(hwc_display_contents_1_t *list,
                            hwc_layer_1_t* hwcl);
 
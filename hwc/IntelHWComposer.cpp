@@ -49,6 +49,7 @@
 #include <IntelHWComposer.h>
 #include <IntelOverlayUtil.h>
 #include <IntelHWComposerCfg.h>
+#include <IntelConfigSnapshot.h>
 #include <IntelUtility.h>
 
 #ifdef INTEL_WIDI
@@ -59,8 +60,18 @@ IntelHWComposer::~IntelHWComposer()
 {
     ALOGD_IF(ALLOW_HWC_PRINT, "%s\n", __func__);
 
+    // the hotplug thread uses everything below, stop it first. a plug
+    // out waiting for SF to release the external display is let go
+    if (mHotplug != NULL) {
+        mHotplug->requestExit();
+        signalHpdCompletion();
+        mHotplug->join();
+        mHotplug.clear();
+    }
+
     delete mPlaneManager;
     delete mBufferManager;
+    freeHDMIFbCache();
     delete mGrallocBufferManager;
     delete mDrm;
 
@@ -81,18 +92,93 @@ void IntelHWComposer::signalHpdCompletion()
     }
 }
 
-void IntelHWComposer::waitForHpdCompletion()
+// must be called before the unplug is reported, a completion signalled
+// before that is otherwise lost
+void IntelHWComposer::armHpdCompletion()
 {
     android::Mutex::Autolock _l(mHpdLock);
-
-    // time out for 300ms
-    nsecs_t reltime = 300000000;
     mHpdCompletion = false;
-    while(!mHpdCompletion) {
+}
+
+bool IntelHWComposer::waitForHpdCompletion()
+{
+    android::Mutex::Autolock _l(mHpdLock);
+
+    // SF releases the external display on its next prepare, the timeout
+    // only guards against a SF that stopped composing
+    const nsecs_t timeout = 500000000;
+    nsecs_t deadline = systemTime(CLOCK_MONOTONIC) + timeout;
+    while (!mHpdCompletion) {
+        nsecs_t reltime = deadline - systemTime(CLOCK_MONOTONIC);
+        if (reltime <= 0) {
+            ALOGW("%s: no hpd completion after %lld ms\n",
+                  __func__, (long long)ns2ms(timeout));
+            mHpdCompletion = true;
+            return false;
+        }
         mHpdCondition.waitRelative(mHpdLock, reltime);
     }
 
-    ALOGD("%s: receive hpd completion signal: %d\n", __func__, mHpdCompletion?1:0);
+    ALOGD("%s: receive hpd completion signal\n", __func__);
+    return true;
+}
+
+bool IntelHWComposer::allocHDMIFb(uint32_t size)
+{
+    // most sinks come back with the same mode, reuse its FB
+    for (size_t i=0; i<HDMI_FB_CACHE_SIZE; i++) {
+        if (mHDMIFBCache[i].size == size) {
+            mHDMIFBHandle = mHDMIFBCache[i];
+            memset(&mHDMIFBCache[i], 0, sizeof(mHDMIFBCache[i]));
+            ALOGD_IF(ALLOW_HWC_PRINT, "%s: reuse hdmi fb, size %d\n",
+                     __func__, size);
+            return true;
+        }
+    }
+
+    mHDMIFBHandle.size = size;
+    if (!mGrallocBufferManager->alloc(mHDMIFBHandle.size,
+                                      &mHDMIFBHandle.umhandle,
+                                      &mHDMIFBHandle.kmhandle)) {
+        memset(&mHDMIFBHandle, 0, sizeof(mHDMIFBHandle));
+        return false;
+    }
+
+    return true;
+}
+
+void IntelHWComposer::releaseHDMIFb()
+{
+    if (!mHDMIFBHandle.size)
+        return;
+
+    // keep the FB for the next plug-in, evict the oldest one
+    size_t i;
+    for (i=0; i<HDMI_FB_CACHE_SIZE; i++) {
+        if (!mHDMIFBCache[i].size)
+            break;
+    }
+    if (i == HDMI_FB_CACHE_SIZE) {
+        mGrallocBufferManager->dealloc(mHDMIFBCache[0].umhandle);
+        memmove(&mHDMIFBCache[0], &mHDMIFBCache[1],
+                sizeof(mHDMIFBCache[0]) * (HDMI_FB_CACHE_SIZE - 1));
+        i = HDMI_FB_CACHE_SIZE - 1;
+    }
+
+    mHDMIFBCache[i] = mHDMIFBHandle;
+    memset(&mHDMIFBHandle, 0, sizeof(mHDMIFBHandle));
+}
+
+void IntelHWComposer::freeHDMIFbCache()
+{
+    if (!mGrallocBufferManager)
+        return;
+
+    for (size_t i=0; i<HDMI_FB_CACHE_SIZE; i++) {
+        if (mHDMIFBCache[i].size)
+            mGrallocBufferManager->dealloc(mHDMIFBCache[i].umhandle);
+    }
+    memset(mHDMIFBCache, 0, sizeof(mHDMIFBCache));
 }
 
 bool IntelHWComposer::handleDisplayModeChange()
@@ -132,22 +218,24 @@ bool IntelHWComposer::handleHotplugEvent(int hpd, void *data)
         // get display mode
         intel_display_mode_t *s_mode = (intel_display_mode_t *)data;
         drmModeModeInfoPtr mode;
+        // the sink may have changed, re-probe the connector
+        mDrm->invalidateOutputCache();
         mode = mDrm->selectDisplayDrmMode(OUTPUT_HDMI, s_mode);
         if (!mode)
             return false;
 
         // alloc buffer;
-        mHDMIFBHandle.size = mode->vdisplay * align_to(mode->hdisplay * 4, 64);
-        ret = mGrallocBufferManager->alloc(mHDMIFBHandle.size,
-                                      &mHDMIFBHandle.umhandle,
-                                      &mHDMIFBHandle.kmhandle);
+        releaseHDMIFb();
+        ret = allocHDMIFb(mode->vdisplay * align_to(mode->hdisplay * 4, 64));
         if (!ret)
             return false;
 
         // mode setting;
         ret = mDrm->setDisplayDrmMode(OUTPUT_HDMI, mHDMIFBHandle.kmhandle, mode);
-        if (!ret)
+        if (!ret) {
+            releaseHDMIFb();
             return false;
+        }
 
         ALOGD("%s: detected hdmi hotplug event:%s\n", __func__, hpd?"IN":"OUT");
         handleDisplayModeChange();
@@ -170,18 +258,15 @@ bool IntelHWComposer::handleHotplugEvent(int hpd, void *data)
          * still a race condition where a hotplug event might occur after the open
          * but before the procs are registered. */
         if (mProcs && mProcs->vsync) {
+            armHpdCompletion();
             mProcs->hotplug(mProcs, HWC_DISPLAY_EXTERNAL, hpd);
+            // wait for SF to stop composing to the external display
+            waitForHpdCompletion();
         }
-        // TODO: here we need to wait for the plug-out take effect.
-        waitForHpdCompletion();
         // rm FB
         mDrm->deleteDrmFb(OUTPUT_HDMI);
-        // release buffer;
-        ret = mGrallocBufferManager->dealloc(mHDMIFBHandle.umhandle);
-        if (!ret)
-            return false;
-
-        memset(&mHDMIFBHandle, 0, sizeof(mHDMIFBHandle));
+        // keep the buffer for the next plug-in
+        releaseHDMIFb();
     }
     return true;
 }
@@ -218,21 +303,27 @@ out:
 bool IntelHWComposer::onUEvent(int msgType, void* msg, int msgLen)
 {
     bool ret = false;
+
+    // events before initialize() are covered by the boot time detection
+    if (mHotplug == NULL)
+        return false;
 #ifdef TARGET_HAS_MULTIPLE_DISPLAY
     if (msgType == IntelExternalDisplayMonitor::MSG_TYPE_MDS)
         ret = handleDisplayModeChange();
 
     // handle hdmi plug in;
     if (msgType == IntelExternalDisplayMonitor::MSG_TYPE_MDS_HOTPLUG_IN)
-        ret = handleHotplugEvent(1, msg);
+        ret = mHotplug->post(IntelHotplugHandler::EVENT_PLUG_IN,
+                             (intel_display_mode_t*)msg);
 
     // handle hdmi plug out;
     if (msgType == IntelExternalDisplayMonitor::MSG_TYPE_MDS_HOTPLUG_OUT)
-        ret = handleHotplugEvent(0, NULL);
+        ret = mHotplug->post(IntelHotplugHandler::EVENT_PLUG_OUT, NULL);
 
     // handle dynamic mode setting
     if (msgType == IntelExternalDisplayMonitor::MSG_TYPE_MDS_TIMING_DYNAMIC_SETTING)
-        ret = handleDynamicModeSetting(msg);
+        ret = mHotplug->post(IntelHotplugHandler::EVENT_MODE_CHANGE,
+                             (intel_display_mode_t*)msg);
 
     return ret;
 #endif
@@ -245,10 +336,10 @@ bool IntelHWComposer::onUEvent(int msgType, void* msg, int msgLen)
     do {
         if (!strncmp(szMsg, "HOTPLUG_IN=1", strlen("HOTPLUG_IN=1"))) {
             ALOGD("%s: detected hdmi hotplug event:%s\n", __func__, szMsg);
-            ret = handleHotplugEvent(1, NULL);
+            ret = mHotplug->post(IntelHotplugHandler::EVENT_PLUG_IN, NULL);
             break;
         } else if (!strncmp(szMsg, "HOTPLUG_OUT=1", strlen("HOTPLUG_OUT=1"))) {
-            ret = handleHotplugEvent(0, NULL);
+            ret = mHotplug->post(IntelHotplugHandler::EVENT_PLUG_OUT, NULL);
             break;
         }
 
@@ -553,6 +644,9 @@ bool IntelHWComposer::dump(char *buff,
     mDumpBuflen = buff_len;
     mDumpLen = 0;
 
+    // dumpsys after setting a property applies it right away
+    propCfg.reload();
+
     dumpDisplayStat();
 
     for (size_t i=0 ; i<DISPLAY_NUM ; i++) {
@@ -672,16 +766,15 @@ bool IntelHWComposer::initialize()
 
     // init mHDMIBuffers
     memset(&mHDMIFBHandle, 0, sizeof(mHDMIFBHandle));
+    memset(mHDMIFBCache, 0, sizeof(mHDMIFBCache));
     memset(&mExtendedModeInfo, 0, sizeof(mExtendedModeInfo));
 
+    // hotplug is handled off the uevent thread
+    mHotplug = new IntelHotplugHandler(this);
+
     // do mode setting in HWC if HDMI is connected when boot up
     if (mDrm->detectDisplayConnection(OUTPUT_HDMI))
-        handleHotplugEvent(1, NULL);
-
-    char value[PROPERTY_VALUE_MAX];
-    property_get("hwcomposer.debug.dumpPost2", value, "0");
-    if (atoi(value))
-        mForceDumpPostBuffer = true;
+        mHotplug->post(IntelHotplugHandler::EVENT_PLUG_IN, NULL);
 
     // startObserver();
     mInitialized = true;
@@ -729,9 +822,9 @@ IMG_native_handle_t *IntelHWComposer::findVideoHandle(hwc_display_contents_1_t*
             hwc_layer_1_t& layer = list->hwLayers[i];
             if (layer.compositionType != HWC_BACKGROUND && layer.handle) {
                 IMG_native_handle_t *grallocHandle = (IMG_native_handle_t*)layer.handle;
-                if (grallocHandle->iFormat == HAL_PIXEL_FORMAT_INTEL_HWC_NV12 ||
-                    grallocHandle->iFormat == HAL_PIXEL_FORMAT_INTEL_HWC_NV12_VED ||
-                    grallocHandle->iFormat == HAL_PIXEL_FORMAT_INTEL_HWC_NV12_TILE)
+                const IntelFormatTraits *traits =
+                    IntelFormatTraits::get(grallocHandle->iFormat);
+                if (traits && traits->has(IntelFormatTraits::FORMAT_NV12))
                 {
                     foundHandle = grallocHandle;
                 }
@@ -872,7 +965,7 @@ bool IntelHWComposer::commitDisplays(size_t numDisplays,
         }
     }
 
-    if ( ret == false || mForceDumpPostBuffer) {
+    if ( ret == false || propCfg.get()->dump_post2) {
         dumpPost2Buffers(numBuffers, bufferHandles);
         dumpLayerLists(numDisplays, displays);
     }
@@ -56,11 +56,13 @@
 #include <IntelHWComposerDump.h>
 #include <IntelVsyncEventHandler.h>
 #include <IntelFakeVsyncEvent.h>
+#include <IntelHotplugHandler.h>
 #include <IntelDisplayDevice.h>
 #ifdef INTEL_RGB_OVERLAY
 #include <IntelHWCWrapper.h>
 #endif
-class IntelHWComposer : public hwc_composer_device_1_t, public IntelHWCUEventObserver, public IntelHWComposerDump  {
+class IntelHWComposer : public hwc_composer_device_1_t, public IntelHWCUEventObserver,
+                        public IntelHWComposerDump, public IntelHotplugListener {
 public:
     enum {
         VSYNC_SRC_MIPI = 0,
@@ -71,6 +73,11 @@ public:
     enum {
         DISPLAY_NUM = 3,
     };
+private:
+    enum {
+        // released HDMI FBs kept for the next plug-in
+        HDMI_FB_CACHE_SIZE = 2,
+    };
 private:
     IMG_gralloc_module_public_t* mGrallocModule;
     IntelHWComposerDrm *mDrm;
@@ -83,12 +90,14 @@ private:
     hwc_procs_t const *mProcs;
     android::sp<IntelVsyncEventHandler> mVsync;
     android::sp<IntelFakeVsyncEvent> mFakeVsync;
+    android::sp<IntelHotplugHandler> mHotplug;
     nsecs_t mLastVsync;
     struct hdmi_fb_handler {
         uint32_t umhandle;
         uint32_t kmhandle;
         uint32_t size;
     } mHDMIFBHandle;
+    hdmi_fb_handler mHDMIFBCache[HDMI_FB_CACHE_SIZE];
     WidiExtendedModeInfo mExtendedModeInfo;
 
     android::Mutex mLock;
@@ -114,10 +123,13 @@ private:
     bool needSwitchVsyncSrc();
     bool vsyncControl_l(int enabled);
     void signalHpdCompletion();
-    void waitForHpdCompletion();
+    void armHpdCompletion();
+    bool waitForHpdCompletion();
+    bool allocHDMIFb(uint32_t size);
+    void releaseHDMIFb();
+    void freeHDMIFbCache();
     static IMG_native_handle_t *findVideoHandle(hwc_display_contents_1_t* list);
 
-    bool mForceDumpPostBuffer;
     int dumpPost2Buffers(int num, buffer_handle_t* buffer);
     int dumpLayerLists(size_t numDisplays, hwc_display_contents_1_t** displays);
     bool checkPresentationMode(hwc_display_contents_1_t*, hwc_display_contents_1_t*);
@@ -146,9 +158,9 @@ public:
         : IntelHWCUEventObserver(), IntelHWComposerDump(),
           mDrm(0), mBufferManager(0), mGrallocBufferManager(0),
           mCursorBufferManager(0), cursorDataBuffer(0),
-          mPlaneManager(0),mProcs(0), mVsync(0), mFakeVsync(0),
+          mPlaneManager(0),mProcs(0), mVsync(0), mFakeVsync(0), mHotplug(0),
           mLastVsync(0), mInitialized(false),
-          mActiveVsyncs(0), mHpdCompletion(true), mForceDumpPostBuffer(false) {}
+          mActiveVsyncs(0), mHpdCompletion(true) {}
     ~IntelHWComposer();
 };
 
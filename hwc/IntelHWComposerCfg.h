@@ -55,6 +55,19 @@ typedef struct {
     unsigned int bypasspost;
 } hwc_cfg;
 
+/* tunables from properties, published by IntelConfigSnapshot */
+typedef struct {
+    unsigned int dump_post2;
+    unsigned int dump_layers;
+    unsigned int panel_width_mm;
+    unsigned int panel_height_mm;
+} hwc_prop_cfg;
+
+#define HWC_PROP_DUMP_POST2        "hwcomposer.debug.dumpPost2"
+#define HWC_PROP_DUMP_LAYERS       "debug.hwc.dumplayers"
+#define HWC_PROP_PANEL_WIDTH_MM    "panel.physicalWidthmm"
+#define HWC_PROP_PANEL_HEIGHT_MM   "panel.physicalHeightmm"
+
 enum hwc_log_level {
     NO_DEBUG = 0x00,
     HWC_DEBUG = 0x01,
@@ -79,6 +92,10 @@ enum hwc_log_level {
 #define ALLOW_MONITOR_PRINT    ALLOW_PRINT(cfg.log_level, MONITOR_DEBUG)
 #define ALLOW_BUFFER_PRINT     ALLOW_PRINT(cfg.log_level, BUFFER_DEBUG)
 
+/* read from HWC_CFG_PATH once at open, constant afterwards */
 extern hwc_cfg cfg;
 
+/* read the property tunables, never called on the frame path */
+void hwc_load_prop_cfg(hwc_prop_cfg *cfg);
+
 #endif /*__INTEL_HWCOMPOSER_CFG_CPP__*/
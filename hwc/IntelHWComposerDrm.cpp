@@ -75,7 +75,7 @@ bool IntelHWComposerDrm::drmInit()
     }
 
     mDrmFd = fd;
-    mHdmiConnector = NULL;
+    mOutputCache.setDrmFd(fd);
     ALOGD("%s: successfully. mDrmFd %d\n", __func__, fd);
     return true;
 }
@@ -88,6 +88,8 @@ void IntelHWComposerDrm::drmDestroy()
         drmClose(mDrmFd);
         mDrmFd = -1;
     }
+
+    mOutputCache.setDrmFd(-1);
 }
 
 void IntelHWComposerDrm::setOutputConnection(const int output,
@@ -426,185 +428,18 @@ bool IntelHWComposerDrm::detectDrmModeInfo()
     return true;
 }
 
-drmModeConnectorPtr
-IntelHWComposerDrm::getConnector(int disp)
+void IntelHWComposerDrm::invalidateOutputCache()
 {
-    if (mDrmFd < 0) {
-        ALOGE("%s: invalid drm FD\n", __func__);
-        return NULL;
-    }
-    uint32_t req_connector_type = 0;
-    uint32_t req_connector_type_id = 1;
-
-    switch (disp) {
-        case OUTPUT_MIPI0:
-        case OUTPUT_MIPI1:
-            req_connector_type = DRM_MODE_CONNECTOR_MIPI;
-            req_connector_type_id = disp ? 2 : 1;
-            break;
-        case OUTPUT_HDMI:
-            req_connector_type = DRM_MODE_CONNECTOR_DVID;
-            break;
-        default:
-            ALOGW("%s: invalid device number: %d\n", __func__, disp);
-            return NULL;
-    }
-
-    drmModeResPtr resources = drmModeGetResources(mDrmFd);
-    if (!resources || !resources->connectors) {
-        ALOGE("%s: fail to get drm resources. %s\n", __func__, strerror(errno));
-        return NULL;
-    }
-
-    drmModeConnectorPtr connector = NULL;
-    // get requested connector type and id
-    // search connector
-    for (int i = 0; i < resources->count_connectors; i++) {
-        connector = drmModeGetConnector(mDrmFd, resources->connectors[i]);
-        if (!connector) {
-            ALOGW("%s: fail to get drm connector\n", __func__);
-            continue;
-        }
-
-        if (connector->connector_type == req_connector_type &&
-            connector->connector_type_id == req_connector_type_id)
-            break;
-
-        drmModeFreeConnector(connector);
-        connector = NULL;
-    }
-
-    drmModeFreeResources(resources);
-
-    if (connector == NULL)
-        ALOGW("%s: fail to get required connector\n", __func__);
-
-    return connector;
+    mOutputCache.invalidate();
 }
 
-void IntelHWComposerDrm::freeConnector(drmModeConnectorPtr connector)
+bool IntelHWComposerDrm::getHdmiConnector(intel_drm_connector_info_t *info)
 {
-    if (connector != NULL) {
-        if (connector->connector_type == DRM_MODE_CONNECTOR_DVID)
-            mHdmiConnector = NULL;
-
-        drmModeFreeConnector(connector);
-    }
-}
-
-drmModeConnectorPtr
-IntelHWComposerDrm::getHdmiConnector() {
-    if (mHdmiConnector == NULL)
-        mHdmiConnector = getConnector(OUTPUT_HDMI);
-    if (mHdmiConnector == NULL || mHdmiConnector->modes == NULL) {
+    if (!mOutputCache.getConnector(OUTPUT_HDMI, info) || !info->count_modes) {
         LOGE("%s: Failed to get HDMI connector", __func__);
-        return NULL;
-    }
-    return mHdmiConnector;
-}
-
-drmModeEncoderPtr
-IntelHWComposerDrm::getEncoder(int disp)
-{
-    if (mDrmFd < 0) {
-        ALOGE("%s: invalid drm FD\n", __func__);
-        return NULL;
-    }
-
-    uint32_t req_encoder_type = 0;
-
-    switch (disp) {
-        case OUTPUT_MIPI0:
-        case OUTPUT_MIPI1:
-            req_encoder_type = DRM_MODE_ENCODER_MIPI;
-            break;
-        case OUTPUT_HDMI:
-            req_encoder_type = DRM_MODE_ENCODER_TMDS;
-            break;
-        default:
-            ALOGW("%s: invalid device number: %d\n", __func__, disp);
-            return NULL;
-    }
-
-    drmModeResPtr resources = drmModeGetResources(mDrmFd);
-    if (!resources || !resources->encoders) {
-        ALOGE("%s: fail to get drm resources. %s\n", __func__, strerror(errno));
-        return NULL;
-    }
-
-    drmModeEncoderPtr encoder = NULL;
-    for (int i = 0; i < resources->count_encoders; i++) {
-        encoder = drmModeGetEncoder(mDrmFd, resources->encoders[i]);
-
-        if (!encoder) {
-            ALOGW("%s: Failed to get encoder\n", __func__);
-            continue;
-        }
-
-        if (encoder->encoder_type == req_encoder_type)
-            break;
-
-        drmModeFreeEncoder(encoder);
-        encoder = NULL;
-    }
-    drmModeFreeResources(resources);
-
-    if (encoder == NULL)
-        ALOGW("%s: fail to get required encoder\n", __func__);
-
-    return encoder;
-}
-
-void IntelHWComposerDrm::freeEncoder(drmModeEncoderPtr encoder)
-{
-    if (encoder != NULL)
-        drmModeFreeEncoder(encoder);
-}
-
-uint32_t IntelHWComposerDrm::getCrtcId(int disp)
-{
-    if (mDrmFd < 0) {
-        ALOGE("%s: invalid drm FD\n", __func__);
-        return 0;
-    }
-
-    drmModeEncoderPtr encoder = NULL;
-    drmModeResPtr resources = NULL;
-    drmModeCrtcPtr crtc = NULL;
-    uint32_t crtc_id = 0;
-    int i = 0;
-
-    if ((encoder = getEncoder(disp)) == NULL)
-        return 0;
-
-    crtc_id = encoder->crtc_id;
-    freeEncoder(encoder);
-
-    if (crtc_id == 0) {
-        /* Query an available crtc to use */
-        if ((resources = drmModeGetResources(mDrmFd)) == NULL)
-            return 0;
-
-        if (!resources->crtcs)
-            return 0;
-
-        for (i = 0; i < resources->count_crtcs; i++) {
-            crtc = drmModeGetCrtc(mDrmFd, resources->crtcs[i]);
-            if (!crtc) {
-                LOGE("%s: Failed to get crtc %d, error is %s",
-                        __func__, resources->crtcs[i], strerror(errno));
-                continue;
-            }
-            if (crtc->buffer_id == 0) {
-                crtc_id = crtc->crtc_id;
-                drmModeFreeCrtc(crtc);
-                break;
-            }
-            drmModeFreeCrtc(crtc);
-        }
+        return false;
     }
-
-    return crtc_id;
+    return true;
 }
 
 // DISP separate functions
@@ -634,28 +469,20 @@ IntelHWComposerDrm::selectDisplayDrmMode(int disp, intel_display_mode_t *display
     // If mode no change, return current mode
     if (displayMode && !isModeChanged(mode, displayMode))
         return mode;
-    if (mHdmiConnector != NULL) {
-        freeConnector(mHdmiConnector);
-        mHdmiConnector = NULL;
-    }
-    drmModeConnectorPtr connector;
-    connector = getHdmiConnector();
-    if (!connector) {
+    intel_drm_connector_info_t connector;
+    if (!getHdmiConnector(&connector)) {
         ALOGW("%s: fail to get drm connector\n", __func__);
         return NULL;
     }
 
-    mode = getSelectMode(displayMode, connector);
-
-    if (!mode) {
+    drmModeModeInfo selected;
+    if (!mOutputCache.getMode(OUTPUT_HDMI, displayMode, &selected)) {
         ALOGW("%s: fail to get selected mode or any other mode! \n", __func__);
         return NULL;
     }
 
     // update current mode to be selected
-    setOutputMode(OUTPUT_HDMI, mode, 1);
-
-    //freeConnector(connector);
+    setOutputMode(OUTPUT_HDMI, &selected, 1);
 
     mode = getOutputMode(OUTPUT_HDMI);
     LOGD("%s: mode is %dx%d@%dHz, 0x%x\n", __func__,
@@ -665,55 +492,6 @@ IntelHWComposerDrm::selectDisplayDrmMode(int disp, intel_display_mode_t *display
 }
 
 // mode and Fb functions
-drmModeModeInfoPtr
-IntelHWComposerDrm::getSelectMode(intel_display_mode_t *displayMode,
-                                  drmModeConnectorPtr connector)
-{
-    int index = -1;
-    int i = 0;
-    int preferred = -1;
-    int max = 0;
-    drmModeModeInfoPtr mode;
-
-    // mode sort as big --> small
-    for (i = 0; i < connector->count_modes; i++) {
-        mode = &connector->modes[i];
-
-        // set to requested mode if found
-        if (displayMode &&
-            displayMode->vrefresh == mode->vrefresh &&
-            displayMode->hdisplay == mode->hdisplay &&
-            displayMode->vdisplay == mode->vdisplay &&
-            isDrmModeFlagsMatched(mode, displayMode)) {
-            index = i;
-            break;
-        }
-        // Get prefer mode
-        if (mode->type & DRM_MODE_TYPE_PREFERRED)
-            preferred = i;
-
-        // Get the max timing
-        if ((connector->modes[i].hdisplay > connector->modes[max].hdisplay) &&
-            (connector->modes[i].vdisplay > connector->modes[max].vdisplay)) {
-            max = i;
-        } else if (
-            (connector->modes[i].hdisplay == connector->modes[max].hdisplay) &&
-            (connector->modes[i].vdisplay == connector->modes[max].vdisplay) &&
-            (connector->modes[i].vrefresh > connector->modes[max].vrefresh)) {
-            max = i;
-        }
-    }
-    // could not find requested mode
-    if (index == -1) {
-        if (preferred != -1)
-            index = preferred;
-        else
-            index = max;
-    }
-    LOGD("Get the timing, %d, %d, %d", preferred, max, index);
-    return &connector->modes[index];
-}
-
 bool IntelHWComposerDrm::isModeChanged(drmModeModeInfoPtr mode,
                                        intel_display_mode_t *displayMode)
 {
@@ -734,24 +512,7 @@ bool IntelHWComposerDrm::isModeChanged(drmModeModeInfoPtr mode,
 
 bool IntelHWComposerDrm::isDrmModeFlagsMatched(drmModeModeInfoPtr mode, intel_display_mode_t* displayMode)
 {
-    if (mode == NULL || displayMode == NULL)
-        return true;
-    uint32_t flags = 0;
-    if (displayMode->interlace)
-        flags |= DRM_MODE_FLAG_INTERLACE;
-    if (displayMode->ratio == 2)
-        flags |= DRM_MODE_FLAG_PAR16_9;
-    else if (displayMode->ratio == 1)
-        flags |= DRM_MODE_FLAG_PAR4_3;
-
-    LOGD("%s: 0x%x, 0x%x", __func__, flags, mode->flags);
-    if (flags == 0)
-        return true;
-
-    if ((mode->flags & flags) == flags)
-        return true;
-
-    return false;
+    return IntelDrmOutputCache::isModeFlagsMatched(mode, displayMode);
 }
 
 bool IntelHWComposerDrm::setupDrmFb(int disp,
@@ -811,10 +572,7 @@ void IntelHWComposerDrm::deleteDrmFb(int disp)
 bool IntelHWComposerDrm::handleDisplayDisConnection(int disp)
 {
     if (disp == OUTPUT_HDMI) {
-        if (mHdmiConnector != NULL) {
-            drmModeFreeConnector(mHdmiConnector);
-            mHdmiConnector = NULL;
-        }
+        // the connector is re-probed by the next plug in
         drmModeModeInfo mode;
         drmModeConnection connection = DRM_MODE_DISCONNECTED;
         setOutputConnection(disp, connection);
@@ -832,30 +590,23 @@ bool IntelHWComposerDrm::detectDisplayConnection(int disp)
               "%s: detecting display %d drm mode info...\n", __func__, disp);
 
     //get mipi0 info
-    drmModeConnectorPtr connector = NULL;
-    drmModeModeInfoPtr mode = NULL;
-    uint32_t connector_type;
+    intel_drm_connector_info_t connector;
+    drmModeModeInfo mode;
 
-    connector = getConnector(disp);
-    if (!connector) {
+    if (!mOutputCache.getConnector(disp, &connector)) {
         ALOGW("%s: fail to get drm connector\n", __func__);
         return false;
     }
 
     //update connection status
-    setOutputConnection(disp, connector->connection);
+    setOutputConnection(disp, connector.connection);
 
-    if (connector->connection != DRM_MODE_CONNECTED) {
-        freeConnector(connector);
+    if (connector.connection != DRM_MODE_CONNECTED)
         return false;
-    }
 
     //update mode info
-    mode = getSelectMode(NULL, connector);
-    if (mode)
-        setOutputMode(disp, mode, 1);
-
-    freeConnector(connector);
+    if (mOutputCache.getMode(disp, NULL, &mode))
+        setOutputMode(disp, &mode, 1);
 
     return true;
 }
@@ -864,7 +615,7 @@ bool IntelHWComposerDrm::setDisplayDrmMode(int disp,
                                            uint32_t fb_handler,
                                            drmModeModeInfoPtr mode)
 {
-    drmModeConnectorPtr connector = NULL;
+    intel_drm_connector_info_t connector;
     uint32_t crtc_id = 0;
     uint32_t fb_id = 0;
 
@@ -879,19 +630,16 @@ bool IntelHWComposerDrm::setDisplayDrmMode(int disp,
     }
     if (disp != OUTPUT_HDMI)
         return false;
-    connector = getHdmiConnector();
-    if (!connector) {
+    if (!getHdmiConnector(&connector)) {
         ALOGW("%s: fail to get drm connector\n", __func__);
         return false;
     }
 
-    setOutputConnection(OUTPUT_HDMI, connector->connection);
+    setOutputConnection(OUTPUT_HDMI, connector.connection);
 
     // re-check connection status
-    if (connector->connection != DRM_MODE_CONNECTED) {
-        freeConnector(connector);
+    if (connector.connection != DRM_MODE_CONNECTED)
         return false;
-    }
 
     // get fb_id
     if (setupDrmFb(OUTPUT_HDMI, fb_handler, mode))
@@ -899,24 +647,23 @@ bool IntelHWComposerDrm::setDisplayDrmMode(int disp,
 
     if (!fb_id) {
         ALOGW("%s: fail to get drm fb id\n", __func__);
-        freeConnector(connector);
         return false;
     }
 
     // get crtc_id
-    crtc_id = getCrtcId(OUTPUT_HDMI);
+    crtc_id = mOutputCache.getCrtcId(OUTPUT_HDMI);
     if (!crtc_id) {
         ALOGW("%s: fail to get drm crtc id\n", __func__);
-        freeConnector(connector);
         return false;
     }
 
     // crtc mode setting
     int ret = drmModeSetCrtc(mDrmFd, crtc_id, fb_id, 0, 0,
-                   &connector->connector_id, 1, mode);
+                   &connector.connector_id, 1, mode);
     if (ret) {
         ALOGW("drm Mode Set Crtc Error: 0x%x!\n", ret);
-        freeConnector(connector);
+        // connector or crtc state may be stale
+        invalidateOutputCache();
         return false;
     }
 
@@ -930,37 +677,29 @@ bool IntelHWComposerDrm::setDisplayDpms(int disp, bool blank)
 
     if (disp == OUTPUT_MIPI0) {
         // Set MIPI On/Off
-        drmModeConnectorPtr connector;
-        drmModePropertyPtr props = NULL;
+        intel_drm_connector_info_t connector;
+        uint32_t prop_id;
 
-        if ((connector = getConnector(disp)) == NULL) {
+        if (!mOutputCache.getConnector(disp, &connector)) {
             ALOGW("%s: failed to get connector :%d!\n", __func__, disp);
             goto err;
         }
 
-        if (connector->connection != DRM_MODE_CONNECTED) {
+        if (connector.connection != DRM_MODE_CONNECTED) {
             ALOGW("%s: connector %d is not connected!\n", __func__, disp);
-            freeConnector(connector);
             goto err;
         }
 
-        for (int i = 0; i < connector->count_props; i++) {
-            props = drmModeGetProperty(mDrmFd, connector->props[i]);
-            if (!props) continue;
-
-            if (!strcmp(props->name, "DPMS")) {
-                ALOGD_IF(ALLOW_MONITOR_PRINT,
-                         "%s: %s %u", __func__,
-                         (blank == 0) ? "On" : "Off",
-                         connector->connector_id);
-                ret = drmModeConnectorSetProperty(mDrmFd,
-                                connector->connector_id,
-                                props->prop_id,
-                                (blank==0) ? DRM_MODE_DPMS_ON : DRM_MODE_DPMS_OFF);
-                drmModeFreeProperty(props);
-                break;
-            }
-            drmModeFreeProperty(props);
+        prop_id = mOutputCache.getDpmsPropId(disp);
+        if (prop_id) {
+            ALOGD_IF(ALLOW_MONITOR_PRINT,
+                     "%s: %s %u", __func__,
+                     (blank == 0) ? "On" : "Off",
+                     connector.connector_id);
+            ret = drmModeConnectorSetProperty(mDrmFd,
+                            connector.connector_id,
+                            prop_id,
+                            (blank==0) ? DRM_MODE_DPMS_ON : DRM_MODE_DPMS_OFF);
         }
     } else if (disp == OUTPUT_HDMI) {
         // Set HDMI On/Off
@@ -49,36 +49,24 @@
 #include <IntelHWCUEventObserver.h>
 #include <linux/psb_drm.h>
 #include <pthread.h>
+#include <utils/threads.h>
 #include <pvr2d.h>
+#include <IntelDrmOutputCache.h>
 #ifdef TARGET_HAS_MULTIPLE_DISPLAY
 #include <IntelExternalDisplayMonitor.h>
 #endif
 
-extern "C" {
-#include "xf86drm.h"
-#include "xf86drmMode.h"
-}
-
 #define PVR_DRM_DRIVER_NAME     "pvrsrvkm"
 
 #define DRM_PSB_GTT_MAP         0x0F
 #define DRM_PSB_GTT_UNMAP       0x10
 
-#define DRM_MODE_CONNECTOR_MIPI 15
-
 typedef enum {
     PVR_OVERLAY_VSYNC_INIT,
     PVR_OVERLAY_VSYNC_DONE,
     PVR_OVERLAY_VSYNC_PENDING,
 } eVsyncState;
 
-typedef enum {
-    OUTPUT_MIPI0 = 0,
-    OUTPUT_HDMI,
-    OUTPUT_MIPI1,
-    OUTPUT_MAX,
-} intel_drm_output_t;
-
 typedef enum {
     OVERLAY_MIPI0 = 0,
     OVERLAY_CLONE_MIPI0,
@@ -97,15 +85,6 @@ typedef struct {
     intel_overlay_mode_t old_display_mode;
 } intel_drm_output_state_t;
 
-// this structure must match MDSHDMITiming
-typedef struct {
-    uint32_t vrefresh;
-    uint32_t hdisplay;
-    uint32_t vdisplay;
-    uint32_t interlace;
-    uint32_t ratio;
-} intel_display_mode_t;
-
 class IntelHWComposer;
 
 /**
@@ -118,8 +97,8 @@ class IntelHWComposer;
 class IntelHWComposerDrm {
 private:
     int mDrmFd;
-    drmModeConnectorPtr mHdmiConnector;
     intel_drm_output_state_t mDrmOutputsState;
+    IntelDrmOutputCache mOutputCache;
     static IntelHWComposerDrm *mInstance;
     bool mIsPresentation;
     bool mOnlyHdmiHasVideo;
@@ -141,12 +120,7 @@ private:
 
 private:
      // basic function set
-    drmModeConnectorPtr getConnector(int disp);
-    drmModeConnectorPtr getHdmiConnector();
-    void freeConnector(drmModeConnectorPtr connector);
-    drmModeEncoderPtr getEncoder(int disp);
-    void freeEncoder(drmModeEncoderPtr encoder);
-    uint32_t getCrtcId(int disp);
+    bool getHdmiConnector(intel_drm_connector_info_t *info);
 
     // DISP separate functions
     bool setMIPIDpms(drmModeConnectorPtr connector, bool on);
@@ -156,8 +130,6 @@ private:
 
     // mode and Fb functions
     bool isModeChanged(drmModeModeInfoPtr mode, intel_display_mode_t *displayMode);
-    drmModeModeInfoPtr getSelectMode(intel_display_mode_t *displayMode,
-                                    drmModeConnectorPtr connector);
     bool setupDrmFb(int disp, uint32_t fb_handler, drmModeModeInfoPtr mode);
 
 public:
@@ -175,6 +147,8 @@ public:
 
     // default detect only called by initialize
     bool detectDrmModeInfo();
+    // drop cached DRM objects, on hotplug or after a failed modeset
+    void invalidateOutputCache();
 
     // Connection and Mode setting
     bool detectDisplayConnection(int disp);
@@ -55,7 +55,7 @@ IntelHWComposerLayer::IntelHWComposerLayer(hwc_layer_1_t *layer,
                                            IntelDisplayPlane *plane,
                                            int flags)
     : mHWCLayer(layer), mPlane(plane), mFlags(flags), mForceOverlay(false),
-      mLayerType(0), mFormat(0), mIsProtected(false)
+      mLayerType(0), mFormat(0), mTraits(0), mIsProtected(false)
 {
 
 }
@@ -97,6 +97,22 @@ IntelHWComposerLayerList::~IntelHWComposerLayerList()
     mInitialized = false;
 }
 
+void IntelHWComposerLayerList::updateLayerInfo(IntelHWComposerLayer& layer,
+                                               IMG_native_handle_t *grallocHandle)
+{
+    const IntelBufferInfoCache::Info& info = mBufferInfo.lookup(grallocHandle);
+
+    layer.mFormat = info.format;
+    layer.mTraits = info.traits;
+    layer.mIsProtected = info.isProtected;
+    if (!layer.mTraits)
+        layer.mLayerType = IntelHWComposerLayer::LAYER_TYPE_INVALID;
+    else if (layer.mTraits->isYUV())
+        layer.mLayerType = IntelHWComposerLayer::LAYER_TYPE_YUV;
+    else
+        layer.mLayerType = IntelHWComposerLayer::LAYER_TYPE_RGB;
+}
+
 void IntelHWComposerLayerList::updateLayerList(hwc_display_contents_1_t *layerList)
 {
     int numLayers;
@@ -113,6 +129,8 @@ void IntelHWComposerLayerList::updateLayerList(hwc_display_contents_1_t *layerLi
 
         delete [] mLayerList;
         mLayerList = 0;
+        mGeometry.clear();
+        mBandwidth.clear();
         return;
     }
 
@@ -129,6 +147,8 @@ void IntelHWComposerLayerList::updateLayerList(hwc_display_contents_1_t *layerLi
         mAttachedSpritePlanes = 0;
         mAttachedOverlayPlanes = 0;
         mNumAttachedPlanes = 0;
+        mGeometry.clear();
+        mBandwidth.clear();
         return;
     }
 
@@ -149,6 +169,7 @@ void IntelHWComposerLayerList::updateLayerList(hwc_display_contents_1_t *layerLi
         mLayerList[i].mNeedClearup = false;
         mLayerList[i].mLayerType = IntelHWComposerLayer::LAYER_TYPE_INVALID;
         mLayerList[i].mFormat = 0;
+        mLayerList[i].mTraits = 0;
         mLayerList[i].mIsProtected = false;
 
         // update layer format
@@ -158,36 +179,20 @@ void IntelHWComposerLayerList::updateLayerList(hwc_display_contents_1_t *layerLi
         if (!grallocHandle)
             continue;
 
-        mLayerList[i].mFormat = grallocHandle->iFormat;
-
-        if (grallocHandle->iFormat == HAL_PIXEL_FORMAT_YV12 ||
-            grallocHandle->iFormat == HAL_PIXEL_FORMAT_INTEL_HWC_NV12 ||
-            grallocHandle->iFormat == HAL_PIXEL_FORMAT_INTEL_HWC_NV12_VED ||
-            grallocHandle->iFormat == HAL_PIXEL_FORMAT_INTEL_HWC_YUY2 ||
-            grallocHandle->iFormat == HAL_PIXEL_FORMAT_INTEL_HWC_UYVY ||
-            grallocHandle->iFormat == HAL_PIXEL_FORMAT_INTEL_HWC_I420 ||
-            grallocHandle->iFormat == HAL_PIXEL_FORMAT_INTEL_HWC_NV12_TILE) {
-            mLayerList[i].mLayerType = IntelHWComposerLayer::LAYER_TYPE_YUV;
+        updateLayerInfo(mLayerList[i], grallocHandle);
+        if (mLayerList[i].mLayerType == IntelHWComposerLayer::LAYER_TYPE_YUV)
             numYUVLayers++;
-        } else if (grallocHandle->iFormat == HAL_PIXEL_FORMAT_RGB_565 ||
-            grallocHandle->iFormat == HAL_PIXEL_FORMAT_BGRA_8888 ||
-            grallocHandle->iFormat == HAL_PIXEL_FORMAT_BGRX_8888 ||
-            grallocHandle->iFormat == HAL_PIXEL_FORMAT_RGBX_8888 ||
-            grallocHandle->iFormat == HAL_PIXEL_FORMAT_RGBA_8888) {
-            mLayerList[i].mLayerType = IntelHWComposerLayer::LAYER_TYPE_RGB;
+        else if (mLayerList[i].mLayerType == IntelHWComposerLayer::LAYER_TYPE_RGB)
             numRGBLayers++;
-        } else
-            ALOGW("updateLayerList: unknown format 0x%x", grallocHandle->iFormat);
-
-        // check if a protected layer
-        if (grallocHandle->usage & GRALLOC_USAGE_PROTECTED)
-            mLayerList[i].mIsProtected = true;
     }
 
     mNumLayers = numLayers;
     mNumRGBLayers = numRGBLayers;
     mNumYUVLayers = numYUVLayers;
     mNumAttachedPlanes = 0;
+
+    mGeometry.update(layerList, numLayers);
+    mBandwidth.update(layerList, numLayers, mGeometry);
 }
 
 bool IntelHWComposerLayerList::invalidatePlanes()
@@ -358,6 +363,16 @@ int IntelHWComposerLayerList::getLayerFormat(int index) const
     return mLayerList[index].mFormat;
 }
 
+const IntelFormatTraits* IntelHWComposerLayerList::getLayerTraits(int index) const
+{
+    if (!initCheck() || index < 0 || index >= mNumLayers) {
+        ALOGE("%s: Invalid parameters\n", __func__);
+        return 0;
+    }
+
+    return mLayerList[index].mTraits;
+}
+
 bool IntelHWComposerLayerList::isProtectedLayer(int index) const
 {
     if (!initCheck() || index < 0 || index >= mNumLayers) {
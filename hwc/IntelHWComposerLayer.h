@@ -50,6 +50,10 @@
 #include <string.h>
 #include <hardware/hwcomposer.h>
 #include <IntelDisplayPlaneManager.h>
+#include <IntelFormatTraits.h>
+#include <IntelBufferInfoCache.h>
+#include <IntelLayerGeometry.h>
+#include <IntelBandwidthModel.h>
 
 class IntelHWComposerLayer {
 public:
@@ -69,6 +73,7 @@ private:
     // layer info
     int mLayerType;
     int mFormat;
+    const IntelFormatTraits *mTraits;
     bool mIsProtected;
 public:
     IntelHWComposerLayer();
@@ -91,6 +96,14 @@ private:
     int mAttachedOverlayPlanes;
     int mNumAttachedPlanes;
     bool mInitialized;
+
+    IntelBufferInfoCache mBufferInfo;
+
+    IntelLayerGeometry mGeometry;
+    IntelBandwidthModel mBandwidth;
+private:
+    void updateLayerInfo(IntelHWComposerLayer& layer,
+                         IMG_native_handle_t *grallocHandle);
 public:
     IntelHWComposerLayerList(IntelDisplayPlaneManager *pm);
     ~IntelHWComposerLayerList();
@@ -108,6 +121,7 @@ public:
     bool getNeedClearup(int index);
     int getLayerType(int index) const;
     int getLayerFormat(int index) const;
+    const IntelFormatTraits* getLayerTraits(int index) const;
     bool isProtectedLayer(int index) const;
     int getLayersCount() const { return mNumLayers; }
     int getRGBLayerCount() const;
@@ -115,6 +129,10 @@ public:
     int getAttachedPlanesCount() const { return mNumAttachedPlanes; }
     int getAttachedSpriteCount() const { return mAttachedSpritePlanes; }
     int getAttachedOverlayCount() const { return mAttachedOverlayPlanes; }
+    uint32_t getBufferInfoHits() const { return mBufferInfo.getHits(); }
+    uint32_t getBufferInfoMisses() const { return mBufferInfo.getMisses(); }
+    const IntelLayerGeometry& getGeometry() const { return mGeometry; }
+    const IntelBandwidthModel& getBandwidth() const { return mBandwidth; }
 };
 
 #endif /*__INTEL_HWCOMPOSER_LAYER_H__*/
@@ -51,12 +51,19 @@
 
 #include <cutils/log.h>
 #include <cutils/atomic.h>
+#include <cutils/properties.h>
 
 #include <IntelHWComposer.h>
 #include <IntelHWComposerCfg.h>
+#include <IntelConfigSnapshot.h>
+
+// how often the property tunables are re-read
+#define HWC_PROP_RELOAD_PERIOD    s2ns(1)
 
 /* global hwcomposer cfg info */
 hwc_cfg cfg;
+IntelConfigSnapshot propCfg(hwc_load_prop_cfg);
+static android::sp<IntelConfigReloader> propCfgReloader;
 
 static void dump_layer(hwc_layer_1_t const* l)
 {
@@ -78,6 +85,9 @@ static int hwc_prepare(struct hwc_composer_device_1 *dev,
         goto prepare_out;
     }
 
+    // the tunables stay the same from here to the end of set()
+    propCfg.beginFrame();
+
 #ifdef INTEL_RGB_OVERLAY
     {
         IntelHWCWrapper* wrapper = hwc->getWrapper();
@@ -322,6 +332,8 @@ static int hwc_device_open(const struct hw_module_t* module, const char* name,
         goto hwc_init_out;
     }
 
+    propCfg.init();
+
     if (!strcmp(name, HWC_HARDWARE_COMPOSER)) {
         IntelHWComposer *hwc = new IntelHWComposer();
         if (!hwc) {
@@ -369,6 +381,9 @@ static int hwc_device_open(const struct hw_module_t* module, const char* name,
         hwc->hwc_composer_device_1_t::reserved_proc[1] = (void*)hwc_setFramecount;
         *device = &hwc->hwc_composer_device_1_t::common;
         status = 0;
+
+        propCfgReloader = new IntelConfigReloader(&propCfg,
+                                                  HWC_PROP_RELOAD_PERIOD);
     }
 hwc_init_out:
     return status;
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cutils/log.h>
+
+#include "IntelHotplugHandler.h"
+
+IntelHotplugHandler::IntelHotplugHandler(IntelHotplugListener *listener) :
+    mHead(0), mCount(0), mExiting(false), mListener(listener)
+{
+    ALOGV("Hotplug handler created");
+}
+
+IntelHotplugHandler::~IntelHotplugHandler()
+{
+
+}
+
+bool IntelHotplugHandler::post(int type, const intel_display_mode_t *mode)
+{
+    android::Mutex::Autolock _l(mLock);
+
+    if (mExiting)
+        return false;
+
+    if (mCount == EVENT_QUEUE_SIZE) {
+        // only the latest connection state matters, drop the oldest event
+        ALOGW("%s: hotplug queue full, dropping event %d\n",
+              __func__, mQueue[mHead].type);
+        mHead = (mHead + 1) % EVENT_QUEUE_SIZE;
+        mCount--;
+    }
+
+    hotplug_event *event = &mQueue[(mHead + mCount) % EVENT_QUEUE_SIZE];
+    event->type = type;
+    event->hasMode = mode != NULL;
+    if (mode)
+        event->mode = *mode;
+    event->queued = systemTime(CLOCK_MONOTONIC);
+    mCount++;
+
+    mCondition.signal();
+    return true;
+}
+
+void IntelHotplugHandler::requestExit()
+{
+    android::Mutex::Autolock _l(mLock);
+
+    mExiting = true;
+    mCount = 0;
+    android::Thread::requestExit();
+    mCondition.signal();
+}
+
+bool IntelHotplugHandler::threadLoop()
+{
+    hotplug_event event;
+
+    { // scope for lock
+        android::Mutex::Autolock _l(mLock);
+        while (!mCount && !mExiting) {
+            mCondition.wait(mLock);
+        }
+        if (mExiting)
+            return false;
+        event = mQueue[mHead];
+        mHead = (mHead + 1) % EVENT_QUEUE_SIZE;
+        mCount--;
+    }
+
+    intel_display_mode_t *mode = event.hasMode ? &event.mode : NULL;
+    nsecs_t start = systemTime(CLOCK_MONOTONIC);
+    bool ret;
+
+    switch (event.type) {
+    case EVENT_PLUG_IN:
+        ret = mListener->handleHotplugEvent(1, mode);
+        break;
+    case EVENT_PLUG_OUT:
+        ret = mListener->handleHotplugEvent(0, NULL);
+        break;
+    case EVENT_MODE_CHANGE:
+        ret = mListener->handleDynamicModeSetting(mode);
+        break;
+    default:
+        ALOGW("%s: unknown hotplug event %d\n", __func__, event.type);
+        return true;
+    }
+
+    nsecs_t end = systemTime(CLOCK_MONOTONIC);
+    ALOGD("%s: event %d %s, queued %lld us, handled in %lld us\n",
+          __func__, event.type, ret ? "done" : "failed",
+          (long long)ns2us(start - event.queued),
+          (long long)ns2us(end - start));
+
+    return true;
+}
+
+android::status_t IntelHotplugHandler::readyToRun()
+{
+    return android::NO_ERROR;
+}
+
+void IntelHotplugHandler::onFirstRef()
+{
+    run("HWC Hotplug Handler", android::PRIORITY_DISPLAY);
+}
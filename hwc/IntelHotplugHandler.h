@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __INTEL_HOTPLUG_HANDLER_H__
+#define __INTEL_HOTPLUG_HANDLER_H__
+
+#include <utils/threads.h>
+#include <IntelDrmOutputCache.h>
+
+// does the work for the queued events, called on the handler thread
+class IntelHotplugListener {
+public:
+    virtual ~IntelHotplugListener() {}
+    virtual bool handleHotplugEvent(int hpd, void *data) = 0;
+    virtual bool handleDynamicModeSetting(void *data) = 0;
+};
+
+/*
+ * Runs HDMI plug-in/plug-out handling (FB allocation, mode setting and
+ * waiting for SurfaceFlinger to drop the external display) off the
+ * thread that received the event, so composition of the primary display
+ * is never blocked by a hotplug.
+ */
+class IntelHotplugHandler : public android::Thread
+{
+public:
+    enum {
+        EVENT_PLUG_OUT = 0,
+        EVENT_PLUG_IN,
+        EVENT_MODE_CHANGE,
+    };
+private:
+    enum {
+        EVENT_QUEUE_SIZE = 8,
+    };
+    struct hotplug_event {
+        int type;
+        bool hasMode;
+        intel_display_mode_t mode;
+        nsecs_t queued;
+    };
+public:
+    IntelHotplugHandler(IntelHotplugListener *listener);
+    virtual ~IntelHotplugHandler();
+    // queue an event, mode may be NULL; returns immediately
+    bool post(int type, const intel_display_mode_t *mode);
+    // wake the thread and have it exit once the event in progress, if
+    // any, is handled. queued events are dropped; join() to wait
+    virtual void requestExit();
+private:
+    virtual bool threadLoop();
+    virtual android::status_t readyToRun();
+    virtual void onFirstRef();
+private:
+    mutable android::Mutex mLock;
+    android::Condition mCondition;
+    hotplug_event mQueue[EVENT_QUEUE_SIZE];
+    int mHead;
+    int mCount;
+    bool mExiting;
+    IntelHotplugListener *mListener;
+};
+
+#endif /*__INTEL_HOTPLUG_HANDLER_H__*/
@@ -0,0 +1,338 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <string.h>
+#include <cutils/log.h>
+
+#include <IntelHWComposerCfg.h>
+#include <IntelLayerGeometry.h>
+
+IntelLayerGeometry::IntelLayerGeometry()
+{
+    clear();
+}
+
+void IntelLayerGeometry::clear()
+{
+    mList = 0;
+    mNumLayers = 0;
+    mValid = false;
+    mOpaque = 0;
+    mOccluded = 0;
+    mOpaqueCover = -1;
+    mOverlapPairs = 0;
+}
+
+bool IntelLayerGeometry::isEmpty(const hwc_rect_t& r)
+{
+    return r.right <= r.left || r.bottom <= r.top;
+}
+
+bool IntelLayerGeometry::intersects(const hwc_rect_t& a, const hwc_rect_t& b)
+{
+    return !(b.right <= a.left ||
+             b.left >= a.right ||
+             b.top >= a.bottom ||
+             b.bottom <= a.top);
+}
+
+bool IntelLayerGeometry::contains(const hwc_rect_t& outer,
+                                  const hwc_rect_t& inner)
+{
+    return outer.left <= inner.left && outer.top <= inner.top &&
+           outer.right >= inner.right && outer.bottom >= inner.bottom;
+}
+
+// remove r from the pieces, false if they no longer fit
+bool IntelLayerGeometry::subtract(hwc_rect_t *pieces, int& count,
+                                  const hwc_rect_t& r)
+{
+    hwc_rect_t out[MAX_PIECES];
+    int n = 0;
+
+    for (int p = 0; p < count; p++) {
+        const hwc_rect_t& s = pieces[p];
+        hwc_rect_t cut[4];
+        int cuts = 0;
+
+        if (!intersects(s, r)) {
+            cut[cuts++] = s;
+        } else {
+            int top = s.top > r.top ? s.top : r.top;
+            int bottom = s.bottom < r.bottom ? s.bottom : r.bottom;
+
+            if (s.top < r.top) {
+                hwc_rect_t c = { s.left, s.top, s.right, r.top };
+                cut[cuts++] = c;
+            }
+            if (s.bottom > r.bottom) {
+                hwc_rect_t c = { s.left, r.bottom, s.right, s.bottom };
+                cut[cuts++] = c;
+            }
+            if (s.left < r.left) {
+                hwc_rect_t c = { s.left, top, r.left, bottom };
+                cut[cuts++] = c;
+            }
+            if (s.right > r.right) {
+                hwc_rect_t c = { r.right, top, s.right, bottom };
+                cut[cuts++] = c;
+            }
+        }
+
+        if (n + cuts > MAX_PIECES)
+            return false;
+        for (int i = 0; i < cuts; i++)
+            out[n++] = cut[i];
+    }
+
+    memcpy(pieces, out, n * sizeof(hwc_rect_t));
+    count = n;
+    return true;
+}
+
+bool IntelLayerGeometry::isOpaque(int index) const
+{
+    const hwc_layer_1_t& layer = mList->hwLayers[index];
+
+    if (layer.planeAlpha != 0xff)
+        return false;
+
+    if (layer.blending == HWC_BLENDING_NONE)
+        return true;
+
+    // blending has no effect without per pixel alpha
+    IMG_native_handle_t *handle = (IMG_native_handle_t*)layer.handle;
+    if (!handle)
+        return false;
+
+    const IntelFormatTraits *traits = IntelFormatTraits::get(handle->iFormat);
+    return traits && !traits->has(IntelFormatTraits::FORMAT_ALPHA);
+}
+
+void IntelLayerGeometry::update(hwc_display_contents_1_t *list, int numLayers)
+{
+    clear();
+
+    if (!list || numLayers <= 0)
+        return;
+
+    mList = list;
+    mNumLayers = numLayers;
+
+    // the framebuffer target spans the whole display
+    size_t last = list->numHwLayers - 1;
+    if (list->hwLayers[last].compositionType == HWC_FRAMEBUFFER_TARGET) {
+        const hwc_rect_t& display = list->hwLayers[last].displayFrame;
+        for (int i = numLayers - 1; i >= 0; i--) {
+            if (isOpaque(i) &&
+                contains(list->hwLayers[i].displayFrame, display)) {
+                mOpaqueCover = i;
+                break;
+            }
+        }
+    }
+
+    if (numLayers > MAX_LAYERS) {
+        ALOGD_IF(ALLOW_HWC_PRINT, "%s: %d layers, testing frames directly\n",
+                 __func__, numLayers);
+        return;
+    }
+
+    // sort by top edge, insertion sort is fine for a few dozen layers
+    int order[MAX_LAYERS];
+    int count = 0;
+    for (int i = 0; i < numLayers; i++) {
+        mOverlaps[i] = 0;
+        const hwc_rect_t& r = list->hwLayers[i].displayFrame;
+        if (isEmpty(r))
+            continue;
+        int j = count++;
+        while (j > 0 && list->hwLayers[order[j - 1]].displayFrame.top > r.top) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    // layers still crossing the sweep line
+    int active[MAX_LAYERS];
+    int numActive = 0;
+
+    for (int n = 0; n < count; n++) {
+        int i = order[n];
+        const hwc_rect_t& r = list->hwLayers[i].displayFrame;
+        int kept = 0;
+
+        for (int k = 0; k < numActive; k++) {
+            int j = active[k];
+            const hwc_rect_t& s = list->hwLayers[j].displayFrame;
+
+            // ended above this layer, and above all that follow
+            if (s.bottom <= r.top)
+                continue;
+            active[kept++] = j;
+
+            if (s.right <= r.left || s.left >= r.right)
+                continue;
+
+            mOverlaps[i] |= bit(j);
+            mOverlaps[j] |= bit(i);
+            mOverlapPairs++;
+        }
+
+        active[kept++] = i;
+        numActive = kept;
+    }
+
+    for (int i = 0; i < numLayers; i++) {
+        if (isOpaque(i))
+            mOpaque |= bit(i);
+    }
+
+    mValid = true;
+
+    // only the opaque layers above that intersect a layer can hide it
+    for (int i = 0; i < numLayers; i++) {
+        uint64_t above = getOverlapsAbove(i) & mOpaque;
+        hwc_rect_t pieces[MAX_PIECES];
+        int count = 1;
+
+        if (!above)
+            continue;
+
+        pieces[0] = list->hwLayers[i].displayFrame;
+        for (int j = i + 1; count && above; j++) {
+            if (!(above & bit(j)))
+                continue;
+            above &= ~bit(j);
+            if (!subtract(pieces, count, list->hwLayers[j].displayFrame))
+                break;
+        }
+
+        if (!count)
+            mOccluded |= bit(i);
+    }
+}
+
+uint64_t IntelLayerGeometry::bruteOverlaps(int index) const
+{
+    uint64_t overlaps = 0;
+    const hwc_rect_t& r = mList->hwLayers[index].displayFrame;
+
+    if (isEmpty(r))
+        return 0;
+
+    // only the first MAX_LAYERS layers can be reported in a mask
+    for (int i = 0; i < mNumLayers && i < MAX_LAYERS; i++) {
+        const hwc_rect_t& s = mList->hwLayers[i].displayFrame;
+        if (i != index && !isEmpty(s) && intersects(s, r))
+            overlaps |= bit(i);
+    }
+    return overlaps;
+}
+
+bool IntelLayerGeometry::bruteOccluded(int index) const
+{
+    hwc_rect_t pieces[MAX_PIECES];
+    int count = 1;
+
+    pieces[0] = mList->hwLayers[index].displayFrame;
+    if (isEmpty(pieces[0]))
+        return false;
+
+    for (int i = index + 1; count && i < mNumLayers; i++) {
+        if (!isOpaque(i))
+            continue;
+        if (!subtract(pieces, count, mList->hwLayers[i].displayFrame))
+            return false;
+    }
+    return !count;
+}
+
+bool IntelLayerGeometry::intersects(int a, int b) const
+{
+    if (a < 0 || b < 0 || a >= mNumLayers || b >= mNumLayers || a == b)
+        return false;
+
+    if (mValid)
+        return (mOverlaps[a] & bit(b)) != 0;
+
+    const hwc_rect_t& ra = mList->hwLayers[a].displayFrame;
+    const hwc_rect_t& rb = mList->hwLayers[b].displayFrame;
+    return !isEmpty(ra) && !isEmpty(rb) && intersects(ra, rb);
+}
+
+uint64_t IntelLayerGeometry::getOverlaps(int index) const
+{
+    if (index < 0 || index >= mNumLayers)
+        return 0;
+
+    return mValid ? mOverlaps[index] : bruteOverlaps(index);
+}
+
+uint64_t IntelLayerGeometry::getOverlapsBelow(int index) const
+{
+    if (index >= MAX_LAYERS)
+        return getOverlaps(index);
+    return getOverlaps(index) & (bit(index) - 1);
+}
+
+uint64_t IntelLayerGeometry::getOverlapsAbove(int index) const
+{
+    if (index >= MAX_LAYERS)
+        return 0;
+    return getOverlaps(index) & ~((bit(index) << 1) - 1);
+}
+
+bool IntelLayerGeometry::isSandwiched(int index) const
+{
+    return getOverlapsBelow(index) && getOverlapsAbove(index);
+}
+
+bool IntelLayerGeometry::isOccluded(int index) const
+{
+    if (index < 0 || index >= mNumLayers)
+        return false;
+
+    if (mValid)
+        return (mOccluded & bit(index)) != 0;
+
+    return bruteOccluded(index);
+}
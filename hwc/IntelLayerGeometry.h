@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __INTEL_LAYER_GEOMETRY_H__
+#define __INTEL_LAYER_GEOMETRY_H__
+
+#include <stdint.h>
+#include <hardware/hwcomposer.h>
+#include <hal_public.h>
+#include <IntelFormatTraits.h>
+
+/*
+ * Overlap facts of a layer list, computed once per geometry change.
+ *
+ * Display frames are swept top to bottom, so a layer is only tested
+ * against the layers whose rows it shares. The result is kept as one
+ * bit mask of intersecting layers per layer (bit n is hwLayers[n]),
+ * which answers the plane eligibility checks without walking the list
+ * again. Layers are indexed in z-order, so the bits below a layer's own
+ * bit are the layers under it.
+ *
+ * A layer is occluded when the union of the opaque layers above it
+ * covers its frame. Opaque means no blending, or a constant alpha of 1
+ * on a format without an alpha channel.
+ *
+ * Lists longer than MAX_LAYERS are answered by testing frames directly.
+ */
+class IntelLayerGeometry {
+public:
+    enum {
+        MAX_LAYERS = 64,
+        // rect pieces tracked while subtracting opaque frames, a frame
+        // cut into more pieces is treated as visible
+        MAX_PIECES = 32,
+    };
+
+private:
+    hwc_display_contents_1_t *mList;
+    int mNumLayers;
+    bool mValid;
+    uint64_t mOverlaps[MAX_LAYERS];
+    uint64_t mOpaque;
+    // layers covered by the opaque layers above them
+    uint64_t mOccluded;
+    // topmost opaque layer covering the display, -1 if none
+    int mOpaqueCover;
+    uint32_t mOverlapPairs;
+
+    static bool isEmpty(const hwc_rect_t& r);
+    static bool intersects(const hwc_rect_t& a, const hwc_rect_t& b);
+    static bool contains(const hwc_rect_t& outer, const hwc_rect_t& inner);
+    static bool subtract(hwc_rect_t *pieces, int& count, const hwc_rect_t& r);
+    bool isOpaque(int index) const;
+    uint64_t bruteOverlaps(int index) const;
+    bool bruteOccluded(int index) const;
+public:
+    IntelLayerGeometry();
+
+    // numLayers leading layers of the list take part, usually all but
+    // the framebuffer target
+    void update(hwc_display_contents_1_t *list, int numLayers);
+    void clear();
+
+    static uint64_t bit(int index) { return (uint64_t)1 << index; }
+
+    bool intersects(int a, int b) const;
+    uint64_t getOverlaps(int index) const;
+    uint64_t getOverlapsBelow(int index) const;
+    uint64_t getOverlapsAbove(int index) const;
+
+    // intersects both a layer under it and a layer above it
+    bool isSandwiched(int index) const;
+    // hidden by the opaque layers above it
+    bool isOccluded(int index) const;
+    int getOpaqueCover() const { return mOpaqueCover; }
+
+    uint32_t getOverlapPairs() const { return mOverlapPairs; }
+};
+
+#endif /*__INTEL_LAYER_GEOMETRY_H__*/
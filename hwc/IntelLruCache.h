@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __INTEL_LRU_CACHE_H__
+#define __INTEL_LRU_CACHE_H__
+
+#include <stdint.h>
+#include <utils/KeyedVector.h>
+#include <utils/RefBase.h>
+
+/*
+ * Up to a fixed number of refcounted entries, the least recently used
+ * one is dropped first to make room. A dropped entry that is still
+ * referenced elsewhere lives on until that reference goes away.
+ * Not locked, the owner serializes the calls.
+ */
+template <class K, class T>
+class IntelLruCache {
+public:
+    struct Stats {
+        uint32_t hits;
+        uint32_t misses;
+        uint32_t evictions;
+    };
+private:
+    struct Entry {
+        android::sp<T> value;
+        uint32_t lastUsed;
+    };
+    android::KeyedVector<K, Entry> mEntries;
+    size_t mCapacity;
+    uint32_t mUse;
+    Stats mStats;
+public:
+    IntelLruCache(size_t capacity) : mCapacity(capacity), mUse(0) {
+        mStats.hits = 0;
+        mStats.misses = 0;
+        mStats.evictions = 0;
+    }
+
+    // NULL on a miss, which the caller follows with add()
+    android::sp<T> get(const K& key) {
+        ssize_t index = mEntries.indexOfKey(key);
+        if (index < 0) {
+            mStats.misses++;
+            return NULL;
+        }
+        mStats.hits++;
+        Entry& entry = mEntries.editValueAt(index);
+        entry.lastUsed = ++mUse;
+        return entry.value;
+    }
+
+    void add(const K& key, const android::sp<T>& value) {
+        if (mEntries.indexOfKey(key) < 0 && mEntries.size() >= mCapacity) {
+            size_t lru = 0;
+            for (size_t i = 1; i < mEntries.size(); i++) {
+                if (mEntries.valueAt(i).lastUsed < mEntries.valueAt(lru).lastUsed)
+                    lru = i;
+            }
+            mEntries.removeItemsAt(lru);
+            mStats.evictions++;
+        }
+        Entry entry;
+        entry.value = value;
+        entry.lastUsed = ++mUse;
+        mEntries.replaceValueFor(key, entry);
+    }
+
+    void clear() { mEntries.clear(); }
+    size_t size() const { return mEntries.size(); }
+    size_t capacity() const { return mCapacity; }
+    const Stats& stats() const { return mStats; }
+};
+
+#endif /*__INTEL_LRU_CACHE_H__*/
@@ -33,6 +33,7 @@
 #include <IntelDisplayDevice.h>
 #include <IntelOverlayUtil.h>
 #include <IntelHWComposerCfg.h>
+#include <IntelConfigSnapshot.h>
 #define INTEL_EXT_SF_ANIMATION_HINT
 
 IntelMIPIDisplayDevice::IntelMIPIDisplayDevice(IntelBufferManager *bm,
@@ -43,7 +44,11 @@ IntelMIPIDisplayDevice::IntelMIPIDisplayDevice(IntelBufferManager *bm,
                                        uint32_t index)
                                      : IntelDisplayDevice(pm, drm, bm, gm, index),
                                        mExtendedModeInfo(extinfo),
-                                       mVideoSentToWidi(false)
+                                       mVideoSentToWidi(false),
+                                       mCulledLayers(0),
+                                       mCulledLayersTotal(0),
+                                       mCursorSkipLayers(0),
+                                       mCursorSkippedCompositions(0)
 {
     ALOGD_IF(ALLOW_HWC_PRINT, "%s\n", __func__);
 
@@ -114,6 +119,7 @@ bool IntelMIPIDisplayDevice::isSpriteLayer(hwc_display_contents_1_t *list,
     bool needClearFb = false;
     bool forceSprite = false;
     bool useSprite = false;
+    const IntelFormatTraits *traits;
 
     int srcWidth, srcHeight;
     int dstWidth, dstHeight;
@@ -130,7 +136,8 @@ bool IntelMIPIDisplayDevice::isSpriteLayer(hwc_display_contents_1_t *list,
     }
 
     // check whether pixel format is supported RGB formats
-    if (mLayerList->getLayerType(index) != IntelHWComposerLayer::LAYER_TYPE_RGB) {
+    traits = mLayerList->getLayerTraits(index);
+    if (!traits || !traits->has(IntelFormatTraits::FORMAT_SPRITE)) {
         ALOGD_IF(ALLOW_HWC_PRINT,
                 "%s: invalid format 0x%x\n", __func__, grallocHandle->iFormat);
         useSprite = false;
@@ -261,6 +268,7 @@ bool IntelMIPIDisplayDevice::isOverlayLayer(hwc_display_contents_1_t *list,
     bool needClearFb = false;
     bool forceOverlay = false;
     bool useOverlay = false;
+    const IntelFormatTraits *traits;
 
     if (!list || !layer)
         return false;
@@ -275,7 +283,8 @@ bool IntelMIPIDisplayDevice::isOverlayLayer(hwc_display_contents_1_t *list,
     layer->hints = 0;
 
     // check format
-    if (mLayerList->getLayerType(index) != IntelHWComposerLayer::LAYER_TYPE_YUV) {
+    traits = mLayerList->getLayerTraits(index);
+    if (!traits || !traits->has(IntelFormatTraits::FORMAT_OVERLAY)) {
         useOverlay = false;
         goto out_check;
     }
@@ -285,7 +294,7 @@ bool IntelMIPIDisplayDevice::isOverlayLayer(hwc_display_contents_1_t *list,
         forceOverlay = true;
 
     // check buffer usage
-    if ((grallocHandle->usage & GRALLOC_USAGE_PROTECTED) || isForceOverlay(layer)) {
+    if (mLayerList->isProtectedLayer(index) || isForceOverlay(layer)) {
         ALOGD_IF(ALLOW_HWC_PRINT, "isOverlayLayer: protected video/force Overlay");
         mDrm->setDisplayIed(true);
         forceOverlay = true;
@@ -321,26 +330,35 @@ bool IntelMIPIDisplayDevice::isOverlayLayer(hwc_display_contents_1_t *list,
         goto out_check;
     }
 
-    // fall back if YUV Layer is in the middle of
-    // other layers and covers the layers under it.
-    if (!forceOverlay && index > 0 && index < (mLayerList->getLayersCount()-1)) {
-        for (int i = index - 1; i >= 0; i--) {
-            if (areLayersIntersecting(layer, &list->hwLayers[i])) {
-                useOverlay = false;
-                goto out_check;
-            }
+    // take the layers the z-order solver picked. without a solution
+    // fall back if YUV Layer is in the middle of other layers and
+    // covers the layers under it.
+    if (!forceOverlay && mZOrderSolver.isValid()) {
+        if (!mZOrderSolver.isOverlayLayer(index)) {
+            useOverlay = false;
+            goto out_check;
+        }
+    } else if (!forceOverlay && index > 0 &&
+               index < (mLayerList->getLayersCount()-1)) {
+        if (mLayerList->getGeometry().getOverlapsBelow(index)) {
+            useOverlay = false;
+            goto out_check;
         }
     }
 
     // check whether layer are covered by layers above it
     // if layer is covered by a layer which needs blending,
     // clear corresponding region in frame buffer
-    for (size_t i = index + 1; i < (size_t)mLayerList->getLayersCount(); i++) {
-        if (areLayersIntersecting(&list->hwLayers[i], layer)) {
+    {
+        uint64_t above = mLayerList->getGeometry().getOverlapsAbove(index);
+        for (int i = index + 1; above && i < mLayerList->getLayersCount(); i++) {
+            if (!(above & IntelLayerGeometry::bit(i)))
+                continue;
+            above &= ~IntelLayerGeometry::bit(i);
             ALOGD_IF(ALLOW_HWC_PRINT,
                 "%s: overlay %d is covered by layer %d\n", __func__, index, i);
-                if (list->hwLayers[i].blending !=  HWC_BLENDING_NONE)
-                    mLayerList->setNeedClearup(index, true);
+            if (list->hwLayers[i].blending !=  HWC_BLENDING_NONE)
+                mLayerList->setNeedClearup(index, true);
         }
     }
 
@@ -457,13 +475,9 @@ bool IntelMIPIDisplayDevice::isRGBOverlayLayer(hwc_display_contents_1_t *list,
     }
 
     // check whether this layer has intersection with other layers
-    for (size_t i = 0; i < list->numHwLayers - 1; i++) {
-        if (i == index)
-            continue;
-        if (areLayersIntersecting(&list->hwLayers[i], layer)) {
-            useRGBOverlay = false;
-            goto out_check;
-        }
+    if (mLayerList->getGeometry().getOverlaps(index)) {
+        useRGBOverlay = false;
+        goto out_check;
     }
 
     useRGBOverlay = true;
@@ -478,6 +492,57 @@ out_check:
 }
 
 
+// Pick the overlay layers for the new geometry. Only layers which pass
+// the overlay checks of isOverlayLayer() are candidates; forced overlay
+// layers and modes with their own overlay policy keep the old rules.
+void IntelMIPIDisplayDevice::solveZOrder(hwc_display_contents_1_t *list)
+{
+    uint64_t candidates = 0;
+    int count = mLayerList->getLayersCount();
+
+    mZOrderSolver.reset();
+
+    if (!list || mVideoSeekingActive ||
+        mDrm->getDisplayMode() == OVERLAY_EXTEND ||
+        mDrm->getDisplayMode() == OVERLAY_CLONE_MIPI0)
+        return;
+
+    for (int i = 0; i < count; i++) {
+        hwc_layer_1_t *layer = &list->hwLayers[i];
+        const IntelFormatTraits *traits = mLayerList->getLayerTraits(i);
+
+        if (mLayerList->isProtectedLayer(i) || isForceOverlay(layer))
+            return;
+
+        if (!layer->handle || !isHWCLayer(layer) ||
+            !traits || !traits->has(IntelFormatTraits::FORMAT_OVERLAY) ||
+            layer->blending != HWC_BLENDING_NONE ||
+            (layer->flags & HWC_SKIP_LAYER) ||
+            layer->visibleRegionScreen.numRects > 1)
+            continue;
+
+        if (mExtendedModeInfo->widiExtHandle != NULL &&
+            mExtendedModeInfo->widiExtHandle ==
+                (IMG_native_handle_t*)layer->handle)
+            continue;
+
+        if (i == mCursorLayer)
+            continue;
+
+        if (i < IntelLayerGeometry::MAX_LAYERS)
+            candidates |= IntelLayerGeometry::bit(i);
+    }
+
+    if (!candidates)
+        return;
+
+    mZOrderSolver.solve(count, mLayerList->getGeometry(),
+                        mLayerList->getBandwidth(), candidates,
+                        mCursorLayer >= 0 ?
+                            IntelLayerGeometry::bit(mCursorLayer) : 0,
+                        mPlaneManager->getOverlayPlaneCount());
+}
+
 // When the geometry changed, we need
 // 0) reclaim all allocated planes, reclaimed planes will be disabled
 //    on the start of next frame. A little bit tricky, we cannot disable the
@@ -498,17 +563,59 @@ void IntelMIPIDisplayDevice::onGeometryChanged(hwc_display_contents_1_t *list)
     // update layer list with new list
     mLayerList->updateLayerList(list);
 
+    mCursorLayer = -1;
+    mCursorSkipLayers = 0;
+
     // TODO: uncomment it to print out layer list info
     // dumpLayerList(list);
 
     if (isScreenshotActive(list)) {
         ALOGD_IF(ALLOW_HWC_PRINT, "%s: Screenshot Active!\n", __func__);
+        mZOrderSolver.reset();
         goto out_check;
     }
 
     mVideoSentToWidi = false;
+    mCulledLayers = 0;
+
+    // the top most layer goes to the cursor plane if it fits and the
+    // plane takes its image
+    if (list && mLayerList->getLayersCount() > 1) {
+        int top = mLayerList->getLayersCount() - 1;
+        hwc_layer_1_t *layer = &list->hwLayers[top];
+        if (isCursorLayer(list, top, layer)) {
+            IMG_native_handle_t *grallocHandle =
+                (IMG_native_handle_t*)layer->handle;
+            if (mPlaneManager->getCursorPlane()->setDataBuffer(
+                    grallocHandle->fd[0], 0, grallocHandle))
+                mCursorLayer = top;
+        }
+    }
+
+    solveZOrder(list);
 
     for (size_t i = 0; list && i < (size_t)mLayerList->getLayersCount(); i++) {
+        if ((int)i == mCursorLayer) {
+            list->hwLayers[i].compositionType = HWC_OVERLAY;
+            list->hwLayers[i].hints = 0;
+            continue;
+        }
+
+        // drop layers hidden by opaque layers above them, e.g. the
+        // wallpaper under a full screen app. HWC_OVERLAY without a plane
+        // keeps them out of the framebuffer composition. the video sent
+        // to widi is still needed there.
+        if (isOccludedLayer(list, i, &list->hwLayers[i]) &&
+            (mExtendedModeInfo->widiExtHandle == NULL ||
+             mExtendedModeInfo->widiExtHandle !=
+                 (IMG_native_handle_t*)list->hwLayers[i].handle)) {
+            list->hwLayers[i].compositionType = HWC_OVERLAY;
+            list->hwLayers[i].hints = 0;
+            mCulledLayers++;
+            mCulledLayersTotal++;
+            continue;
+        }
+
         // check whether a layer can be handled in general
         if (!isHWCLayer(&list->hwLayers[i]))
             continue;
@@ -651,6 +758,7 @@ bool IntelMIPIDisplayDevice::prepare(hwc_display_contents_1_t *list)
         revisitLayerList(list, false);
     }
 
+    handleCursor(list);
     handleSmartComposition(list);
 
     if (list && (list->flags & HWC_GEOMETRY_CHANGED))
@@ -659,6 +767,108 @@ bool IntelMIPIDisplayDevice::prepare(hwc_display_contents_1_t *list)
     return true;
 }
 
+// A layer can be shown by the cursor plane when it is the top most layer,
+// a small unscaled and untransformed ARGB buffer, and it starts inside
+// the screen. Only pipe A has the cursor, so not while cloning.
+bool IntelMIPIDisplayDevice::isCursorLayer(hwc_display_contents_1_t *list,
+                                           int index,
+                                           hwc_layer_1_t *layer)
+{
+    if (!list || !layer || !mPlaneManager->getCursorPlane())
+        return false;
+
+    IMG_native_handle_t *grallocHandle =
+        (IMG_native_handle_t*)layer->handle;
+
+    if (!grallocHandle)
+        return false;
+
+    if (mDrm->getDisplayMode() != OVERLAY_MIPI0 || mDrm->isHdmiConnected())
+        return false;
+
+    if ((layer->flags & HWC_SKIP_LAYER) || layer->transform ||
+        layer->planeAlpha != 0xff || mLayerList->isProtectedLayer(index))
+        return false;
+
+    // the cursor plane always blends its image as premultiplied
+    if (layer->blending != HWC_BLENDING_PREMULT)
+        return false;
+
+    int width = grallocHandle->iWidth;
+    int height = grallocHandle->iHeight;
+    if (!IntelCursorPlane::isCursorSize(width, height) ||
+        (grallocHandle->iFormat != HAL_PIXEL_FORMAT_RGBA_8888 &&
+         grallocHandle->iFormat != HAL_PIXEL_FORMAT_BGRA_8888))
+        return false;
+
+    hwc_rect_t& crop = layer->sourceCrop;
+    hwc_rect_t& frame = layer->displayFrame;
+    if (crop.left || crop.top || crop.right != width || crop.bottom != height)
+        return false;
+
+    if (frame.left < 0 || frame.top < 0 ||
+        frame.right - frame.left != width || frame.bottom - frame.top != height)
+        return false;
+
+    ALOGD_IF(ALLOW_HWC_PRINT, "%s: layer %d is a %dx%d cursor\n",
+             __func__, index, width, height);
+    return true;
+}
+
+// Upload the cursor image if its buffer changed and place the plane. If
+// nothing but the cursor changed since the last frame, keep the last
+// framebuffer target instead of composing the same layers again.
+void IntelMIPIDisplayDevice::handleCursor(hwc_display_contents_1_t *list)
+{
+    IntelCursorPlane *cursor = mPlaneManager->getCursorPlane();
+    int count = mLayerList->getLayersCount();
+
+    if (!list || !cursor)
+        return;
+
+    // undo the last skip so the tracker sees the types HWC picked
+    for (int i = 0; mCursorSkipLayers && i < count; i++) {
+        if ((mCursorSkipLayers & (1 << i)) &&
+            list->hwLayers[i].compositionType == HWC_OVERLAY)
+            list->hwLayers[i].compositionType = HWC_FRAMEBUFFER;
+    }
+    mCursorSkipLayers = 0;
+
+    if (mCursorLayer >= 0) {
+        hwc_layer_1_t *layer = &list->hwLayers[mCursorLayer];
+        IMG_native_handle_t *grallocHandle =
+            (IMG_native_handle_t*)layer->handle;
+
+        if (!grallocHandle ||
+            !cursor->setDataBuffer(grallocHandle->fd[0], 0, grallocHandle)) {
+            ALOGD_IF(ALLOW_HWC_PRINT, "%s: cursor back to GLES\n", __func__);
+            layer->compositionType = HWC_FRAMEBUFFER;
+            mCursorLayer = -1;
+        } else {
+            cursor->setPosition(layer->displayFrame.left,
+                                layer->displayFrame.top,
+                                layer->displayFrame.right,
+                                layer->displayFrame.bottom);
+        }
+    }
+
+    if (!mCursorTracker.update(list, count, mCursorLayer) || mSkipComposition)
+        return;
+
+    for (int i = 0; i < count; i++) {
+        if (i != mCursorLayer &&
+            list->hwLayers[i].compositionType == HWC_FRAMEBUFFER) {
+            list->hwLayers[i].compositionType = HWC_OVERLAY;
+            mCursorSkipLayers |= (1 << i);
+        }
+    }
+
+    if (mCursorSkipLayers) {
+        mCursorSkippedCompositions++;
+        ALOGD_IF(ALLOW_HWC_PRINT, "%s: cursor only frame, reuse fb\n", __func__);
+    }
+}
+
 void IntelMIPIDisplayDevice::handleSmartComposition(hwc_display_contents_1_t *list)
 {
     int i;
@@ -710,9 +920,11 @@ void IntelMIPIDisplayDevice::handleSmartComposition(hwc_display_contents_1_t *li
 
         // Update compositeType
         for (i = 0; i < list->numHwLayers - 1; i++) {
-            if (i != mYUVOverlay)
+            if (i != mYUVOverlay && i != mCursorLayer)
                 list->hwLayers[i].compositionType =
-                        mSkipComposition ? HWC_OVERLAY : HWC_FRAMEBUFFER;
+                        (mSkipComposition ||
+                         isOccludedLayer(list, i, &list->hwLayers[i])) ?
+                        HWC_OVERLAY : HWC_FRAMEBUFFER;
         }
     }
 }
@@ -791,7 +1003,7 @@ bool IntelMIPIDisplayDevice::commit(hwc_display_contents_1_t *list,
 
         // setup primary plane contexts if swap buffers is needed
         hwc_layer_1_t* fb_layer = &list->hwLayers[list->numHwLayers-1];
-        if ((needSwapBuffer || mSkipComposition) &&
+        if ((needSwapBuffer || mSkipComposition || mCursorSkipLayers) &&
             mLayerList->getLayersCount() > 0 &&
             fb_layer->handle &&
             fb_layer->compositionType == HWC_FRAMEBUFFER_TARGET) {
@@ -855,6 +1067,15 @@ bool IntelMIPIDisplayDevice::commit(hwc_display_contents_1_t *list,
             // remove clear fb hints
             list->hwLayers[i].hints &= ~HWC_HINT_CLEAR_FB;
         }
+
+        // only writes the cursor registers if the image or position changed
+        IntelCursorPlane *cursor = mPlaneManager->getCursorPlane();
+        if (cursor && mCursorLayer >= 0) {
+            if (!cursor->flip(context, 0))
+                ALOGW("%s: failed to flip cursor plane\n", __func__);
+        } else if (cursor) {
+            cursor->disable();
+        }
     }
 
 #if 0
@@ -937,6 +1158,40 @@ bool IntelMIPIDisplayDevice::dump(char *buff,
        dumpPrintf("  + mForceSwapBuffer: %d \n", mForceSwapBuffer);
        dumpPrintf("  + mForceSwapBuffer: %d \n", mForceSwapBuffer);
        dumpPrintf("  + Display Mode: %d \n", mDrm->getDisplayMode());
+       dumpPrintf("  + buffer info cache hits: %u, misses: %u \n",
+                  mLayerList->getBufferInfoHits(),
+                  mLayerList->getBufferInfoMisses());
+       dumpPrintf("  + overlapping layer pairs: %u, opaque cover: %d \n",
+                  mLayerList->getGeometry().getOverlapPairs(),
+                  mLayerList->getGeometry().getOpaqueCover());
+       dumpPrintf("  + culled layers: %u (total %u) \n",
+                  mCulledLayers, mCulledLayersTotal);
+       dumpPrintf("  + cursor layer: %d, cursor only frames: %u of %u, "
+                  "compositions skipped: %u \n", mCursorLayer,
+                  mCursorTracker.getCursorOnlyFrames(),
+                  mCursorTracker.getFrames(), mCursorSkippedCompositions);
+       if (mZOrderSolver.isValid())
+           dumpPrintf("  + z-order: overlays 0x%llx, fb %s, %u assignments \n",
+                      (unsigned long long)mZOrderSolver.getOverlayLayers(),
+                      mZOrderSolver.isFbOnTop() ? "on top" : "at bottom",
+                      mZOrderSolver.getEvaluated());
+       if (mLayerList->getBandwidth().isValid()) {
+           const IntelBandwidthModel& bw = mLayerList->getBandwidth();
+           for (i = 0; i < mLayerList->getLayersCount(); i++) {
+               if (!bw.isVisible(i))
+                   continue;
+               dumpPrintf("   # layer %d: %llu KB on a plane, %llu KB with gles\n",
+                          i, (unsigned long long)(bw.getPlaneBytes(i) >> 10),
+                          (unsigned long long)(bw.getGlesBytes(i) >> 10));
+           }
+           dumpPrintf("  + frame bandwidth: %llu KB with gles only",
+                      (unsigned long long)(bw.getFrameBytes(0) >> 10));
+           if (mZOrderSolver.isValid())
+               dumpPrintf(", %llu KB as composed",
+                          (unsigned long long)(mZOrderSolver.getFrameBytes() >> 10));
+           dumpPrintf(", fb scanout %llu KB \n",
+                      (unsigned long long)(bw.getScanoutBytes() >> 10));
+       }
     }
 
     *cur_len = mDumpLen;
@@ -961,8 +1216,6 @@ bool IntelMIPIDisplayDevice::getDisplayConfig(uint32_t* configs,
 bool IntelMIPIDisplayDevice::getDisplayAttributes(uint32_t config,
             const uint32_t* attributes, int32_t* values)
 {
-    char val[PROPERTY_VALUE_MAX];
-
     if (config != 0)
         return false;
 
@@ -986,14 +1239,12 @@ bool IntelMIPIDisplayDevice::getDisplayAttributes(uint32_t config,
             *values = mode->vdisplay;
             break;
         case HWC_DISPLAY_DPI_X:
-            property_get("panel.physicalWidthmm", val, "47");
-            *values = (atoi(val) == 0) ? 144000.0f :
-                (mode->hdisplay * 25000.4f / atoi(val));
+            *values = (propCfg.get()->panel_width_mm == 0) ? 144000.0f :
+                (mode->hdisplay * 25000.4f / propCfg.get()->panel_width_mm);
             break;
         case HWC_DISPLAY_DPI_Y:
-            property_get("panel.physicalHeightmm", val, "82");
-            *values = (atoi(val) == 0) ? 144000.0f :
-                (mode->vdisplay * 25000.4f / atoi(val));
+            *values = (propCfg.get()->panel_height_mm == 0) ? 144000.0f :
+                (mode->vdisplay * 25000.4f / propCfg.get()->panel_height_mm);
             break;
         default:
             break;
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stddef.h>
+#include <string.h>
+#include <IntelOverlayBackBufferSync.h>
+
+IntelOverlayBackBufferSync::IntelOverlayBackBufferSync()
+    : mCoeffDirty(false), mInvalid(false),
+      mSyncs(0), mDirtySyncs(0), mDirtyRegs(0), mLastDirtyRegs(0),
+      mCoeffLoads(0)
+{
+    memset(&mSynced, 0, sizeof(mSynced));
+}
+
+void IntelOverlayBackBufferSync::reset(const intel_overlay_back_buffer_t *hw)
+{
+    if (hw)
+        memcpy(&mSynced, hw, sizeof(mSynced));
+    else
+        memset(&mSynced, 0, sizeof(mSynced));
+    mCoeffDirty = false;
+    mInvalid = false;
+}
+
+bool IntelOverlayBackBufferSync::sync(const intel_overlay_back_buffer_t *shadow,
+                                      intel_overlay_back_buffer_t *hw)
+{
+    if (!shadow || !hw)
+        return false;
+
+    // turning the overlay on needs the coefficients loaded again
+    if ((shadow->OCMD & OVERLAY_ENABLE) && !(mSynced.OCMD & OVERLAY_ENABLE))
+        mCoeffDirty = true;
+
+    // registers up to the reserved block, written one dword at a time
+    // so that the hardware copy is only touched where it changed
+    const uint32_t regCount =
+        offsetof(intel_overlay_back_buffer_t, RESERVEDC) / sizeof(uint32_t);
+    const uint32_t *src = (const uint32_t*)shadow;
+    uint32_t *synced = (uint32_t*)&mSynced;
+    volatile uint32_t *dst = (volatile uint32_t*)hw;
+    uint32_t dirty = 0;
+
+    for (uint32_t i = 0; i < regCount; i++) {
+        if (mInvalid || src[i] != synced[i]) {
+            dst[i] = synced[i] = src[i];
+            dirty++;
+        }
+    }
+
+    // filter coefficients
+    const size_t coeffOffset = offsetof(intel_overlay_back_buffer_t, Y_VCOEFS);
+    const size_t coeffSize = sizeof(intel_overlay_back_buffer_t) - coeffOffset;
+    const uint8_t *srcCoeff = (const uint8_t*)shadow + coeffOffset;
+    uint8_t *syncedCoeff = (uint8_t*)&mSynced + coeffOffset;
+
+    if (mInvalid || memcmp(srcCoeff, syncedCoeff, coeffSize)) {
+        memcpy(syncedCoeff, srcCoeff, coeffSize);
+        memcpy((uint8_t*)hw + coeffOffset, srcCoeff, coeffSize);
+        mCoeffDirty = true;
+    }
+    mInvalid = false;
+
+    mSyncs++;
+    if (dirty)
+        mDirtySyncs++;
+    mDirtyRegs += dirty;
+    mLastDirtyRegs = dirty;
+
+    if (!mCoeffDirty)
+        return false;
+
+    mCoeffDirty = false;
+    mCoeffLoads++;
+    return true;
+}
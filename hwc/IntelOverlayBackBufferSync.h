@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __INTEL_OVERLAY_BACK_BUFFER_SYNC_H__
+#define __INTEL_OVERLAY_BACK_BUFFER_SYNC_H__
+
+#include <stdint.h>
+#include <IntelOverlayHW.h>
+
+/*
+ * Overlay register updates are made on a copy in system memory. This
+ * writes the registers that changed since the last sync to the back
+ * buffer the hardware reads, and asks for a coefficient reload only when
+ * the filter coefficients changed or the overlay is turned on. After a
+ * sync the hardware back buffer holds what a full rewrite would.
+ */
+class IntelOverlayBackBufferSync {
+public:
+    IntelOverlayBackBufferSync();
+    // start from what the hardware back buffer holds, NULL for zeroes
+    void reset(const intel_overlay_back_buffer_t *hw);
+    // what the overlay latched can't be trusted any more, e.g. it was
+    // disabled or the display went through DPMS off; the next sync
+    // rewrites every register and reloads the coefficients
+    void invalidate() { mInvalid = true; }
+    // returns true if the coefficients must be reloaded with the next flip
+    bool sync(const intel_overlay_back_buffer_t *shadow,
+              intel_overlay_back_buffer_t *hw);
+
+    uint32_t getSyncCount() const { return mSyncs; }
+    uint32_t getDirtySyncCount() const { return mDirtySyncs; }
+    uint32_t getDirtyRegCount() const { return mDirtyRegs; }
+    uint32_t getLastDirtyRegCount() const { return mLastDirtyRegs; }
+    uint32_t getCoeffLoadCount() const { return mCoeffLoads; }
+private:
+    intel_overlay_back_buffer_t mSynced;
+    bool mCoeffDirty;
+    bool mInvalid;
+    uint32_t mSyncs;
+    uint32_t mDirtySyncs;
+    uint32_t mDirtyRegs;
+    uint32_t mLastDirtyRegs;
+    uint32_t mCoeffLoads;
+};
+
+#endif /*__INTEL_OVERLAY_BACK_BUFFER_SYNC_H__*/
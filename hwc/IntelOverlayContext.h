@@ -45,6 +45,7 @@
 #ifndef __INTEL_OVERLAY_CONTEXT_H__
 #define __INTEL_OVERLAY_CONTEXT_H__
 
+#include <IntelBufferManager.h>
 #include <IntelOverlayHW.h>
 #include <pthread.h>
 
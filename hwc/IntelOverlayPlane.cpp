@@ -45,10 +45,13 @@
 #include <cutils/ashmem.h>
 #include <sys/mman.h>
 #include <math.h>
+#include <stddef.h>
+#include <unistd.h>
 
 #include <IntelHWComposerDrm.h>
 #include <IntelOverlayPlane.h>
 #include <IntelOverlayUtil.h>
+#include <IntelFormatTraits.h>
 
 IntelOverlayContext::~IntelOverlayContext()
 {
@@ -83,47 +86,34 @@ bool IntelOverlayContext::create()
 
     memset(mContext, 0, size);
     mContext->refCount = 1;
-
-    if (pthread_mutexattr_init(&mContext->attr)) {
-        ALOGE("%s: Initialize overlay mutex attr failed\n", __func__);
-        goto mutexattr_init_err;
-    }
-
-    if (pthread_mutexattr_setpshared(&mContext->attr,
-                                     PTHREAD_PROCESS_SHARED)) {
-        ALOGE("%s: set pshared error\n", __func__);
-        goto pshared_err;
-    }
-
-
-    if (pthread_mutex_init(&mContext->lock, &mContext->attr)) {
-        ALOGE("%s: shared block lock init failed\n", __func__);
-        goto mutex_init_err;
-    }
+    mOwnership.attach(&mContext->owner, &mContext->generation);
 
     // allocate back buffer
     backBufferSize = sizeof(intel_overlay_back_buffer_t);
     backBuffer = mBufferManager->get(backBufferSize, 64 * 1024);
     if (!backBuffer) {
         ALOGE("%s: failed to allocate back buffer\n", __func__);
-        goto mutex_init_err;
+        goto alloc_err;
     }
 
     mContext->gtt_offset_in_page = backBuffer->getGttOffsetInPage();
     mContext->back_buffer_handle = backBuffer->getHandle();
 
     mSize = size;
-    mOverlayBackBuffer = (intel_overlay_back_buffer_t*)backBuffer->getCpuAddr();
+    mHwBackBuffer = (intel_overlay_back_buffer_t*)backBuffer->getCpuAddr();
     mBackBuffer = backBuffer;
 
+    // register updates are made on the shadow and synced before a flip
+    memset(mHwBackBuffer, 0, sizeof(intel_overlay_back_buffer_t));
+    memset(&mShadowBackBuffer, 0, sizeof(intel_overlay_back_buffer_t));
+    mSync.reset(mHwBackBuffer);
+    mOverlayBackBuffer = &mShadowBackBuffer;
+
     ALOGD_IF(ALLOW_OVERLAY_PRINT, "%s: created overlay context!\n", __func__);
 
     return true;
 
-mutex_init_err:
-pshared_err:
-    pthread_mutexattr_destroy(&mContext->attr);
-mutexattr_init_err:
+alloc_err:
     munmap(mContext, size);
 mmap_err:
     close(mDrmFd);
@@ -160,6 +150,7 @@ bool IntelOverlayContext::open(int handle, int size)
     }
 
     android_atomic_inc(&mContext->refCount);
+    mOwnership.attach(&mContext->owner, &mContext->generation);
 
     mHandle = handle;
     mSize = size;
@@ -174,9 +165,14 @@ bool IntelOverlayContext::open(int handle, int size)
         goto map_err;
     }
 
-    mOverlayBackBuffer = (intel_overlay_back_buffer_t*)backBuffer->getCpuAddr();
+    mHwBackBuffer = (intel_overlay_back_buffer_t*)backBuffer->getCpuAddr();
     mBackBuffer = backBuffer;
 
+    // start from what the creator has programmed
+    memcpy(&mShadowBackBuffer, mHwBackBuffer, sizeof(intel_overlay_back_buffer_t));
+    mSync.reset(mHwBackBuffer);
+    mOverlayBackBuffer = &mShadowBackBuffer;
+
     ALOGD_IF(ALLOW_OVERLAY_PRINT, "%s: opened overlay context\n", __func__);
     return true;
 
@@ -199,17 +195,7 @@ bool IntelOverlayContext::destroy()
 
     if (android_atomic_dec(&mContext->refCount) == 1) {
         ALOGD_IF(ALLOW_OVERLAY_PRINT,
-               "%s: refcount = 0, destroy mutex\n", __func__);
-        if (pthread_mutex_destroy(&mContext->lock)) {
-            ALOGE("%s: destroy share context lock failed\n", __func__);
-            ret = false;
-        }
-
-        if (pthread_mutexattr_destroy(&mContext->attr)) {
-            ALOGE("%s: destroy mutex attr failed\n", __func__);
-            ret = false;
-        }
-
+               "%s: refcount = 0, release context\n", __func__);
         closeFd = true;
     }
 
@@ -225,9 +211,11 @@ bool IntelOverlayContext::destroy()
         mBufferManager = 0;
     }
 
+    mOwnership.attach(0, 0);
     mContext = 0;
     mSize = 0;
     mOverlayBackBuffer = 0;
+    mHwBackBuffer = 0;
 
     if (closeFd && (mHandle > 0)) {
         close(mHandle);
@@ -243,18 +231,6 @@ void IntelOverlayContext::clean()
     ALOGD_IF(ALLOW_OVERLAY_PRINT, "%s\n", __func__);
 }
 
-void IntelOverlayContext::lock()
-{
-    //if (mContext)
-    //     pthread_mutex_lock(&mContext->lock);
-}
-
-void IntelOverlayContext::unlock()
-{
-    //if (mContext)
-    //    pthread_mutex_unlock(&mContext->lock);
-}
-
 void IntelOverlayContext::setBackBufferGttOffset(const uint32_t gttOffset)
 {
     lock();
@@ -268,13 +244,15 @@ void IntelOverlayContext::setBackBufferGttOffset(const uint32_t gttOffset)
 uint32_t IntelOverlayContext::getGttOffsetInPage()
 {
     uint32_t offset = 0;
+    int32_t generation;
 
-    lock();
+    if (!mContext)
+        return 0;
 
-    if (mContext)
+    do {
+        generation = readBegin();
         offset = mContext->gtt_offset_in_page;
-
-    unlock();
+    } while (readRetry(generation));
 
     return offset;
 }
@@ -282,17 +260,25 @@ uint32_t IntelOverlayContext::getGttOffsetInPage()
 intel_overlay_orientation_t IntelOverlayContext::getOrientation()
 {
     intel_overlay_orientation_t orientation = OVERLAY_ORIENTATION_PORTRAINT;
+    int32_t generation;
 
     if (!mContext)
         return orientation;
 
-    lock();
+    do {
+        generation = readBegin();
+        orientation = mContext->orientation;
+    } while (readRetry(generation));
 
-    orientation = mContext->orientation;
+    return orientation;
+}
 
-    unlock();
+bool IntelOverlayContext::syncBackBuffer()
+{
+    if (!mHwBackBuffer)
+        return false;
 
-    return orientation;
+    return mSync.sync(mOverlayBackBuffer, mHwBackBuffer);
 }
 
 bool IntelOverlayContext::flush(uint32_t flags)
@@ -303,11 +289,15 @@ bool IntelOverlayContext::flush(uint32_t flags)
     if (!mContext || !(flags & IntelDisplayPlane::FLASH_NEEDED))
         return false;
 
-    if (!mContext->gtt_offset_in_page) {
+    uint32_t gttOffset = getGttOffsetInPage();
+    if (!gttOffset) {
         ALOGE("%s: invalid gtt offset\n", __func__);
         return false;
     }
 
+    if (syncBackBuffer())
+        flags |= IntelDisplayPlane::UPDATE_COEF;
+
     struct drm_psb_register_rw_arg arg;
 
     memset(&arg, 0, sizeof(struct drm_psb_register_rw_arg));
@@ -315,9 +305,9 @@ bool IntelOverlayContext::flush(uint32_t flags)
     arg.overlay_read_mask = 0;
     arg.overlay.b_wms = (flags & IntelDisplayPlane::HDMI_HP) ? 0 : 1;
     arg.overlay.b_wait_vblank = (flags & IntelDisplayPlane::WAIT_VBLANK) ? 1 : 0;
-    arg.overlay.OVADD = (mContext->gtt_offset_in_page << 12);
+    arg.overlay.OVADD = (gttOffset << 12);
     // pipe select
-    arg.overlay.OVADD |= mContext->pipe;
+    arg.overlay.OVADD |= getPipe();
     if (flags & IntelDisplayPlane::UPDATE_COEF)
         arg.overlay.OVADD |= 1;
 
@@ -345,6 +335,20 @@ bool IntelOverlayContext::flush(uint32_t flags)
     return true;
 }
 
+bool IntelOverlayContext::flushAndUnlock(uint32_t flags)
+{
+    bool ret = flush(flags & ~IntelDisplayPlane::WAIT_VBLANK);
+
+    unlock();
+
+    // the register write has the kernel poll for the flip when asked to
+    // wait, waitForFlip() does the same poll without the ownership word
+    if (ret && (flags & IntelDisplayPlane::WAIT_VBLANK))
+        waitForFlip();
+
+    return ret;
+}
+
 bool IntelOverlayContext::waitForFlip()
 {
     if (mDrmFd <= 0)
@@ -358,7 +362,7 @@ bool IntelOverlayContext::waitForFlip()
     memset(&arg, 0, sizeof(struct drm_psb_register_rw_arg));
     arg.overlay_write_mask = OV_REGRWBITS_WAIT_FLIP;
     // pipe select
-    arg.overlay.OVADD |= mContext->pipe;
+    arg.overlay.OVADD |= getPipe();
 
     int ret = drmCommandWriteRead(mDrmFd,
                                   DRM_PSB_REGISTER_RW,
@@ -412,12 +416,16 @@ bool IntelOverlayContext::bufferOffsetSetup(IntelDisplayDataBuffer &buf)
         return false;
     }
 
+    const IntelBufferLayout *layout = buf.getLayout();
+    if (!layout) {
+        ALOGE("%s: no buffer layout\n", __func__);
+        return false;
+    }
+
     uint32_t format = buf.getFormat();
     uint32_t gttOffsetInBytes = (buf.getGttOffsetInPage() << 12);
-    yStride = buf.getYStride();
-    uvStride = buf.getUVStride();
-    uint32_t w = buf.getWidth();
-    uint32_t h = buf.getHeight();
+    yStride = layout->yStride;
+    uvStride = layout->uvStride;
     uint32_t srcX= buf.getSrcX();
     uint32_t srcY= buf.getSrcY();
 
@@ -435,48 +443,25 @@ bool IntelOverlayContext::bufferOffsetSetup(IntelDisplayDataBuffer &buf)
     mOverlayBackBuffer->OSTART_1U = mOverlayBackBuffer->OSTART_0U;
     mOverlayBackBuffer->OSTART_1V = mOverlayBackBuffer->OSTART_0V;
 
+    mOverlayBackBuffer->OBUF_0Y = 0;
+    mOverlayBackBuffer->OBUF_0U = layout->uOffset;
+    mOverlayBackBuffer->OBUF_0V = layout->vOffset;
+
     switch(format) {
     case HAL_PIXEL_FORMAT_YV12:    /*YV12*/
-        mOverlayBackBuffer->OBUF_0Y = 0;
-        mOverlayBackBuffer->OBUF_0V = yStride * h;
-        mOverlayBackBuffer->OBUF_0U = mOverlayBackBuffer->OBUF_0V +
-                                        (uvStride * (h / 2));
-
-        mOverlayBackBuffer->OCMD |= OVERLAY_FORMAT_PLANAR_YUV420;
-        break;
     case HAL_PIXEL_FORMAT_INTEL_HWC_I420:    /*I420*/
-        mOverlayBackBuffer->OBUF_0Y = 0;
-        mOverlayBackBuffer->OBUF_0U = yStride * h;
-        mOverlayBackBuffer->OBUF_0V = mOverlayBackBuffer->OBUF_0U +
-                                        (uvStride * (h / 2));
-
         mOverlayBackBuffer->OCMD |= OVERLAY_FORMAT_PLANAR_YUV420;
         break;
-    /**
-     * NOTE: this is the decoded video format, align the height to 32B
-     * as it's defined by video driver
-     */
     case HAL_PIXEL_FORMAT_INTEL_HWC_NV12:    /*normal NV12*/
-        mOverlayBackBuffer->OBUF_0Y = 0;
-        mOverlayBackBuffer->OBUF_0U = yStride * h;
-        mOverlayBackBuffer->OBUF_0V = 0;
-        mOverlayBackBuffer->OCMD |= OVERLAY_FORMAT_PLANAR_NV12_2;
-        break;
     case HAL_PIXEL_FORMAT_INTEL_HWC_NV12_VED:    /*NV12_VED, NV12 for video decoding*/
-        mOverlayBackBuffer->OBUF_0Y = 0;
-        mOverlayBackBuffer->OBUF_0U = yStride * align_to(h, 32);
-        mOverlayBackBuffer->OBUF_0V = 0;
         mOverlayBackBuffer->OCMD |= OVERLAY_FORMAT_PLANAR_NV12_2;
         break;
     case HAL_PIXEL_FORMAT_INTEL_HWC_NV12_TILE:    /*NV12_TILE*/
         /* Tiling memory is supported for NV12 only */
         LOGD_IF(ALLOW_OVERLAY_PRINT,
                 "%s: setting up tiling buffer offset...\n", __func__);
-        mOverlayBackBuffer->OBUF_0Y = 0;
-        mOverlayBackBuffer->OBUF_0U = yStride * align_to(h, 32);
-        mOverlayBackBuffer->OBUF_0V = 0;
-        mOverlayBackBuffer->OSTART_0U += yStride * align_to(h, 32);
-        mOverlayBackBuffer->OSTART_0V += yStride * align_to(h, 32);
+        mOverlayBackBuffer->OSTART_0U += layout->uOffset;
+        mOverlayBackBuffer->OSTART_0V += layout->uOffset;
         mOverlayBackBuffer->OSTART_1U = mOverlayBackBuffer->OSTART_0U;
         mOverlayBackBuffer->OSTART_1V = mOverlayBackBuffer->OSTART_0V;
         mOverlayBackBuffer->OTILEOFF_0Y = srcX + (srcY << 16);
@@ -489,16 +474,10 @@ bool IntelOverlayContext::bufferOffsetSetup(IntelDisplayDataBuffer &buf)
         mOverlayBackBuffer->OCMD |= OVERLAY_MEMORY_LAYOUT_TILED;
         break;
     case HAL_PIXEL_FORMAT_INTEL_HWC_YUY2:    /*YUY2*/
-        mOverlayBackBuffer->OBUF_0Y = 0;
-        mOverlayBackBuffer->OBUF_0U = 0;
-        mOverlayBackBuffer->OBUF_0V = 0;
         mOverlayBackBuffer->OCMD |= OVERLAY_FORMAT_PACKED_YUV422;
         mOverlayBackBuffer->OCMD |= OVERLAY_PACKED_ORDER_YUY2;
         break;
     case HAL_PIXEL_FORMAT_INTEL_HWC_UYVY:    /*UYVY*/
-        mOverlayBackBuffer->OBUF_0Y = 0;
-        mOverlayBackBuffer->OBUF_0U = 0;
-        mOverlayBackBuffer->OBUF_0V = 0;
         mOverlayBackBuffer->OCMD |= OVERLAY_FORMAT_PACKED_YUV422;
         mOverlayBackBuffer->OCMD |= OVERLAY_PACKED_ORDER_UYVY;
         break;
@@ -1104,14 +1083,13 @@ bool IntelOverlayContext::enable()
     lock();
 
     mOverlayBackBuffer->OCMD |= OVERLAY_ENABLE;
-    bool ret = flush(IntelDisplayPlane::FLASH_NEEDED | IntelDisplayPlane::WAIT_VBLANK);
+    bool ret = flushAndUnlock(IntelDisplayPlane::FLASH_NEEDED |
+                              IntelDisplayPlane::WAIT_VBLANK);
     if (ret == false) {
         ALOGE("%s: failed to enable overlay\n", __func__);
-        unlock();
         return false;
     }
 
-    unlock();
     return true;
 }
 
@@ -1131,15 +1109,21 @@ bool IntelOverlayContext::disable(uint32_t flags)
     //bool ret = flush((IntelDisplayPlane::FLASH_NEEDED |
     //                 IntelDisplayPlane::WAIT_VBLANK));
     bool ret = flush((IntelDisplayPlane::FLASH_NEEDED |
-			flags));
+			flags) & ~IntelDisplayPlane::WAIT_VBLANK);
     if (ret == false) {
         ALOGE("%s: failed to disable overlay\n", __func__);
         unlock();
         return false;
     }
 
+    // a disabled overlay doesn't keep what it latched
+    mSync.invalidate();
+
     unlock();
 
+    if (flags & IntelDisplayPlane::WAIT_VBLANK)
+        waitForFlip();
+
     return true;
 }
 
@@ -1152,17 +1136,14 @@ bool IntelOverlayContext::reset()
 
     ALOGD_IF(ALLOW_OVERLAY_PRINT, "%s: reset overlay...\n", __func__);
     backBufferInit();
-    bool ret = flush((IntelDisplayPlane::FLASH_NEEDED |
-                      IntelDisplayPlane::WAIT_VBLANK |
-                      IntelDisplayPlane::FLASH_GAMMA));
+    bool ret = flushAndUnlock(IntelDisplayPlane::FLASH_NEEDED |
+                              IntelDisplayPlane::WAIT_VBLANK |
+                              IntelDisplayPlane::FLASH_GAMMA);
     if (ret == false) {
         ALOGE("%s: failed to reset overlay\n", __func__);
-        unlock();
         return false;
     }
 
-    unlock();
-
     return true;
 }
 
@@ -1251,13 +1232,15 @@ void IntelOverlayContext::setPipeByMode(intel_overlay_mode_t displayMode)
 uint32_t IntelOverlayContext::getPipe()
 {
     uint32_t pipe = 0;
+    int32_t generation;
 
     if (!mContext)
         return 0;
 
-    lock();
+    do {
+        generation = readBegin();
         pipe = mContext->pipe;
-    unlock();
+    } while (readRetry(generation));
 
     return pipe;
 }
@@ -1337,11 +1320,15 @@ bool IntelOverlayContextMfld::flush_bottom_field(uint32_t flags)
     if (!mContext || !(flags & IntelDisplayPlane::FLASH_NEEDED))
         return false;
 
-    if (!mContext->gtt_offset_in_page) {
+    uint32_t gttOffset = getGttOffsetInPage();
+    if (!gttOffset) {
         ALOGE("%s: invalid gtt offset\n", __func__);
         return false;
     }
 
+    if (syncBackBuffer())
+        flags |= IntelDisplayPlane::UPDATE_COEF;
+
     struct drm_psb_register_rw_arg arg;
 
     memset(&arg, 0, sizeof(struct drm_psb_register_rw_arg));
@@ -1349,9 +1336,9 @@ bool IntelOverlayContextMfld::flush_bottom_field(uint32_t flags)
     arg.overlay_read_mask = 0;
     /*will not wait vblank, otherwise, wait too long will lead to intermittent issue*/
     arg.overlay.b_wait_vblank = 0; //(flags & IntelDisplayPlane::WAIT_VBLANK) ? 1 : 0;
-    arg.overlay.OVADD = (mContext->gtt_offset_in_page << 12);
+    arg.overlay.OVADD = (gttOffset << 12);
     // pipe select
-    arg.overlay.OVADD |= mContext->pipe;
+    arg.overlay.OVADD |= getPipe();
     if (flags & IntelDisplayPlane::UPDATE_COEF)
         arg.overlay.OVADD |= 1;
     int ret = drmCommandWriteRead(mDrmFd,
@@ -1374,11 +1361,15 @@ bool IntelOverlayContextMfld::flush_frame_or_top_field(uint32_t flags)
     if (!mContext || !(flags & IntelDisplayPlane::FLASH_NEEDED))
         return false;
 
-    if (!mContext->gtt_offset_in_page) {
+    uint32_t gttOffset = getGttOffsetInPage();
+    if (!gttOffset) {
         ALOGE("%s: invalid gtt offset\n", __func__);
         return false;
     }
 
+    if (syncBackBuffer())
+        flags |= IntelDisplayPlane::UPDATE_COEF;
+
     struct drm_psb_register_rw_arg arg;
 
     memset(&arg, 0, sizeof(struct drm_psb_register_rw_arg));
@@ -1386,9 +1377,9 @@ bool IntelOverlayContextMfld::flush_frame_or_top_field(uint32_t flags)
     arg.overlay_read_mask = 0;
     arg.overlay.b_wms = (flags & IntelDisplayPlane::WMS_NEEDED) ? 1 : 0;
     arg.overlay.b_wait_vblank = (flags & IntelDisplayPlane::WAIT_VBLANK) ? 1 : 0;
-    arg.overlay.OVADD = (mContext->gtt_offset_in_page << 12);
+    arg.overlay.OVADD = (gttOffset << 12);
     // pipe select
-    arg.overlay.OVADD |= mContext->pipe;
+    arg.overlay.OVADD |= getPipe();
     if (flags & IntelDisplayPlane::UPDATE_COEF)
         arg.overlay.OVADD |= 1;
     int ret = drmCommandWriteRead(mDrmFd,
@@ -1406,7 +1397,8 @@ bool IntelOverlayContextMfld::flush_frame_or_top_field(uint32_t flags)
 }
 
 IntelOverlayPlane::IntelOverlayPlane(int fd, int index, IntelBufferManager *bm)
-    : IntelDisplayPlane(fd, IntelDisplayPlane::DISPLAY_PLANE_OVERLAY, index, bm)
+    : IntelDisplayPlane(fd, IntelDisplayPlane::DISPLAY_PLANE_OVERLAY, index, bm),
+      mNextBuffer(0)
 {
     bool ret;
     ALOGD_IF(ALLOW_OVERLAY_PRINT, "%s\n", __func__);
@@ -1501,64 +1493,19 @@ bool IntelOverlayPlane::setDataBuffer(uint32_t handle, uint32_t flags,
 
     ui64Stamp = nHandle->ui64Stamp;
 
-    // verify if HW overlay capable for this data buffer
     IntelDisplayDataBuffer *overlayDataBuffer =
         reinterpret_cast<IntelDisplayDataBuffer*>(mDataBuffer);
-    uint32_t yStride, uvStride;
-    bool isYUVPacked = false;
     int format = overlayDataBuffer->getFormat();
     uint32_t grallocStride = overlayDataBuffer->getStride();
-    uint32_t grallocHeight = overlayDataBuffer->getSrcHeight();
-    uint32_t grallocWidth = overlayDataBuffer->getSrcWidth();
-
-    // calculate YUV stride, HW overlay requires 64 bytes alignment.
-    switch (format) {
-    case HAL_PIXEL_FORMAT_YV12:
-    case HAL_PIXEL_FORMAT_INTEL_HWC_I420:
-        //
-        yStride = align_to(grallocStride, 64);
-        uvStride = align_to(yStride >> 1, 64);
-        break;
-    case HAL_PIXEL_FORMAT_INTEL_HWC_NV12:
-    case HAL_PIXEL_FORMAT_INTEL_HWC_NV12_VED:
-    case HAL_PIXEL_FORMAT_INTEL_HWC_NV12_TILE:
-        yStride = align_to(grallocStride, 64);
-        uvStride = yStride;
-        break;
-    case HAL_PIXEL_FORMAT_INTEL_HWC_YUY2:
-    case HAL_PIXEL_FORMAT_INTEL_HWC_UYVY:
-        yStride = align_to(grallocStride << 1, 64);
-        uvStride = 0;
-        isYUVPacked = true;
-        break;
-    default:
-        ALOGE("%s: unsupported YUV format 0x%x\n", __func__, format);
-        return false;
-    }
-
-    // check the minimum and maximun stride restriction of HW overlay
-    if (yStride < INTEL_OVERLAY_MIN_STRIDE) {
-        ALOGW("%s: yStride %d is too small, switch to ST", __func__, yStride);
-        return false;
-    }
+    uint32_t srcHeight = overlayDataBuffer->getSrcHeight();
+    uint32_t srcWidth = overlayDataBuffer->getSrcWidth();
 
-    if (isYUVPacked && (yStride > INTEL_OVERLAY_MAX_STRIDE_PACKED)) {
-        ALOGW("%s: packed YUV stride %d is too big, switch to ST",
-             __func__, yStride);
-        return false;
-    } else if (!isYUVPacked && (yStride > INTEL_OVERLAY_MAX_STRIDE_LINEAR)) {
-        ALOGW("%s: planar YUV stride %d is too big, switch to ST",
-             __func__, yStride);
-        return false;
-    } else if ((grallocHeight > 2047) || (grallocWidth > 2047)) {
+    if ((srcHeight > 2047) || (srcWidth > 2047)) {
         ALOGW("%s: source width or height (%dx%d) is too big, switch to ST",
-             __func__, grallocWidth, grallocHeight);
+             __func__, srcWidth, srcHeight);
         return false;
     }
 
-    // update data buffer's yuv strides and continue
-    overlayDataBuffer->setStride(yStride, uvStride);
-
     int grallocBuffFd = (nHandle->iFormat == HAL_PIXEL_FORMAT_INTEL_HWC_NV12_VED ||
                      nHandle->iFormat == HAL_PIXEL_FORMAT_INTEL_HWC_NV12_TILE) ?
                      nHandle->fd[1] : 0;
@@ -1568,11 +1515,13 @@ bool IntelOverlayPlane::setDataBuffer(uint32_t handle, uint32_t flags,
     else
         bufferType = IntelBufferManager::GRALLOC_BUFFER;
 
+    int cached = -1;
     for (int i = 0; i < OVERLAY_DATA_BUFFER_NUM_MAX; i++) {
         if (mDataBuffers[i].ui64Stamp == ui64Stamp &&
             mDataBuffers[i].handle == handle &&
             mDataBuffers[i].bufferType == bufferType) {
             buffer = mDataBuffers[i].buffer;
+            cached = i;
             mNextBuffer = (i + 1) % OVERLAY_DATA_BUFFER_NUM_MAX;
             break;
         }
@@ -1625,11 +1574,47 @@ bool IntelOverlayPlane::setDataBuffer(uint32_t handle, uint32_t flags,
         mDataBuffers[mNextBuffer].buffer = buffer;
         mDataBuffers[mNextBuffer].bufferType = bufferType;
         mDataBuffers[mNextBuffer].grallocBuffFd = grallocBuffFd;
+        mDataBuffers[mNextBuffer].idle =
+            bufferType != IntelBufferManager::TTM_BUFFER;
+        cached = mNextBuffer;
 
         // move mNextBuffer pointer
         mNextBuffer = (mNextBuffer + 1) % OVERLAY_DATA_BUFFER_NUM_MAX;
     }
 
+    // verify if HW overlay capable for this data buffer, the layout is
+    // computed when a buffer is mapped and kept with the mapping
+    IntelBufferLayout& layout = mDataBuffers[cached].layout;
+    if (!layout.matches(format, grallocStride,
+                        overlayDataBuffer->getWidth(),
+                        overlayDataBuffer->getHeight()))
+        layout.setup(format, grallocStride,
+                     overlayDataBuffer->getWidth(),
+                     overlayDataBuffer->getHeight());
+
+    if (!layout.has(IntelBufferLayout::LAYOUT_OVERLAY)) {
+        ALOGW("%s: format 0x%x, yStride %d not supported, switch to ST",
+             __func__, format, layout.yStride);
+        return false;
+    }
+
+    bool idle = mDataBuffers[cached].idle || mBufferManager->isIdle(buffer);
+    switch (mFlipDeferral.check(idle)) {
+    case IntelFlipDeferral::FLIP_DEFERRED:
+        // mDataBufferHandle is left on the frame shown, see flip()
+        ALOGD_IF(ALLOW_OVERLAY_PRINT,
+               "%s: buffer %x is busy, defer flip\n", __func__, handle);
+        return true;
+    case IntelFlipDeferral::FLIP_AFTER_WAIT:
+        mBufferManager->waitIdle(buffer);
+        break;
+    default:
+        break;
+    }
+    mDataBuffers[cached].idle = true;
+
+    overlayDataBuffer->setStride(layout.yStride, layout.uvStride);
+    overlayDataBuffer->setLayout(&layout);
     overlayDataBuffer->setBuffer(buffer);
 
     mDataBufferHandle = (uint32_t)nHandle;
@@ -1675,6 +1660,7 @@ bool IntelOverlayPlane::invalidateDataBuffer()
     memset(mDataBuffers, 0, sizeof(mDataBuffers));
     memset(mDataBuffer, 0, sizeof(*mDataBuffer));
     mNextBuffer = 0;
+    mFlipDeferral.reset();
 
     return true;
 }
@@ -1689,9 +1675,13 @@ bool IntelOverlayPlane::flip(void *contexts, uint32_t flags)
             (IntelHWComposerDrm::getInstance().isOverlayOff())) {
             // return false as overlay context flip is bypassed
             ret = false;
+        } else if (mFlipDeferral.isDeferred()) {
+            // data buffer not ready yet, the plane keeps scanning out the
+            // previous frame. Report success so that the caller posts
+            // getDataBufferHandle(), still the buffer on screen, with the
+            // layer's release fence: it stays pinned until a real flip.
+            ALOGD_IF(ALLOW_OVERLAY_PRINT, "%s: flip deferred\n", __func__);
         } else {
-            flags |= IntelDisplayPlane::UPDATE_COEF;
-
             mdfld_plane_contexts_t *planeContexts;
             planeContexts = (mdfld_plane_contexts_t*)contexts;
             if (!planeContexts) {
@@ -1699,6 +1689,11 @@ bool IntelOverlayPlane::flip(void *contexts, uint32_t flags)
                 return false;
             }
 
+            // push the register changes of this frame, the coefficients
+            // are only reloaded when they changed
+            if (overlayContext->syncBackBuffer())
+                flags |= IntelDisplayPlane::UPDATE_COEF;
+
             planeContexts->overlay_contexts[mIndex].ovadd = 0x0;
             planeContexts->overlay_contexts[mIndex].ovadd =
                 (overlayContext->getGttOffsetInPage() << 12);
@@ -1706,6 +1701,7 @@ bool IntelOverlayPlane::flip(void *contexts, uint32_t flags)
             planeContexts->overlay_contexts[mIndex].pipe =
                 overlayContext->getPipe();
             planeContexts->active_overlays |= (1 << mIndex);
+            mFlipDeferral.flipped();
 
             if (flags & IntelDisplayPlane::UPDATE_COEF)
                 planeContexts->overlay_contexts[mIndex].ovadd |= 0x1;
@@ -1759,6 +1755,7 @@ bool IntelOverlayPlane::disable()
         ret = overlayContext->disable(0);
         if (ret == false)
             LOGE("%s: failed to disable overlay\n", __func__);
+        mFlipDeferral.reset();
     }
 
     return ret;
@@ -1800,6 +1797,15 @@ uint32_t IntelOverlayPlane::onDrmModeChange()
     return 0;
 }
 
+void IntelOverlayPlane::onDpmsChange()
+{
+    if (initCheck()) {
+        IntelOverlayContext *overlayContext =
+            reinterpret_cast<IntelOverlayContext*>(mContext);
+        overlayContext->invalidateBackBuffer();
+    }
+}
+
 bool IntelOverlayPlane::setOverlayOnTop(bool isOnTop)
 {
     IntelOverlayContext *overlayContext =
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#include <cutils/log.h>
+#include <cutils/atomic.h>
+#include <cutils/atomic-inline.h>
+#include <IntelOwnershipLock.h>
+
+// spins between two checks whether the owner is still alive
+#define OWNER_CHECK_SPINS    64
+
+static bool ownerAlive(int32_t owner)
+{
+    return !(kill(owner, 0) < 0 && errno == ESRCH);
+}
+
+IntelOwnershipLock::IntelOwnershipLock()
+    : mOwner(0), mGeneration(0), mDepth(0),
+      mAcquires(0), mContended(0), mMaxWait(0), mTakeovers(0)
+{
+}
+
+void IntelOwnershipLock::attach(volatile int32_t *owner,
+                                volatile int32_t *generation)
+{
+    mOwner = owner;
+    mGeneration = generation;
+    mDepth = 0;
+}
+
+bool IntelOwnershipLock::takeOver(int32_t owner)
+{
+    // a thread id of ours without a lock held is left over from a dead
+    // thread whose id got reused
+    if (owner != gettid() && ownerAlive(owner))
+        return false;
+
+    if (android_atomic_acquire_cas(owner, gettid(), mOwner))
+        return false;
+
+    ALOGW("%s: owner %d is gone, taking over\n", __func__, owner);
+
+    // close the update the dead owner left open, the fields it was
+    // writing are rewritten by the next update anyway
+    if (*mGeneration & 1)
+        android_atomic_inc(mGeneration);
+
+    mTakeovers++;
+    return true;
+}
+
+bool IntelOwnershipLock::isHeld() const
+{
+    return mOwner && mDepth &&
+           android_atomic_acquire_load(mOwner) == gettid();
+}
+
+void IntelOwnershipLock::lock()
+{
+    if (!mOwner)
+        return;
+
+    int32_t self = gettid();
+
+    if (isHeld()) {
+        mDepth++;
+        return;
+    }
+
+    nsecs_t start = 0;
+    uint32_t spins = 0;
+
+    while (android_atomic_acquire_cas(0, self, mOwner)) {
+        int32_t owner = android_atomic_acquire_load(mOwner);
+
+        if (!start)
+            start = systemTime(CLOCK_MONOTONIC);
+
+        if (owner && !(++spins % OWNER_CHECK_SPINS) && takeOver(owner))
+            break;
+
+        sched_yield();
+    }
+
+    mAcquires++;
+    if (start) {
+        nsecs_t wait = systemTime(CLOCK_MONOTONIC) - start;
+        mContended++;
+        if (wait > mMaxWait)
+            mMaxWait = wait;
+    }
+
+    // readers retry while the generation is odd
+    android_atomic_inc(mGeneration);
+    mDepth = 1;
+}
+
+void IntelOwnershipLock::unlock()
+{
+    if (!isHeld())
+        return;
+
+    if (--mDepth)
+        return;
+
+    android_atomic_inc(mGeneration);
+    android_atomic_release_store(0, mOwner);
+}
+
+int32_t IntelOwnershipLock::readBegin()
+{
+    uint32_t spins = 0;
+
+    for (;;) {
+        int32_t generation = android_atomic_acquire_load(mGeneration);
+        if (!(generation & 1))
+            return generation;
+
+        // our own update is in progress, nothing can change under us
+        if (isHeld())
+            return generation;
+
+        int32_t owner = android_atomic_acquire_load(mOwner);
+        // the takeover already closed the update, just give it back
+        if (owner && !(++spins % OWNER_CHECK_SPINS) && takeOver(owner))
+            android_atomic_release_store(0, mOwner);
+
+        sched_yield();
+    }
+}
+
+bool IntelOwnershipLock::readRetry(int32_t generation) const
+{
+    // order the field reads before the second generation read
+    android_memory_barrier();
+    return *mGeneration != generation;
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __INTEL_OWNERSHIP_LOCK_H__
+#define __INTEL_OWNERSHIP_LOCK_H__
+
+#include <stdint.h>
+#include <utils/Timers.h>
+
+/*
+ * Lock on an ownership word and a generation counter kept in shared
+ * memory, used instead of a process-shared mutex so that a dead owner
+ * can be taken over. A writer claims the word with its thread id, the
+ * generation is odd while its update is in progress. Single fields are
+ * read without the lock and retried on a generation change.
+ *
+ * Contenders spin, so the lock must not be held across anything that
+ * blocks, such as a vblank wait.
+ */
+class IntelOwnershipLock {
+public:
+    IntelOwnershipLock();
+    // use the words at owner and generation, NULL to detach
+    void attach(volatile int32_t *owner, volatile int32_t *generation);
+
+    // nests, e.g. disable() called from setDataBuffer()
+    void lock();
+    void unlock();
+    // true if the calling thread holds the lock
+    bool isHeld() const;
+
+    int32_t readBegin();
+    bool readRetry(int32_t generation) const;
+
+    uint32_t getAcquireCount() const { return mAcquires; }
+    uint32_t getContendedCount() const { return mContended; }
+    nsecs_t getMaxWait() const { return mMaxWait; }
+    uint32_t getTakeoverCount() const { return mTakeovers; }
+private:
+    bool takeOver(int32_t owner);
+
+    volatile int32_t *mOwner;
+    volatile int32_t *mGeneration;
+    int mDepth;
+    uint32_t mAcquires;
+    uint32_t mContended;
+    nsecs_t mMaxWait;
+    uint32_t mTakeovers;
+};
+
+#endif /*__INTEL_OWNERSHIP_LOCK_H__*/
@@ -54,6 +54,7 @@
 #include <PixelFormat.h>
 
 #include <IntelUtility.h>
+#include <IntelConfigSnapshot.h>
 
 using namespace::android;
 
@@ -87,15 +88,7 @@ void IntelUtility::setLayerList(struct hwc_display_contents_1** list)
 
 bool IntelUtility::needDump()
 {
-    int dump = 0;
-    char val[PROPERTY_VALUE_MAX];
-
-    if(property_get("debug.hwc.dumplayers", val, NULL) > 0) {
-        dump = atoi(val);
-    }
-
-//    LOGD("IntelUtility::needDump %d, val = %s", dump, val);
-    return dump ? true : false;
+    return propCfg.get()->dump_layers ? true : false;
 }
 
 void IntelUtility::dumpLayers(char* path)
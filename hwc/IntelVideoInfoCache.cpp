@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <IntelVideoInfoCache.h>
+#include <IntelHWComposerCfg.h>
+#include <string.h>
+#include <cutils/log.h>
+
+IntelVideoInfoCache::IntelVideoInfoCache()
+    : mState(STATE_STALE), mGeneration(0), mRetryTime(0),
+      mRetryDelay(ms2ns(RETRY_MIN_MS))
+{
+    memset(&mInfo, 0, sizeof(mInfo));
+}
+
+void IntelVideoInfoCache::invalidate()
+{
+    android::Mutex::Autolock _l(mLock);
+    mState = STATE_STALE;
+    mGeneration++;
+    mRetryDelay = ms2ns(RETRY_MIN_MS);
+}
+
+bool IntelVideoInfoCache::get(IntelVideoInfoSource *source,
+                              intel_video_info_t *info)
+{
+    nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+    uint32_t generation;
+    intel_video_info_t result;
+    bool ok;
+
+    {
+        android::Mutex::Autolock _l(mLock);
+        if (mState == STATE_VALID) {
+            *info = mInfo;
+            return true;
+        }
+        if (!source || (mState == STATE_FAILED && now < mRetryTime))
+            return false;
+        generation = mGeneration;
+    }
+
+    memset(&result, 0, sizeof(result));
+    ok = source->queryVideoInfo(&result);
+    ALOGD_IF(ALLOW_MONITOR_PRINT, "%s: video info %dx%d@%d%s, %s",
+             __func__, result.displayW, result.displayH, result.fps,
+             result.isInterlace ? "i" : "p", ok ? "ok" : "failed");
+
+    android::Mutex::Autolock _l(mLock);
+    // drop the result if the state changed during the query
+    if (mGeneration != generation)
+        return false;
+
+    if (!ok) {
+        mState = STATE_FAILED;
+        mRetryTime = now + mRetryDelay;
+        mRetryDelay *= 2;
+        if (mRetryDelay > ms2ns(RETRY_MAX_MS))
+            mRetryDelay = ms2ns(RETRY_MAX_MS);
+        return false;
+    }
+
+    mState = STATE_VALID;
+    mRetryDelay = ms2ns(RETRY_MIN_MS);
+    mInfo = result;
+    *info = result;
+    return true;
+}
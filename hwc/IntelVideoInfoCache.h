@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __INTEL_VIDEO_INFO_CACHE_H__
+#define __INTEL_VIDEO_INFO_CACHE_H__
+
+#include <stdint.h>
+#include <utils/threads.h>
+
+typedef struct {
+    int displayW;
+    int displayH;
+    int fps;
+    int isInterlace;
+} intel_video_info_t;
+
+// answers the queries of the cache, MultiDisplayClient in the HAL
+class IntelVideoInfoSource {
+public:
+    virtual ~IntelVideoInfoSource() {}
+    virtual bool queryVideoInfo(intel_video_info_t *info) = 0;
+};
+
+/*
+ * Last video info reported by MDS. The source is queried once after
+ * each invalidate(), every other get() is served from the copy. A
+ * failed query is not cached: it is retried on a later frame, with the
+ * delay doubling from RETRY_MIN_MS up to RETRY_MAX_MS.
+ */
+class IntelVideoInfoCache {
+public:
+    enum {
+        RETRY_MIN_MS = 16,
+        RETRY_MAX_MS = 1000,
+    };
+private:
+    enum {
+        STATE_STALE = 0,    // video state changed, query again
+        STATE_VALID,
+        STATE_FAILED,       // query failed, retry at mRetryTime
+    };
+    android::Mutex mLock;
+    int mState;
+    uint32_t mGeneration;
+    nsecs_t mRetryTime;
+    nsecs_t mRetryDelay;
+    intel_video_info_t mInfo;
+public:
+    IntelVideoInfoCache();
+    // a video started, stopped or changed
+    void invalidate();
+    // called on the frame path, the source is called without the lock
+    bool get(IntelVideoInfoSource *source, intel_video_info_t *info);
+};
+
+#endif /*__INTEL_VIDEO_INFO_CACHE_H__*/
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <string.h>
+#include <IntelWidiStreamState.h>
+
+IntelWidiStreamState::IntelWidiStreamState()
+{
+    reset();
+}
+
+void IntelWidiStreamState::reset()
+{
+    mLayer = 0;
+    mFastPath = false;
+    clearLastFrame();
+}
+
+void IntelWidiStreamState::clearLastFrame()
+{
+    frameSent(0, 0);
+    mLastHandle = NULL;
+    mLastStamp = 0;
+    memset(&mLastCrop, 0, sizeof(mLastCrop));
+    mLastWidth = 0;
+    mLastHeight = 0;
+}
+
+bool IntelWidiStreamState::isSameBuffer(const hwc_layer_1_t& layer,
+                                        uint64_t stamp,
+                                        uint32_t width, uint32_t height) const
+{
+    return layer.handle != NULL && layer.handle == mLastHandle &&
+           stamp == mLastStamp &&
+           !memcmp(&layer.sourceCrop, &mLastCrop, sizeof(mLastCrop)) &&
+           width == mLastWidth && height == mLastHeight;
+}
+
+void IntelWidiStreamState::bufferSent(const hwc_layer_1_t& layer,
+                                      uint64_t stamp,
+                                      uint32_t width, uint32_t height)
+{
+    mLastHandle = layer.handle;
+    mLastStamp = stamp;
+    mLastCrop = layer.sourceCrop;
+    mLastWidth = width;
+    mLastHeight = height;
+}
+
+size_t IntelWidiStreamState::select(const hwc_display_contents_1_t *list,
+                                    buffer_handle_t videoHandle,
+                                    bool forceNotify, bool *fastPath)
+{
+    size_t target = list->numHwLayers - 1;
+
+    if (mFastPath && !(list->flags & HWC_GEOMETRY_CHANGED) &&
+        !forceNotify && videoHandle != NULL &&
+        mLayer < target && list->hwLayers[mLayer].handle == videoHandle) {
+        *fastPath = true;
+        return mLayer;
+    }
+    *fastPath = false;
+
+    // by default send the FRAMEBUFFER_TARGET layer (composited image)
+    mLayer = target;
+
+    if (videoHandle != NULL) {
+        for (size_t i = 0; i < target; i++) {
+            if (list->hwLayers[i].handle == videoHandle) {
+                mLayer = i;
+                break;
+            }
+        }
+    } else if (target == 1) {
+        const hwc_layer_1_t& layer = list->hwLayers[0];
+        if (layer.transform == 0 && layer.blending == HWC_BLENDING_NONE)
+            mLayer = 0;
+    }
+
+    mFastPath = videoHandle != NULL && mLayer < target;
+    return mLayer;
+}
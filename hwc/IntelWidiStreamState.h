@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __INTEL_WIDI_STREAM_STATE_H__
+#define __INTEL_WIDI_STREAM_STATE_H__
+
+#include <stdint.h>
+#include <hardware/hwcomposer.h>
+
+/*
+ * Which layer of the list WiDi streams, and the last decoder frame
+ * sent. In extended mode that is the video layer, for a single opaque
+ * untransformed layer the layer itself, otherwise the composited
+ * FRAMEBUFFER_TARGET.
+ *
+ * Once the video layer has been picked, following lists without a
+ * geometry change that still hold the video handle in the same slot
+ * take the fast path: the layers keep the composition types set on the
+ * full path, only the frame is forwarded.
+ *
+ * Compositions that leave the streamed layer on the buffer sent last
+ * are not sent again; prepare() skips the payload mapping, frame info
+ * and buffer hold for them.
+ */
+class IntelWidiStreamState {
+public:
+    IntelWidiStreamState();
+    void reset();
+    // returns the index of the layer to stream; fastPath is set when
+    // the list is unchanged since the video layer was picked
+    size_t select(const hwc_display_contents_1_t *list, buffer_handle_t videoHandle,
+                  bool forceNotify, bool *fastPath);
+    // a decoder frame with this khandle and timestamp was sent already
+    bool isRepeat(uint32_t khandle, int64_t timestamp) const {
+        return khandle != 0 && khandle == mLastKhandle && timestamp == mLastTimestamp;
+    }
+    void frameSent(uint32_t khandle, int64_t timestamp) {
+        mLastKhandle = khandle;
+        mLastTimestamp = timestamp;
+    }
+    // the layer shows the buffer last sent, with the same crop and at
+    // the same output size
+    bool isSameBuffer(const hwc_layer_1_t& layer, uint64_t stamp,
+                      uint32_t width, uint32_t height) const;
+    void bufferSent(const hwc_layer_1_t& layer, uint64_t stamp,
+                    uint32_t width, uint32_t height);
+    void clearLastFrame();
+private:
+    size_t mLayer;
+    bool mFastPath;
+    uint32_t mLastKhandle;
+    int64_t mLastTimestamp;
+    buffer_handle_t mLastHandle;
+    uint64_t mLastStamp;
+    hwc_rect_t mLastCrop;
+    uint32_t mLastWidth;
+    uint32_t mLastHeight;
+};
+
+#endif /*__INTEL_WIDI_STREAM_STATE_H__*/
@@ -141,3 +141,9 @@ bool IntelWsbm::waitIdleTTMBuffer(void *buf)
 
     return true;
 }
+
+bool IntelWsbm::isIdleTTMBuffer(void *buf)
+{
+    // treat a failed query as idle, waiting wouldn't help either
+    return pvrWsbmIsIdle(buf) != 0;
+}
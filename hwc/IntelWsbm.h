@@ -66,6 +66,7 @@ public:
     bool wrapTTMBuffer(uint32_t handle, void **buf);
     bool unreferenceTTMBuffer(void *buf);
     bool waitIdleTTMBuffer(void *buf);
+    bool isIdleTTMBuffer(void *buf);
     uint32_t getKBufHandle(void *buf);
 };
 #endif /*__INTEL_WSBM_H__*/
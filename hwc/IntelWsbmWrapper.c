@@ -344,3 +344,25 @@ uint32_t pvrWsbmWaitIdle(void *buf)
     wsbmBOWaitIdle(buf, 0);
     return 0;
 }
+
+/* returns 1 if nothing is rendering to the buffer, 0 if it is still busy */
+int pvrWsbmIsIdle(void *buf)
+{
+    int ret;
+
+    if (!buf) {
+        ALOGE("%s: Invalid ttm buffer\n", __func__);
+        return -EINVAL;
+    }
+
+    ret = wsbmBOSyncForCpu(buf, WSBM_SYNCCPU_READ | WSBM_SYNCCPU_DONT_BLOCK);
+    if (ret == -EBUSY)
+        return 0;
+    else if (ret) {
+        ALOGE("%s: failed to query buffer, %d\n", __func__, ret);
+        return ret;
+    }
+
+    wsbmBOReleaseFromCpu(buf, WSBM_SYNCCPU_READ);
+    return 1;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cutils/log.h>
+
+#include <IntelHWComposerCfg.h>
+#include <IntelZOrderSolver.h>
+
+IntelZOrderSolver::IntelZOrderSolver()
+{
+    reset();
+}
+
+void IntelZOrderSolver::reset()
+{
+    mValid = false;
+    mOverlayLayers = 0;
+    mFbOnTop = true;
+    mFrameBytes = 0;
+    mGlesBytes = 0;
+    mEvaluated = 0;
+}
+
+bool IntelZOrderSolver::solve(int numLayers,
+                              const IntelLayerGeometry& geometry,
+                              const IntelBandwidthModel& bandwidth,
+                              uint64_t candidates, uint64_t fixed,
+                              int numOverlays)
+{
+    int index[MAX_CANDIDATES];
+    uint64_t composed = 0;
+    int count = 0;
+
+    reset();
+
+    if (!bandwidth.isValid() ||
+        numLayers <= 0 || numLayers > IntelLayerGeometry::MAX_LAYERS)
+        return false;
+
+    for (int i = 0; i < numLayers; i++) {
+        if (bandwidth.isVisible(i))
+            composed |= IntelLayerGeometry::bit(i);
+    }
+    composed &= ~fixed;
+
+    // keep the candidates saving the most
+    candidates &= composed;
+    for (int i = 0; i < numLayers; i++) {
+        if (!(candidates & IntelLayerGeometry::bit(i)))
+            continue;
+
+        int64_t saving = (int64_t)bandwidth.getGlesBytes(i) -
+                         (int64_t)bandwidth.getPlaneBytes(i);
+        int j = count < MAX_CANDIDATES ? count++ : MAX_CANDIDATES;
+        while (j > 0 &&
+               (int64_t)bandwidth.getGlesBytes(index[j - 1]) -
+               (int64_t)bandwidth.getPlaneBytes(index[j - 1]) < saving) {
+            if (j < MAX_CANDIDATES)
+                index[j] = index[j - 1];
+            j--;
+        }
+        if (j < MAX_CANDIDATES)
+            index[j] = i;
+    }
+
+    mValid = true;
+    mGlesBytes = bandwidth.getFrameBytes(fixed);
+    mFrameBytes = mGlesBytes;
+
+    for (uint32_t subset = 1; subset < (1U << count); subset++) {
+        uint64_t overlays = 0;
+        int used = 0;
+
+        for (int c = 0; c < count; c++) {
+            if (subset & (1U << c)) {
+                overlays |= IntelLayerGeometry::bit(index[c]);
+                used++;
+            }
+        }
+        if (used > numOverlays)
+            continue;
+
+        uint64_t gles = composed & ~overlays;
+        bool underFb = true;
+        bool overFb = true;
+
+        for (int c = 0; c < count; c++) {
+            if (!(subset & (1U << c)))
+                continue;
+            int i = index[c];
+            if (geometry.getOverlaps(i) & overlays) {
+                underFb = overFb = false;
+                break;
+            }
+            if (geometry.getOverlapsBelow(i) & gles)
+                underFb = false;
+            if (geometry.getOverlapsAbove(i) & gles)
+                overFb = false;
+        }
+
+        mEvaluated += 2;
+        if (!underFb && !overFb)
+            continue;
+
+        uint64_t cost = bandwidth.getFrameBytes(overlays | fixed);
+        if (cost > mFrameBytes)
+            continue;
+        if (cost == mFrameBytes &&
+            used >= __builtin_popcountll(mOverlayLayers))
+            continue;
+
+        mFrameBytes = cost;
+        mOverlayLayers = overlays;
+        mFbOnTop = underFb;
+    }
+
+    ALOGD_IF(ALLOW_HWC_PRINT,
+             "%s: overlays 0x%llx, fb %s, %llu bytes per frame, %llu with gles\n",
+             __func__, (unsigned long long)mOverlayLayers,
+             mFbOnTop ? "on top" : "at bottom",
+             (unsigned long long)mFrameBytes, (unsigned long long)mGlesBytes);
+    return true;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __INTEL_ZORDER_SOLVER_H__
+#define __INTEL_ZORDER_SOLVER_H__
+
+#include <stdint.h>
+#include <hardware/hwcomposer.h>
+#include <IntelLayerGeometry.h>
+#include <IntelBandwidthModel.h>
+
+/*
+ * Picks the layers to put on overlays and where the primary plane goes.
+ *
+ * The primary plane scans out the framebuffer target holding every
+ * GLES composed layer, and sits either above all overlays or below
+ * them. An overlay layer is legal under the framebuffer if no GLES
+ * layer under it overlaps it, and above the framebuffer if no GLES
+ * layer above it overlaps it. Two overlay layers must not overlap
+ * because which overlay ends up on top isn't known here.
+ *
+ * All subsets of the candidates that fit the overlays are tried with
+ * both framebuffer positions, and the legal one with the least memory
+ * traffic per frame as estimated by IntelBandwidthModel wins. Fewer
+ * overlays, then the framebuffer on top, break ties.
+ */
+class IntelZOrderSolver {
+public:
+    enum {
+        // largest candidates considered, 2^8 subsets at most
+        MAX_CANDIDATES = 8,
+    };
+
+private:
+    bool mValid;
+    uint64_t mOverlayLayers;
+    bool mFbOnTop;
+    uint64_t mFrameBytes;
+    uint64_t mGlesBytes;
+    uint32_t mEvaluated;
+public:
+    IntelZOrderSolver();
+
+    void reset();
+
+    // candidates is a mask of the layers an overlay can show, fixed
+    // the layers on planes outside the z-order configs (the cursor).
+    // hidden layers are neither composed nor scanned out
+    bool solve(int numLayers, const IntelLayerGeometry& geometry,
+               const IntelBandwidthModel& bandwidth,
+               uint64_t candidates, uint64_t fixed, int numOverlays);
+
+    bool isValid() const { return mValid; }
+    bool isOverlayLayer(int index) const {
+        return mValid && index >= 0 && index < IntelLayerGeometry::MAX_LAYERS &&
+               (mOverlayLayers & IntelLayerGeometry::bit(index));
+    }
+    uint64_t getOverlayLayers() const { return mOverlayLayers; }
+    bool isFbOnTop() const { return mFbOnTop; }
+    // estimated bytes per frame of the solution and of composing
+    // everything with GLES
+    uint64_t getFrameBytes() const { return mFrameBytes; }
+    uint64_t getGlesBytes() const { return mGlesBytes; }
+    uint32_t getEvaluated() const { return mEvaluated; }
+};
+
+#endif /*__INTEL_ZORDER_SOLVER_H__*/
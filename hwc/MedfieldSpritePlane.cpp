@@ -114,30 +114,30 @@ bool MedfieldSpritePlane::setDataBuffer(IntelDisplayBuffer& buffer)
             reinterpret_cast<IntelSpriteContext*>(mContext);
         intel_sprite_context_t *context = spriteContext->getContext();
 
+        const IntelBufferLayout *layout = spriteDataBuffer->getLayout();
         uint32_t format = spriteDataBuffer->getFormat();
         uint32_t spriteFormat;
-        int bpp;
+
+        if (!layout || !layout->has(IntelBufferLayout::LAYOUT_SPRITE)) {
+            ALOGE("%s: unsupported format 0x%x\n", __func__, format);
+            return false;
+        }
 
         switch (format) {
         case HAL_PIXEL_FORMAT_RGBA_8888:
             spriteFormat = INTEL_SPRITE_PIXEL_FORMAT_RGBA8888;
-            bpp = 4;
             break;
         case HAL_PIXEL_FORMAT_RGBX_8888:
             spriteFormat = INTEL_SPRITE_PIXEL_FORMAT_RGBX8888;
-            bpp = 4;
             break;
         case HAL_PIXEL_FORMAT_BGRX_8888:
             spriteFormat = INTEL_SPRITE_PIXEL_FORMAT_BGRX8888;
-            bpp = 4;
             break;
         case HAL_PIXEL_FORMAT_BGRA_8888:
             spriteFormat = INTEL_SPRITE_PIXEL_FORMAT_BGRA8888;
-            bpp = 4;
             break;
         case HAL_PIXEL_FORMAT_RGB_565:
             spriteFormat = INTEL_SPRITE_PIXEL_FORMAT_BGRX565;
-            bpp = 2;
             break;
         default:
             ALOGE("%s: unsupported format 0x%x\n", __func__, format);
@@ -149,10 +149,8 @@ bool MedfieldSpritePlane::setDataBuffer(IntelDisplayBuffer& buffer)
         int srcY = spriteDataBuffer->getSrcY();
         int bufferWidth = spriteDataBuffer->getWidth();
         int bufferHeight = spriteDataBuffer->getHeight();
-
-        // IMG alloc buffer has 32 pixel alignment on Width
-        int bufferStride = bpp * align_to(bufferWidth, 32);
-        uint32_t stride = align_to(bufferStride, 64);
+        int bpp = layout->traits->bpp / 8;
+        uint32_t stride = layout->yStride;
         uint32_t linoff = srcY * stride + srcX * bpp;
 
         // unlikely happen, but still we need make sure linoff is valid
@@ -245,6 +243,16 @@ bool MedfieldSpritePlane::setDataBuffer(uint32_t handle, uint32_t flags, IMG_nat
 
     IntelDisplayDataBuffer *spriteDataBuffer =
         reinterpret_cast<IntelDisplayDataBuffer*>(mDataBuffer);
+
+    // IMG alloc buffer has 32 pixel alignment on Width
+    IntelBufferLayout& layout = mDataBuffers[mPrevHitSlot].layout;
+    int format = spriteDataBuffer->getFormat();
+    uint32_t width = spriteDataBuffer->getWidth();
+    uint32_t height = spriteDataBuffer->getHeight();
+    if (!layout.matches(format, align_to(width, 32), width, height))
+        layout.setup(format, align_to(width, 32), width, height);
+
+    spriteDataBuffer->setLayout(&layout);
     spriteDataBuffer->setBuffer(buffer);
 
     mDataBufferHandle = (uint32_t)nHandle;
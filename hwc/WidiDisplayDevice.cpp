@@ -49,19 +49,20 @@ WidiDisplayDevice::CachedBuffer::~CachedBuffer()
     grallocBufferManager->unmap(displayBuffer);
 }
 
-WidiDisplayDevice::HeldCscBuffer::HeldCscBuffer(const sp<WidiDisplayDevice>& wdd, const sp<GraphicBuffer>& gb)
+WidiDisplayDevice::HeldCscBuffer::HeldCscBuffer(const sp<WidiDisplayDevice>& wdd, const sp<GraphicBuffer>& gb,
+                                                uint32_t generation)
     : wdd(wdd),
-      buffer(gb)
+      buffer(gb),
+      generation(generation)
 {
 }
 
 WidiDisplayDevice::HeldCscBuffer::~HeldCscBuffer()
 {
-    Mutex::Autolock _l(wdd->mCscLock);
-    if (buffer->getWidth() == wdd->mCscWidth && buffer->getHeight() == wdd->mCscHeight)
-        wdd->mAvailableCscBuffers.push_back(buffer);
-    else
-        wdd->mCscBuffersToCreate++;
+    // back to the pool of its size, freed here if that pool was trimmed
+    // or re-created meanwhile
+    wdd->mCscPool.put(IntelCscBufferPool<GraphicBuffer>::key(buffer->getWidth(), buffer->getHeight()),
+                      generation, buffer);
 }
 
 WidiDisplayDevice::HeldDecoderBuffer::HeldDecoderBuffer(const android::sp<CachedBuffer>& cachedBuffer)
@@ -85,10 +86,9 @@ WidiDisplayDevice::WidiDisplayDevice(IntelBufferManager *bm,
                                      uint32_t index)
                                    : IntelDisplayDevice(pm, drm, bm, gm, index),
                                      mExtendedModeInfo(extinfo),
-                                     mExtLastKhandle(0),
-                                     mExtLastTimestamp(0),
                                      mGrallocModule(0),
-                                     mGrallocDevice(0)
+                                     mGrallocDevice(0),
+                                     mMappedBufferCache(MAPPED_BUFFER_CACHE_SIZE)
 {
     ALOGD_IF(ALLOW_WIDI_PRINT, "%s", __func__);
 
@@ -121,11 +121,6 @@ WidiDisplayDevice::WidiDisplayDevice(IntelBufferManager *bm,
     mNextConfig.extendedModeEnabled = false;
     mNextConfig.forceNotify = false;
     mCurrentConfig = mNextConfig;
-    mLayerToSend = 0;
-
-    mCscBuffersToCreate = 4;
-    mCscWidth = 0;
-    mCscHeight = 0;
 
     memset(&mLastInputFrameInfo, 0, sizeof(mLastInputFrameInfo));
     memset(&mLastOutputFrameInfo, 0, sizeof(mLastOutputFrameInfo));
@@ -166,20 +161,17 @@ WidiDisplayDevice::~WidiDisplayDevice()
     ALOGI("%s", __func__);
 }
 
-sp<WidiDisplayDevice::CachedBuffer> WidiDisplayDevice::getMappedBuffer(uint32_t handle)
+sp<WidiDisplayDevice::CachedBuffer> WidiDisplayDevice::getMappedBuffer(uint64_t stamp, uint32_t handle)
 {
-    ssize_t index = mMappedBufferCache.indexOfKey(handle);
-    sp<CachedBuffer> cachedBuffer;
-    if (index == NAME_NOT_FOUND) {
+    sp<CachedBuffer> cachedBuffer = mMappedBufferCache.get(stamp);
+    if (cachedBuffer == NULL) {
+        // an evicted mapping is unmapped once the widi stack returns it
         IntelDisplayBuffer* displayBuffer = mGrallocBufferManager->map(handle);
         if (displayBuffer != NULL) {
             cachedBuffer = new CachedBuffer(mGrallocBufferManager, displayBuffer);
-            mMappedBufferCache.add(handle, cachedBuffer);
+            mMappedBufferCache.add(stamp, cachedBuffer);
         }
     }
-    else {
-        cachedBuffer = mMappedBufferCache[index];
-    }
     return cachedBuffer;
 }
 
@@ -213,24 +205,85 @@ status_t WidiDisplayDevice::stop(bool isConnected) {
 
 status_t WidiDisplayDevice::notifyBufferReturned(int khandle) {
     ALOGD_IF(ALLOW_WIDI_PRINT, "%s khandle=%x", __func__, (uint32_t)khandle);
-    Mutex::Autolock _l(mHeldBuffersLock);
-    ssize_t index = mHeldBuffers.indexOfKey(khandle);
-    if (index == NAME_NOT_FOUND) {
-        LOGE("Couldn't find returned khandle %x", khandle);
-    }
-    else {
-        mHeldBuffers.removeItemsAt(index, 1);
+    // released after the lock is dropped, returning a CSC buffer takes the pool lock
+    sp<RefBase> heldBuffer;
+    {
+        Mutex::Autolock _l(mHeldBuffersLock);
+        ssize_t index = mHeldBuffers.indexOfKey(khandle);
+        if (index == NAME_NOT_FOUND) {
+            LOGE("Couldn't find returned khandle %x", khandle);
+        }
+        else {
+            heldBuffer = mHeldBuffers.valueAt(index);
+            mHeldBuffers.removeItemsAt(index, 1);
+        }
     }
     return NO_ERROR;
 }
 
 status_t WidiDisplayDevice::setResolution(const FrameProcessingPolicy& policy, sp<IFrameListener> listener) {
-    Mutex::Autolock _l(mConfigLock);
-    mNextConfig.frameListener = listener;
-    mNextConfig.policy = policy;
+    {
+        Mutex::Autolock _l(mConfigLock);
+        mNextConfig.frameListener = listener;
+        mNextConfig.policy = policy;
+    }
+    // allocate on the widi thread rather than on the next frame
+    fillCscPool(policy.scaledWidth, policy.scaledHeight);
+    trimCscPool();
     return NO_ERROR;
 }
 
+sp<GraphicBuffer> WidiDisplayDevice::allocCscBuffer(uint32_t width, uint32_t height)
+{
+    sp<GraphicBuffer> graphicBuffer =
+        new GraphicBuffer(width, height,
+                          OMX_INTEL_COLOR_FormatYUV420PackedSemiPlanar,
+                          GRALLOC_USAGE_HW_VIDEO_ENCODER | GRALLOC_USAGE_HW_RENDER);
+    if (graphicBuffer->initCheck() != NO_ERROR) {
+        ALOGE("%s: failed to allocate %dx%d CSC buffer", __func__, width, height);
+        return NULL;
+    }
+    return graphicBuffer;
+}
+
+void WidiDisplayDevice::fillCscPool(uint32_t width, uint32_t height)
+{
+    if (width == 0 || height == 0)
+        return;
+
+    uint32_t generation;
+    uint32_t key = IntelCscBufferPool<GraphicBuffer>::key(width, height);
+    int count = mCscPool.reserve(width, height, systemTime(), &generation);
+
+    // what could not be allocated is left to the frame path
+    for (int i = 0; i < count; i++)
+        mCscPool.put(key, generation, allocCscBuffer(width, height));
+}
+
+void WidiDisplayDevice::trimCscPool()
+{
+    // freed when this goes out of scope, after the pool lock
+    IntelCscBufferPool<GraphicBuffer>::BufferList trimmed;
+    mCscPool.trim(systemTime(), &trimmed);
+}
+
+sp<GraphicBuffer> WidiDisplayDevice::getCscBuffer(uint32_t width, uint32_t height,
+                                                  uint32_t *generation)
+{
+    bool allocate;
+    sp<GraphicBuffer> graphicBuffer =
+        mCscPool.get(width, height, systemTime(), generation, &allocate);
+
+    if (allocate) {
+        // not filled by setResolution, allocate here as a fallback
+        graphicBuffer = allocCscBuffer(width, height);
+        if (graphicBuffer == NULL)
+            mCscPool.put(IntelCscBufferPool<GraphicBuffer>::key(width, height),
+                         *generation, NULL);
+    }
+    return graphicBuffer;
+}
+
 bool WidiDisplayDevice::prepare(hwc_display_contents_1_t *list)
 {
     ALOGD_IF(ALLOW_WIDI_PRINT, "%s", __func__);
@@ -251,36 +304,23 @@ bool WidiDisplayDevice::prepare(hwc_display_contents_1_t *list)
     if (mCurrentConfig.typeChangeListener == NULL)
         return false;
 
-    // by default send the FRAMEBUFFER_TARGET layer (composited image)
-    mLayerToSend = list->numHwLayers-1;
-
     if (mExtendedModeInfo->widiExtHandle != NULL &&
         (!mCurrentConfig.extendedModeEnabled || !mDrm->isVideoPlaying()))
     {
         mExtendedModeInfo->widiExtHandle = NULL;
     }
 
-    // if we have an extended mode handle, find out which layer it is
-    // and send that to widi instead of the framebuffer
-    if (mExtendedModeInfo->widiExtHandle) {
-        for (size_t i = 0; i < list->numHwLayers-1; i++) {
-            hwc_layer_1_t& layer = list->hwLayers[i];
-            IMG_native_handle_t *grallocHandle =
-                (IMG_native_handle_t*)layer.handle;
-            if (grallocHandle == mExtendedModeInfo->widiExtHandle)
-            {
-                mLayerToSend = i;
-                break;
-            }
-        }
-    }
-    else if ((list->numHwLayers-1) == 1) {
-        hwc_layer_1_t& layer = list->hwLayers[0];
-        if (layer.transform == 0 && layer.blending == HWC_BLENDING_NONE) {
-            mLayerToSend = 0;
-        }
+    bool fastPath;
+    size_t layerToSend = mStream.select(list,
+                                        (buffer_handle_t)mExtendedModeInfo->widiExtHandle,
+                                        mCurrentConfig.forceNotify, &fastPath);
+    hwc_layer_1_t& streamingLayer = list->hwLayers[layerToSend];
+
+    // video only: layers are still marked as overlay, only forward the frame
+    if (fastPath) {
+        sendToWidi(streamingLayer);
+        return true;
     }
-    hwc_layer_1_t& streamingLayer = list->hwLayers[mLayerToSend];
 
     // if we're streaming the target framebuffer, just notify widi stack and return
     if (streamingLayer.compositionType == HWC_FRAMEBUFFER_TARGET) {
@@ -293,8 +333,8 @@ bool WidiDisplayDevice::prepare(hwc_display_contents_1_t *list)
             mCurrentConfig.typeChangeListener->frameTypeChanged(frameInfo);
             mCurrentConfig.typeChangeListener->bufferInfoChanged(frameInfo);
 
-            mExtLastTimestamp = 0;
-            mExtLastKhandle = 0;
+            mStream.clearLastFrame();
+            mCadence.reset();
 
             mMappedBufferCache.clear();
             mLastInputFrameInfo = frameInfo;
@@ -311,7 +351,6 @@ bool WidiDisplayDevice::prepare(hwc_display_contents_1_t *list)
     }
 
     sendToWidi(streamingLayer);
-
     return true;
 }
 
@@ -339,6 +378,17 @@ void WidiDisplayDevice::sendToWidi(const hwc_layer_1_t& layer)
         return;
     }
 
+    // the layer kept the buffer sent last, nothing new to map or hold
+    uint32_t scaledWidth = mCurrentConfig.policy.scaledWidth;
+    uint32_t scaledHeight = mCurrentConfig.policy.scaledHeight;
+    if (!mCurrentConfig.forceNotify &&
+        mStream.isSameBuffer(layer, grallocHandle->ui64Stamp,
+                             scaledWidth, scaledHeight))
+        return;
+
+    // on every frame, the video path no longer asks for CSC buffers
+    trimCscPool();
+
     uint32_t handle = (uint32_t)grallocHandle;
     HWCBufferHandleType handleType = HWC_HANDLE_TYPE_GRALLOC;
     int64_t mediaTimestamp = -1;
@@ -356,13 +406,12 @@ void WidiDisplayDevice::sendToWidi(const hwc_layer_1_t& layer)
     FrameInfo outputFrameInfo;
     outputFrameInfo = inputFrameInfo;
 
-    if (grallocHandle->iFormat == HAL_PIXEL_FORMAT_INTEL_HWC_NV12 ||
-        grallocHandle->iFormat == HAL_PIXEL_FORMAT_INTEL_HWC_NV12_VED ||
-        grallocHandle->iFormat == HAL_PIXEL_FORMAT_INTEL_HWC_NV12_TILE)
+    const IntelFormatTraits *traits = IntelFormatTraits::get(grallocHandle->iFormat);
+    if (traits && traits->has(IntelFormatTraits::FORMAT_NV12))
     {
         sp<CachedBuffer> payloadBuffer;
         intel_gralloc_payload_t *p;
-        if ((payloadBuffer = getMappedBuffer(grallocHandle->fd[1])) == NULL) {
+        if ((payloadBuffer = getMappedBuffer(grallocHandle->ui64Stamp, grallocHandle->fd[1])) == NULL) {
             ALOGE("%s: Failed to map display buffer", __func__);
             return;
         }
@@ -370,13 +419,25 @@ void WidiDisplayDevice::sendToWidi(const hwc_layer_1_t& layer)
             ALOGE("%s: Got null payload from display buffer", __func__);
             return;
         }
+
+        // the decoder did not queue a new frame. skip before the buffer
+        // is held again, releasing that hold would clear renderStatus of
+        // a buffer the widi stack may still be using
+        uint32_t khandle = (p->rotated_buffer_handle != 0 && p->metadata_transform != 0) ?
+                           p->rotated_buffer_handle : p->khandle;
+        mCadence.update(khandle, p->timestamp);
+        if (!mCurrentConfig.forceNotify && mStream.isRepeat(khandle, p->timestamp))
+            return;
+
         heldBuffer = new HeldDecoderBuffer(payloadBuffer);
 
         mediaTimestamp = p->timestamp;
 
         // default fps to 0. widi stack will decide what correct fps should be
         int displayW = 0, displayH = 0, fps = 0, isInterlace = 0;
-        mDrm->getVideoInfo(&displayW, &displayH, &fps, &isInterlace);
+        if (!mDrm->getVideoInfo(&displayW, &displayH, &fps, &isInterlace) ||
+            fps <= 0)
+            fps = mCadence.getFrameRate();
         if (fps > 0) {
             inputFrameInfo.contentFrameRateN = fps;
             inputFrameInfo.contentFrameRateD = 1;
@@ -451,35 +512,15 @@ void WidiDisplayDevice::sendToWidi(const hwc_layer_1_t& layer)
         }
     }
     else {
-        sp<GraphicBuffer> destBuffer;
-        {
-            Mutex::Autolock _l(mCscLock);
-            if (mCscWidth != mCurrentConfig.policy.scaledWidth || mCscHeight != mCurrentConfig.policy.scaledHeight) {
-                ALOGI("CSC buffers changing from %dx%d to %dx%d",
-                      mCscWidth, mCscHeight, mCurrentConfig.policy.scaledWidth, mCurrentConfig.policy.scaledHeight);
-                mAvailableCscBuffers.clear();
-                mCscWidth = mCurrentConfig.policy.scaledWidth;
-                mCscHeight = mCurrentConfig.policy.scaledHeight;
-                mCscBuffersToCreate = 4;
-            }
-
-            if (mAvailableCscBuffers.empty()) {
-                if (mCscBuffersToCreate <= 0) {
-                    ALOGW("%s: Out of CSC buffers, dropping frame", __func__);
-                    return;
-                }
-                mCscBuffersToCreate--;
-                sp<GraphicBuffer> graphicBuffer =
-                    new GraphicBuffer(mCurrentConfig.policy.scaledWidth, mCurrentConfig.policy.scaledHeight,
-                                      OMX_INTEL_COLOR_FormatYUV420PackedSemiPlanar,
-                                      GRALLOC_USAGE_HW_VIDEO_ENCODER | GRALLOC_USAGE_HW_RENDER);
-                mAvailableCscBuffers.push_back(graphicBuffer);
-
-            }
-            destBuffer = *mAvailableCscBuffers.begin();
-            mAvailableCscBuffers.erase(mAvailableCscBuffers.begin());
+        uint32_t generation;
+        sp<GraphicBuffer> destBuffer =
+            getCscBuffer(mCurrentConfig.policy.scaledWidth, mCurrentConfig.policy.scaledHeight,
+                         &generation);
+        if (destBuffer == NULL) {
+            ALOGW("%s: Out of CSC buffers, dropping frame", __func__);
+            return;
         }
-        heldBuffer = new HeldCscBuffer(this, destBuffer);
+        heldBuffer = new HeldCscBuffer(this, destBuffer, generation);
         if (mGrallocModule->Blit2(mGrallocModule,
                 (buffer_handle_t)handle, destBuffer->handle,
                 mCurrentConfig.policy.scaledWidth, mCurrentConfig.policy.scaledHeight, 0, 0))
@@ -516,15 +557,13 @@ void WidiDisplayDevice::sendToWidi(const hwc_layer_1_t& layer)
         mCurrentConfig.typeChangeListener->bufferInfoChanged(outputFrameInfo);
         mLastOutputFrameInfo = outputFrameInfo;
 
+        // left the video path, drop its mappings
         if (handleType == HWC_HANDLE_TYPE_GRALLOC)
             mMappedBufferCache.clear();
     }
 
-    if (handleType == HWC_HANDLE_TYPE_KBUF &&
-        handle == mExtLastKhandle && mediaTimestamp == mExtLastTimestamp)
-    {
+    if (handleType == HWC_HANDLE_TYPE_KBUF && mStream.isRepeat(handle, mediaTimestamp))
         return;
-    }
 
     {
         Mutex::Autolock _l(mHeldBuffersLock);
@@ -534,11 +573,12 @@ void WidiDisplayDevice::sendToWidi(const hwc_layer_1_t& layer)
     if (result != OK) {
         Mutex::Autolock _l(mHeldBuffersLock);
         mHeldBuffers.removeItem(handle);
+        return;
     }
-    if (handleType == HWC_HANDLE_TYPE_KBUF) {
-        mExtLastKhandle = handle;
-        mExtLastTimestamp = mediaTimestamp;
-    }
+    if (handleType == HWC_HANDLE_TYPE_KBUF)
+        mStream.frameSent(handle, mediaTimestamp);
+    mStream.bufferSent(layer, ((IMG_native_handle_t*)layer.handle)->ui64Stamp,
+                       scaledWidth, scaledHeight);
 }
 
 bool WidiDisplayDevice::dump(char *buff,
@@ -550,6 +590,17 @@ bool WidiDisplayDevice::dump(char *buff,
     mDumpBuflen = buff_len;
     mDumpLen = (int)(*cur_len);
 
+    dumpPrintf("-------------WIDI runtime parameters -------------\n");
+    dumpPrintf("  + mapped payloads: %d/%d, hits %u, misses %u, evictions %u\n",
+               (int)mMappedBufferCache.size(), MAPPED_BUFFER_CACHE_SIZE,
+               mMappedBufferCache.stats().hits, mMappedBufferCache.stats().misses,
+               mMappedBufferCache.stats().evictions);
+    int first, second;
+    mCadence.getPulldown(mCurrentConfig.policy.refresh, &first, &second);
+    dumpPrintf("  + video: %d fps, %d:%d at %dHz, %u frames, %u duplicates not sent\n",
+               mCadence.getFrameRate(), first, second, mCurrentConfig.policy.refresh,
+               mCadence.getFrames(), mCadence.getDuplicates());
+
     *cur_len = mDumpLen;
     return ret;
 }
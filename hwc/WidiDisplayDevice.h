@@ -35,12 +35,20 @@
 #include <utils/RefBase.h>
 
 #include "IntelDisplayDevice.h"
+#include "IntelCscBufferPool.h"
+#include "IntelFrameCadence.h"
+#include "IntelLruCache.h"
+#include "IntelWidiStreamState.h"
 #include "IFrameServer.h"
 
 using namespace android;
 
 class WidiDisplayDevice : public IntelDisplayDevice, public BnFrameServer {
 protected:
+    enum {
+        // payload mappings kept, least recently used is unmapped first
+        MAPPED_BUFFER_CACHE_SIZE = 24,
+    };
     struct CachedBuffer : public android::RefBase {
         CachedBuffer(IntelBufferManager *gbm, IntelDisplayBuffer* buffer);
         ~CachedBuffer();
@@ -48,10 +56,12 @@ protected:
         IntelDisplayBuffer* displayBuffer;
     };
     struct HeldCscBuffer : public android::RefBase {
-        HeldCscBuffer(const android::sp<WidiDisplayDevice>& wdd, const sp<GraphicBuffer>& gb);
+        HeldCscBuffer(const android::sp<WidiDisplayDevice>& wdd, const sp<GraphicBuffer>& gb,
+                      uint32_t generation);
         virtual ~HeldCscBuffer();
         android::sp<WidiDisplayDevice> wdd;
         android::sp<GraphicBuffer> buffer;
+        uint32_t generation;
     };
     struct HeldDecoderBuffer : public android::RefBase {
         HeldDecoderBuffer(const android::sp<CachedBuffer>& cachedBuffer);
@@ -68,33 +78,37 @@ protected:
     android::Mutex mConfigLock;
     Configuration mCurrentConfig;
     Configuration mNextConfig;
-    size_t mLayerToSend;
 
     WidiExtendedModeInfo *mExtendedModeInfo;
-    uint32_t mExtLastKhandle;
-    int64_t mExtLastTimestamp;
+    // streamed layer and last decoder frame sent
+    IntelWidiStreamState mStream;
+
+    // content frame rate estimated from media timestamps
+    IntelFrameCadence mCadence;
 
     int64_t mRenderTimestamp;
 
     // colorspace conversion
-    android::Mutex mCscLock;
     IMG_gralloc_module_public_t* mGrallocModule;
     alloc_device_t* mGrallocDevice;
-    android::List< android::sp<GraphicBuffer> > mAvailableCscBuffers;
-    int mCscBuffersToCreate;
-    uint32_t mCscWidth;
-    uint32_t mCscHeight;
+    IntelCscBufferPool<GraphicBuffer> mCscPool;
 
     FrameInfo mLastInputFrameInfo;
     FrameInfo mLastOutputFrameInfo;
 
-    android::KeyedVector<uint32_t, android::sp<CachedBuffer> > mMappedBufferCache;
+    // keyed by the gralloc stamp, unique for every allocation
+    IntelLruCache<uint64_t, CachedBuffer> mMappedBufferCache;
     android::Mutex mHeldBuffersLock;
     android::KeyedVector<uint32_t, android::sp<android::RefBase> > mHeldBuffers;
 
 private:
-    android::sp<CachedBuffer> getMappedBuffer(uint32_t handle);
+    android::sp<CachedBuffer> getMappedBuffer(uint64_t stamp, uint32_t handle);
     void sendToWidi(const hwc_layer_1_t& layer);
+    static android::sp<GraphicBuffer> allocCscBuffer(uint32_t width, uint32_t height);
+    void fillCscPool(uint32_t width, uint32_t height);
+    void trimCscPool();
+    android::sp<GraphicBuffer> getCscBuffer(uint32_t width, uint32_t height,
+                                            uint32_t *generation);
 
 public:
     WidiDisplayDevice(IntelBufferManager *bm,
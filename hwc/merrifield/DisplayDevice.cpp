@@ -46,7 +46,7 @@ DisplayDevice::DisplayDevice(uint32_t type, Hwcomposer& hwc, DisplayPlaneManager
       mConnection(DEVICE_DISCONNECTED),
       mInitialized(false)
 {
-    log.v("DisplayDevice()");
+    VLOG("DisplayDevice()");
 
     switch (type) {
     case DEVICE_PRIMARY:
@@ -67,24 +67,24 @@ DisplayDevice::DisplayDevice(uint32_t type, Hwcomposer& hwc, DisplayPlaneManager
 
 DisplayDevice::~DisplayDevice()
 {
-    log.v("~DisplayDevice()");
+    VLOG("~DisplayDevice()");
 }
 
 void DisplayDevice::onGeometryChanged(hwc_display_contents_1_t *list)
 {
-    log.v("DisplayDevice::onGeometryChanged, disp %d", mType);
+    VLOG("DisplayDevice::onGeometryChanged, disp %d", mType);
     // create a new layer list
     mLayerList = new HwcLayerList(list,
                                   mDisplayPlaneManager,
                                   mPrimaryPlane,
                                   mType);
     if (!mLayerList)
-        log.w("onGeometryChanged: failed to create layer list");
+        WLOG("onGeometryChanged: failed to create layer list");
 }
 
 void DisplayDevice::prePrepare(hwc_display_contents_1_t *display)
 {
-    log.v("DisplayDevice::prepare");
+    VLOG("DisplayDevice::prepare");
 
     if (!initCheck())
         return;
@@ -111,7 +111,7 @@ void DisplayDevice::prePrepare(hwc_display_contents_1_t *display)
 bool DisplayDevice::prepare(hwc_display_contents_1_t *display)
 {
 
-    log.v("DisplayDevice::prepare");
+    VLOG("DisplayDevice::prepare");
 
     if (!initCheck())
         return false;
@@ -129,7 +129,7 @@ bool DisplayDevice::prepare(hwc_display_contents_1_t *display)
         onGeometryChanged(display);
 
     if (!mLayerList) {
-        log.e("prepare: null HWC layer list");
+        ELOG("prepare: null HWC layer list");
         return false;
     }
 
@@ -141,7 +141,7 @@ bool DisplayDevice::commit(hwc_display_contents_1_t *display,
                             void *context,
                             int& count)
 {
-    log.v("commit");
+    VLOG("commit");
     return true;
 }
 
@@ -151,7 +151,7 @@ bool DisplayDevice::vsyncControl(int enabled)
     Drm& drm(Drm::getInstance());
     bool ret;
 
-    log.v("vsyncControl");
+    VLOG("vsyncControl");
 
     if (!initCheck())
         return false;
@@ -168,11 +168,11 @@ bool DisplayDevice::vsyncControl(int enabled)
     else
         arg.vsync_operation_mask = VSYNC_DISABLE;
 
-    log.v("DisplayDevice::vsyncControl: disp %d, enabled %d", mType, enabled);
+    VLOG("DisplayDevice::vsyncControl: disp %d, enabled %d", mType, enabled);
 
     ret = drm.writeReadIoctl(DRM_PSB_VSYNC_SET, &arg, sizeof(arg));
     if (ret == false) {
-        log.e("DisplayDevice::vsyncControl: failed set vsync");
+        ELOG("DisplayDevice::vsyncControl: failed set vsync");
         return false;
     }
 
@@ -182,7 +182,7 @@ bool DisplayDevice::vsyncControl(int enabled)
 
 bool DisplayDevice::blank(int blank)
 {
-    log.v("blank");
+    VLOG("blank");
 
     if (!initCheck())
         return false;
@@ -198,7 +198,7 @@ bool DisplayDevice::blank(int blank)
 bool DisplayDevice::getDisplayConfigs(uint32_t *configs,
                                          size_t *numConfigs)
 {
-    log.v("getDisplayConfigs");
+    VLOG("getDisplayConfigs");
 
     if (!initCheck())
         return false;
@@ -209,7 +209,7 @@ bool DisplayDevice::getDisplayConfigs(uint32_t *configs,
         return false;
 
     if (!configs || !numConfigs) {
-        log.e("getDisplayConfigs: invalid parameters");
+        ELOG("getDisplayConfigs: invalid parameters");
         return false;
     }
 
@@ -223,7 +223,7 @@ bool DisplayDevice::getDisplayAttributes(uint32_t configs,
                                             const uint32_t *attributes,
                                             int32_t *values)
 {
-    log.v("getDisplayAttributes");
+    VLOG("getDisplayAttributes");
 
     if (!initCheck())
         return false;
@@ -234,13 +234,13 @@ bool DisplayDevice::getDisplayAttributes(uint32_t configs,
         return false;
 
     if (!attributes || !values) {
-        log.e("getDisplayAttributes: invalid parameters");
+        ELOG("getDisplayAttributes: invalid parameters");
         return false;
     }
 
     DisplayConfig *config = mDisplayConfigs.itemAt(mActiveDisplayConfig);
     if  (!config) {
-        log.e("getDisplayAttributes: failed to get display config");
+        ELOG("getDisplayAttributes: failed to get display config");
         return false;
     }
 
@@ -263,7 +263,7 @@ bool DisplayDevice::getDisplayAttributes(uint32_t configs,
             values[i] = config->getDpiY();
             break;
         default:
-            log.e("getDisplayAttributes: unknown attribute %d", attributes[i]);
+            ELOG("getDisplayAttributes: unknown attribute %d", attributes[i]);
             break;
         }
         i++;
@@ -274,7 +274,7 @@ bool DisplayDevice::getDisplayAttributes(uint32_t configs,
 
 bool DisplayDevice::compositionComplete()
 {
-    log.v("compositionComplete");
+    VLOG("compositionComplete");
 
     if (!initCheck())
         return false;
@@ -310,13 +310,13 @@ bool DisplayDevice::updateDisplayConfigs(struct Output *output)
     float physHeightInch;
     int dpiX, dpiY;
 
-    log.d("updateDisplayConfigs()");
+    DLOG("updateDisplayConfigs()");
 
     Mutex::Autolock _l(mLock);
 
     drmConnector = output->connector;
     if (!drmConnector) {
-        log.e("DisplayDevice::updateDisplayConfigs:Output has no connector");
+        ELOG("DisplayDevice::updateDisplayConfigs:Output has no connector");
         return false;
     }
 
@@ -324,7 +324,8 @@ bool DisplayDevice::updateDisplayConfigs(struct Output *output)
     physHeightInch = (float)drmConnector->mmHeight * 0.039370f;
 
     drmModeCount = drmConnector->count_modes;
-    drmPreferredMode = 0;
+    // ranked by Drm::detect()
+    drmPreferredMode = drmModeCount ? &drmConnector->modes[output->bestMode] : 0;
 
     // reset display configs
     removeDisplayConfigs();
@@ -332,23 +333,21 @@ bool DisplayDevice::updateDisplayConfigs(struct Output *output)
     // reset the number of display configs
     mDisplayConfigs.setCapacity(drmModeCount + 1);
 
-    log.v("updateDisplayConfigs: mode count %d", drmModeCount);
+    VLOG("updateDisplayConfigs: mode count %d", drmModeCount);
 
-    // find preferred mode of this display device
+    // add all but the preferred mode of this display device
     for (int i = 0; i < drmModeCount; i++) {
         drmMode = &drmConnector->modes[i];
         dpiX = drmMode->hdisplay / physWidthInch;
         dpiY = drmMode->vdisplay / physHeightInch;
 
-        if ((drmMode->type & DRM_MODE_TYPE_PREFERRED)) {
-            drmPreferredMode = drmMode;
+        if (drmMode == drmPreferredMode)
             continue;
-        }
 
-        log.v("updateDisplayConfigs: adding new config %dx%d %d\n",
-              drmMode->hdisplay,
-              drmMode->vdisplay,
-              drmMode->vrefresh);
+        VLOG("updateDisplayConfigs: adding new config %dx%d %d\n",
+             drmMode->hdisplay,
+             drmMode->vdisplay,
+             drmMode->vrefresh);
 
         // if not preferred mode add it to display configs
         DisplayConfig *config = new DisplayConfig(drmMode->vrefresh,
@@ -369,7 +368,7 @@ bool DisplayDevice::updateDisplayConfigs(struct Output *output)
         drmCrtc = output->crtc;
         drmFb = output->fb;
         if (!drmCrtc || !drmFb) {
-            log.e("updateDisplayConfigs: impossible");
+            ELOG("updateDisplayConfigs: impossible");
             goto use_preferred_mode;
         }
 
@@ -377,10 +376,10 @@ bool DisplayDevice::updateDisplayConfigs(struct Output *output)
         if (!drmCrtc->mode_valid)
             goto use_preferred_mode;
 
-        log.v("updateDisplayConfigs: using current mode %dx%d %d\n",
-              drmMode->hdisplay,
-              drmMode->vdisplay,
-              drmMode->vrefresh);
+        VLOG("updateDisplayConfigs: using current mode %dx%d %d\n",
+             drmMode->hdisplay,
+             drmMode->vdisplay,
+             drmMode->vrefresh);
 
         // use current drm mode, likely it's preferred mode
         dpiX = drmMode->hdisplay / physWidthInch;
@@ -409,14 +408,14 @@ use_preferred_mode:
                                                   drmPreferredMode->vdisplay,
                                                   dpiX, dpiY);
         if (!config) {
-            log.e("updateDisplayConfigs: failed to allocate display config");
+            ELOG("updateDisplayConfigs: failed to allocate display config");
             return false;
         }
 
-        log.v("updateDisplayConfigs: using preferred mode %dx%d %d\n",
-              drmPreferredMode->hdisplay,
-              drmPreferredMode->vdisplay,
-              drmPreferredMode->vrefresh);
+        VLOG("updateDisplayConfigs: using preferred mode %dx%d %d\n",
+             drmPreferredMode->hdisplay,
+             drmPreferredMode->vdisplay,
+             drmPreferredMode->vrefresh);
 
         // add it to the front of other configs
         mDisplayConfigs.push_front(config);
@@ -434,7 +433,7 @@ bool DisplayDevice::detectDisplayConfigs()
     bool ret;
     Drm& drm(Drm::getInstance());
 
-    log.d("detectDisplayConfigs");
+    DLOG("detectDisplayConfigs");
 
     // detect drm objects
     switch (mType) {
@@ -449,21 +448,21 @@ bool DisplayDevice::detectDisplayConfigs()
     }
 
     if (outputIndex < 0) {
-        log.w("detectDisplayConfigs(): failed to detect Drm objects");
+        WLOG("detectDisplayConfigs(): failed to detect Drm objects");
         return false;
     }
 
     // detect
     ret = drm.detect();
     if (ret == false) {
-        log.e("detectDisplayConfigs(): Drm detection failed");
+        ELOG("detectDisplayConfigs(): Drm detection failed");
         return false;
     }
 
     // get output
     output = drm.getOutput(outputIndex);
     if (!output) {
-        log.e("detectDisplayConfigs(): failed to get output");
+        ELOG("detectDisplayConfigs(): failed to get output");
         return false;
     }
 
@@ -476,19 +475,19 @@ bool DisplayDevice::initialize()
 {
     bool ret;
 
-    log.v("DisplayDevice::initialize");
+    VLOG("DisplayDevice::initialize");
 
     // detect display configs
     ret = detectDisplayConfigs();
     if (ret == false) {
-        log.e("initialize(): failed to detect display config");
+        ELOG("initialize(): failed to detect display config");
         return false;
     }
 
     // get primary plane of this device
     mPrimaryPlane = mDisplayPlaneManager.getPrimaryPlane(mType);
     if (!mPrimaryPlane) {
-        log.e("initialize(): failed to get primary plane");
+        ELOG("initialize(): failed to get primary plane");
         goto prim_err;
     }
 
@@ -523,12 +522,15 @@ int DisplayDevice::getType() const
 
 void DisplayDevice::onHotplug(int connected)
 {
-    log.v("DisplayDevice::onHotplug");
+    VLOG("DisplayDevice::onHotplug");
+
+    // connector state changed, next detection has to query the kernel
+    Drm::getInstance().invalidate();
 }
 
 void DisplayDevice::onVsync(int64_t timestamp)
 {
-    log.v("DisplayDevice::timestamp");
+    VLOG("DisplayDevice::timestamp");
 
     if (!initCheck())
         return;
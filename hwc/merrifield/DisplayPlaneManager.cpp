@@ -74,7 +74,7 @@ bool DisplayPlaneManager::initialize()
     int i;
     size_t j;
 
-    log.v("DisplayPlaneManager::initialize");
+    VLOG("DisplayPlaneManager::initialize");
 
     // detect display plane usage. Hopefully throw DRM ioctl
     detect();
@@ -86,7 +86,7 @@ bool DisplayPlaneManager::initialize()
         for (i = 0; i < mPrimaryPlaneCount; i++) {
             IDisplayPlane* plane = allocPlane(i, IDisplayPlane::PLANE_PRIMARY);
             if (!plane) {
-                log.e("initialize: failed to allocate primary plane %d", i);
+                ELOG("initialize: failed to allocate primary plane %d", i);
                 goto primary_err;;
             }
             // reset overlay plane
@@ -98,7 +98,7 @@ bool DisplayPlaneManager::initialize()
         // allocate dummy primary plane
         mDummyPrimaryPlane = allocPlane(-1, IDisplayPlane::PLANE_PRIMARY);
         if (!mDummyPrimaryPlane) {
-            log.e("initialize: failed to allocate dummy primary plane");
+            ELOG("initialize: failed to allocate dummy primary plane");
             goto dummy_primary_err;
         }
     }
@@ -110,7 +110,7 @@ bool DisplayPlaneManager::initialize()
         for (i = 0; i < mSpritePlaneCount; i++) {
             IDisplayPlane* plane = allocPlane(i, IDisplayPlane::PLANE_SPRITE);
             if (!plane) {
-                log.e("initialize: failed to allocate sprite plane %d", i);
+                ELOG("initialize: failed to allocate sprite plane %d", i);
                 goto sprite_err;
             }
             // reset overlay plane
@@ -122,7 +122,7 @@ bool DisplayPlaneManager::initialize()
         // allocate dummy primary plane
         mDummySpritePlane = allocPlane(-1, IDisplayPlane::PLANE_SPRITE);
         if (!mDummySpritePlane) {
-            log.e("initialize: failed to allocate dummy sprite plane");
+            ELOG("initialize: failed to allocate dummy sprite plane");
             goto dummy_sprite_err;
         }
     }
@@ -133,7 +133,7 @@ bool DisplayPlaneManager::initialize()
         for (i = 0; i < mOverlayPlaneCount; i++) {
             IDisplayPlane* plane = allocPlane(i, IDisplayPlane::PLANE_OVERLAY);
             if (!plane) {
-                log.e("initialize: failed to allocate sprite plane %d", i);
+                ELOG("initialize: failed to allocate sprite plane %d", i);
                 goto overlay_err;
             }
             // reset overlay plane
@@ -144,7 +144,7 @@ bool DisplayPlaneManager::initialize()
 
         mDummyOverlayPlane = allocPlane(-1, IDisplayPlane::PLANE_OVERLAY);
         if (!mDummyOverlayPlane) {
-            log.e("initialize: failed to allocate dummy overlay plane");
+            ELOG("initialize: failed to allocate dummy overlay plane");
             goto overlay_err;
         }
     }
@@ -173,12 +173,12 @@ primary_err:
 
 void DisplayPlaneManager::detect()
 {
-    log.v("DisplayPlaneManager::detect");
+    VLOG("DisplayPlaneManager::detect");
 }
 
 IDisplayPlane* DisplayPlaneManager::allocPlane(int index, int type)
 {
-    log.v("DisplayPlaneManager::allocPlane");
+    VLOG("DisplayPlaneManager::allocPlane");
     return 0;
 }
 
@@ -206,7 +206,7 @@ void DisplayPlaneManager::putPlane(int index, uint32_t& mask)
     int bit = (1 << index);
 
     if (bit & mask) {
-        log.w("putPlane: bit %d was set", index);
+        WLOG("putPlane: bit %d was set", index);
         return;
     }
 
@@ -230,7 +230,7 @@ int DisplayPlaneManager::getPlane(uint32_t& mask, int index)
 IDisplayPlane* DisplayPlaneManager::getSpritePlane()
 {
     if (!initCheck()) {
-        log.e("getSpritePlane: plane manager was not initialized\n");
+        ELOG("getSpritePlane: plane manager was not initialized\n");
         return 0;
     }
 
@@ -245,14 +245,14 @@ IDisplayPlane* DisplayPlaneManager::getSpritePlane()
     freePlaneIndex = getPlane(mFreeSpritePlanes);
     if (freePlaneIndex >= 0)
         return mSpritePlanes.itemAt(freePlaneIndex);
-    log.e("getSpritePlane: failed to get a sprite plane\n");
+    ELOG("getSpritePlane: failed to get a sprite plane\n");
     return 0;
 }
 
 IDisplayPlane* DisplayPlaneManager::getPrimaryPlane(int pipe)
 {
     if (!initCheck()) {
-        log.e("getSpritePlane: plane manager was not initialized\n");
+        ELOG("getSpritePlane: plane manager was not initialized\n");
         return 0;
     }
 
@@ -267,14 +267,14 @@ IDisplayPlane* DisplayPlaneManager::getPrimaryPlane(int pipe)
     freePlaneIndex = getPlane(mFreePrimaryPlanes, pipe);
     if (freePlaneIndex >= 0)
         return mPrimaryPlanes.itemAt(freePlaneIndex);
-    log.e("getPrimaryPlane: failed to get a primary plane\n");
+    ELOG("getPrimaryPlane: failed to get a primary plane\n");
     return 0;
 }
 
 IDisplayPlane* DisplayPlaneManager::getOverlayPlane()
 {
     if (!initCheck()) {
-        log.e("getOverlayPlane: plane manager was not initialized\n");
+        ELOG("getOverlayPlane: plane manager was not initialized\n");
         return 0;
     }
 
@@ -288,7 +288,7 @@ IDisplayPlane* DisplayPlaneManager::getOverlayPlane()
     }
 
     if (freePlaneIndex < 0) {
-       log.e("getOverlayPlane: failed to get a overlay plane\n");
+       ELOG("getOverlayPlane: failed to get a overlay plane\n");
        return 0;
     }
 
@@ -313,7 +313,7 @@ void DisplayPlaneManager::putOverlayPlane(IDisplayPlane& plane)
 IDisplayPlane* DisplayPlaneManager::getSpritePlane(int& where)
 {
     if (!initCheck()) {
-        log.e("getSpritePlane: plane manager was not initialized\n");
+        ELOG("getSpritePlane: plane manager was not initialized\n");
         return 0;
     }
 
@@ -332,14 +332,14 @@ IDisplayPlane* DisplayPlaneManager::getSpritePlane(int& where)
         where = PLANE_ON_FREE_LIST;
         return mSpritePlanes.itemAt(freePlaneIndex);
     }
-    log.e("getSpritePlane: failed to get a sprite plane\n");
+    ELOG("getSpritePlane: failed to get a sprite plane\n");
     return 0;
 }
 
 IDisplayPlane* DisplayPlaneManager::getOverlayPlane(int& where)
 {
     if (!initCheck()) {
-        log.e("getOverlayPlane: plane manager was not initialized\n");
+        ELOG("getOverlayPlane: plane manager was not initialized\n");
         return 0;
     }
 
@@ -358,7 +358,7 @@ IDisplayPlane* DisplayPlaneManager::getOverlayPlane(int& where)
         return mOverlayPlanes.itemAt(freePlaneIndex);
     }
 
-    log.e("getOverlayPlane: failed to get a overlay plane\n");
+    ELOG("getOverlayPlane: failed to get a overlay plane\n");
     return 0;
 }
 
@@ -396,7 +396,7 @@ void DisplayPlaneManager::putOverlayPlane(IDisplayPlane& plane, int where)
 IDisplayPlane* DisplayPlaneManager::getDummyPrimaryPlane()
 {
     if (!initCheck()) {
-        log.e("getOverlayPlane: plane manager was not initialized\n");
+        ELOG("getOverlayPlane: plane manager was not initialized\n");
         return 0;
     }
 
@@ -406,7 +406,7 @@ IDisplayPlane* DisplayPlaneManager::getDummyPrimaryPlane()
 IDisplayPlane* DisplayPlaneManager::getDummySpritePlane()
 {
     if (!initCheck()) {
-        log.e("getOverlayPlane: plane manager was not initialized\n");
+        ELOG("getOverlayPlane: plane manager was not initialized\n");
         return 0;
     }
 
@@ -416,7 +416,7 @@ IDisplayPlane* DisplayPlaneManager::getDummySpritePlane()
 IDisplayPlane* DisplayPlaneManager::getDummyOverlayPlane()
 {
     if (!initCheck()) {
-        log.e("getOverlayPlane: plane manager was not initialized\n");
+        ELOG("getOverlayPlane: plane manager was not initialized\n");
         return 0;
     }
 
@@ -493,13 +493,13 @@ bool DisplayPlaneManager::primaryAvailable(int pipe)
 void DisplayPlaneManager::reclaimPlane(IDisplayPlane& plane)
 {
     if (!initCheck()) {
-        log.e("reclaimPlane: plane manager is not initialized\n");
+        ELOG("reclaimPlane: plane manager is not initialized\n");
         return;
     }
 
     int index = plane.getIndex();
 
-    log.v("reclaimPlane: reclaimPlane %d, type %d\n", index, plane.getType());
+    VLOG("reclaimPlane: reclaimPlane %d, type %d\n", index, plane.getType());
 
     if (plane.getType() == IDisplayPlane::PLANE_OVERLAY)
         putPlane(index, mReclaimedOverlayPlanes);
@@ -508,23 +508,23 @@ void DisplayPlaneManager::reclaimPlane(IDisplayPlane& plane)
     else if (plane.getType() == IDisplayPlane::PLANE_PRIMARY)
         putPlane(index, mReclaimedPrimaryPlanes);
     else
-        log.e("reclaimPlane: invalid plane type %d", plane.getType());
+        ELOG("reclaimPlane: invalid plane type %d", plane.getType());
 }
 
 void DisplayPlaneManager::disableReclaimedPlanes()
 {
     if (!initCheck()) {
-        log.e("disableReclaimedPlanes: plane manager is not initialized");
+        ELOG("disableReclaimedPlanes: plane manager is not initialized");
         return;
     }
 
-    log.v("DisplayPlaneManager::disableReclaimedPlanes: "
-          "sprite %d, reclaimed 0x%x"
-          "primary %d, reclaimed 0x%x"
-          "overlay %d, reclaimed 0x%x",
-          mSpritePlanes.size(), mReclaimedSpritePlanes,
-          mPrimaryPlanes.size(), mReclaimedPrimaryPlanes,
-          mOverlayPlanes.size(), mReclaimedOverlayPlanes);
+    VLOG("DisplayPlaneManager::disableReclaimedPlanes: "
+         "sprite %d, reclaimed 0x%x"
+         "primary %d, reclaimed 0x%x"
+         "overlay %d, reclaimed 0x%x",
+         mSpritePlanes.size(), mReclaimedSpritePlanes,
+         mPrimaryPlanes.size(), mReclaimedPrimaryPlanes,
+         mOverlayPlanes.size(), mReclaimedOverlayPlanes);
 
     // disable reclaimed sprite planes
     if (mSpritePlanes.size() && mReclaimedSpritePlanes) {
@@ -45,28 +45,58 @@ Drm::Drm() : Singleton<Drm>()
 {
     int fd = open("/dev/card0", O_RDWR, 0);
     if (fd < 0) {
-        log.e("Drm(): drmOpen failed. %s", strerror(errno));
+        ELOG("Drm(): drmOpen failed. %s", strerror(errno));
     }
 
     mDrmFd = fd;
     memset(&mOutputs, 0, sizeof(mOutputs));
+    mGeneration = 1;
+    mDetectedGeneration = 0;
 
     LOGD("Drm(): successfully. mDrmFd %d", fd);
 }
 
+static int selectBestMode(drmModeConnectorPtr connector)
+{
+    int best = 0;
+
+    for (int i = 0; i < connector->count_modes; i++) {
+        drmModeModeInfoPtr mode = &connector->modes[i];
+        drmModeModeInfoPtr max = &connector->modes[best];
+
+        if (mode->type & DRM_MODE_TYPE_PREFERRED)
+            return i;
+        if (mode->hdisplay * mode->vdisplay > max->hdisplay * max->vdisplay ||
+            (mode->hdisplay * mode->vdisplay == max->hdisplay * max->vdisplay &&
+             mode->vrefresh > max->vrefresh))
+            best = i;
+    }
+    return best;
+}
+
+void Drm::invalidate()
+{
+    Mutex::Autolock _l(mLock);
+    mGeneration++;
+}
+
 bool Drm::detect()
 {
     Mutex::Autolock _l(mLock);
 
     if (mDrmFd < 0) {
-        log.e("detect(): invalid Fd");
+        ELOG("detect(): invalid Fd");
         return false;
     }
 
+    // nothing changed since the last detection
+    if (mDetectedGeneration == mGeneration)
+        return true;
+
     // try to get drm resources
     drmModeResPtr resources = drmModeGetResources(mDrmFd);
     if (!resources || !resources->connectors) {
-        log.e("detect(): fail to get drm resources. %s\n", strerror(errno));
+        ELOG("detect(): fail to get drm resources. %s\n", strerror(errno));
         return false;
     }
 
@@ -81,25 +111,25 @@ bool Drm::detect()
     for (int i = 0; i < resources->count_connectors; i++) {
         connector = drmModeGetConnector(mDrmFd, resources->connectors[i]);
         if (!connector) {
-            log.e("detect(): fail to get drm connector\n");
+            ELOG("detect(): fail to get drm connector\n");
             continue;
         }
 
         int outputIndex = -1;
         if (connector->connector_type == DRM_MODE_CONNECTOR_MIPI ||
             connector->connector_type == DRM_MODE_CONNECTOR_LVDS) {
-            log.v("detect(): got MIPI/LVDS connector\n");
+            VLOG("detect(): got MIPI/LVDS connector\n");
             if (connector->connector_type_id == 1)
                 outputIndex = OUTPUT_MIPI0;
             else if (connector->connector_type_id == 2)
                 outputIndex = OUTPUT_MIPI1;
             else {
-                log.w("detect(): unknown connector type\n");
+                WLOG("detect(): unknown connector type\n");
                 // FIXME: sure?
                 outputIndex = OUTPUT_MIPI0;
             }
         } else if (connector->connector_type == DRM_MODE_CONNECTOR_DVID) {
-            log.v("detect(): got HDMI connector\n");
+            VLOG("detect(): got HDMI connector\n");
             outputIndex = OUTPUT_HDMI;
         }
 
@@ -131,11 +161,12 @@ bool Drm::detect()
         }
 
         output->connector = connector;
+        output->bestMode = selectBestMode(connector);
 
         // get current encoder
         encoder = drmModeGetEncoder(mDrmFd, connector->encoder_id);
         if (!encoder) {
-            log.e("detect(): fail to get drm encoder\n");
+            ELOG("detect(): fail to get drm encoder\n");
             continue;
         }
 
@@ -144,7 +175,7 @@ bool Drm::detect()
         // get crtc
         crtc = drmModeGetCrtc(mDrmFd, encoder->crtc_id);
         if (!crtc) {
-            log.e("detect(): fail to get drm crtc\n");
+            ELOG("detect(): fail to get drm crtc\n");
             continue;
         }
 
@@ -153,7 +184,7 @@ bool Drm::detect()
         // get fb info
         fbInfo = drmModeGetFB(mDrmFd, crtc->buffer_id);
         if (!fbInfo) {
-            log.e("detect(): fail to get fb info\n");
+            ELOG("detect(): fail to get fb info\n");
             continue;
         }
 
@@ -168,18 +199,19 @@ bool Drm::detect()
 
     drmModeFreeResources(resources);
 
+    mDetectedGeneration = mGeneration;
     return true;
 }
 
 bool Drm::setMode(int output, drmModeModeInfoPtr mode)
 {
     if (!mode) {
-        log.e("Drm::setMode: invalid parameters");
+        ELOG("Drm::setMode: invalid parameters");
         return false;
     }
 
-    log.d("Drm::setMode: %dx%d %d",
-          mode->hdisplay, mode->vdisplay, mode->vrefresh);
+    DLOG("Drm::setMode: %dx%d %d",
+         mode->hdisplay, mode->vdisplay, mode->vrefresh);
 
     return false;
 }
@@ -192,18 +224,18 @@ bool Drm::writeReadIoctl(unsigned long cmd, void *data,
     Mutex::Autolock _l(mLock);
 
     if (mDrmFd <= 0) {
-        log.e("Drm is not initialized");
+        ELOG("Drm is not initialized");
         return false;
     }
 
     if (!data || !size) {
-        log.e("Invalid parameters");
+        ELOG("Invalid parameters");
         return false;
     }
 
     err = drmCommandWriteRead(mDrmFd, cmd, data, size);
     if (err) {
-        log.e("Drm::Failed call 0x%x ioct with failure %d", cmd, err);
+        ELOG("Drm::Failed call 0x%x ioct with failure %d", cmd, err);
         return false;
     }
 
@@ -218,18 +250,18 @@ bool Drm::writeIoctl(unsigned long cmd, void *data,
     Mutex::Autolock _l(mLock);
 
     if (mDrmFd <= 0) {
-        log.e("Drm is not initialized");
+        ELOG("Drm is not initialized");
         return false;
     }
 
     if (!data || !size) {
-        log.e("Invalid parameters");
+        ELOG("Invalid parameters");
         return false;
     }
 
     err = drmCommandWrite(mDrmFd, cmd, data, size);
     if (err) {
-        log.e("Drm::Failed call 0x%x ioct with failure %d", cmd, err);
+        ELOG("Drm::Failed call 0x%x ioct with failure %d", cmd, err);
         return false;
     }
 
@@ -246,7 +278,7 @@ struct Output* Drm::getOutput(int output)
     Mutex::Autolock _l(mLock);
 
     if (output < 0 || output >= OUTPUT_MAX) {
-        log.e("getOutput(): invalid output %d", output);
+        ELOG("getOutput(): invalid output %d", output);
         return 0;
     }
 
@@ -258,7 +290,7 @@ bool Drm::outputConnected(int output)
     Mutex::Autolock _l(mLock);
 
     if (output < 0 || output >= OUTPUT_MAX) {
-        log.e("outputConnected(): invalid output %d", output);
+        ELOG("outputConnected(): invalid output %d", output);
         return false;
     }
 
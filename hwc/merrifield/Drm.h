@@ -45,6 +45,8 @@ struct Output {
     drmModeCrtcPtr crtc;
     drmModeFBPtr fb;
     int connected;
+    // connector mode index: preferred mode, or the biggest one
+    int bestMode;
 };
 
 class Drm : public android::Singleton<Drm> {
@@ -59,8 +61,10 @@ public:
 public:
     Drm();
 public:
-    // mode setting
+    // mode setting, detect() only queries the kernel again after
+    // invalidate()
     bool detect();
+    void invalidate();
     bool setMode(int output, drmModeModeInfoPtr mode);
 
     bool writeReadIoctl(unsigned long cmd, void *data,
@@ -74,6 +78,9 @@ public:
 private:
     int mDrmFd;
     struct Output mOutputs[OUTPUT_MAX];
+    // detection results are valid while these match
+    uint32_t mGeneration;
+    uint32_t mDetectedGeneration;
     Mutex mLock;
 };
 
@@ -43,12 +43,12 @@ HotplugEventObserver::HotplugEventObserver(IDisplayDevice& disp)
     : mDisplayDevice(disp),
       mUeventFd(-1)
 {
-    log.d("HotplugEventObserver");
+    DLOG("HotplugEventObserver");
 }
 
 HotplugEventObserver::~HotplugEventObserver()
 {
-    log.d("~HotplugEventObserver");
+    DLOG("~HotplugEventObserver");
 }
 
 void HotplugEventObserver::onUEvent(const char *msg, int msgLen)
@@ -62,8 +62,8 @@ void HotplugEventObserver::onUEvent(const char *msg, int msgLen)
 
     do {
         if (!strncmp(msg, "HOTPLUG=1", strlen("HOTPLUG=1"))) {
-            log.d("HotplugEventObserver::onUEvent: disp %d,",
-                  mDisplayDevice.getType());
+            DLOG("HotplugEventObserver::onUEvent: disp %d,",
+                 mDisplayDevice.getType());
             //connection = IDisplayDevice::DEVICE_CONNECTED;
 
             // notify device
@@ -101,7 +101,7 @@ bool HotplugEventObserver::threadLoop()
 
 status_t HotplugEventObserver::readyToRun()
 {
-    log.d("HotplugEventObserver::readyToRun");
+    DLOG("HotplugEventObserver::readyToRun");
 
     struct sockaddr_nl addr;
     int sz = 64*1024;
@@ -113,7 +113,7 @@ status_t HotplugEventObserver::readyToRun()
 
     mUeventFd = socket(PF_NETLINK, SOCK_DGRAM, NETLINK_KOBJECT_UEVENT);
     if(mUeventFd < 0) {
-        log.d("HotplugEventObserver::readyToRun: failed create uevent sockect");
+        DLOG("HotplugEventObserver::readyToRun: failed create uevent sockect");
         return TIMED_OUT;
     }
 
@@ -130,7 +130,7 @@ status_t HotplugEventObserver::readyToRun()
 
 void HotplugEventObserver::onFirstRef()
 {
-    log.d("HotplugEventObserver::onFirstRef");
+    DLOG("HotplugEventObserver::onFirstRef");
     run("HotplugEventObserver", PRIORITY_URGENT_DISPLAY);
 }
 
@@ -25,7 +25,10 @@
  *    Jackie Li <yaodong.li@intel.com>
  *
  */
+#include <stdlib.h>
+#include <string.h>
 #include <HwcConfig.h>
+#include <Log.h>
 #include <cutils/properties.h>
 
 namespace android {
@@ -35,29 +38,75 @@ ANDROID_SINGLETON_STATIC_INSTANCE(HwcConfig);
 
 namespace intel {
 
-HwcConfig::HwcConfig() : Singleton<HwcConfig>()
+HwcConfig::HwcConfig()
+    : Singleton<HwcConfig>(),
+      mCurrent(0),
+      mRetired(0),
+      mQuiescent(0),
+      mFrame(0)
 {
+    mCurrent = new Published;
+    memset(mCurrent, 0, sizeof(Published));
+    load(mCurrent->values);
+    mFrame = mCurrent;
+}
 
+HwcConfig::~HwcConfig()
+{
+    delete mCurrent;
+    delete mRetired;
 }
 
-void HwcConfig::debugLogLevel(int& value)
+void HwcConfig::load(Snapshot& snapshot)
 {
-    char propValueString[32];
+    char propValueString[PROPERTY_VALUE_MAX];
 
     property_get(HWC_CONFIG_DEBUG_LOG_LEVEL,
                  propValueString,
                  HWC_CONFIG_DEFAULT_LOG_LEVEL);
-    value = atoi(propValueString);
-}
-
-void HwcConfig::extendVideo(int& value)
-{
-    char propValueString[32];
+    snapshot.debugLogLevel = atoi(propValueString);
 
     property_get(HWC_CONFIG_FEATURE_EXTEND_VIDEO,
                  propValueString,
                  HWC_CONFIG_DEFAULT_VIDEO_MODE_SUPPORT);
-    value = atoi(propValueString);
+    snapshot.extendVideo = atoi(propValueString);
+}
+
+const HwcConfig::Snapshot& HwcConfig::beginFrame()
+{
+    // the previous frame is done, and with it its snapshot
+    mFrame = __atomic_load_n(&mCurrent, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&mQuiescent, mFrame->generation, __ATOMIC_RELEASE);
+    return mFrame->values;
+}
+
+void HwcConfig::reload()
+{
+    Mutex::Autolock _l(mLock);
+    Published *current = mCurrent;
+
+    if (mRetired) {
+        // the frame thread is still on it, try again on the next reload
+        if (__atomic_load_n(&mQuiescent, __ATOMIC_ACQUIRE) ==
+            mRetired->generation)
+            return;
+        delete mRetired;
+        mRetired = 0;
+    }
+
+    Published *next = new Published;
+    memset(next, 0, sizeof(Published));
+    load(next->values);
+    if (!memcmp(&next->values, &current->values, sizeof(Snapshot))) {
+        delete next;
+        return;
+    }
+
+    next->generation = current->generation + 1;
+    mRetired = current;
+    __atomic_store_n(&mCurrent, next, __ATOMIC_RELEASE);
+
+    Log::setLevel(next->values.debugLogLevel);
 }
 
 } // namespace intel
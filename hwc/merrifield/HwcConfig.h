@@ -28,7 +28,9 @@
 #ifndef HWCCONFIG_H_
 #define HWCCONFIG_H_
 
+#include <stdint.h>
 #include <utils/Singleton.h>
+#include <utils/threads.h>
 
 namespace android {
 namespace intel {
@@ -56,11 +58,41 @@ public:
         UNSUPPORTED = 0,
         SUPPORTED,
     };
+    // property values, immutable once published
+    struct Snapshot {
+        int debugLogLevel;
+        int extendVideo;
+    };
 public:
     HwcConfig();
+    ~HwcConfig();
 public:
-    void debugLogLevel(int& value);
-    void extendVideo(int& value);
+    // frame thread, at the start of prepare(). takes the current
+    // configuration with one acquire load, it stays in use until the
+    // next frame
+    const Snapshot& beginFrame();
+    // frame thread, the configuration taken by the last beginFrame()
+    inline const Snapshot& get() const {
+        return mFrame->values;
+    }
+    // re-read the properties, publish a new snapshot if anything
+    // changed. never called from the frame path. the replaced one is
+    // freed once the frame thread has moved past it, until then
+    // nothing new is published
+    void reload();
+private:
+    struct Published {
+        Snapshot values;
+        uint32_t generation;
+    };
+    void load(Snapshot& snapshot);
+private:
+    Mutex mLock;
+    Published *mCurrent;
+    Published *mRetired;
+    // generation the frame thread works on
+    uint32_t mQuiescent;
+    const Published *mFrame;
 };
 
 } // namespace intel
@@ -54,7 +54,7 @@ HwcLayer::~HwcLayer()
 bool HwcLayer::attachPlane(IDisplayPlane* plane)
 {
     if (mPlane) {
-        log.e("attachPlane: failed to attach plane, plane exists");
+        ELOG("attachPlane: failed to attach plane, plane exists");
         return false;
     }
 
@@ -124,7 +124,7 @@ bool HwcLayer::update(hwc_layer_1_t *layer, int disp)
             outputIndex = Drm::OUTPUT_HDMI;
             break;
         default:
-            log.e("HwcLayer::update: unsupported device %d", disp);
+            ELOG("HwcLayer::update: unsupported device %d", disp);
             return false;
         }
 
@@ -160,7 +160,7 @@ HwcLayerList::HwcLayerList(hwc_display_contents_1_t *list,
       mFramebufferTarget(0),
       mDisplayIndex(disp)
 {
-    log.v("HwcLayerList: layer count = %d", list->numHwLayers);
+    VLOG("HwcLayerList: layer count = %d", list->numHwLayers);
 
     if (mList) {
         mLayers.setCapacity(list->numHwLayers);
@@ -210,28 +210,28 @@ bool HwcLayerList::check(IDisplayPlane& plane, hwc_layer_1_t& layer)
 
     // check layer flags
     if (layer.flags & HWC_SKIP_LAYER) {
-        log.v("plane type %d: (skip layer flag was set)", plane.getType());
+        VLOG("plane type %d: (skip layer flag was set)", plane.getType());
         goto check_out;
     }
 
     // check buffer format
     valid = plane.isValidBuffer((uint32_t)layer.handle);
     if (!valid) {
-        log.v("plane type %d: (bad buffer format)", plane.getType());
+        VLOG("plane type %d: (bad buffer format)", plane.getType());
         goto check_out;
     }
 
     // check layer blending
     valid = plane.isValidBlending((uint32_t)layer.blending);
     if (!valid) {
-        log.v("plane type %d: layer %d: (bad blending)", plane.getType());
+        VLOG("plane type %d: layer %d: (bad blending)", plane.getType());
         goto check_out;
     }
 
     // check layer scaling
     valid = plane.isValidScaling(layer.sourceCrop, layer.displayFrame);
     if (!valid) {
-        log.v("plane type %d: layer %d: (bad scaling)", plane.getType());
+        VLOG("plane type %d: layer %d: (bad scaling)", plane.getType());
         goto check_out;
     }
 
@@ -317,7 +317,7 @@ void HwcLayerList::revisit()
     if ((mFBLayers.size() == 1)) {
         HwcLayer *hwcLayer = mFBLayers.itemAt(0);
         if (check(*mPrimaryPlane, *(hwcLayer->getLayer()))) {
-            log.v("primary check passed for primary layer");
+            VLOG("primary check passed for primary layer");
             // attach primary to hwc layer
             hwcLayer->attachPlane(mPrimaryPlane);
             // set the layer type to primary
@@ -331,17 +331,17 @@ void HwcLayerList::revisit()
 
     // attach frame buffer target
     if (!mPrimaryPlane) {
-        log.w("HwcLayerList::revisit: no primary plane");
+        WLOG("HwcLayerList::revisit: no primary plane");
         return;
     }
 
     if (!mFramebufferTarget) {
-        log.w("HwcLayerList::revisit: no frame buffer target");
+        WLOG("HwcLayerList::revisit: no frame buffer target");
         return;
     }
 
     if (mFBLayers.size()) {
-        log.v("analyzeFrom: using frame buffer target");
+        VLOG("analyzeFrom: using frame buffer target");
         hwc_layer_1_t *layer = mFramebufferTarget->getLayer();
 
         // attach primary plane
@@ -360,14 +360,12 @@ void HwcLayerList::analyzeFrom(uint32_t index)
     int freeSpriteCount = 0;
     int freeOverlayCount = 0;
     bool primaryAvailable = true;
-    int supportExtendVideo = 0;
     IDisplayPlane *plane;
 
     if (!mList || index >= mLayerCount)
         return;
 
-    // load prop
-    HwcConfig::getInstance().extendVideo(supportExtendVideo);
+    const HwcConfig::Snapshot& config = HwcConfig::getInstance().get();
 
     freeSpriteCount = mDisplayPlaneManager.getFreeSpriteCount();
     freeOverlayCount = mDisplayPlaneManager.getFreeOverlayCount();
@@ -388,7 +386,7 @@ void HwcLayerList::analyzeFrom(uint32_t index)
         // new hwc layer
         HwcLayer *hwcLayer = new HwcLayer(i, layer);
         if (!hwcLayer) {
-            log.e("failed to allocate hwc layer");
+            ELOG("failed to allocate hwc layer");
             continue;
         }
 
@@ -405,9 +403,9 @@ void HwcLayerList::analyzeFrom(uint32_t index)
         if (freeSpriteCount) {
             plane = mDisplayPlaneManager.getDummySpritePlane();
             if (!plane)
-                log.e("failed to get dummy sprite plane");
+                ELOG("failed to get dummy sprite plane");
             else if (check(*plane, *layer)) {
-                log.v("sprite check passed for layer %d", i);
+                VLOG("sprite check passed for layer %d", i);
                 plane = mDisplayPlaneManager.getSpritePlane();
                 if (plane) {
                     // attach plane to hwc layer
@@ -422,9 +420,9 @@ void HwcLayerList::analyzeFrom(uint32_t index)
         if (freeOverlayCount) {
             plane = mDisplayPlaneManager.getDummyOverlayPlane();
             if (!plane) {
-                log.e("failed to get dummy sprite plane");
+                ELOG("failed to get dummy sprite plane");
             } else if (check(*plane, *layer)) {
-                log.v("overlay check passed for layer %d", i);
+                VLOG("overlay check passed for layer %d", i);
                 plane = mDisplayPlaneManager.getOverlayPlane();
                 if (plane) {
                     // attach plane to hwc layer
@@ -434,7 +432,7 @@ void HwcLayerList::analyzeFrom(uint32_t index)
                 }
 
                 // check wheter we are supporting extend video mode
-                if (supportExtendVideo) {
+                if (config.extendVideo) {
                     bool extConnected =
                           Drm::getInstance().outputConnected(Drm::OUTPUT_HDMI);
                     if (extConnected && plane && !mDisplayIndex) {
@@ -467,18 +465,18 @@ bool HwcLayerList::update(hwc_display_contents_1_t *list)
     bool ret;
     bool updateError = false;
 
-    log.v("HwcLayerList::update");
+    VLOG("HwcLayerList::update");
 
     // basic check to make sure the consistance
     if (!list) {
-        log.e("update: null layer list");
+        ELOG("update: null layer list");
         return false;
     }
 
     if (list->numHwLayers != mLayerCount ||
         list->numHwLayers != mLayers.size()) {
-        log.e("update: update layer count doesn't match (%d, %d, %d)",
-              list->numHwLayers, mLayerCount, mLayers.size());
+        ELOG("update: update layer count doesn't match (%d, %d, %d)",
+             list->numHwLayers, mLayerCount, mLayers.size());
         return false;
     }
 
@@ -491,13 +489,13 @@ bool HwcLayerList::update(hwc_display_contents_1_t *list)
         for (size_t i = 0; i < list->numHwLayers; i++) {
             HwcLayer *hwcLayer = mLayers.itemAt(i);
             if (!hwcLayer) {
-                log.e("update: no HWC layer for layer %d", i);
+                ELOG("update: no HWC layer for layer %d", i);
                 continue;
             }
 
             ret = hwcLayer->update(&list->hwLayers[i], mDisplayIndex);
             if (ret == false) {
-                log.i("update: failed to update layer %d", i);
+                ILOG("update: failed to update layer %d", i);
                 updateError = true;
                 // set layer to FB layer
                 hwcLayer->setType(HwcLayer::LAYER_FB);
@@ -517,7 +515,7 @@ bool HwcLayerList::update(hwc_display_contents_1_t *list)
 IDisplayPlane* HwcLayerList::getPlane(uint32_t index) const
 {
     if (index >= mLayers.size()) {
-        log.e("HwcLayerList::getPlane: invalid layer index %d", index);
+        ELOG("HwcLayerList::getPlane: invalid layer index %d", index);
         return 0;
     }
 
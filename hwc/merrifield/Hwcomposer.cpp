@@ -42,14 +42,14 @@ Hwcomposer::Hwcomposer()
       mFBDev(0),
       mInitialized(false)
 {
-    log.d("Hwcomposer");
+    DLOG("Hwcomposer");
 
     mDisplayDevices.setCapacity(IDisplayDevice::DEVICE_COUNT);
 }
 
 Hwcomposer::~Hwcomposer()
 {
-    log.d("~Hwcomposer");
+    DLOG("~Hwcomposer");
 }
 
 bool Hwcomposer::initCheck() const
@@ -64,13 +64,15 @@ bool Hwcomposer::prepare(size_t numDisplays,
 
     //Mutex::Autolock _l(mLock);
 
-    log.v("prepare display count %d\n", numDisplays);
+    VLOG("prepare display count %d\n", numDisplays);
+
+    HwcConfig::getInstance().beginFrame();
 
     if (!initCheck())
         return false;
 
     if (!numDisplays || !displays) {
-        log.e("prepare: invalid parameters");
+        ELOG("prepare: invalid parameters");
         return false;
     }
 
@@ -82,12 +84,12 @@ bool Hwcomposer::prepare(size_t numDisplays,
     for (size_t i = 0; i < numDisplays; i++) {
         IDisplayDevice *device = mDisplayDevices.itemAt(i);
         if (!device) {
-            log.v("prepare: device %d doesn't exist", i);
+            VLOG("prepare: device %d doesn't exist", i);
             continue;
         }
 
         if (!device->isConnected()) {
-            log.v("prepare: device %d is disconnected", i);
+            VLOG("prepare: device %d is disconnected", i);
             continue;
         }
 
@@ -97,18 +99,18 @@ bool Hwcomposer::prepare(size_t numDisplays,
     for (size_t i = 0; i < numDisplays; i++) {
         IDisplayDevice *device = mDisplayDevices.itemAt(i);
         if (!device) {
-            log.v("prepare: device %d doesn't exist", i);
+            VLOG("prepare: device %d doesn't exist", i);
             continue;
         }
 
         if (!device->isConnected()) {
-            log.v("prepare: device %d is disconnected", i);
+            VLOG("prepare: device %d is disconnected", i);
             continue;
         }
 
         ret = device->prepare(displays[i]);
         if (ret == false) {
-            log.e("prepare: failed to do prepare for device %d", i);
+            ELOG("prepare: failed to do prepare for device %d", i);
             continue;
         }
     }
@@ -121,7 +123,7 @@ bool Hwcomposer::commit(size_t numDisplays,
 {
     bool ret = true;
 
-    log.v("commit display count %d\n", numDisplays);
+    VLOG("commit display count %d\n", numDisplays);
 
     //Mutex::Autolock _l(mLock);
 
@@ -129,32 +131,32 @@ bool Hwcomposer::commit(size_t numDisplays,
         return false;
 
     if (!numDisplays || !displays) {
-        log.e("commit: invalid parameters");
+        ELOG("commit: invalid parameters");
         return false;
     }
 
     void *hwContexts = getContexts();
     int count = 0;
     if (!hwContexts) {
-        log.e("Hwcomposer::commit: invalid hwContexts");
+        ELOG("Hwcomposer::commit: invalid hwContexts");
         return false;
     }
 
     for (size_t i = 0; i < numDisplays; i++) {
         IDisplayDevice *device = mDisplayDevices.itemAt(i);
         if (!device) {
-            log.v("commit: device %d doesn't exist", i);
+            VLOG("commit: device %d doesn't exist", i);
             continue;
         }
 
         if (!device->isConnected()) {
-            log.v("commit: device %d is disconnected", i);
+            VLOG("commit: device %d is disconnected", i);
             continue;
         }
 
         ret = device->commit(displays[i], hwContexts, count);
         if (ret == false) {
-            log.e("commit: failed to do commit for device %d", i);
+            ELOG("commit: failed to do commit for device %d", i);
             continue;
         }
     }
@@ -162,7 +164,7 @@ bool Hwcomposer::commit(size_t numDisplays,
     // commit hwContexts to hardware
     ret = commitContexts(hwContexts, count);
     if (ret == false) {
-        log.e("Hwcomposer::commit: failed to commit hwContexts");
+        ELOG("Hwcomposer::commit: failed to commit hwContexts");
         return false;
     }
 
@@ -171,19 +173,19 @@ bool Hwcomposer::commit(size_t numDisplays,
 
 bool Hwcomposer::vsyncControl(int disp, int enabled)
 {
-    log.v("vsyncControl: disp %d, enabled %d", disp, enabled);
+    VLOG("vsyncControl: disp %d, enabled %d", disp, enabled);
 
     if (!initCheck())
         return false;
 
     if (disp < 0 || disp >= IDisplayDevice::DEVICE_COUNT) {
-        log.e("vsyncControl: invalid disp %d", disp);
+        ELOG("vsyncControl: invalid disp %d", disp);
         return false;
     }
 
     IDisplayDevice *device = mDisplayDevices.itemAt(disp);
     if (!device) {
-        log.e("vsyncControl: no device found");
+        ELOG("vsyncControl: no device found");
         return false;
     }
 
@@ -192,19 +194,19 @@ bool Hwcomposer::vsyncControl(int disp, int enabled)
 
 bool Hwcomposer::blank(int disp, int blank)
 {
-    log.v("blank: disp %d, blank %d", disp, blank);
+    VLOG("blank: disp %d, blank %d", disp, blank);
 
     if (!initCheck())
         return false;
 
     if (disp < 0 || disp >= IDisplayDevice::DEVICE_COUNT) {
-        log.e("blank: invalid disp %d", disp);
+        ELOG("blank: invalid disp %d", disp);
         return false;
     }
 
     IDisplayDevice *device = mDisplayDevices.itemAt(disp);
     if (!device) {
-        log.e("blank: no device found");
+        ELOG("blank: no device found");
         return false;
     }
 
@@ -215,19 +217,19 @@ bool Hwcomposer::getDisplayConfigs(int disp,
                                       uint32_t *configs,
                                       size_t *numConfigs)
 {
-    log.v("getDisplayConfig");
+    VLOG("getDisplayConfig");
 
     if (!initCheck())
         return false;
 
     if (disp < 0 || disp >= IDisplayDevice::DEVICE_COUNT) {
-        log.e("getDisplayConfigs: invalid disp %d", disp);
+        ELOG("getDisplayConfigs: invalid disp %d", disp);
         return false;
     }
 
     IDisplayDevice *device = mDisplayDevices.itemAt(disp);
     if (!device) {
-        log.e("getDisplayConfigs: no device %d found", disp);
+        ELOG("getDisplayConfigs: no device %d found", disp);
         return false;
     }
 
@@ -239,19 +241,19 @@ bool Hwcomposer::getDisplayAttributes(int disp,
                                          const uint32_t *attributes,
                                          int32_t *values)
 {
-    log.v("getDisplayAttributes");
+    VLOG("getDisplayAttributes");
 
     if (!initCheck())
         return false;
 
     if (disp < 0 || disp >= IDisplayDevice::DEVICE_COUNT) {
-        log.e("getDisplayAttributes: invalid disp %d", disp);
+        ELOG("getDisplayAttributes: invalid disp %d", disp);
         return false;
     }
 
     IDisplayDevice *device = mDisplayDevices.itemAt(disp);
     if (!device) {
-        log.e("getDisplayAttributes: no device found");
+        ELOG("getDisplayAttributes: no device found");
         return false;
     }
 
@@ -260,7 +262,7 @@ bool Hwcomposer::getDisplayAttributes(int disp,
 
 bool Hwcomposer::compositionComplete(int disp)
 {
-    log.v("compositionComplete");
+    VLOG("compositionComplete");
 
     if (!initCheck())
         return false;
@@ -271,13 +273,13 @@ bool Hwcomposer::compositionComplete(int disp)
     }
 
     if (disp < 0 || disp >= IDisplayDevice::DEVICE_COUNT) {
-        log.e("compositionComplete: invalid disp %d", disp);
+        ELOG("compositionComplete: invalid disp %d", disp);
         return false;
     }
 
     IDisplayDevice *device = mDisplayDevices.itemAt(disp);
     if (!device) {
-        log.e("compositionComplete: no device found");
+        ELOG("compositionComplete: no device found");
         return false;
     }
 
@@ -292,7 +294,7 @@ void Hwcomposer::vsync(int disp, int64_t timestamp)
         return;
 
     if (mProcs && mProcs->vsync) {
-        log.v("report vsync disp %d timestamp %llu", disp, timestamp);
+        VLOG("report vsync disp %d timestamp %llu", disp, timestamp);
         mProcs->vsync(const_cast<hwc_procs_t*>(mProcs), disp, timestamp);
     }
 }
@@ -305,14 +307,14 @@ void Hwcomposer::hotplug(int disp, int connected)
         return;
 
     if (mProcs && mProcs->hotplug) {
-        log.v("report hotplug disp %d connected %d", disp, connected);
+        VLOG("report hotplug disp %d connected %d", disp, connected);
         mProcs->hotplug(const_cast<hwc_procs_t*>(mProcs), disp, connected);
     }
 }
 
 bool Hwcomposer::release()
 {
-    log.d("release");
+    DLOG("release");
 
     if (!initCheck())
         return false;
@@ -322,7 +324,11 @@ bool Hwcomposer::release()
 
 bool Hwcomposer::dump(char *buff, int buff_len, int *cur_len)
 {
-    log.d("dump");
+    // properties are read once at init, setprop followed by
+    // dumpsys SurfaceFlinger applies them
+    HwcConfig::getInstance().reload();
+
+    DLOG("dump");
 
     if (!initCheck())
         return false;
@@ -347,10 +353,10 @@ bool Hwcomposer::dump(char *buff, int buff_len, int *cur_len)
 
 void Hwcomposer::registerProcs(hwc_procs_t const *procs)
 {
-    log.d("registerProcs");
+    DLOG("registerProcs");
 
     if (!procs)
-        log.w("registerProcs: procs is NULL");
+        WLOG("registerProcs: procs is NULL");
 
     mProcs = procs;
 }
@@ -358,13 +364,13 @@ void Hwcomposer::registerProcs(hwc_procs_t const *procs)
 bool Hwcomposer::initialize()
 {
     int err;
-    log.d("initialize");
+    DLOG("initialize");
 
     // open frame buffer device
     hw_module_t const* module;
     err = hw_get_module(GRALLOC_HARDWARE_MODULE_ID, &module);
     if (err) {
-        log.e("Hwcomposer::initialize: failed to load gralloc module, %d", err);
+        ELOG("Hwcomposer::initialize: failed to load gralloc module, %d", err);
         return false;
     }
 
@@ -374,8 +380,8 @@ bool Hwcomposer::initialize()
     // open frame buffer device
     err = framebuffer_open(module, (framebuffer_device_t**)&mFBDev);
     if (err) {
-        log.e("Hwcomposer::initialize: failed to open frame buffer device, %d",
-              err);
+        ELOG("Hwcomposer::initialize: failed to open frame buffer device, %d",
+             err);
         return false;
     }
 
@@ -384,7 +390,7 @@ bool Hwcomposer::initialize()
     // create display plane manager
     mPlaneManager = createDisplayPlaneManager();
     if (!mPlaneManager || !mPlaneManager->initialize()) {
-        log.e("initialize: failed to create display plane manager");
+        ELOG("initialize: failed to create display plane manager");
         goto dpm_create_err;
     }
 
@@ -392,7 +398,7 @@ bool Hwcomposer::initialize()
     for (int i = 0; i < IDisplayDevice::DEVICE_COUNT; i++) {
         IDisplayDevice *device = createDisplayDevice(i, *mPlaneManager);
         if (!device || !device->initialize()) {
-            log.e("initialize: failed to create device %d", i);
+            ELOG("initialize: failed to create device %d", i);
             continue;
         }
         // add this device
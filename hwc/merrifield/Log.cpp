@@ -38,18 +38,21 @@ ANDROID_SINGLETON_STATIC_INSTANCE(Log);
 
 namespace intel {
 
+volatile int32_t Log::sLogLevel = HwcConfig::DEBUG_LOG_INFO;
+
 Log::Log() : Singleton<Log>()
 {
+    setLevel(HwcConfig::getInstance().get().debugLogLevel);
+}
 
+void Log::setLevel(int level)
+{
+    android_atomic_release_store(level, &sLogLevel);
 }
 
 void Log::e(int comp, const char *fmt, ...)
 {
-    int logLevel;
-
-    HwcConfig::getInstance().debugLogLevel(logLevel);
-
-    if (logLevel <= HwcConfig::DEBUG_LOG_ERROR) {
+    if (isLoggable(HwcConfig::DEBUG_LOG_ERROR)) {
         va_list ap;
 
         va_start(ap, fmt);
@@ -60,11 +63,7 @@ void Log::e(int comp, const char *fmt, ...)
 
 void Log::e(const char *fmt, ...)
 {
-    int logLevel;
-
-    HwcConfig::getInstance().debugLogLevel(logLevel);
-
-    if (logLevel <= HwcConfig::DEBUG_LOG_ERROR) {
+    if (isLoggable(HwcConfig::DEBUG_LOG_ERROR)) {
         va_list ap;
 
         va_start(ap, fmt);
@@ -75,11 +74,7 @@ void Log::e(const char *fmt, ...)
 
 void Log::w(int comp, const char *fmt, ...)
 {
-    int logLevel;
-
-    HwcConfig::getInstance().debugLogLevel(logLevel);
-
-    if (logLevel <= HwcConfig::DEBUG_LOG_WARNING) {
+    if (isLoggable(HwcConfig::DEBUG_LOG_WARNING)) {
         va_list ap;
 
         va_start(ap, fmt);
@@ -88,14 +83,9 @@ void Log::w(int comp, const char *fmt, ...)
     }
 }
 
-
 void Log::w(const char *fmt, ...)
 {
-    int logLevel;
-
-    HwcConfig::getInstance().debugLogLevel(logLevel);
-
-    if (logLevel <= HwcConfig::DEBUG_LOG_WARNING) {
+    if (isLoggable(HwcConfig::DEBUG_LOG_WARNING)) {
         va_list ap;
 
         va_start(ap, fmt);
@@ -106,11 +96,7 @@ void Log::w(const char *fmt, ...)
 
 void Log::d(int comp, const char *fmt, ...)
 {
-    int logLevel;
-
-    HwcConfig::getInstance().debugLogLevel(logLevel);
-
-    if (logLevel <= HwcConfig::DEBUG_LOG_DEBUG) {
+    if (isLoggable(HwcConfig::DEBUG_LOG_DEBUG)) {
         va_list ap;
 
         va_start(ap, fmt);
@@ -119,14 +105,9 @@ void Log::d(int comp, const char *fmt, ...)
     }
 }
 
-
 void Log::d(const char *fmt, ...)
 {
-    int logLevel;
-
-    HwcConfig::getInstance().debugLogLevel(logLevel);
-
-    if (logLevel <= HwcConfig::DEBUG_LOG_DEBUG) {
+    if (isLoggable(HwcConfig::DEBUG_LOG_DEBUG)) {
         va_list ap;
 
         va_start(ap, fmt);
@@ -137,11 +118,7 @@ void Log::d(const char *fmt, ...)
 
 void Log::i(int comp, const char *fmt, ...)
 {
-    int logLevel;
-
-    HwcConfig::getInstance().debugLogLevel(logLevel);
-
-    if (logLevel <= HwcConfig::DEBUG_LOG_INFO) {
+    if (isLoggable(HwcConfig::DEBUG_LOG_INFO)) {
         va_list ap;
 
         va_start(ap, fmt);
@@ -152,11 +129,7 @@ void Log::i(int comp, const char *fmt, ...)
 
 void Log::i(const char *fmt, ...)
 {
-    int logLevel;
-
-    HwcConfig::getInstance().debugLogLevel(logLevel);
-
-    if (logLevel <= HwcConfig::DEBUG_LOG_INFO) {
+    if (isLoggable(HwcConfig::DEBUG_LOG_INFO)) {
         va_list ap;
 
         va_start(ap, fmt);
@@ -167,11 +140,7 @@ void Log::i(const char *fmt, ...)
 
 void Log::v(int comp, const char *fmt, ...)
 {
-    int logLevel;
-
-    HwcConfig::getInstance().debugLogLevel(logLevel);
-
-    if (logLevel <= HwcConfig::DEBUG_LOG_VERBOSE) {
+    if (isLoggable(HwcConfig::DEBUG_LOG_VERBOSE)) {
         va_list ap;
 
         va_start(ap, fmt);
@@ -182,11 +151,7 @@ void Log::v(int comp, const char *fmt, ...)
 
 void Log::v(const char *fmt, ...)
 {
-    int logLevel;
-
-    HwcConfig::getInstance().debugLogLevel(logLevel);
-
-    if (logLevel <= HwcConfig::DEBUG_LOG_VERBOSE) {
+    if (isLoggable(HwcConfig::DEBUG_LOG_VERBOSE)) {
         va_list ap;
 
         va_start(ap, fmt);
@@ -29,6 +29,8 @@
 #define LOG_H_
 
 #include <utils/Singleton.h>
+#include <cutils/atomic.h>
+#include <HwcConfig.h>
 
 namespace android {
 namespace intel {
@@ -52,8 +54,30 @@ public:
     void i(const char *fmt, ...);
     void v(int comp, const char *fmt, ...);
     void v(const char *fmt, ...);
+
+    // cached value of HWC_CONFIG_DEBUG_LOG_LEVEL
+    static inline bool isLoggable(int level) {
+        return level >= android_atomic_acquire_load(&sLogLevel);
+    }
+    // called by HwcConfig when a new configuration is published
+    static void setLevel(int level);
+private:
+    static volatile int32_t sLogLevel;
 };
 
+// check the level before the arguments are evaluated, expects the
+// file scope Log reference named log
+#define VLOG(...) \
+    do { if (Log::isLoggable(HwcConfig::DEBUG_LOG_VERBOSE)) log.v(__VA_ARGS__); } while (0)
+#define DLOG(...) \
+    do { if (Log::isLoggable(HwcConfig::DEBUG_LOG_DEBUG)) log.d(__VA_ARGS__); } while (0)
+#define ILOG(...) \
+    do { if (Log::isLoggable(HwcConfig::DEBUG_LOG_INFO)) log.i(__VA_ARGS__); } while (0)
+#define WLOG(...) \
+    do { if (Log::isLoggable(HwcConfig::DEBUG_LOG_WARNING)) log.w(__VA_ARGS__); } while (0)
+#define ELOG(...) \
+    do { if (Log::isLoggable(HwcConfig::DEBUG_LOG_ERROR)) log.e(__VA_ARGS__); } while (0)
+
 static inline uint32_t align_to(uint32_t arg, uint32_t align)
 {
     return ((arg + (align - 1)) & (~(align - 1)));
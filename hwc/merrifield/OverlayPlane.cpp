@@ -47,7 +47,7 @@ OverlayPlane::OverlayPlane(int index, int pipe)
       mTransform(0),
       mPipe(pipe)
 {
-    log.v("OverlayPlane");
+    VLOG("OverlayPlane");
     memset(&mPosition, 0, sizeof(PlanePosition));
     memset(&mSrcCrop, 0, sizeof(crop_t));
 
@@ -57,7 +57,7 @@ OverlayPlane::OverlayPlane(int index, int pipe)
 
 OverlayPlane::~OverlayPlane()
 {
-    log.v("~OverlayPlane");
+    VLOG("~OverlayPlane");
 
     if (!initCheck())
         return;
@@ -77,20 +77,20 @@ OverlayPlane::~OverlayPlane()
 
 int OverlayPlane::getIndex() const
 {
-    log.v("getIndex");
+    VLOG("getIndex");
 
     return mIndex;
 }
 
 int OverlayPlane::getType() const
 {
-    log.v("getType");
+    VLOG("getType");
     return mType;
 }
 
 bool OverlayPlane::initialize()
 {
-    log.v("OverlayPlane::initialize");
+    VLOG("OverlayPlane::initialize");
 
     // create buffer cache
     mGrallocBufferCache = new BufferCache(5);
@@ -148,10 +148,10 @@ cache_err:
 
 void OverlayPlane::setPosition(int x, int y, int w, int h)
 {
-    log.v("OverlayPlane::setPosition: %d, %d - %dx%d", x, y, w, h);
+    VLOG("OverlayPlane::setPosition: %d, %d - %dx%d", x, y, w, h);
 
     if (!initCheck()) {
-        log.e("OverlayPlane:setPosition: plane hasn't been initialized");
+        ELOG("OverlayPlane:setPosition: plane hasn't been initialized");
         return;
     }
 
@@ -163,10 +163,10 @@ void OverlayPlane::setPosition(int x, int y, int w, int h)
 
 void OverlayPlane::setSourceCrop(int x, int y, int w, int h)
 {
-    log.v("OverlayPlane::setSourceCrop: %d, %d - %dx%d", x, y, w, h);
+    VLOG("OverlayPlane::setSourceCrop: %d, %d - %dx%d", x, y, w, h);
 
     if (!initCheck()) {
-        log.e("OverlayPlane:setSourceCrop: plane hasn't been initialized");
+        ELOG("OverlayPlane:setSourceCrop: plane hasn't been initialized");
         return;
     }
 
@@ -178,10 +178,10 @@ void OverlayPlane::setSourceCrop(int x, int y, int w, int h)
 
 void OverlayPlane::setTransform(int trans)
 {
-    log.v("OverlayPlane::setTransform: %d", trans);
+    VLOG("OverlayPlane::setTransform: %d", trans);
 
     if (!initCheck()) {
-        log.e("OverlayPlane:setPosition: plane hasn't been initialized");
+        ELOG("OverlayPlane:setPosition: plane hasn't been initialized");
         return;
     }
 
@@ -190,39 +190,39 @@ void OverlayPlane::setTransform(int trans)
 
 bool OverlayPlane::isValidBuffer(uint32_t handle)
 {
-    log.v("OverlayPlane::isValidBuffer: handle = 0x%x", handle);
+    VLOG("OverlayPlane::isValidBuffer: handle = 0x%x", handle);
     return true;
 }
 
 bool OverlayPlane::isValidTransform(uint32_t trans)
 {
-    log.v("OverlayPlane::isValidTransform: transform = 0x%x", trans);
+    VLOG("OverlayPlane::isValidTransform: transform = 0x%x", trans);
     return true;
 }
 
 bool OverlayPlane::isValidBlending(uint32_t blending)
 {
-    log.v("OverlayPlane::isValidBlending: blending = 0x%x", blending);
+    VLOG("OverlayPlane::isValidBlending: blending = 0x%x", blending);
     // overlay doesn't support blending
     return (blending == HWC_BLENDING_NONE) ? true : false;
 }
 
 bool OverlayPlane::isValidScaling(hwc_rect_t& src, hwc_rect_t& dest)
 {
-    log.v("OverlayPlane::isValidScaling");
+    VLOG("OverlayPlane::isValidScaling");
     return true;
 }
 
 bool OverlayPlane::setDataBuffer(uint32_t handle)
 {
-    log.v("OverlayPlane::setDataBuffer: handle = 0x%x");
+    VLOG("OverlayPlane::setDataBuffer: handle = 0x%x");
     return true;
 }
 
 void OverlayPlane::invalidateBufferCache()
 {
     if (!initCheck()) {
-        log.e("OverlayPlane:invalidateBufferCache: plane hasn't been initialized");
+        ELOG("OverlayPlane:invalidateBufferCache: plane hasn't been initialized");
         return;
     }
 
@@ -234,10 +234,10 @@ bool OverlayPlane::assignToPipe(uint32_t pipe)
 {
     uint32_t pipeConfig = 0;
 
-    log.v("OverlayPlane::assignToPipe: pipe = %d", pipe);
+    VLOG("OverlayPlane::assignToPipe: pipe = %d", pipe);
 
     if (!initCheck()) {
-        log.e("OverlayPlane:setPosition: plane hasn't been initialized");
+        ELOG("OverlayPlane:setPosition: plane hasn't been initialized");
         return false;
     }
 
@@ -265,15 +265,15 @@ bool OverlayPlane::assignToPipe(uint32_t pipe)
 
 void OverlayPlane::setZOrderConfig(ZOrderConfig& config)
 {
-    log.v("OverlayPlane::setZOrderConfig");
+    VLOG("OverlayPlane::setZOrderConfig");
 }
 
 bool OverlayPlane::reset()
 {
-    log.v("OverlayPlane::reset");
+    VLOG("OverlayPlane::reset");
 
     if (!initCheck()) {
-        log.e("OverlayPlane:setPosition: plane hasn't been initialized");
+        ELOG("OverlayPlane:setPosition: plane hasn't been initialized");
         return false;
     }
 
@@ -287,10 +287,10 @@ bool OverlayPlane::reset()
 
 bool OverlayPlane::enable()
 {
-    log.v("OverlayPlane::enable");
+    VLOG("OverlayPlane::enable");
 
     if (!initCheck()) {
-        log.e("OverlayPlane:setPosition: plane hasn't been initialized");
+        ELOG("OverlayPlane:setPosition: plane hasn't been initialized");
         return false;
     }
 
@@ -310,10 +310,10 @@ bool OverlayPlane::enable()
 
 bool OverlayPlane::disable()
 {
-    log.d("OverlayPlane::disable");
+    DLOG("OverlayPlane::disable");
 
     if (!initCheck()) {
-        log.e("OverlayPlane:setPosition: plane hasn't been initialized");
+        ELOG("OverlayPlane:setPosition: plane hasn't been initialized");
         return false;
     }
 
@@ -333,10 +333,10 @@ bool OverlayPlane::disable()
 
 bool OverlayPlane::flush(uint32_t flags)
 {
-    log.v("OverlayPlane::flush: flags = 0x%x", flags);
+    VLOG("OverlayPlane::flush: flags = 0x%x", flags);
 
     if (!initCheck()) {
-        log.e("OverlayPlane:setPosition: plane hasn't been initialized");
+        ELOG("OverlayPlane:setPosition: plane hasn't been initialized");
         return false;
     }
 
@@ -380,10 +380,10 @@ OverlayBackBuffer* OverlayPlane::createBackBuffer()
     OverlayBackBuffer *backBuffer;
     bool ret;
 
-    log.v("OverlayPlane::createBackBuffer");
+    VLOG("OverlayPlane::createBackBuffer");
 
     if (!mWsbm) {
-        log.e("OverlayPlane::createBackBuffer: no WSBM found");
+        ELOG("OverlayPlane::createBackBuffer: no WSBM found");
         return 0;
     }
 
@@ -392,8 +392,8 @@ OverlayBackBuffer* OverlayPlane::createBackBuffer()
     wsbmBufferObject = 0;
     ret = mWsbm->allocateTTMBuffer(size, alignment, &wsbmBufferObject);
     if (ret == false) {
-        log.e("OverlayPlane::createBackBuffer: failed to allocate buffer",
-              size, alignment);
+        ELOG("OverlayPlane::createBackBuffer: failed to allocate buffer",
+             size, alignment);
         return 0;
     }
 
@@ -403,7 +403,7 @@ OverlayBackBuffer* OverlayPlane::createBackBuffer()
     // create back buffer
     backBuffer = (OverlayBackBuffer *)malloc(sizeof(OverlayBackBuffer));
     if (!backBuffer) {
-        log.e("OverlayPlane::createBackBuffer: failed to allocate back buffer");
+        ELOG("OverlayPlane::createBackBuffer: failed to allocate back buffer");
         goto alloc_err;
     }
 
@@ -411,8 +411,8 @@ OverlayBackBuffer* OverlayPlane::createBackBuffer()
     backBuffer->gttOffsetInPage = gttOffsetInPage;
     backBuffer->bufObject = (uint32_t)wsbmBufferObject;
 
-    log.v("OverlayPlane::createBackBuffer: created back buffer. cpu %p, gtt %d",
-          virtAddr, gttOffsetInPage);
+    VLOG("OverlayPlane::createBackBuffer: created back buffer. cpu %p, gtt %d",
+         virtAddr, gttOffsetInPage);
 
     return backBuffer;
 alloc_err:
@@ -431,7 +431,7 @@ void OverlayPlane::deleteBackBuffer()
     wsbmBufferObject = (void *)mBackBuffer->bufObject;
     ret = mWsbm->destroyTTMBuffer(wsbmBufferObject);
     if (ret == false)
-        log.w("OverlayPlane::deleteBackBuffer: failed to delete back buffer");
+        WLOG("OverlayPlane::deleteBackBuffer: failed to delete back buffer");
 
     // free back buffer
     free(mBackBuffer);
@@ -442,7 +442,7 @@ void OverlayPlane::resetBackBuffer()
 {
     OverlayBackBufferBlk *backBuffer;
 
-    log.v("OverlayPlane::resetBackBuffer");
+    VLOG("OverlayPlane::resetBackBuffer");
 
     if (!mBackBuffer)
         return;
@@ -490,7 +490,7 @@ void OverlayPlane::checkPosition(int& x, int& y, int& w, int& h)
     // get output
     output = Drm::getInstance().getOutput(outputIndex);
     if (!output) {
-        log.e("checkPosition(): failed to get output");
+        ELOG("checkPosition(): failed to get output");
         return;
     }
 
@@ -514,11 +514,11 @@ void OverlayPlane::checkPosition(int& x, int& y, int& w, int& h)
 
 bool OverlayPlane::bufferOffsetSetup(IBufferMapper& mapper)
 {
-    log.v("OverlayPlane::bufferOffsetSetup");
+    VLOG("OverlayPlane::bufferOffsetSetup");
 
     OverlayBackBufferBlk *backBuffer = mBackBuffer->buf;
     if (!backBuffer) {
-        log.e("OverlayPlane::bufferOffsetSetup: invalid back buffer");
+        ELOG("OverlayPlane::bufferOffsetSetup: invalid back buffer");
         return false;
     }
 
@@ -592,18 +592,18 @@ bool OverlayPlane::bufferOffsetSetup(IBufferMapper& mapper)
     backBuffer->OBUF_1U = backBuffer->OBUF_0U;
     backBuffer->OBUF_1V = backBuffer->OBUF_0V;
 
-    log.v("OverlayPlane::bufferOffsetSetup: done. offset (%d, %d, %d)\n",
-          backBuffer->OBUF_0Y,
-          backBuffer->OBUF_0U,
-          backBuffer->OBUF_0V);
+    VLOG("OverlayPlane::bufferOffsetSetup: done. offset (%d, %d, %d)\n",
+         backBuffer->OBUF_0Y,
+         backBuffer->OBUF_0U,
+         backBuffer->OBUF_0V);
     return true;
 }
 
 uint32_t OverlayPlane::calculateSWidthSW(uint32_t offset, uint32_t width)
 {
-    log.v("OverlayPlane::calculateSWidthSW: offset %d, width %d\n",
-          offset,
-          width);
+    VLOG("OverlayPlane::calculateSWidthSW: offset %d, width %d\n",
+         offset,
+         width);
 
     uint32_t swidth = ((offset + width + 0x3F) >> 6) - (offset >> 6);
 
@@ -615,11 +615,11 @@ uint32_t OverlayPlane::calculateSWidthSW(uint32_t offset, uint32_t width)
 
 bool OverlayPlane::coordinateSetup(IBufferMapper& mapper)
 {
-    log.v("OverlayPlane::coordinateSetup");
+    VLOG("OverlayPlane::coordinateSetup");
 
     OverlayBackBufferBlk *backBuffer = mBackBuffer->buf;
     if (!backBuffer) {
-        log.e("OverlayPlane::bufferOffsetSetup: invalid back buffer");
+        ELOG("OverlayPlane::bufferOffsetSetup: invalid back buffer");
         return false;
     }
 
@@ -643,18 +643,18 @@ bool OverlayPlane::coordinateSetup(IBufferMapper& mapper)
         width <<= 1;
         break;
     default:
-        log.e("OverlayPlane::bufferOffsetSetup: unsupported format %d",
-              format);
+        ELOG("OverlayPlane::bufferOffsetSetup: unsupported format %d",
+             format);
         return false;
     }
 
     if (width <= 0 || height <= 0) {
-        log.e("OverlayPlane::bufferOffsetSetup: invalid src dim");
+        ELOG("OverlayPlane::bufferOffsetSetup: invalid src dim");
         return false;
     }
 
     if (yStride <=0 && uvStride <= 0) {
-        log.e("OverlayPlane::bufferOffsetSetup: invalid source stride");
+        ELOG("OverlayPlane::bufferOffsetSetup: invalid source stride");
         return false;
     }
 
@@ -665,7 +665,7 @@ bool OverlayPlane::coordinateSetup(IBufferMapper& mapper)
     backBuffer->SHEIGHT = height | ((height / 2) << 16);
     backBuffer->OSTRIDE = (yStride & (~0x3f)) | ((uvStride & (~0x3f)) << 16);
 
-    log.v("OverlayPlane::coordinateSetup: finished");
+    VLOG("OverlayPlane::coordinateSetup: finished");
 
     return true;
 }
@@ -812,7 +812,7 @@ bool OverlayPlane::scalingSetup(IBufferMapper& mapper)
 
     OverlayBackBufferBlk *backBuffer = mBackBuffer->buf;
     if (!backBuffer) {
-        log.e("OverlayPlane::bufferOffsetSetup: invalid back buffer");
+        ELOG("OverlayPlane::bufferOffsetSetup: invalid back buffer");
         return false;
     }
 
@@ -823,11 +823,11 @@ bool OverlayPlane::scalingSetup(IBufferMapper& mapper)
 
     // check position
     checkPosition(x, y, w, h);
-    log.v("OverlayPlane::scalingSetup: Final position (%d, %d, %d, %d)",
-          x, y, w, h);
+    VLOG("OverlayPlane::scalingSetup: Final position (%d, %d, %d, %d)",
+         x, y, w, h);
 
     if ((w <= 0) || (h <= 0)) {
-         log.e("OverlayPlane::scalingSetup: Invalid dst width/height");
+         ELOG("OverlayPlane::scalingSetup: Invalid dst width/height");
          return false;
     }
 
@@ -840,9 +840,9 @@ bool OverlayPlane::scalingSetup(IBufferMapper& mapper)
     uint32_t dstWidth = w;
     uint32_t dstHeight = h;
 
-    log.v("OverlayPlane::scalingSetup: src (%dx%d) v.s. (%dx%d)",
-          srcWidth, srcHeight,
-          dstWidth, dstHeight);
+    VLOG("OverlayPlane::scalingSetup: src (%dx%d) v.s. (%dx%d)",
+         srcWidth, srcHeight,
+         dstWidth, dstHeight);
     /*
      * Y down-scale factor as a multiple of 4096.
      */
@@ -874,14 +874,14 @@ bool OverlayPlane::scalingSetup(IBufferMapper& mapper)
 
     /* Check scaling ratio */
     if (xscaleInt > INTEL_OVERLAY_MAX_SCALING_RATIO) {
-        log.e("OverlayPlane:scalingSetup:xscaleInt > %d",
-              INTEL_OVERLAY_MAX_SCALING_RATIO);
+        ELOG("OverlayPlane:scalingSetup:xscaleInt > %d",
+             INTEL_OVERLAY_MAX_SCALING_RATIO);
         return false;
     }
 
     /* shouldn't get here */
     if (xscaleIntUV > INTEL_OVERLAY_MAX_SCALING_RATIO) {
-        log.e("OverlayPlane:scalingSetup: xscaleIntUV > %d",
+        ELOG("OverlayPlane:scalingSetup: xscaleIntUV > %d",
              INTEL_OVERLAY_MAX_SCALING_RATIO);
         return false;
     }
@@ -950,7 +950,7 @@ bool OverlayPlane::scalingSetup(IBufferMapper& mapper)
         }
     }
 
-    log.v("OverlayPlane::scalingSetup: finished");
+    VLOG("OverlayPlane::scalingSetup: finished");
 
     return true;
 }
@@ -958,31 +958,31 @@ bool OverlayPlane::scalingSetup(IBufferMapper& mapper)
 bool OverlayPlane::setDataBuffer(IBufferMapper& mapper)
 {
     if (!initCheck()) {
-        log.e("OverlayPlane:setPosition: plane hasn't been initialized");
+        ELOG("OverlayPlane:setPosition: plane hasn't been initialized");
         return false;
     }
 
     OverlayBackBufferBlk *backBuffer = mBackBuffer->buf;
     if (!backBuffer) {
-        log.e("OverlayPlane::bufferOffsetSetup: invalid back buffer");
+        ELOG("OverlayPlane::bufferOffsetSetup: invalid back buffer");
         return false;
     }
 
     bool ret = bufferOffsetSetup(mapper);
     if (ret == false) {
-        log.e("OverlayPlane::setDataBuffer: failed to set up buffer offsets");
+        ELOG("OverlayPlane::setDataBuffer: failed to set up buffer offsets");
         return false;
     }
 
     ret = coordinateSetup(mapper);
     if (ret == false) {
-        log.e("OverlayPlane::setDataBuffer: failed to set up overlay coordinates");
+        ELOG("OverlayPlane::setDataBuffer: failed to set up overlay coordinates");
         return false;
     }
 
     ret = scalingSetup(mapper);
     if (ret == false) {
-        log.e("OverlayPlane::setDataBuffer: failed to set up scaling parameters");
+        ELOG("OverlayPlane::setDataBuffer: failed to set up scaling parameters");
         return false;
     }
 
@@ -992,13 +992,13 @@ bool OverlayPlane::setDataBuffer(IBufferMapper& mapper)
 
 bool OverlayPlane::flip()
 {
-    log.v("OverlayPlane::flip");
+    VLOG("OverlayPlane::flip");
     return true;
 }
 
 void* OverlayPlane::getContext() const
 {
-    log.v("OverlayPlane::getContext");
+    VLOG("OverlayPlane::getContext");
     return 0;
 }
 
@@ -1019,7 +1019,7 @@ bool OverlayPlane::BufferCache::addMapper(uint64_t handle,
 {
     ssize_t index = mBufferPool.indexOfKey(handle);
     if (index >= 0) {
-        log.e("addMapper: buffer 0x%llx exists\n", handle);
+        ELOG("addMapper: buffer 0x%llx exists\n", handle);
         return false;
     }
 
@@ -40,7 +40,7 @@ SpritePlane::SpritePlane(int index, int pipe)
       mTransform(PLANE_TRANSFORM_0),
       mPipe(pipe)
 {
-    log.v("SpritePlane");
+    VLOG("SpritePlane");
 
     mPosition.x = 0;
     mPosition.y = 0;
@@ -53,12 +53,12 @@ SpritePlane::SpritePlane(int index, int pipe)
 
 SpritePlane::~SpritePlane()
 {
-    log.v("~SpritePlane");
+    VLOG("~SpritePlane");
 }
 
 bool SpritePlane::initialize()
 {
-    log.v("SpritePlane::initialize");
+    VLOG("SpritePlane::initialize");
 
     // create buffer cache
     mGrallocBufferCache = new BufferCache(5);
@@ -87,20 +87,20 @@ cache_err:
 
 int SpritePlane::getIndex() const
 {
-    log.v("SpritePlane::getIndex");
+    VLOG("SpritePlane::getIndex");
 
     return mIndex;
 }
 
 int SpritePlane::getType() const
 {
-    log.v("SpritePlane::getType");
+    VLOG("SpritePlane::getType");
     return mType;
 }
 
 void SpritePlane::setPosition(int x, int y, int w, int h)
 {
-    log.v("SpritePlane::setPosition: %d, %d - %dx%d", x, y, w, h);
+    VLOG("SpritePlane::setPosition: %d, %d - %dx%d", x, y, w, h);
 
     mPosition.x = x;
     mPosition.y = y;
@@ -110,10 +110,10 @@ void SpritePlane::setPosition(int x, int y, int w, int h)
 
 void SpritePlane::setSourceCrop(int x, int y, int w, int h)
 {
-    log.v("setSourceCrop: %d, %d - %dx%d", x, y, w, h);
+    VLOG("setSourceCrop: %d, %d - %dx%d", x, y, w, h);
 
     if (!initCheck()) {
-        log.e("SpritePlane::setSourceCrop: plane hasn't been initialized");
+        ELOG("SpritePlane::setSourceCrop: plane hasn't been initialized");
         return;
     }
 
@@ -125,10 +125,10 @@ void SpritePlane::setSourceCrop(int x, int y, int w, int h)
 
 void SpritePlane::setTransform(int trans)
 {
-    log.v("SpritePlane::setTransform: %d", trans);
+    VLOG("SpritePlane::setTransform: %d", trans);
 
     if (!initCheck()) {
-        log.e("SpritePlane::setTransform: plane hasn't been initialized");
+        ELOG("SpritePlane::setTransform: plane hasn't been initialized");
         return;
     }
 
@@ -145,10 +145,10 @@ void SpritePlane::setTransform(int trans)
 
 bool SpritePlane::isValidTransform(uint32_t trans)
 {
-    log.v("SpritePlane::isValidTransform: trans %d", trans);
+    VLOG("SpritePlane::isValidTransform: trans %d", trans);
 
     if (!initCheck()) {
-        log.e("SpritePlane::isValidTransform: plane hasn't been initialized");
+        ELOG("SpritePlane::isValidTransform: plane hasn't been initialized");
         return false;
     }
 
@@ -157,16 +157,16 @@ bool SpritePlane::isValidTransform(uint32_t trans)
 
 bool SpritePlane::isValidBuffer(uint32_t handle)
 {
-    log.v("SpritePlane::isValidBuffer: handle = 0x%x", handle);
+    VLOG("SpritePlane::isValidBuffer: handle = 0x%x", handle);
     return false;
 }
 
 bool SpritePlane::isValidBlending(uint32_t blending)
 {
-    log.v("SpritePlane::isValidBlending: blending = 0x%x", blending);
+    VLOG("SpritePlane::isValidBlending: blending = 0x%x", blending);
 
     if (!initCheck()) {
-        log.e("SpritePlane::isValidBlending: plane hasn't been initialized");
+        ELOG("SpritePlane::isValidBlending: plane hasn't been initialized");
         return false;
     }
 
@@ -176,8 +176,8 @@ bool SpritePlane::isValidBlending(uint32_t blending)
     case PLANE_BLENDING_PREMULT:
         return true;
     default:
-        log.v("SpritePlane::isValidBlending: unsupported blending 0x%x",
-              blending);
+        VLOG("SpritePlane::isValidBlending: unsupported blending 0x%x",
+             blending);
     }
 
     return false;
@@ -188,10 +188,10 @@ bool SpritePlane::isValidScaling(hwc_rect_t& src, hwc_rect_t& dest)
     int srcW, srcH;
     int dstW, dstH;
 
-    log.v("SpritePlane::isValidScaling");
+    VLOG("SpritePlane::isValidScaling");
 
     if (!initCheck()) {
-        log.e("SpritePlane::isValidScaling: plane hasn't been initialized");
+        ELOG("SpritePlane::isValidScaling: plane hasn't been initialized");
         return false;
     }
 
@@ -200,7 +200,7 @@ bool SpritePlane::isValidScaling(hwc_rect_t& src, hwc_rect_t& dest)
     dstW = dest.right - dest.left;
     dstH = dest.bottom - dest.top;
 
-    log.v("SpritePlane::isValidScaling: (%dx%d) v.s. (%dx%d)",
+    VLOG("SpritePlane::isValidScaling: (%dx%d) v.s. (%dx%d)",
             srcW, srcH, dstW, dstH);
     // no scaling is supported
     return ((srcW == dstW) && (srcH == dstH)) ? true : false;
@@ -208,16 +208,16 @@ bool SpritePlane::isValidScaling(hwc_rect_t& src, hwc_rect_t& dest)
 
 bool SpritePlane::setDataBuffer(uint32_t handle)
 {
-    log.v("SpritePlane::setDataBuffer: handle = 0x%x", handle);
+    VLOG("SpritePlane::setDataBuffer: handle = 0x%x", handle);
     return false;
 }
 
 void SpritePlane::invalidateBufferCache()
 {
-    log.v("SpritePlane::invalidateBufferCache");
+    VLOG("SpritePlane::invalidateBufferCache");
 
     if (!initCheck()) {
-        log.e("SpritePlane:invalidateBufferCache: plane hasn't been initialized");
+        ELOG("SpritePlane:invalidateBufferCache: plane hasn't been initialized");
         return;
     }
 
@@ -226,42 +226,42 @@ void SpritePlane::invalidateBufferCache()
 
 bool SpritePlane::assignToPipe(uint32_t pipe)
 {
-    log.v("SpritePlane::assignToPipe: pipe = %d", pipe);
+    VLOG("SpritePlane::assignToPipe: pipe = %d", pipe);
     return false;
 }
 
 void SpritePlane::setZOrderConfig(ZOrderConfig& config)
 {
-    log.v("SpritePlane::assignToPipe");
+    VLOG("SpritePlane::assignToPipe");
 }
 
 bool SpritePlane::reset()
 {
-    log.v("SpritePlane::reset");
+    VLOG("SpritePlane::reset");
     return false;
 }
 
 bool SpritePlane::flip()
 {
-    log.v("SpritePlane::flip");
+    VLOG("SpritePlane::flip");
     return false;
 }
 
 bool SpritePlane::enable()
 {
-    log.v("SpritePlane::enable");
+    VLOG("SpritePlane::enable");
     return false;
 }
 
 bool SpritePlane::disable()
 {
-    log.v("SpritePlane::disable");
+    VLOG("SpritePlane::disable");
     return false;
 }
 
 void* SpritePlane::getContext() const
 {
-    log.v("SpritePlane::getContext");
+    VLOG("SpritePlane::getContext");
     return 0;
 }
 
@@ -282,7 +282,7 @@ bool SpritePlane::BufferCache::addMapper(uint64_t handle,
 {
     ssize_t index = mBufferPool.indexOfKey(handle);
     if (index >= 0) {
-        log.e("addMapper: buffer 0x%llx exists\n", handle);
+        ELOG("addMapper: buffer 0x%llx exists\n", handle);
         return false;
     }
 
@@ -41,12 +41,12 @@ TTMBufferMapper::TTMBufferMapper(IntelWsbm& wsbm, IDataBuffer& buffer)
       mCpuAddress(0),
       mSize(0)
 {
-    log.v("TTMBufferMapper::TTMBufferMapper");
+    VLOG("TTMBufferMapper::TTMBufferMapper");
 }
 
 TTMBufferMapper::~TTMBufferMapper()
 {
-    log.v("TTMBufferMapper::~TTMBufferMapper");
+    VLOG("TTMBufferMapper::~TTMBufferMapper");
     // delete buffer
     delete &mBuffer;
 }
@@ -58,29 +58,24 @@ bool TTMBufferMapper::map()
     void *virtAddr;
     uint32_t gttOffsetInPage;
 
-    log.v("TTMBufferMapper::map");
+    VLOG("TTMBufferMapper::map");
 
     handle = mBuffer.getHandle();
 
     bool ret = mWsbm.wrapTTMBuffer(handle, &wsbmBufferObject);
     if (ret == false) {
-        log.e("TTMBufferMapper::map: failed to map TTM buffer");
-        return false;
-    }
-
-    // TODO: review this later
-    ret = mWsbm.waitIdleTTMBuffer(wsbmBufferObject);
-    if (ret == false) {
-        log.e("TTMBufferMapper::map: wait ttm buffer idle failed");
+        ELOG("TTMBufferMapper::map: failed to map TTM buffer");
         return false;
     }
 
+    // don't wait for idle here, the buffer is synced by its user right
+    // before it's scanned out, see MrflOverlayPlane::getTTMMapper()
     virtAddr = mWsbm.getCPUAddress(wsbmBufferObject);
     gttOffsetInPage = mWsbm.getGttOffset(wsbmBufferObject);
 
     if (!gttOffsetInPage || !virtAddr) {
-        log.w("TTMBufferMapper::map: %x Virtual addr: %p.",
-              gttOffsetInPage, virtAddr);
+        WLOG("TTMBufferMapper::map: %x Virtual addr: %p.",
+             gttOffsetInPage, virtAddr);
         return false;
     }
 
@@ -94,7 +89,7 @@ bool TTMBufferMapper::map()
 
 bool TTMBufferMapper::unmap()
 {
-    log.v("TTMBufferMapper::unmap");
+    VLOG("TTMBufferMapper::unmap");
 
     if (!mBufferObject)
         return false;
@@ -150,6 +145,11 @@ bool TTMBufferMapper::waitIdle()
     return mWsbm.waitIdleTTMBuffer(mBufferObject);
 }
 
+bool TTMBufferMapper::isIdle()
+{
+    return mWsbm.isIdleTTMBuffer(mBufferObject);
+}
+
 } // namespace intel
 } // namespace android
 
@@ -64,6 +64,7 @@ public:
 
     // wait idle
     bool waitIdle();
+    bool isIdle();
 private:
     int mRefCount;
     IntelWsbm& mWsbm;
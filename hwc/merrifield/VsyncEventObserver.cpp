@@ -45,7 +45,7 @@ VsyncEventObserver::VsyncEventObserver(IDisplayDevice& disp)
     : mDisplayDevice(disp),
       mEnabled(0)
 {
-    log.v("VsyncEventObserver()");
+    VLOG("VsyncEventObserver()");
 }
 
 VsyncEventObserver::~VsyncEventObserver()
@@ -55,7 +55,7 @@ VsyncEventObserver::~VsyncEventObserver()
 
 void VsyncEventObserver::control(int enabled)
 {
-    log.v("control: enabled %s", enabled ? "True" : "False");
+    VLOG("control: enabled %s", enabled ? "True" : "False");
 
     Mutex::Autolock _l(mLock);
     mEnabled = enabled;
@@ -83,7 +83,7 @@ bool VsyncEventObserver::threadLoop()
                                                  &arg,
                                                  sizeof(arg));
     if (ret == false) {
-        log.w("threadLoop: failed to wait for vsync, check vsync enabling...");
+        WLOG("threadLoop: failed to wait for vsync, check vsync enabling...");
         return true;
     }
 
@@ -94,13 +94,13 @@ bool VsyncEventObserver::threadLoop()
 
 status_t VsyncEventObserver::readyToRun()
 {
-    log.v("VsyncEventObserver: readyToRun. disp %d", mDisplayDevice.getType());
+    VLOG("VsyncEventObserver: readyToRun. disp %d", mDisplayDevice.getType());
     return NO_ERROR;
 }
 
 void VsyncEventObserver::onFirstRef()
 {
-    log.v("VsyncEventObserver: onFirstRef. disp %d", mDisplayDevice.getType());
+    VLOG("VsyncEventObserver: onFirstRef. disp %d", mDisplayDevice.getType());
     run("VsyncEventObserver", PRIORITY_URGENT_DISPLAY);
 }
 
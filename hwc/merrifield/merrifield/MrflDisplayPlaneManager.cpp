@@ -38,7 +38,7 @@ static Log& log = Log::getInstance();
 MrflDisplayPlaneManager::MrflDisplayPlaneManager()
     : DisplayPlaneManager()
 {
-    log.v("MrflDisplayPlaneManager");
+    VLOG("MrflDisplayPlaneManager");
 }
 
 MrflDisplayPlaneManager::~MrflDisplayPlaneManager()
@@ -48,7 +48,7 @@ MrflDisplayPlaneManager::~MrflDisplayPlaneManager()
 
 void MrflDisplayPlaneManager::detect()
 {
-    log.v("MrflDisplayPlaneManager::detect");
+    VLOG("MrflDisplayPlaneManager::detect");
 
     mSpritePlaneCount = 0;
     mPrimaryPlaneCount = 3;
@@ -66,7 +66,7 @@ void MrflDisplayPlaneManager::detect()
 IDisplayPlane* MrflDisplayPlaneManager::allocPlane(int index, int type)
 {
     IDisplayPlane *plane = 0;
-    log.v("MrflDisplayPlaneManager::allocPlane index %d, type %d", index, type);
+    VLOG("MrflDisplayPlaneManager::allocPlane index %d, type %d", index, type);
 
     switch (type) {
     case IDisplayPlane::PLANE_PRIMARY:
@@ -79,7 +79,7 @@ IDisplayPlane* MrflDisplayPlaneManager::allocPlane(int index, int type)
         plane = new MrflOverlayPlane(index, index);
         break;
     default:
-        log.e("MrflDisplayPlaneManager::allocPlane: unsupported type %d", type);
+        ELOG("MrflDisplayPlaneManager::allocPlane: unsupported type %d", type);
     }
     return plane;
 }
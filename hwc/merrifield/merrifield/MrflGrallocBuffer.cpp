@@ -38,7 +38,7 @@ MrflGrallocBuffer::MrflGrallocBuffer(uint32_t handle)
     int bpp;
     int yStride, uvStride;
 
-    log.v("MrflGrallocBuffer: handle 0x%x\n");
+    VLOG("MrflGrallocBuffer: handle 0x%x\n");
 
     memset(&mCrop, 0, sizeof(crop_t));
 
@@ -82,7 +82,7 @@ MrflGrallocBuffer::MrflGrallocBuffer(uint32_t handle)
 
     return;
 invalid_handle:
-    log.e("MrflGrallocBuffer: invalid gralloc handle");
+    ELOG("MrflGrallocBuffer: invalid gralloc handle");
     mHandle = 0;
     mFormat = FORMAT_INVALID;
     mWidth = 0;
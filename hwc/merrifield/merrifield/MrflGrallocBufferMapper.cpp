@@ -40,7 +40,7 @@ MrflGrallocBufferMapper::MrflGrallocBufferMapper(IMG_gralloc_module_public_t& mo
       mBuffer(buffer),
       mBufferObject(0)
 {
-    log.v("MrflGrallocBufferMapper::MrflGrallocBufferMapper");
+    VLOG("MrflGrallocBufferMapper::MrflGrallocBufferMapper");
 
     for (int i = 0; i < SUB_BUFFER_MAX; i++) {
         mGttOffsetInPage[i] = 0;
@@ -51,7 +51,7 @@ MrflGrallocBufferMapper::MrflGrallocBufferMapper(IMG_gralloc_module_public_t& mo
 
 MrflGrallocBufferMapper::~MrflGrallocBufferMapper()
 {
-    log.v("MrflGrallocBufferMapper::~MrflGrallocBufferMapper");
+    VLOG("MrflGrallocBufferMapper::~MrflGrallocBufferMapper");
     // delete data buffer
     delete &mBuffer;
 }
@@ -65,10 +65,10 @@ bool MrflGrallocBufferMapper::gttMap(void *vaddr,
     Drm& drm(Drm::getInstance());
     bool ret;
 
-    log.v("MrflGrallocBufferMapper::gttMap: virt 0x%x, size %d\n", vaddr, size);
+    VLOG("MrflGrallocBufferMapper::gttMap: virt 0x%x, size %d\n", vaddr, size);
 
     if (!vaddr || !size || !offset) {
-        log.v("MrflGrallocBufferMapper::gttMap: invalid parameters.");
+        VLOG("MrflGrallocBufferMapper::gttMap: invalid parameters.");
         return false;
     }
 
@@ -79,11 +79,11 @@ bool MrflGrallocBufferMapper::gttMap(void *vaddr,
 
     ret = drm.writeReadIoctl(DRM_PSB_GTT_MAP, &arg, sizeof(arg));
     if (ret == false) {
-        log.e("MrflGrallocBufferMapper::gttMap: gtt mapping failed");
+        ELOG("MrflGrallocBufferMapper::gttMap: gtt mapping failed");
         return false;
     }
 
-    log.v("MrflGrallocBufferMapper::gttMap: offset %d", arg.offset_pages);
+    VLOG("MrflGrallocBufferMapper::gttMap: offset %d", arg.offset_pages);
     *offset =  arg.offset_pages;
     return true;
 }
@@ -94,10 +94,10 @@ bool MrflGrallocBufferMapper::gttUnmap(void *vaddr)
     Drm& drm(Drm::getInstance());
     bool ret;
 
-    log.v("MrflGrallocBufferMapper::gttUnmap: virt 0x%x", vaddr);
+    VLOG("MrflGrallocBufferMapper::gttUnmap: virt 0x%x", vaddr);
 
     if(!vaddr) {
-        log.e("MrflGrallocBufferMapper::gttUnmap: invalid parameter");
+        ELOG("MrflGrallocBufferMapper::gttUnmap: invalid parameter");
         return false;
     }
 
@@ -106,7 +106,7 @@ bool MrflGrallocBufferMapper::gttUnmap(void *vaddr)
 
     ret = drm.writeIoctl(DRM_PSB_GTT_UNMAP, &arg, sizeof(arg));
     if(ret == false) {
-        log.e("%MrflGrallocBufferMapper::gttUnmap: gtt unmapping failed");
+        ELOG("%MrflGrallocBufferMapper::gttUnmap: gtt unmapping failed");
         return false;
     }
 
@@ -122,7 +122,7 @@ bool MrflGrallocBufferMapper::map()
     int err;
     int i;
 
-    log.v("MrflGrallocBufferMapper::map");
+    VLOG("MrflGrallocBufferMapper::map");
 
     // get virtual address
     for (i = 0; i < SUB_BUFFER_MAX; i++) {
@@ -132,15 +132,15 @@ bool MrflGrallocBufferMapper::map()
                                               &vaddr,
                                               &size);
         if (err) {
-            log.e("MrflGrallocBufferMapper::map: failed to map. err = %d",
-                  err);
+            ELOG("MrflGrallocBufferMapper::map: failed to map. err = %d",
+                 err);
             goto map_err;
         }
 
         // map to gtt
         ret = gttMap(vaddr, size, 0, &gttOffsetInPage);
         if (!ret)
-            log.v("MrflGrallocBufferMapper::map: failed to map %d into gtt", i);
+            VLOG("MrflGrallocBufferMapper::map: failed to map %d into gtt", i);
 
         mCpuAddress[i] = vaddr;
         mSize[i] = size;
@@ -163,7 +163,7 @@ bool MrflGrallocBufferMapper::unmap()
 {
     int i;
 
-    log.v("MrflGrallocBufferMapper::unmap");
+    VLOG("MrflGrallocBufferMapper::unmap");
 
     for (i = 0; i < SUB_BUFFER_MAX; i++) {
         if (mCpuAddress[i])
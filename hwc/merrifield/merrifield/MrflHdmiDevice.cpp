@@ -38,17 +38,17 @@ MrflHdmiDevice::MrflHdmiDevice(Hwcomposer& hwc, DisplayPlaneManager& dpm)
     : DisplayDevice(DEVICE_EXTERNAL, hwc, dpm),
       mHotplugObserver(0)
 {
-    log.v("MrflHdmiDevice()");
+    VLOG("MrflHdmiDevice()");
 }
 
 MrflHdmiDevice::~MrflHdmiDevice()
 {
-    log.v("~MrflHdmiDevice");
+    VLOG("~MrflHdmiDevice");
 }
 
 bool MrflHdmiDevice::initialize()
 {
-    log.d("MrflHdmiDevice::initialize");
+    DLOG("MrflHdmiDevice::initialize");
 
     // create hotplug observer
     mHotplugObserver = new HotplugEventObserver(*this);
@@ -61,10 +61,10 @@ bool MrflHdmiDevice::commit(hwc_display_contents_1_t *display,
 {
     bool ret;
 
-    log.v("MrflHdmiDevice::commit");
+    VLOG("MrflHdmiDevice::commit");
 
     if (!display || !contexts) {
-        log.e("MrflHdmiDevice::commit: invalid parameters");
+        ELOG("MrflHdmiDevice::commit: invalid parameters");
         return false;
     }
 
@@ -79,7 +79,7 @@ bool MrflHdmiDevice::commit(hwc_display_contents_1_t *display,
 
         ret = plane->flip();
         if (ret == false) {
-            log.w("MrflHdmiDevice::commit: failed to flip plane %d", i);
+            WLOG("MrflHdmiDevice::commit: failed to flip plane %d", i);
             continue;
         }
 
@@ -99,14 +99,14 @@ void MrflHdmiDevice::onHotplug(int connected)
 {
     bool ret;
 
-    log.d("MrflHdmiDevice::onHotplug: connected %d", connected);
+    DLOG("MrflHdmiDevice::onHotplug: connected %d", connected);
 
     //Mutex::Autolock _l(mLock);
 
     // detect display configs
     ret = detectDisplayConfigs();
     if (ret == false) {
-        log.d("MrflHdmiDevice::onHotplug: failed to detect display config");
+        DLOG("MrflHdmiDevice::onHotplug: failed to detect display config");
         return;
     }
 
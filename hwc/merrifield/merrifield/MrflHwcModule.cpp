@@ -47,12 +47,12 @@ static int hwc_prepare(struct hwc_composer_device_1 *dev,
 {
     int status = 0;
 
-    log.v("hwc_prepare");
+    VLOG("hwc_prepare");
 
     Hwcomposer *hwc = static_cast<Hwcomposer*>(dev);
 
     if (!hwc) {
-        log.e("hwc_prepare: Invalid HWC device\n");
+        ELOG("hwc_prepare: Invalid HWC device\n");
         status = -EINVAL;
         goto prepare_out;
     }
@@ -71,18 +71,18 @@ static int hwc_set(struct hwc_composer_device_1 *dev,
 {
     int status = 0;
 
-    log.v("hwc_set\n");
+    VLOG("hwc_set\n");
 
     Hwcomposer *hwc = static_cast<Hwcomposer*>(dev);
 
     if (!hwc) {
-        log.e("hwc_set: Invalid HWC device\n");
+        ELOG("hwc_set: Invalid HWC device\n");
         status = -EINVAL;
         goto set_out;
     }
 
     if (hwc->commit(numDisplays, displays) == false) {
-        log.e("hwc_set: failed to commit\n");
+        ELOG("hwc_set: failed to commit\n");
         status = HWC_EGL_ERROR;
         goto set_out;
     }
@@ -104,12 +104,12 @@ static void hwc_dump(struct hwc_composer_device_1 *dev,
 void hwc_registerProcs(struct hwc_composer_device_1 *dev,
                           hwc_procs_t const *procs)
 {
-    log.v("hwc_registerProcs\n");
+    VLOG("hwc_registerProcs\n");
 
     Hwcomposer *hwc = static_cast<Hwcomposer*>(dev);
 
     if (!hwc) {
-        log.e("hwc_registerProcs: Invalid HWC device\n");
+        ELOG("hwc_registerProcs: Invalid HWC device\n");
         return;
     }
 
@@ -125,7 +125,7 @@ static int hwc_query(struct hwc_composer_device_1 *dev,
                        int what,
                        int* value)
 {
-    log.v("hwc_query: what %d\n", what);
+    VLOG("hwc_query: what %d\n", what);
     return -EINVAL;
 }
 
@@ -137,11 +137,11 @@ static int hwc_eventControl(struct hwc_composer_device_1 *dev,
     int err = 0;
     bool ret;
 
-    log.v("hwc_eventControl: event %d, enabled %d\n", event, enabled);
+    VLOG("hwc_eventControl: event %d, enabled %d\n", event, enabled);
     Hwcomposer *hwc = static_cast<Hwcomposer*>(dev);
 
     if (!hwc) {
-        log.e("hwc_eventControl: Invalid HWC device\n");
+        ELOG("hwc_eventControl: Invalid HWC device\n");
         return -EINVAL;
     }
 
@@ -149,12 +149,12 @@ static int hwc_eventControl(struct hwc_composer_device_1 *dev,
     case HWC_EVENT_VSYNC:
         ret = hwc->vsyncControl(disp, enabled);
         if (ret == false) {
-            log.e("hwc_eventControl: failed to enable/disable vsync\n");
+            ELOG("hwc_eventControl: failed to enable/disable vsync\n");
             err = -EINVAL;
         }
         break;
     default:
-        log.e("hwc_eventControl: unsupported event %d\n", event);
+        ELOG("hwc_eventControl: unsupported event %d\n", event);
     }
 
     return err;
@@ -166,13 +166,13 @@ static int hwc_blank(hwc_composer_device_1_t *dev, int disp, int blank)
     bool ret;
 
     if (!hwc) {
-        log.e("hwc_blank: invalid HWC device");
+        ELOG("hwc_blank: invalid HWC device");
         return -EINVAL;
     }
 
     ret = hwc->blank(disp, blank);
     if (ret == false) {
-        log.e("hwc_blank: failed to blank disp %d, blank %d", disp, blank);
+        ELOG("hwc_blank: failed to blank disp %d, blank %d", disp, blank);
         return -EINVAL;
     }
 
@@ -188,13 +188,13 @@ static int hwc_getDisplayConfigs(hwc_composer_device_1_t *dev,
     bool ret;
 
     if (!hwc) {
-        log.e("hwc_getDisplayConfigs: invalid HWC device");
+        ELOG("hwc_getDisplayConfigs: invalid HWC device");
         return -EINVAL;
     }
 
     ret = hwc->getDisplayConfigs(disp, configs, numConfigs);
     if (ret == false) {
-        log.e("hwc_getDisplayConfigs: failed to get configs of disp %d", disp);
+        ELOG("hwc_getDisplayConfigs: failed to get configs of disp %d", disp);
         return -EINVAL;
     }
 
@@ -211,14 +211,14 @@ static int hwc_getDisplayAttributes(hwc_composer_device_1_t *dev,
     bool ret;
 
     if (!hwc) {
-        log.e("hwc_getDisplayAttributes: invalid HWC device");
+        ELOG("hwc_getDisplayAttributes: invalid HWC device");
         return -EINVAL;
     }
 
     ret = hwc->getDisplayAttributes(disp, config, attributes, values);
     if (ret == false) {
-        log.e("hwc_getDisplayAttributes: failed to get attributes of disp %d",
-              disp);
+        ELOG("hwc_getDisplayAttributes: failed to get attributes of disp %d",
+             disp);
         return -EINVAL;
     }
 
@@ -231,13 +231,13 @@ static int hwc_compositionComplete(hwc_composer_device_1_t *dev, int disp)
     bool ret;
 
     if (!hwc) {
-        log.e("hwc_compositionComplete: invalid HWC device");
+        ELOG("hwc_compositionComplete: invalid HWC device");
         return -EINVAL;
     }
 
     ret = hwc->compositionComplete(disp);
     if (ret == false) {
-        log.e("hwc_compositionComplete: faild for disp %d", disp);
+        ELOG("hwc_compositionComplete: faild for disp %d", disp);
         return -EINVAL;
     }
 
@@ -252,19 +252,19 @@ static int hwc_device_open(const struct hw_module_t* module,
 {
     int status = -EINVAL;
 
-    log.d("hwc_device_open: open device %s", name);
+    DLOG("hwc_device_open: open device %s", name);
 
     if (!strcmp(name, HWC_HARDWARE_COMPOSER)) {
         Hwcomposer *hwc = new MrflHwcomposer();
         if (!hwc) {
-            log.e("hwc_device_open: No memory\n");
+            ELOG("hwc_device_open: No memory\n");
             status = -ENOMEM;
             goto hwc_init_out;
         }
 
         /* initialize our state here */
         if (hwc->initialize() == false) {
-            log.e("hwc_device_open: failed to intialize HWCompower\n");
+            ELOG("hwc_device_open: failed to intialize HWCompower\n");
             status = -EINVAL;
             goto hwc_init_out;
         }
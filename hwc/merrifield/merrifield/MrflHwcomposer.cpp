@@ -49,14 +49,14 @@ MrflHwcomposer::~MrflHwcomposer()
 // implement createDisplayPlaneManager()
 DisplayPlaneManager* MrflHwcomposer::createDisplayPlaneManager()
 {
-    log.v("MrflHwcomposer::createDisplayPlaneManager");
+    VLOG("MrflHwcomposer::createDisplayPlaneManager");
     return (new MrflDisplayPlaneManager());
 }
 
 IDisplayDevice* MrflHwcomposer::createDisplayDevice(int disp,
                                                      DisplayPlaneManager& dpm)
 {
-    log.v("MrflHwcomposer::createDisplayDevice");
+    VLOG("MrflHwcomposer::createDisplayDevice");
 
     switch (disp) {
     case IDisplayDevice::DEVICE_PRIMARY:
@@ -64,36 +64,36 @@ IDisplayDevice* MrflHwcomposer::createDisplayDevice(int disp,
     case IDisplayDevice::DEVICE_EXTERNAL:
         return (new MrflHdmiDevice(*this, dpm));
     default:
-        log.e("MrflHwcomposer::createDisplayDevice: unsupported device %d",
-              disp);
+        ELOG("MrflHwcomposer::createDisplayDevice: unsupported device %d",
+             disp);
         return 0;
     }
 }
 
 void* MrflHwcomposer::getContexts()
 {
-    log.v("MrflHwcomposer::getContexts");
+    VLOG("MrflHwcomposer::getContexts");
     return (void *)mImgLayers;
 }
 
 bool MrflHwcomposer::commitContexts(void *contexts, int count)
 {
-    log.v("MrflHwcomposer::commitContexts: contexts = 0x%x, count = %d",
-          contexts, count);
+    VLOG("MrflHwcomposer::commitContexts: contexts = 0x%x, count = %d",
+         contexts, count);
 
     // nothing need to be submitted
     if (!count)
         return true;
 
     if (!contexts) {
-        log.e("MrflHwcomposer::commitContexts: invalid parameters");
+        ELOG("MrflHwcomposer::commitContexts: invalid parameters");
         return false;
     }
 
     if (mFBDev) {
         int err = mFBDev->Post2(&mFBDev->base, mImgLayers, count);
         if (err) {
-            log.e("MrflHwcomposer::commitContexts: Post2 failed err = %d", err);
+            ELOG("MrflHwcomposer::commitContexts: Post2 failed err = %d", err);
             return false;
         }
     }
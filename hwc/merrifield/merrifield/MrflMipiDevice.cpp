@@ -36,12 +36,12 @@ static Log& log = Log::getInstance();
 MrflMipiDevice::MrflMipiDevice(Hwcomposer& hwc, DisplayPlaneManager& dpm)
     : DisplayDevice(DEVICE_PRIMARY, hwc, dpm)
 {
-    log.v("MrflMipiDevice()");
+    VLOG("MrflMipiDevice()");
 }
 
 MrflMipiDevice::~MrflMipiDevice()
 {
-    log.v("~MrflMipiDevice");
+    VLOG("~MrflMipiDevice");
 }
 
 bool MrflMipiDevice::commit(hwc_display_contents_1_t *display,
@@ -50,13 +50,13 @@ bool MrflMipiDevice::commit(hwc_display_contents_1_t *display,
 {
     bool ret;
 
-    log.v("MrflMipiDevice::commit");
+    VLOG("MrflMipiDevice::commit");
 
     if (!initCheck())
         return false;
 
     if (!display || !contexts) {
-        log.e("MrflMipiDevice::commit: invalid parameters");
+        ELOG("MrflMipiDevice::commit: invalid parameters");
         return false;
     }
 
@@ -71,7 +71,7 @@ bool MrflMipiDevice::commit(hwc_display_contents_1_t *display,
 
         ret = plane->flip();
         if (ret == false) {
-            log.w("MrflMipiDevice::commit: failed to flip plane %d", i);
+            WLOG("MrflMipiDevice::commit: failed to flip plane %d", i);
             continue;
         }
 
@@ -84,21 +84,21 @@ bool MrflMipiDevice::commit(hwc_display_contents_1_t *display,
         imgLayer->displayFrame = display->hwLayers[i].displayFrame;
         imgLayer->custom = (uint32_t)plane->getContext();
 
-        log.v("MrflMipiDevice::commit %d: handle 0x%x, trans 0x%x, blending 0x%x"
-              " sourceCrop %d,%d - %dx%d, dst %d,%d - %dx%d, custom 0x%x",
-              count,
-              imgLayer->handle,
-              imgLayer->transform,
-              imgLayer->blending,
-              imgLayer->sourceCrop.left,
-              imgLayer->sourceCrop.top,
-              imgLayer->sourceCrop.right - imgLayer->sourceCrop.left,
-              imgLayer->sourceCrop.bottom - imgLayer->sourceCrop.top,
-              imgLayer->displayFrame.left,
-              imgLayer->displayFrame.top,
-              imgLayer->displayFrame.right - imgLayer->displayFrame.left,
-              imgLayer->displayFrame.bottom - imgLayer->displayFrame.top,
-              imgLayer->custom);
+        VLOG("MrflMipiDevice::commit %d: handle 0x%x, trans 0x%x, blending 0x%x"
+             " sourceCrop %d,%d - %dx%d, dst %d,%d - %dx%d, custom 0x%x",
+             count,
+             imgLayer->handle,
+             imgLayer->transform,
+             imgLayer->blending,
+             imgLayer->sourceCrop.left,
+             imgLayer->sourceCrop.top,
+             imgLayer->sourceCrop.right - imgLayer->sourceCrop.left,
+             imgLayer->sourceCrop.bottom - imgLayer->sourceCrop.top,
+             imgLayer->displayFrame.left,
+             imgLayer->displayFrame.top,
+             imgLayer->displayFrame.right - imgLayer->displayFrame.left,
+             imgLayer->displayFrame.bottom - imgLayer->displayFrame.top,
+             imgLayer->custom);
     }
     return true;
 }
@@ -38,25 +38,27 @@ namespace intel {
 static Log& log = Log::getInstance();
 
 MrflOverlayPlane::MrflOverlayPlane(int index, int pipe)
-    : OverlayPlane(index, pipe)
+    : OverlayPlane(index, pipe),
+      mFrameSet(false),
+      mFlipDeferred(false)
 {
-    log.v("MrflOverlayPlane");
+    VLOG("MrflOverlayPlane");
     memset(&mContext, 0, sizeof(mContext));
 }
 
 MrflOverlayPlane::~MrflOverlayPlane()
 {
-    log.v("~MrflOverlayPlane");
+    VLOG("~MrflOverlayPlane");
 }
 
 bool MrflOverlayPlane::isValidBuffer(uint32_t handle)
 {
-    log.v("MrflOverlayPlane::isValidBuffer: handle = 0x%x", handle);
+    VLOG("MrflOverlayPlane::isValidBuffer: handle = 0x%x", handle);
     MrflGrallocBuffer buff(handle);
     uint32_t format = buff.getFormat();
 
     if (!initCheck()) {
-        log.e("MrflOverlayPlane::setDataBuffer: overlay wasn't initialized");
+        ELOG("MrflOverlayPlane::setDataBuffer: overlay wasn't initialized");
         return false;
     }
 
@@ -69,8 +71,8 @@ bool MrflOverlayPlane::isValidBuffer(uint32_t handle)
     case IDataBuffer::FORMAT_UYVY:
         return true;
     default:
-        log.v("MrflOverlayPlane::isValidBuffer: unsupported format 0x%x",
-              format);
+        VLOG("MrflOverlayPlane::isValidBuffer: unsupported format 0x%x",
+             format);
     }
 
     return false;
@@ -84,26 +86,26 @@ IBufferMapper* MrflOverlayPlane::getGrallocMapper(uint32_t handle)
 
     buf = new MrflGrallocBuffer(handle);
     if (!buf) {
-        log.e("MrflOverlayPlane::setDataBuffer: failed to allocate buffer");
+        ELOG("MrflOverlayPlane::setDataBuffer: failed to allocate buffer");
         return 0;
     }
 
     // map buffer if it's not in cache
     mapper = mGrallocBufferCache->getMapper(buf->getStamp());
     if (!mapper) {
-        log.v("MrflOverlayPlane::getGrallocMapper: new buffer, will add it");
+        VLOG("MrflOverlayPlane::getGrallocMapper: new buffer, will add it");
         // update buffer's source crop
         buf->setCrop(mSrcCrop.x, mSrcCrop.y, mSrcCrop.w, mSrcCrop.h);
 
         mapper = new MrflGrallocBufferMapper(*mGrallocModule, *buf);
         if (!mapper) {
-            log.e("MrflOverlayPlane::getGrallocMapper: failed to allocate mapper");
+            ELOG("MrflOverlayPlane::getGrallocMapper: failed to allocate mapper");
             goto mapper_err;
         }
         // map gralloc buffer
         ret = mapper->map();
         if (!ret) {
-            log.e("MrflOverlayPlane::getGrallocMapper: failed to map");
+            ELOG("MrflOverlayPlane::getGrallocMapper: failed to map");
             goto map_err;
         }
 
@@ -112,7 +114,7 @@ IBufferMapper* MrflOverlayPlane::getGrallocMapper(uint32_t handle)
     }
 
     // TODO: delete gralloc buffer;
-    log.v("MrflOverlayPlane::getGrallocMapper: got gralloc mapper");
+    VLOG("MrflOverlayPlane::getGrallocMapper: got gralloc mapper");
     return mapper;
 map_err:
     delete mapper;
@@ -122,7 +124,7 @@ mapper_err:
     return 0;
 }
 
-IBufferMapper* MrflOverlayPlane::getTTMMapper(IBufferMapper& grallocMapper)
+TTMBufferMapper* MrflOverlayPlane::getTTMMapper(IBufferMapper& grallocMapper)
 {
     struct PayloadBuffer *payload;
     uint32_t khandle;
@@ -138,7 +140,7 @@ IBufferMapper* MrflOverlayPlane::getTTMMapper(IBufferMapper& grallocMapper)
 
     payload = (struct PayloadBuffer *)grallocMapper.getCpuAddress(SUB_BUFFER1);
     if (!payload) {
-        log.e("MrflOverlayPlane::getTTMMapper: invalid payload buffer");
+        ELOG("MrflOverlayPlane::getTTMMapper: invalid payload buffer");
         return 0;
     }
 
@@ -146,10 +148,10 @@ IBufferMapper* MrflOverlayPlane::getTTMMapper(IBufferMapper& grallocMapper)
     khandle = payload->rotated_buffer_handle;
     mapper = reinterpret_cast<TTMBufferMapper *>(mTTMBufferCache->getMapper(khandle));
     if (!mapper) {
-        log.v("MrflOverlayPlane::getTTMMapper: new buffer, will add it");
+        VLOG("MrflOverlayPlane::getTTMMapper: new buffer, will add it");
         buf = new TTMBuffer(khandle);
         if (!buf) {
-            log.e("MrflOverlayPlane::getTTMMapper: failed to create buffer");
+            ELOG("MrflOverlayPlane::getTTMMapper: failed to create buffer");
             return 0;
         }
 
@@ -220,13 +222,13 @@ IBufferMapper* MrflOverlayPlane::getTTMMapper(IBufferMapper& grallocMapper)
         // create buffer mapper
         mapper = new TTMBufferMapper(*mWsbm, *buf);
         if (!mapper) {
-            log.e("MrflOverlayPlane::getTTMMapper: failed to allocate mapper");
+            ELOG("MrflOverlayPlane::getTTMMapper: failed to allocate mapper");
             goto mapper_err;
         }
         // map gralloc buffer
         ret = mapper->map();
         if (!ret) {
-            log.e("MrflOverlayPlane::getTTMMapper: failed to map");
+            ELOG("MrflOverlayPlane::getTTMMapper: failed to map");
             goto map_err;
         }
 
@@ -234,13 +236,7 @@ IBufferMapper* MrflOverlayPlane::getTTMMapper(IBufferMapper& grallocMapper)
         mTTMBufferCache->addMapper(khandle, mapper);
     }
 
-    // sync rotated data buffer.
-    // Well, I have to, video driver DOESN'T support sync this buffer
-    ret = mapper->waitIdle();
-    if (ret == false)
-        log.w("MrflOverlayPlane::getTTMMapper: failed to wait idle");
-
-    log.v("MrflOverlayPlane::getTTMMapper: got ttm mapper");
+    VLOG("MrflOverlayPlane::getTTMMapper: got ttm mapper");
 
     return mapper;
 map_err:
@@ -264,7 +260,7 @@ bool MrflOverlayPlane::rotatedBufferReady(IBufferMapper& mapper)
     payload = (struct PayloadBuffer *)mapper.getCpuAddress(SUB_BUFFER1);
     // check payload
     if (!payload) {
-        log.e("MrflOverlayPlane::rotatedBufferReady: no payload found");
+        ELOG("MrflOverlayPlane::rotatedBufferReady: no payload found");
         return false;
     }
 
@@ -272,7 +268,7 @@ bool MrflOverlayPlane::rotatedBufferReady(IBufferMapper& mapper)
         return false;
 
     if (payload->client_transform != mTransform) {
-        log.w("MrflOverlayPlane::rotatedBufferReady: client is not ready");
+        WLOG("MrflOverlayPlane::rotatedBufferReady: client is not ready");
         return false;
     }
 
@@ -282,51 +278,76 @@ bool MrflOverlayPlane::rotatedBufferReady(IBufferMapper& mapper)
 bool MrflOverlayPlane::setDataBuffer(uint32_t handle)
 {
     IBufferMapper *mapper;
-    bool ret;
+    TTMBufferMapper *ttmMapper;
 
-    log.v("MrflOverlayPlane::setDataBuffer: handle = %d");
+    VLOG("MrflOverlayPlane::setDataBuffer: handle = %d");
 
     if (!initCheck()) {
-        log.e("MrflOverlayPlane::setDataBuffer: overlay wasn't initialized");
+        ELOG("MrflOverlayPlane::setDataBuffer: overlay wasn't initialized");
         return false;
     }
 
     if (!handle) {
-        log.e("MrflOverlayPlane::setDataBuffer: invalid buffer handle");
+        ELOG("MrflOverlayPlane::setDataBuffer: invalid buffer handle");
         return false;
     }
 
     // get gralloc mapper
     mapper = getGrallocMapper(handle);
     if (!mapper) {
-        log.e("MrflOverlayPlane::setDataBuffer: failed to get gralloc mapper");
+        ELOG("MrflOverlayPlane::setDataBuffer: failed to get gralloc mapper");
         return false;
     }
 
     // check transform when overlay is attached to primary device
     if (mTransform && !mPipe) {
         if (!rotatedBufferReady(*mapper)) {
-            log.w("MrflOverlayPlane::setDataBuffer: rotated buffer is not ready");
+            WLOG("MrflOverlayPlane::setDataBuffer: rotated buffer is not ready");
             return false;
         }
 
         // get rotated data buffer mapper
-        mapper = getTTMMapper(*mapper);
-        if (!mapper) {
-            log.e("MrflOverlayPlane::setDataBuffer: failed to get rotated buffer");
+        ttmMapper = getTTMMapper(*mapper);
+        if (!ttmMapper) {
+            ELOG("MrflOverlayPlane::setDataBuffer: failed to get rotated buffer");
             return false;
         }
+
+        // video driver doesn't sync the rotated buffer. Rather than
+        // waiting for it every frame, keep the back buffer of the frame
+        // shown when it is still busy; the next busy one is waited for
+        if (!ttmMapper->isIdle()) {
+            if (mFrameSet && !mFlipDeferred) {
+                VLOG("MrflOverlayPlane::setDataBuffer: busy, defer flip");
+                mFlipDeferred = true;
+                return true;
+            }
+            if (!ttmMapper->waitIdle())
+                WLOG("MrflOverlayPlane::setDataBuffer: failed to wait idle");
+        }
+        mapper = ttmMapper;
     }
+    mFlipDeferred = false;
 
-    return OverlayPlane::setDataBuffer(*mapper);
+    if (!OverlayPlane::setDataBuffer(*mapper))
+        return false;
+    mFrameSet = true;
+    return true;
+}
+
+bool MrflOverlayPlane::disable()
+{
+    mFrameSet = false;
+    mFlipDeferred = false;
+    return OverlayPlane::disable();
 }
 
 bool MrflOverlayPlane::flip()
 {
-    log.v("MrflOverlayPlane:flip");
+    VLOG("MrflOverlayPlane:flip");
 
     if (!initCheck()) {
-        log.e("MrflOverlayPlane::setDataBuffer: overlay wasn't initialized");
+        ELOG("MrflOverlayPlane::setDataBuffer: overlay wasn't initialized");
         return false;
     }
 
@@ -337,17 +358,17 @@ bool MrflOverlayPlane::flip()
     mContext.ctx.ov_ctx.pipe = mPipe;
     mContext.ctx.ov_ctx.ovadd |= 0x1;
 
-    log.v("MrflOverlayPlane::flip: ovadd = 0x%x, index = %d, pipe = %d",
-          mContext.ctx.ov_ctx.ovadd,
-          mIndex,
-          mPipe);
+    VLOG("MrflOverlayPlane::flip: ovadd = 0x%x, index = %d, pipe = %d",
+         mContext.ctx.ov_ctx.ovadd,
+         mIndex,
+         mPipe);
 
     return true;
 }
 
 void* MrflOverlayPlane::getContext() const
 {
-    log.v("MrflOverlayPlane::getContext");
+    VLOG("MrflOverlayPlane::getContext");
     return (void *)&mContext;
 }
 
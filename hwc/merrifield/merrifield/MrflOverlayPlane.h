@@ -30,6 +30,7 @@
 
 #include <displayclass_interface.h>
 #include <OverlayPlane.h>
+#include <TTMBufferMapper.h>
 
 namespace android {
 namespace intel {
@@ -39,7 +40,7 @@ public:
     MrflOverlayPlane(int index, int pipe);
     ~MrflOverlayPlane();
 private:
-    IBufferMapper* getTTMMapper(IBufferMapper& grallocMapper);
+    TTMBufferMapper* getTTMMapper(IBufferMapper& grallocMapper);
     IBufferMapper* getGrallocMapper(uint32_t handle);
     bool rotatedBufferReady(IBufferMapper& mapper);
 public:
@@ -47,9 +48,13 @@ public:
     bool isValidBuffer(uint32_t handle);
     bool setDataBuffer(uint32_t handle);
     bool flip();
+    bool disable();
     void* getContext() const;
 private:
     struct intel_dc_plane_ctx mContext;
+    // a back buffer was set up, and the last one kept on a busy buffer
+    bool mFrameSet;
+    bool mFlipDeferred;
 };
 
 } // namespace intel
@@ -40,7 +40,7 @@ MrflPrimaryPlane::MrflPrimaryPlane(int index, int pipe)
     : SpritePlane(index, pipe),
       mForceBottom(true)
 {
-    log.v("MrflPrimaryPlane");
+    VLOG("MrflPrimaryPlane");
     SpritePlane::mType = PLANE_PRIMARY;
     // reset context
     memset(&mContext, 0, sizeof(mContext));
@@ -48,12 +48,12 @@ MrflPrimaryPlane::MrflPrimaryPlane(int index, int pipe)
 
 MrflPrimaryPlane::~MrflPrimaryPlane()
 {
-    log.v("~MrflPrimaryPlane");
+    VLOG("~MrflPrimaryPlane");
 }
 
 void MrflPrimaryPlane::setFramebufferTarget(IDataBuffer& buf)
 {
-    log.v("MrflPrimaryPlane::setFramebufferTarget");
+    VLOG("MrflPrimaryPlane::setFramebufferTarget");
 
     // don't need to map data buffer for primary plane
     mContext.type = DC_PRIMARY_PLANE;
@@ -75,7 +75,7 @@ void MrflPrimaryPlane::setFramebufferTarget(IDataBuffer& buf)
 
 bool MrflPrimaryPlane::isValidBuffer(uint32_t handle)
 {
-    log.v("MrflPrimaryPlane::isValidBuffer: handle = 0x%x", handle);
+    VLOG("MrflPrimaryPlane::isValidBuffer: handle = 0x%x", handle);
     MrflGrallocBuffer buff(handle);
     uint32_t format = buff.getFormat();
 
@@ -86,8 +86,8 @@ bool MrflPrimaryPlane::isValidBuffer(uint32_t handle)
     case IDataBuffer::FORMAT_RGB565:
         return true;
     default:
-        log.v("MrflPrimaryPlane::isValidBuffer: unsupported format 0x%x",
-              format);
+        VLOG("MrflPrimaryPlane::isValidBuffer: unsupported format 0x%x",
+             format);
     }
 
     return false;
@@ -107,7 +107,7 @@ bool MrflPrimaryPlane::setDataBuffer(IBufferMapper& mapper)
     uint32_t stride;
     uint32_t linoff;
 
-    log.v("MrflPrimaryPlane::setDataBuffer");
+    VLOG("MrflPrimaryPlane::setDataBuffer");
 
     // setup plane position
     dstX = mPosition.x;
@@ -140,8 +140,8 @@ bool MrflPrimaryPlane::setDataBuffer(IBufferMapper& mapper)
         bpp = 2;
         break;
     default:
-        log.e("MrflPrimaryPlane::setDataBuffer: unsupported format 0x%x",
-              mapper.getFormat());
+        ELOG("MrflPrimaryPlane::setDataBuffer: unsupported format 0x%x",
+             mapper.getFormat());
         return false;
     }
 
@@ -153,7 +153,7 @@ bool MrflPrimaryPlane::setDataBuffer(IBufferMapper& mapper)
 
     // unlikely happen, but still we need make sure linoff is valid
     if (linoff > (stride * mapper.getHeight())) {
-        log.e("MrflPrimaryPlane::setDataBuffer: invalid source crop");
+        ELOG("MrflPrimaryPlane::setDataBuffer: invalid source crop");
         return false;
     }
 
@@ -172,14 +172,14 @@ bool MrflPrimaryPlane::setDataBuffer(IBufferMapper& mapper)
     if (mForceBottom)
         mContext.ctx.sp_ctx.cntr  |= 0x00000004;
 
-    log.v("MrflPrimaryPlane::setDataBuffer: cntr = 0x%x, linoff = 0x%x, stride = 0x%x,"
-          "surf = 0x%x, pos = 0x%x, size = 0x%x\n",
-          mContext.ctx.sp_ctx.cntr,
-          mContext.ctx.sp_ctx.linoff,
-          mContext.ctx.sp_ctx.stride,
-          mContext.ctx.sp_ctx.surf,
-          mContext.ctx.sp_ctx.pos,
-          mContext.ctx.sp_ctx.size);
+    VLOG("MrflPrimaryPlane::setDataBuffer: cntr = 0x%x, linoff = 0x%x, stride = 0x%x,"
+         "surf = 0x%x, pos = 0x%x, size = 0x%x\n",
+         mContext.ctx.sp_ctx.cntr,
+         mContext.ctx.sp_ctx.linoff,
+         mContext.ctx.sp_ctx.stride,
+         mContext.ctx.sp_ctx.surf,
+         mContext.ctx.sp_ctx.pos,
+         mContext.ctx.sp_ctx.size);
     return true;
 }
 
@@ -191,7 +191,7 @@ bool MrflPrimaryPlane::setDataBuffer(uint32_t handle)
     uint32_t usage;
     bool ret;
 
-    log.v("MrflPrimaryPlane::setDataBuffer: handle = %d");
+    VLOG("MrflPrimaryPlane::setDataBuffer: handle = %d");
 
     usage = tmpBuf.getUsage();
     if (!handle || (GRALLOC_USAGE_HW_FB & usage)) {
@@ -200,21 +200,21 @@ bool MrflPrimaryPlane::setDataBuffer(uint32_t handle)
     }
 
     // primary is used as a sprite plane
-    log.v("MrflPrimaryPlane::setDataBuffer: usage = 0x%x", usage);
+    VLOG("MrflPrimaryPlane::setDataBuffer: usage = 0x%x", usage);
 
     if (!initCheck()) {
-        log.e("MrflPrimaryPlane::setDataBuffer: plane hasn't been initialized");
+        ELOG("MrflPrimaryPlane::setDataBuffer: plane hasn't been initialized");
         return false;
     }
 
     if (!handle) {
-        log.e("MrflPrimaryPlane::setDataBuffer: invalid buffer handle");
+        ELOG("MrflPrimaryPlane::setDataBuffer: invalid buffer handle");
         return false;
     }
 
     buf = new MrflGrallocBuffer(handle);
     if (!buf) {
-        log.e("MrflPrimaryPlane::setDataBuffer: failed to allocate buffer");
+        ELOG("MrflPrimaryPlane::setDataBuffer: failed to allocate buffer");
         return false;
     }
 
@@ -224,16 +224,16 @@ bool MrflPrimaryPlane::setDataBuffer(uint32_t handle)
     // map buffer if it's not in cache
     mapper = mGrallocBufferCache->getMapper(buf->getStamp());
     if (!mapper) {
-        log.v("MrflPrimaryPlane::setDataBuffer: new buffer, will add it");
+        VLOG("MrflPrimaryPlane::setDataBuffer: new buffer, will add it");
         mapper = new MrflGrallocBufferMapper(*mGrallocModule, *buf);
         if (!mapper) {
-            log.e("MrflPrimaryPlane::setDataBuffer: failed to allocate mapper");
+            ELOG("MrflPrimaryPlane::setDataBuffer: failed to allocate mapper");
             goto mapper_err;
         }
         // map gralloc buffer
         ret = mapper->map();
         if (!ret) {
-            log.e("MrflPrimaryPlane::setDataBuffer: failed to map");
+            ELOG("MrflPrimaryPlane::setDataBuffer: failed to map");
             goto map_err;
         }
 
@@ -252,13 +252,13 @@ mapper_err:
 
 bool MrflPrimaryPlane::assignToPipe(uint32_t pipe)
 {
-    log.v("MrflPrimaryPlane::assignToPipe:Unsupported for a primary plane");
+    VLOG("MrflPrimaryPlane::assignToPipe:Unsupported for a primary plane");
     return true;
 }
 
 void MrflPrimaryPlane::setZOrderConfig(ZOrderConfig& config)
 {
-    log.v("MrflPrimaryPlane::setZOrderConfig");
+    VLOG("MrflPrimaryPlane::setZOrderConfig");
 
     // for primary plane of external display, force it to be bottom
     if (mIndex == Drm::OUTPUT_HDMI) {
@@ -274,31 +274,31 @@ void MrflPrimaryPlane::setZOrderConfig(ZOrderConfig& config)
 
 bool MrflPrimaryPlane::reset()
 {
-    log.v("reset");
+    VLOG("reset");
     return true;
 }
 
 bool MrflPrimaryPlane::flip()
 {
-    log.v("flip");
+    VLOG("flip");
     return true;
 }
 
 bool MrflPrimaryPlane::enable()
 {
-    log.v("enable");
+    VLOG("enable");
     return true;
 }
 
 bool MrflPrimaryPlane::disable()
 {
-    log.v("disable");
+    VLOG("disable");
     return true;
 }
 
 void* MrflPrimaryPlane::getContext() const
 {
-    log.v("getContext");
+    VLOG("getContext");
     return (void *)&mContext;
 }
 
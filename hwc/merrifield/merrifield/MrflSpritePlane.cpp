@@ -38,14 +38,14 @@ static Log& log = Log::getInstance();
 MrflSpritePlane::MrflSpritePlane(int index, int pipe)
     : SpritePlane(3, pipe)
 {
-    log.v("MrflSpritePlane");
+    VLOG("MrflSpritePlane");
     // reset context
     memset(&mContext, 0, sizeof(mContext));
 }
 
 MrflSpritePlane::~MrflSpritePlane()
 {
-    log.v("~MrflSpritePlane");
+    VLOG("~MrflSpritePlane");
 }
 
 bool MrflSpritePlane::isValidBuffer(uint32_t handle)
@@ -53,10 +53,10 @@ bool MrflSpritePlane::isValidBuffer(uint32_t handle)
     MrflGrallocBuffer buff(handle);
     uint32_t format = buff.getFormat();
 
-    log.v("MrflSpritePlane::isValidTransform: trans = 0x%x");
+    VLOG("MrflSpritePlane::isValidTransform: trans = 0x%x");
 
     if (!initCheck()) {
-        log.e("MrflSpritePlane::isValidTransform: plane hasn't been initialized");
+        ELOG("MrflSpritePlane::isValidTransform: plane hasn't been initialized");
         return false;
     }
 
@@ -67,8 +67,8 @@ bool MrflSpritePlane::isValidBuffer(uint32_t handle)
     case IDataBuffer::FORMAT_RGB565:
         return true;
     default:
-        log.v("MrflSpritePlane::isValidBuffer: unsupported format 0x%x",
-              format);
+        VLOG("MrflSpritePlane::isValidBuffer: unsupported format 0x%x",
+             format);
     }
 
     return false;
@@ -89,7 +89,7 @@ bool MrflSpritePlane::setDataBuffer(IBufferMapper& mapper)
     uint32_t stride;
     uint32_t linoff;
 
-    log.v("MrflSpritePlane::setDataBuffer");
+    VLOG("MrflSpritePlane::setDataBuffer");
 
     // setup plane position
     dstX = mPosition.x;
@@ -122,8 +122,8 @@ bool MrflSpritePlane::setDataBuffer(IBufferMapper& mapper)
         bpp = 2;
         break;
     default:
-        log.e("MrflSpritePlane::setDataBuffer: unsupported format 0x%x",
-              mapper.getFormat());
+        ELOG("MrflSpritePlane::setDataBuffer: unsupported format 0x%x",
+             mapper.getFormat());
         return false;
     }
 
@@ -135,7 +135,7 @@ bool MrflSpritePlane::setDataBuffer(IBufferMapper& mapper)
 
     // unlikely happen, but still we need make sure linoff is valid
     if (linoff > (stride * mapper.getHeight())) {
-        log.e("MrflSpritePlane::setDataBuffer: invalid source crop");
+        ELOG("MrflSpritePlane::setDataBuffer: invalid source crop");
         return false;
     }
 
@@ -152,14 +152,14 @@ bool MrflSpritePlane::setDataBuffer(IBufferMapper& mapper)
         ((dstH - 1) & 0xfff) << 16 | ((dstW - 1) & 0xfff);
     mContext.ctx.sp_ctx.update_mask = SPRITE_UPDATE_ALL;
 
-    log.v("MrflSpritePlane::setDataBuffer: cntr = 0x%x, linoff = 0x%x, stride = 0x%x,"
-          "surf = 0x%x, pos = 0x%x, size = 0x%x\n",
-          mContext.ctx.sp_ctx.cntr,
-          mContext.ctx.sp_ctx.linoff,
-          mContext.ctx.sp_ctx.stride,
-          mContext.ctx.sp_ctx.surf,
-          mContext.ctx.sp_ctx.pos,
-          mContext.ctx.sp_ctx.size);
+    VLOG("MrflSpritePlane::setDataBuffer: cntr = 0x%x, linoff = 0x%x, stride = 0x%x,"
+         "surf = 0x%x, pos = 0x%x, size = 0x%x\n",
+         mContext.ctx.sp_ctx.cntr,
+         mContext.ctx.sp_ctx.linoff,
+         mContext.ctx.sp_ctx.stride,
+         mContext.ctx.sp_ctx.surf,
+         mContext.ctx.sp_ctx.pos,
+         mContext.ctx.sp_ctx.size);
     return true;
 }
 
@@ -169,21 +169,21 @@ bool MrflSpritePlane::setDataBuffer(uint32_t handle)
     IBufferMapper *mapper;
     bool ret;
 
-    log.v("MrflSpritePlane::setDataBuffer: handle = %d");
+    VLOG("MrflSpritePlane::setDataBuffer: handle = %d");
 
     if (!initCheck()) {
-        log.e("MrflSpritePlane::setDataBuffer: plane hasn't been initialized");
+        ELOG("MrflSpritePlane::setDataBuffer: plane hasn't been initialized");
         return false;
     }
 
     if (!handle) {
-        log.e("MrflSpritePlane::setDataBuffer: invalid buffer handle");
+        ELOG("MrflSpritePlane::setDataBuffer: invalid buffer handle");
         return false;
     }
 
     buf = new MrflGrallocBuffer(handle);
     if (!buf) {
-        log.e("MrflSpritePlane::setDataBuffer: failed to allocate buffer");
+        ELOG("MrflSpritePlane::setDataBuffer: failed to allocate buffer");
         return false;
     }
 
@@ -193,16 +193,16 @@ bool MrflSpritePlane::setDataBuffer(uint32_t handle)
     // map buffer if it's not in cache
     mapper = mGrallocBufferCache->getMapper(buf->getStamp());
     if (!mapper) {
-        log.v("MrflSpritePlane::setDataBuffer: new buffer, will add it");
+        VLOG("MrflSpritePlane::setDataBuffer: new buffer, will add it");
         mapper = new MrflGrallocBufferMapper(*mGrallocModule, *buf);
         if (!mapper) {
-            log.e("MrflSpritePlane::setDataBuffer: failed to allocate mapper");
+            ELOG("MrflSpritePlane::setDataBuffer: failed to allocate mapper");
             goto mapper_err;
         }
         // map gralloc buffer
         ret = mapper->map();
         if (!ret) {
-            log.e("MrflSpritePlane::setDataBuffer: failed to map");
+            ELOG("MrflSpritePlane::setDataBuffer: failed to map");
             goto map_err;
         }
 
@@ -221,13 +221,13 @@ mapper_err:
 
 bool MrflSpritePlane::flip()
 {
-    log.v("MrflSpritePlane::flip");
+    VLOG("MrflSpritePlane::flip");
     return true;
 }
 
 void* MrflSpritePlane::getContext() const
 {
-    log.v("MrflSpritePlane::getContext");
+    VLOG("MrflSpritePlane::getContext");
     return (void *)&mContext;
 }
 
@@ -0,0 +1,369 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Offline evaluator for the overlay assignment. Reads layer lists in
+ * the format of the HWC table printed by dumpsys SurfaceFlinger, runs
+ * IntelBandwidthModel and IntelZOrderSolver on each and reports, per
+ * list, the estimated traffic of the composition the device recorded
+ * (HWC layers on overlays, GLES layers composed) next to that of the
+ * solver's choice and of composing everything with GLES.
+ *
+ * A list starts at its "numHwLayers=" line; table rows follow. A line
+ * "# measured <bytes>" after a list gives the traffic measured for it,
+ * e.g. from a DRAM counter, which is then reported against the
+ * estimate of the recorded composition.
+ *
+ * usage: hwc_bandwidth_eval [-o overlays] [-v] scene...
+ *
+ * tests/scenes holds example scenes to start from.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <IntelZOrderSolver.h>
+#include <IntelBandwidthModel.h>
+#include <IntelLayerGeometry.h>
+#include <IntelHWComposerCfg.h>
+
+/* defined by IntelHWComposerModule.cpp in the HAL */
+hwc_cfg cfg;
+
+#define MAX_LINE        512
+#define MAX_SCENE_LAYERS IntelLayerGeometry::MAX_LAYERS
+#define REFRESH_RATE    60
+
+struct scene {
+    hwc_display_contents_1_t *list;
+    IMG_native_handle_t handles[MAX_SCENE_LAYERS];
+    int numLayers;
+    bool hasTarget;
+    bool hasMeasured;
+    uint64_t measured;
+};
+
+struct totals {
+    int lists;
+    int matched;
+    uint64_t recordedBytes;
+    uint64_t solverBytes;
+    uint64_t glesBytes;
+    int measuredLists;
+    uint64_t measuredBytes;
+    uint64_t measuredEstimate;
+};
+
+static int numOverlays = 1;
+static bool verbose;
+
+static void scene_reset(scene *s)
+{
+    memset(s->list, 0, sizeof(hwc_display_contents_1_t) +
+           (MAX_SCENE_LAYERS + 1) * sizeof(hwc_layer_1_t));
+    memset(s->handles, 0, sizeof(s->handles));
+    s->numLayers = 0;
+    s->hasTarget = false;
+    s->hasMeasured = false;
+    s->measured = 0;
+}
+
+static bool parse_rect(const char *str, hwc_rect_t *r)
+{
+    return sscanf(str, "[%d,%d,%d,%d]",
+                  &r->left, &r->top, &r->right, &r->bottom) == 4;
+}
+
+// one row of the table, e.g.
+//   GLES | 40f1a2c0 | 00000000 | 00000000 | 00 | 00105 | 00000001 |
+//   [    0,    0,  720,   50] | [    0,    0,  720,   50] StatusBar
+static bool parse_row(scene *s, const char *line)
+{
+    char type[16];
+    unsigned int handle, hints, flags, transform, blend, format;
+    const char *crop, *frame;
+    hwc_rect_t sourceCrop, displayFrame;
+
+    if (sscanf(line, " %15[A-Z ] | %x | %x | %x | %x | %x | %x |",
+               type, &handle, &hints, &flags, &transform,
+               &blend, &format) != 7)
+        return false;
+
+    crop = strchr(line, '[');
+    frame = crop ? strchr(crop + 1, '[') : NULL;
+    if (!crop || !frame ||
+        !parse_rect(crop, &sourceCrop) || !parse_rect(frame, &displayFrame))
+        return false;
+
+    // the framebuffer target ends the list
+    if (!strncmp(type, "FB TARGET", 9)) {
+        hwc_layer_1_t& target = s->list->hwLayers[s->numLayers];
+        target.compositionType = HWC_FRAMEBUFFER_TARGET;
+        target.displayFrame = displayFrame;
+        s->hasTarget = true;
+        return true;
+    }
+
+    if (s->hasTarget || s->numLayers >= MAX_SCENE_LAYERS)
+        return false;
+
+    int i = s->numLayers++;
+    hwc_layer_1_t& layer = s->list->hwLayers[i];
+    IMG_native_handle_t& h = s->handles[i];
+
+    h.iFormat = format;
+    h.iWidth = sourceCrop.right;
+    h.iHeight = sourceCrop.bottom;
+
+    layer.compositionType =
+        !strncmp(type, "HWC", 3) ? HWC_OVERLAY : HWC_FRAMEBUFFER;
+    layer.hints = hints;
+    layer.flags = flags;
+    layer.handle = handle ? (buffer_handle_t)&h : NULL;
+    layer.transform = transform;
+    layer.blending = blend;
+    layer.planeAlpha = 0xff;
+    layer.sourceCrop = sourceCrop;
+    layer.displayFrame = displayFrame;
+    return true;
+}
+
+// what solveZOrder() would let an overlay show, less the runtime state
+static bool is_candidate(const hwc_layer_1_t& layer)
+{
+    const IMG_native_handle_t *h = (const IMG_native_handle_t*)layer.handle;
+    const IntelFormatTraits *traits = h ? IntelFormatTraits::get(h->iFormat) : 0;
+
+    return traits && traits->has(IntelFormatTraits::FORMAT_OVERLAY) &&
+           layer.blending == HWC_BLENDING_NONE &&
+           !(layer.flags & HWC_SKIP_LAYER);
+}
+
+static void print_layers(uint64_t mask, int numLayers)
+{
+    bool any = false;
+
+    printf("{");
+    for (int i = 0; i < numLayers; i++) {
+        if (mask & IntelLayerGeometry::bit(i)) {
+            printf("%s%d", any ? "," : "", i);
+            any = true;
+        }
+    }
+    printf("}");
+}
+
+static double mb(uint64_t bytes)
+{
+    return bytes / (1024.0 * 1024.0);
+}
+
+static void evaluate(const char *name, int index, scene *s, totals *t)
+{
+    IntelLayerGeometry geometry;
+    IntelBandwidthModel bandwidth;
+    IntelZOrderSolver solver;
+    uint64_t candidates = 0, recorded = 0;
+    int n = s->numLayers;
+
+    if (!n)
+        return;
+
+    s->list->numHwLayers = n + (s->hasTarget ? 1 : 0);
+    geometry.update(s->list, n);
+    bandwidth.update(s->list, n, geometry);
+
+    for (int i = 0; i < n; i++) {
+        const hwc_layer_1_t& layer = s->list->hwLayers[i];
+        if (layer.compositionType == HWC_OVERLAY)
+            recorded |= IntelLayerGeometry::bit(i);
+        if (is_candidate(layer))
+            candidates |= IntelLayerGeometry::bit(i);
+    }
+
+    uint64_t recordedBytes = bandwidth.getFrameBytes(recorded);
+    uint64_t glesBytes = bandwidth.getFrameBytes(0);
+    uint64_t solverBytes = glesBytes;
+    uint64_t overlays = 0;
+    bool fbOnTop = true;
+
+    if (candidates &&
+        solver.solve(n, geometry, bandwidth, candidates, 0, numOverlays)) {
+        overlays = solver.getOverlayLayers();
+        fbOnTop = solver.isFbOnTop();
+        solverBytes = solver.getFrameBytes();
+    }
+
+    printf("%s list %d: %d layers\n", name, index, n);
+    if (verbose) {
+        for (int i = 0; i < n; i++) {
+            const hwc_layer_1_t& layer = s->list->hwLayers[i];
+            const hwc_rect_t& f = layer.displayFrame;
+            printf("  %2d %-4s [%d,%d,%d,%d] plane %.2f MB gles %.2f MB%s%s\n",
+                   i, layer.compositionType == HWC_OVERLAY ? "HWC" : "GLES",
+                   f.left, f.top, f.right, f.bottom,
+                   mb(bandwidth.getPlaneBytes(i)),
+                   mb(bandwidth.getGlesBytes(i)),
+                   bandwidth.isVisible(i) ? "" : " hidden",
+                   (candidates & IntelLayerGeometry::bit(i)) ?
+                       " candidate" : "");
+        }
+    }
+
+    printf("  recorded overlays ");
+    print_layers(recorded, n);
+    printf("  %8.2f MB/frame\n", mb(recordedBytes));
+    printf("  solver   overlays ");
+    print_layers(overlays, n);
+    printf(" fb %s  %8.2f MB/frame\n", fbOnTop ? "top" : "bottom",
+           mb(solverBytes));
+    printf("  all gles          %8.2f MB/frame\n", mb(glesBytes));
+    if (s->hasMeasured) {
+        printf("  measured          %8.2f MB/frame, recorded estimate %+.1f%%\n",
+               mb(s->measured),
+               100.0 * ((double)recordedBytes - s->measured) / s->measured);
+        t->measuredLists++;
+        t->measuredBytes += s->measured;
+        t->measuredEstimate += recordedBytes;
+    }
+
+    t->lists++;
+    if (overlays == recorded)
+        t->matched++;
+    t->recordedBytes += recordedBytes;
+    t->solverBytes += solverBytes;
+    t->glesBytes += glesBytes;
+}
+
+static int evaluate_file(const char *path, totals *t)
+{
+    FILE *fp = fopen(path, "r");
+    char line[MAX_LINE];
+    scene s;
+    bool inList = false;
+    int index = 0;
+
+    if (!fp) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return -1;
+    }
+
+    s.list = (hwc_display_contents_1_t*)calloc(1,
+                sizeof(hwc_display_contents_1_t) +
+                (MAX_SCENE_LAYERS + 1) * sizeof(hwc_layer_1_t));
+    scene_reset(&s);
+
+    while (fgets(line, sizeof(line), fp)) {
+        unsigned long long measured;
+
+        if (strstr(line, "numHwLayers=")) {
+            if (inList)
+                evaluate(path, index++, &s, t);
+            scene_reset(&s);
+            inList = true;
+        } else if (sscanf(line, " # measured %llu", &measured) == 1) {
+            s.hasMeasured = true;
+            s.measured = measured;
+        } else if (inList && strchr(line, '|') && strchr(line, '[')) {
+            if (!parse_row(&s, line))
+                fprintf(stderr, "%s: skipped row: %s", path, line);
+        }
+    }
+    if (inList)
+        evaluate(path, index, &s, t);
+
+    free(s.list);
+    fclose(fp);
+    return 0;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-o overlays] [-v] scene...\n", prog);
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    totals t;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:v")) != -1) {
+        switch (opt) {
+        case 'o':
+            numOverlays = atoi(optarg);
+            break;
+        case 'v':
+            verbose = true;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (optind >= argc)
+        usage(argv[0]);
+
+    memset(&t, 0, sizeof(t));
+    for (int i = optind; i < argc; i++) {
+        if (evaluate_file(argv[i], &t))
+            return 1;
+    }
+
+    if (!t.lists) {
+        fprintf(stderr, "no layer lists found\n");
+        return 1;
+    }
+
+    printf("\n%d lists, solver agrees with the recorded overlays on %d\n",
+           t.lists, t.matched);
+    printf("recorded %.1f MB/s, solver %.1f MB/s, all gles %.1f MB/s at %d Hz\n",
+           mb(t.recordedBytes) * REFRESH_RATE / t.lists,
+           mb(t.solverBytes) * REFRESH_RATE / t.lists,
+           mb(t.glesBytes) * REFRESH_RATE / t.lists, REFRESH_RATE);
+    if (t.measuredLists)
+        printf("measured %.1f MB/s over %d lists, recorded estimate %+.1f%%\n",
+               mb(t.measuredBytes) * REFRESH_RATE / t.measuredLists,
+               t.measuredLists,
+               100.0 * ((double)t.measuredEstimate - t.measuredBytes) /
+                   t.measuredBytes);
+    return 0;
+}
@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host test for IntelBandwidthModel. Each table entry is one layer on a
+ * 1000x1000 display with the plane and GLES bytes worked out by hand,
+ * then frame totals are checked against the per layer numbers.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <IntelBandwidthModel.h>
+#include <IntelHWComposerCfg.h>
+
+/* defined by IntelHWComposerModule.cpp in the HAL */
+hwc_cfg cfg;
+
+static int failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+static IMG_native_handle_t rgba = { HAL_PIXEL_FORMAT_RGBA_8888 };
+static IMG_native_handle_t rgb565 = { HAL_PIXEL_FORMAT_RGB_565 };
+static IMG_native_handle_t nv12 = { HAL_PIXEL_FORMAT_INTEL_HWC_NV12 };
+static IMG_native_handle_t yuy2 = { HAL_PIXEL_FORMAT_INTEL_HWC_YUY2 };
+static IMG_native_handle_t unknown = { 0x7fff };
+
+#define DISPLAY_SIZE        1000
+#define FB_BYTES            (DISPLAY_SIZE * DISPLAY_SIZE * 4ULL)
+
+struct bandwidth_case {
+    const char *name;
+    IMG_native_handle_t *handle;
+    int blending;
+    hwc_rect_t crop;
+    hwc_rect_t frame;
+    uint64_t planeBytes;
+    uint64_t glesBytes;
+};
+
+// GLES reads max(src, dst) texels, writes dst and reads it back to blend
+static const bandwidth_case cases[] = {
+    { "opaque rgba", &rgba, HWC_BLENDING_NONE,
+      { 0, 0, 100, 100 }, { 0, 0, 100, 100 },
+      40000, 40000 + 40000 },
+    { "blended rgba", &rgba, HWC_BLENDING_PREMULT,
+      { 0, 0, 100, 100 }, { 0, 0, 100, 100 },
+      40000, 40000 + 40000 + 40000 },
+    { "coverage rgba", &rgba, HWC_BLENDING_COVERAGE,
+      { 0, 0, 100, 100 }, { 0, 0, 100, 100 },
+      40000, 40000 + 40000 + 40000 },
+    { "upscaled rgba", &rgba, HWC_BLENDING_NONE,
+      { 0, 0, 50, 50 }, { 0, 0, 100, 100 },
+      10000, 40000 + 40000 },
+    { "downscaled rgba", &rgba, HWC_BLENDING_NONE,
+      { 0, 0, 200, 200 }, { 0, 0, 100, 100 },
+      160000, 160000 + 40000 },
+    { "rgb565", &rgb565, HWC_BLENDING_NONE,
+      { 0, 0, 100, 100 }, { 0, 0, 100, 100 },
+      20000, 20000 + 40000 },
+    { "nv12 video", &nv12, HWC_BLENDING_NONE,
+      { 0, 0, 1920, 1080 }, { 0, 0, 1000, 562 },
+      1920 * 1080 * 3 / 2, 1920 * 1080 * 3 / 2 + 1000 * 562 * 4 },
+    { "yuy2 video", &yuy2, HWC_BLENDING_NONE,
+      { 0, 0, 640, 480 }, { 0, 0, 1000, 750 },
+      640 * 480 * 2, 1000 * 750 * 2 + 1000 * 750 * 4 },
+    { "unknown format", &unknown, HWC_BLENDING_NONE,
+      { 0, 0, 100, 100 }, { 0, 0, 100, 100 },
+      40000, 40000 + 40000 },
+    { "no buffer", 0, HWC_BLENDING_NONE,
+      { 0, 0, 100, 100 }, { 0, 0, 100, 100 },
+      40000, 40000 + 40000 },
+    { "no crop", &rgba, HWC_BLENDING_NONE,
+      { 0, 0, 0, 0 }, { 0, 0, 100, 100 },
+      40000, 40000 + 40000 },
+    { "cropped at an offset", &rgba, HWC_BLENDING_NONE,
+      { 300, 200, 400, 300 }, { 500, 500, 600, 600 },
+      40000, 40000 + 40000 },
+    { "empty frame", &rgba, HWC_BLENDING_PREMULT,
+      { 0, 0, 100, 100 }, { 100, 100, 100, 200 },
+      0, 0 },
+};
+
+static hwc_display_contents_1_t* alloc_list(int numLayers)
+{
+    size_t size = sizeof(hwc_display_contents_1_t) +
+                  (numLayers + 1) * sizeof(hwc_layer_1_t);
+    return (hwc_display_contents_1_t*)calloc(1, size);
+}
+
+static void set_target(hwc_display_contents_1_t *list, int n)
+{
+    hwc_layer_1_t& target = list->hwLayers[n];
+    hwc_rect_t display = { 0, 0, DISPLAY_SIZE, DISPLAY_SIZE };
+
+    target.compositionType = HWC_FRAMEBUFFER_TARGET;
+    target.displayFrame = display;
+    list->numHwLayers = n + 1;
+}
+
+static void set_case(hwc_layer_1_t& layer, const bandwidth_case& t)
+{
+    memset(&layer, 0, sizeof(layer));
+    layer.handle = (buffer_handle_t)t.handle;
+    layer.blending = t.blending;
+    layer.planeAlpha = 0xff;
+    layer.sourceCrop = t.crop;
+    layer.displayFrame = t.frame;
+}
+
+static void test_table()
+{
+    const int count = sizeof(cases) / sizeof(cases[0]);
+
+    // each layer alone
+    for (int c = 0; c < count; c++) {
+        const bandwidth_case& t = cases[c];
+        hwc_display_contents_1_t *list = alloc_list(1);
+        IntelLayerGeometry geometry;
+        IntelBandwidthModel bandwidth;
+
+        set_case(list->hwLayers[0], t);
+        set_target(list, 1);
+        geometry.update(list, 1);
+        bandwidth.update(list, 1, geometry);
+
+        if (bandwidth.getPlaneBytes(0) != t.planeBytes ||
+            bandwidth.getGlesBytes(0) != t.glesBytes) {
+            fprintf(stderr, "%s: plane %llu gles %llu, expected %llu %llu\n",
+                    t.name, (unsigned long long)bandwidth.getPlaneBytes(0),
+                    (unsigned long long)bandwidth.getGlesBytes(0),
+                    (unsigned long long)t.planeBytes,
+                    (unsigned long long)t.glesBytes);
+            failures++;
+        }
+        CHECK(bandwidth.isVisible(0) == (t.planeBytes != 0));
+        CHECK(bandwidth.getScanoutBytes() == FB_BYTES);
+
+        // composing it adds the scanout, a plane doesn't
+        if (t.planeBytes) {
+            CHECK(bandwidth.getFrameBytes(0) == t.glesBytes + FB_BYTES);
+            CHECK(bandwidth.getFrameBytes(1) == t.planeBytes);
+        } else {
+            CHECK(bandwidth.getFrameBytes(0) == 0);
+            CHECK(bandwidth.getFrameBytes(1) == 0);
+        }
+
+        free(list);
+    }
+
+    // all of them in one list, totals are the sums
+    hwc_display_contents_1_t *list = alloc_list(count);
+    IntelLayerGeometry geometry;
+    IntelBandwidthModel bandwidth;
+    uint64_t gles = 0, planes = 0, mixed = 0;
+
+    for (int c = 0; c < count; c++) {
+        set_case(list->hwLayers[c], cases[c]);
+        // translucent, so that none hides another
+        list->hwLayers[c].planeAlpha = 0x80;
+        gles += cases[c].glesBytes;
+        planes += cases[c].planeBytes;
+        mixed += c % 2 ? cases[c].planeBytes : cases[c].glesBytes;
+    }
+    set_target(list, count);
+    geometry.update(list, count);
+    bandwidth.update(list, count, geometry);
+
+    uint64_t all = IntelLayerGeometry::bit(count) - 1;
+    uint64_t odd = all & 0xaaaaaaaaaaaaaaaaULL;
+    CHECK(bandwidth.getFrameBytes(0) == gles + FB_BYTES);
+    CHECK(bandwidth.getFrameBytes(all) == planes);
+    CHECK(bandwidth.getFrameBytes(odd) == mixed + FB_BYTES);
+
+    free(list);
+}
+
+static void test_hidden()
+{
+    hwc_display_contents_1_t *list = alloc_list(2);
+    IntelLayerGeometry geometry;
+    IntelBandwidthModel bandwidth;
+
+    // wallpaper under a full screen opaque app costs nothing
+    set_case(list->hwLayers[0], cases[0]);
+    set_case(list->hwLayers[1], cases[0]);
+    hwc_rect_t display = { 0, 0, DISPLAY_SIZE, DISPLAY_SIZE };
+    list->hwLayers[1].sourceCrop = display;
+    list->hwLayers[1].displayFrame = display;
+    set_target(list, 2);
+    geometry.update(list, 2);
+    bandwidth.update(list, 2, geometry);
+
+    CHECK(!bandwidth.isVisible(0));
+    CHECK(bandwidth.getPlaneBytes(0) == 0);
+    CHECK(bandwidth.getGlesBytes(0) == 0);
+    CHECK(bandwidth.getFrameBytes(0) == FB_BYTES * 2 + FB_BYTES);
+    CHECK(bandwidth.getFrameBytes(2) == FB_BYTES);
+    CHECK(bandwidth.getFrameBytes(1) == bandwidth.getFrameBytes(0));
+
+    free(list);
+}
+
+static void test_invalid()
+{
+    hwc_display_contents_1_t *list = alloc_list(IntelLayerGeometry::MAX_LAYERS + 1);
+    IntelLayerGeometry geometry;
+    IntelBandwidthModel bandwidth;
+
+    // without a framebuffer target nothing is scanned out
+    set_case(list->hwLayers[0], cases[0]);
+    list->numHwLayers = 1;
+    geometry.update(list, 1);
+    bandwidth.update(list, 1, geometry);
+    CHECK(bandwidth.isValid());
+    CHECK(bandwidth.getScanoutBytes() == 0);
+    CHECK(bandwidth.getFrameBytes(0) == cases[0].glesBytes);
+
+    // more layers than a mask holds
+    for (int i = 0; i <= IntelLayerGeometry::MAX_LAYERS; i++)
+        set_case(list->hwLayers[i], cases[0]);
+    set_target(list, IntelLayerGeometry::MAX_LAYERS + 1);
+    geometry.update(list, IntelLayerGeometry::MAX_LAYERS + 1);
+    bandwidth.update(list, IntelLayerGeometry::MAX_LAYERS + 1, geometry);
+    CHECK(!bandwidth.isValid());
+    CHECK(!bandwidth.isVisible(0));
+    CHECK(bandwidth.getFrameBytes(0) == 0);
+
+    bandwidth.update(0, 1, geometry);
+    CHECK(!bandwidth.isValid());
+
+    free(list);
+}
+
+int main()
+{
+    test_table();
+    test_hidden();
+    test_invalid();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("bandwidth_model_test: all checks passed\n");
+    return 0;
+}
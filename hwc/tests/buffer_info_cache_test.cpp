@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host test for IntelBufferInfoCache against a counting
+ * IntelFormatTraits::get(). A buffer seen again is answered from the
+ * cache without a lookup, while a buffer without a stamp, a new buffer
+ * or one evicted by another stamp in its slot is looked up again.
+ *
+ * With -b it also replays recorded layer lists frame by frame, once
+ * looking every layer up as updateLayerInfo() did before the cache and
+ * once through the cache, and reports format lookups and cost per
+ * frame of each.
+ *
+ * usage: buffer_info_cache_test [-b]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <hardware/gralloc.h>
+#include <utils/Timers.h>
+
+#include <IntelBufferInfoCache.h>
+
+#define BENCH_ROUNDS    100
+
+static int failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+/* stands in for IntelFormatTraits.cpp, counting the lookups */
+static int formatLookups;
+
+static const IntelFormatTraits sTraits[] = {
+    { HAL_PIXEL_FORMAT_INTEL_HWC_NV12_VED, IntelFormatTraits::FORMAT_YUV,
+      8, 2, IntelFormatTraits::FORMAT_OVERLAY, 64 },
+    { HAL_PIXEL_FORMAT_INTEL_HWC_NV12, IntelFormatTraits::FORMAT_YUV,
+      8, 2, IntelFormatTraits::FORMAT_OVERLAY, 64 },
+    { HAL_PIXEL_FORMAT_YV12, IntelFormatTraits::FORMAT_YUV,
+      8, 3, IntelFormatTraits::FORMAT_OVERLAY, 64 },
+    { HAL_PIXEL_FORMAT_RGBA_8888, IntelFormatTraits::FORMAT_RGB,
+      32, 1, IntelFormatTraits::FORMAT_SPRITE, 64 },
+    { HAL_PIXEL_FORMAT_RGBX_8888, IntelFormatTraits::FORMAT_RGB,
+      32, 1, IntelFormatTraits::FORMAT_SPRITE, 64 },
+    { HAL_PIXEL_FORMAT_BGRA_8888, IntelFormatTraits::FORMAT_RGB,
+      32, 1, IntelFormatTraits::FORMAT_SPRITE, 64 },
+    { HAL_PIXEL_FORMAT_RGB_565, IntelFormatTraits::FORMAT_RGB,
+      16, 1, IntelFormatTraits::FORMAT_SPRITE, 64 },
+};
+
+const IntelFormatTraits* IntelFormatTraits::get(int format)
+{
+    formatLookups++;
+    for (size_t i = 0; i < sizeof(sTraits) / sizeof(sTraits[0]); i++) {
+        if (sTraits[i].format == format)
+            return &sTraits[i];
+    }
+    return 0;
+}
+
+static IMG_native_handle_t buffer(unsigned long long stamp, int format,
+                                  int usage)
+{
+    IMG_native_handle_t handle;
+
+    memset(&handle, 0, sizeof(handle));
+    handle.ui64Stamp = stamp;
+    handle.iFormat = format;
+    handle.usage = usage;
+    return handle;
+}
+
+static void test_hit()
+{
+    IntelBufferInfoCache cache;
+    IMG_native_handle_t video =
+        buffer(5, HAL_PIXEL_FORMAT_INTEL_HWC_NV12_VED,
+               GRALLOC_USAGE_PROTECTED);
+    IMG_native_handle_t ui = buffer(6, HAL_PIXEL_FORMAT_RGBA_8888, 0);
+
+    formatLookups = 0;
+    for (int i = 0; i < 10; i++) {
+        const IntelBufferInfoCache::Info& v = cache.lookup(&video);
+        CHECK(v.format == HAL_PIXEL_FORMAT_INTEL_HWC_NV12_VED);
+        CHECK(v.traits && v.traits->isYUV());
+        CHECK(v.isProtected);
+
+        const IntelBufferInfoCache::Info& u = cache.lookup(&ui);
+        CHECK(u.format == HAL_PIXEL_FORMAT_RGBA_8888);
+        CHECK(u.traits && u.traits->isRGB());
+        CHECK(!u.isProtected);
+    }
+    CHECK(formatLookups == 2);
+    CHECK(cache.getMisses() == 2);
+    CHECK(cache.getHits() == 18);
+}
+
+static void test_miss()
+{
+    IntelBufferInfoCache cache;
+    IMG_native_handle_t unstamped = buffer(0, HAL_PIXEL_FORMAT_RGB_565, 0);
+    IMG_native_handle_t unknown = buffer(7, HAL_PIXEL_FORMAT_RGB_888, 0);
+    IMG_native_handle_t a = buffer(3, HAL_PIXEL_FORMAT_RGBA_8888, 0);
+    IMG_native_handle_t b =
+        buffer(3 + IntelBufferInfoCache::CACHE_SIZE,
+               HAL_PIXEL_FORMAT_YV12, 0);
+
+    // no stamp, no caching
+    formatLookups = 0;
+    CHECK(cache.lookup(&unstamped).traits != 0);
+    CHECK(cache.lookup(&unstamped).traits != 0);
+    CHECK(formatLookups == 2);
+
+    // an unknown format is remembered as such
+    formatLookups = 0;
+    CHECK(cache.lookup(&unknown).traits == 0);
+    CHECK(cache.lookup(&unknown).traits == 0);
+    CHECK(cache.lookup(&unknown).format == HAL_PIXEL_FORMAT_RGB_888);
+    CHECK(formatLookups == 1);
+
+    // two stamps sharing a slot evict each other
+    formatLookups = 0;
+    CHECK(cache.lookup(&a).format == HAL_PIXEL_FORMAT_RGBA_8888);
+    CHECK(cache.lookup(&b).format == HAL_PIXEL_FORMAT_YV12);
+    CHECK(cache.lookup(&a).format == HAL_PIXEL_FORMAT_RGBA_8888);
+    CHECK(formatLookups == 3);
+
+    // clear() forgets everything
+    cache.clear();
+    formatLookups = 0;
+    cache.lookup(&a);
+    CHECK(formatLookups == 1);
+}
+
+/*
+ * A recorded scene: each layer cycles through its own buffer queue,
+ * moving to the next buffer every `period` frames (0 for a static
+ * layer). Stamps are handed out in allocation order as gralloc does.
+ */
+struct SceneLayer {
+    int format;
+    int buffers;
+    int period;
+};
+
+struct Scene {
+    const char *name;
+    int frames;
+    int numLayers;
+    SceneLayer layers[6];
+};
+
+static const Scene sScenes[] = {
+    // 24fps video on the overlay under the status and navigation bars
+    { "video_playback", 3600, 4, {
+        { HAL_PIXEL_FORMAT_RGBX_8888, 1, 0 },
+        { HAL_PIXEL_FORMAT_INTEL_HWC_NV12_VED, 8, 2 },
+        { HAL_PIXEL_FORMAT_RGBA_8888, 2, 60 },
+        { HAL_PIXEL_FORMAT_RGBA_8888, 1, 0 },
+    } },
+    // launcher scrolling over the wallpaper at 60fps
+    { "home_scroll", 600, 4, {
+        { HAL_PIXEL_FORMAT_RGBX_8888, 1, 0 },
+        { HAL_PIXEL_FORMAT_RGBA_8888, 3, 1 },
+        { HAL_PIXEL_FORMAT_RGBA_8888, 2, 60 },
+        { HAL_PIXEL_FORMAT_RGBA_8888, 1, 0 },
+    } },
+    // camera preview with its controls on top
+    { "camera_preview", 1800, 5, {
+        { HAL_PIXEL_FORMAT_INTEL_HWC_NV12, 6, 2 },
+        { HAL_PIXEL_FORMAT_RGBA_8888, 2, 30 },
+        { HAL_PIXEL_FORMAT_RGB_565, 1, 0 },
+        { HAL_PIXEL_FORMAT_RGBA_8888, 2, 60 },
+        { HAL_PIXEL_FORMAT_RGBA_8888, 1, 0 },
+    } },
+};
+
+struct ReplayResult {
+    int lookups;
+    int layers;
+    nsecs_t time;
+};
+
+static void replay(const Scene& scene, bool cached, ReplayResult& result)
+{
+    IMG_native_handle_t handles[6][8];
+    unsigned long long stamp = 1;
+    IntelBufferInfoCache cache;
+    volatile int yuv = 0;
+
+    for (int l = 0; l < scene.numLayers; l++)
+        for (int b = 0; b < scene.layers[l].buffers; b++)
+            handles[l][b] = buffer(stamp++, scene.layers[l].format, 0);
+
+    formatLookups = 0;
+    result.layers = 0;
+    nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (int f = 0; f < scene.frames; f++) {
+            for (int l = 0; l < scene.numLayers; l++) {
+                const SceneLayer& layer = scene.layers[l];
+                int b = layer.period ?
+                    (f / layer.period) % layer.buffers : 0;
+                const IntelFormatTraits *traits;
+
+                if (cached)
+                    traits = cache.lookup(&handles[l][b]).traits;
+                else
+                    traits = IntelFormatTraits::get(handles[l][b].iFormat);
+                if (traits && traits->isYUV())
+                    yuv++;
+                result.layers++;
+            }
+        }
+    }
+    result.time = systemTime(SYSTEM_TIME_MONOTONIC) - start;
+    result.lookups = formatLookups;
+}
+
+static void bench()
+{
+    for (size_t i = 0; i < sizeof(sScenes) / sizeof(sScenes[0]); i++) {
+        const Scene& scene = sScenes[i];
+        int frames = scene.frames * BENCH_ROUNDS;
+        ReplayResult before, after;
+
+        replay(scene, false, before);
+        replay(scene, true, after);
+
+        printf("%s: %d frames of %d layers\n",
+               scene.name, frames, scene.numLayers);
+        printf("  per layer:   %d lookups, %.4f/frame, %.1f ns/frame\n",
+               before.lookups, (double)before.lookups / frames,
+               (double)before.time / frames);
+        printf("  stamp cache: %d lookups, %.4f/frame, %.1f ns/frame\n",
+               after.lookups, (double)after.lookups / frames,
+               (double)after.time / frames);
+
+        CHECK(before.lookups == before.layers);
+        CHECK(after.layers == before.layers);
+        // only the first sight of each buffer is looked up
+        int buffers = 0;
+        for (int l = 0; l < scene.numLayers; l++)
+            buffers += scene.layers[l].buffers;
+        CHECK(after.lookups == buffers);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bool benchmark = argc > 1 && !strcmp(argv[1], "-b");
+
+    test_hit();
+    test_miss();
+    if (benchmark)
+        bench();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("buffer_info_cache_test: all checks passed\n");
+    return 0;
+}
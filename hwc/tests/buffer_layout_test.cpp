@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host test for IntelBufferLayout against the per-frame computations it
+ * replaced: the overlay strides and stride limits of setDataBuffer(),
+ * the plane offsets of bufferOffsetSetup() and the sprite stride of
+ * MedfieldSpritePlane, for every supported format over a range of
+ * buffer sizes.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IntelFormatTraits.h>
+#include <IntelOverlayUtil.h>
+
+static int failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+static const int sYUVFormats[] = {
+    HAL_PIXEL_FORMAT_YV12,
+    HAL_PIXEL_FORMAT_INTEL_HWC_I420,
+    HAL_PIXEL_FORMAT_INTEL_HWC_NV12,
+    HAL_PIXEL_FORMAT_INTEL_HWC_NV12_VED,
+    HAL_PIXEL_FORMAT_INTEL_HWC_NV12_TILE,
+    HAL_PIXEL_FORMAT_INTEL_HWC_YUY2,
+    HAL_PIXEL_FORMAT_INTEL_HWC_UYVY,
+};
+
+static const int sRGBFormats[] = {
+    HAL_PIXEL_FORMAT_RGBA_8888,
+    HAL_PIXEL_FORMAT_RGBX_8888,
+    HAL_PIXEL_FORMAT_BGRA_8888,
+    HAL_PIXEL_FORMAT_BGRX_8888,
+    HAL_PIXEL_FORMAT_RGB_565,
+};
+
+struct Overlay {
+    bool supported;
+    uint32_t yStride;
+    uint32_t uvStride;
+    uint32_t bufU;
+    uint32_t bufV;
+    bool tiled;
+};
+
+// IntelOverlayPlane::setDataBuffer() and bufferOffsetSetup() as they
+// were before the layout was kept with the mapping
+static Overlay overlay(int format, uint32_t grallocStride, uint32_t h)
+{
+    Overlay o = Overlay();
+    bool isYUVPacked = false;
+
+    switch (format) {
+    case HAL_PIXEL_FORMAT_YV12:
+    case HAL_PIXEL_FORMAT_INTEL_HWC_I420:
+        o.yStride = align_to(grallocStride, 64);
+        o.uvStride = align_to(o.yStride >> 1, 64);
+        break;
+    case HAL_PIXEL_FORMAT_INTEL_HWC_NV12:
+    case HAL_PIXEL_FORMAT_INTEL_HWC_NV12_VED:
+    case HAL_PIXEL_FORMAT_INTEL_HWC_NV12_TILE:
+        o.yStride = align_to(grallocStride, 64);
+        o.uvStride = o.yStride;
+        break;
+    case HAL_PIXEL_FORMAT_INTEL_HWC_YUY2:
+    case HAL_PIXEL_FORMAT_INTEL_HWC_UYVY:
+        o.yStride = align_to(grallocStride << 1, 64);
+        o.uvStride = 0;
+        isYUVPacked = true;
+        break;
+    default:
+        return o;
+    }
+
+    o.supported = o.yStride >= INTEL_OVERLAY_MIN_STRIDE &&
+                  o.yStride <= (uint32_t)(isYUVPacked ?
+                                          INTEL_OVERLAY_MAX_STRIDE_PACKED :
+                                          INTEL_OVERLAY_MAX_STRIDE_LINEAR);
+
+    switch (format) {
+    case HAL_PIXEL_FORMAT_YV12:
+        o.bufV = o.yStride * h;
+        o.bufU = o.bufV + o.uvStride * (h / 2);
+        break;
+    case HAL_PIXEL_FORMAT_INTEL_HWC_I420:
+        o.bufU = o.yStride * h;
+        o.bufV = o.bufU + o.uvStride * (h / 2);
+        break;
+    case HAL_PIXEL_FORMAT_INTEL_HWC_NV12:
+        o.bufU = o.yStride * h;
+        break;
+    case HAL_PIXEL_FORMAT_INTEL_HWC_NV12_VED:
+        o.bufU = o.yStride * align_to(h, 32);
+        break;
+    case HAL_PIXEL_FORMAT_INTEL_HWC_NV12_TILE:
+        o.bufU = o.yStride * align_to(h, 32);
+        o.tiled = true;
+        break;
+    default:
+        break;
+    }
+
+    return o;
+}
+
+// MedfieldSpritePlane::setDataBuffer() before the layout, 0 if the
+// format can't go to a sprite
+static uint32_t spriteStride(int format, uint32_t width)
+{
+    int bpp;
+
+    switch (format) {
+    case HAL_PIXEL_FORMAT_RGBA_8888:
+    case HAL_PIXEL_FORMAT_RGBX_8888:
+    case HAL_PIXEL_FORMAT_BGRX_8888:
+    case HAL_PIXEL_FORMAT_BGRA_8888:
+        bpp = 4;
+        break;
+    case HAL_PIXEL_FORMAT_RGB_565:
+        bpp = 2;
+        break;
+    default:
+        return 0;
+    }
+
+    // IMG alloc buffer has 32 pixel alignment on Width
+    int bufferStride = bpp * align_to(width, 32);
+    return align_to(bufferStride, 64);
+}
+
+static void test_overlay()
+{
+    int mismatches = 0;
+
+    for (size_t f = 0; f < sizeof(sYUVFormats) / sizeof(sYUVFormats[0]); f++) {
+        int format = sYUVFormats[f];
+        for (uint32_t w = 16; w <= 4608; w += 24) {
+            for (uint32_t h = 16; h <= 2048; h += 76) {
+                // gralloc pads the stride to 32 pixels, the decoder to 64
+                uint32_t stride = align_to(w, (w / 24) % 2 ? 32 : 64);
+                IntelBufferLayout layout;
+                Overlay o = overlay(format, stride, h);
+
+                CHECK(layout.setup(format, stride, w, h));
+                if (layout.has(IntelBufferLayout::LAYOUT_OVERLAY) != o.supported ||
+                    layout.yStride != o.yStride ||
+                    layout.uvStride != o.uvStride ||
+                    (o.supported && (layout.uOffset != o.bufU ||
+                                     layout.vOffset != o.bufV)) ||
+                    layout.has(IntelBufferLayout::LAYOUT_TILED) != o.tiled) {
+                    if (mismatches++ < 10)
+                        fprintf(stderr, "format 0x%x %ux%u stride %u: layout "
+                                "%u/%u %u/%u overlay %d, expected %u/%u "
+                                "%u/%u overlay %d\n", format, w, h, stride,
+                                layout.yStride, layout.uvStride,
+                                layout.uOffset, layout.vOffset,
+                                layout.has(IntelBufferLayout::LAYOUT_OVERLAY),
+                                o.yStride, o.uvStride, o.bufU, o.bufV,
+                                o.supported);
+                }
+                // YUV never goes to a sprite
+                CHECK(!layout.has(IntelBufferLayout::LAYOUT_SPRITE));
+            }
+        }
+    }
+
+    CHECK(mismatches == 0);
+}
+
+static void test_sprite()
+{
+    int mismatches = 0;
+
+    for (size_t f = 0; f < sizeof(sRGBFormats) / sizeof(sRGBFormats[0]); f++) {
+        int format = sRGBFormats[f];
+        for (uint32_t w = 1; w <= 2560; w += 7) {
+            IntelBufferLayout layout;
+
+            // as MedfieldSpritePlane sets it up
+            CHECK(layout.setup(format, align_to(w, 32), w, 600));
+            if (!layout.has(IntelBufferLayout::LAYOUT_SPRITE) ||
+                layout.has(IntelBufferLayout::LAYOUT_OVERLAY) ||
+                layout.yStride != spriteStride(format, w) ||
+                layout.uvStride != 0) {
+                if (mismatches++ < 10)
+                    fprintf(stderr, "format 0x%x width %u: stride %u, "
+                            "expected %u\n", format, w, layout.yStride,
+                            spriteStride(format, w));
+            }
+        }
+    }
+
+    CHECK(mismatches == 0);
+}
+
+int main()
+{
+    test_overlay();
+    test_sprite();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("buffer_layout_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Tests for IntelConfigSnapshot against a counting property_get. The
+ * frame path must not read a single property, a changed property must
+ * show up at the next frame after a reload, and a replaced snapshot
+ * must outlive the frame that took it. The stress part runs a frame
+ * thread against a reloading thread, run it under ASan to catch a
+ * snapshot freed too early.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <cutils/properties.h>
+
+#include <IntelConfigSnapshot.h>
+
+#define FRAMES          10000
+#define STRESS_FRAMES   2000
+
+static int failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __FILE__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+/* every property reads as the same number, so a snapshot is
+ * consistent if all its fields are equal */
+static volatile int propValue;
+static volatile int propReads;
+
+extern "C" int property_get(const char *key, char *value,
+                            const char *default_value)
+{
+    __atomic_add_fetch(&propReads, 1, __ATOMIC_RELAXED);
+    return snprintf(value, PROPERTY_VALUE_MAX, "%d",
+                    __atomic_load_n(&propValue, __ATOMIC_RELAXED));
+}
+
+static int reads()
+{
+    return __atomic_load_n(&propReads, __ATOMIC_RELAXED);
+}
+
+static void setValue(int value)
+{
+    __atomic_store_n(&propValue, value, __ATOMIC_RELAXED);
+}
+
+static bool consistent(const hwc_prop_cfg *c, unsigned int value)
+{
+    return c->dump_post2 == value && c->dump_layers == value &&
+           c->panel_width_mm == value && c->panel_height_mm == value;
+}
+
+static void test_frames_read_no_property()
+{
+    IntelConfigSnapshot snapshot(hwc_load_prop_cfg);
+
+    setValue(1);
+    snapshot.init();
+    CHECK(reads() > 0);
+    CHECK(consistent(snapshot.get(), 1));
+
+    int before = reads();
+    for (int i = 0; i < FRAMES; i++) {
+        const hwc_prop_cfg *c = snapshot.beginFrame();
+        CHECK(c == snapshot.get());
+        CHECK(c->dump_post2 == 1);
+    }
+    printf("property reads per frame: %.3f\n",
+           (double)(reads() - before) / FRAMES);
+    CHECK(reads() == before);
+}
+
+static void test_reload_applies_at_next_frame()
+{
+    IntelConfigSnapshot snapshot(hwc_load_prop_cfg);
+
+    setValue(1);
+    snapshot.init();
+    snapshot.beginFrame();
+
+    // unchanged properties publish nothing
+    CHECK(!snapshot.reload());
+    CHECK(snapshot.getPublishCount() == 0);
+
+    setValue(2);
+    CHECK(snapshot.reload());
+    CHECK(snapshot.getPublishCount() == 1);
+    // the frame in progress keeps its snapshot
+    CHECK(consistent(snapshot.get(), 1));
+    CHECK(consistent(snapshot.beginFrame(), 2));
+    CHECK(consistent(snapshot.get(), 2));
+}
+
+static void test_retire_waits_for_frame()
+{
+    IntelConfigSnapshot snapshot(hwc_load_prop_cfg);
+
+    setValue(1);
+    snapshot.init();
+    const hwc_prop_cfg *first = snapshot.beginFrame();
+
+    setValue(2);
+    CHECK(snapshot.reload());
+
+    // the frame thread has not moved on, the first snapshot must stay
+    setValue(3);
+    CHECK(!snapshot.reload());
+    CHECK(!snapshot.reload());
+    CHECK(snapshot.getDeferCount() == 2);
+    CHECK(consistent(first, 1));
+
+    // a frame on the second snapshot frees the first and lets the
+    // third one through
+    CHECK(consistent(snapshot.beginFrame(), 2));
+    CHECK(snapshot.reload());
+    CHECK(consistent(snapshot.get(), 2));
+    CHECK(consistent(snapshot.beginFrame(), 3));
+}
+
+struct stress_t {
+    IntelConfigSnapshot *snapshot;
+    volatile bool done;
+    int torn;
+    int frames;
+};
+
+static void *frame_thread(void *arg)
+{
+    stress_t *s = (stress_t *)arg;
+
+    for (int i = 0; i < STRESS_FRAMES; i++) {
+        const hwc_prop_cfg *c = s->snapshot->beginFrame();
+        // the rest of the frame, the reloading thread runs in between
+        unsigned int value = c->dump_post2;
+        sched_yield();
+        if (c->dump_layers != value)
+            s->torn++;
+        sched_yield();
+        if (c->panel_width_mm != value || c->panel_height_mm != value)
+            s->torn++;
+        if (!consistent(s->snapshot->get(), value))
+            s->torn++;
+        s->frames++;
+    }
+    __atomic_store_n(&s->done, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void test_stress()
+{
+    IntelConfigSnapshot snapshot(hwc_load_prop_cfg);
+    stress_t s;
+    pthread_t thread;
+    int value = 1;
+
+    setValue(value);
+    snapshot.init();
+    memset(&s, 0, sizeof(s));
+    s.snapshot = &snapshot;
+
+    pthread_create(&thread, NULL, frame_thread, &s);
+    while (!__atomic_load_n(&s.done, __ATOMIC_ACQUIRE)) {
+        setValue(++value);
+        snapshot.reload();
+        sched_yield();
+    }
+    pthread_join(thread, NULL);
+
+    printf("stress: %d frames, %u published, %u deferred\n",
+           s.frames, snapshot.getPublishCount(), snapshot.getDeferCount());
+    CHECK(s.torn == 0);
+    CHECK(snapshot.getPublishCount() > 0);
+}
+
+static void test_reloader()
+{
+    IntelConfigSnapshot snapshot(hwc_load_prop_cfg);
+
+    setValue(1);
+    snapshot.init();
+    android::sp<IntelConfigReloader> reloader =
+        new IntelConfigReloader(&snapshot, ms2ns(1));
+
+    // no dump, the reloader alone brings the change in
+    setValue(7);
+    int frames;
+    for (frames = 0; frames < 1000; frames++) {
+        if (snapshot.beginFrame()->dump_post2 == 7)
+            break;
+        usleep(1000);
+    }
+    CHECK(consistent(snapshot.get(), 7));
+
+    reloader->requestExit();
+    reloader->join();
+}
+
+int main()
+{
+    test_frames_read_no_property();
+    test_reload_applies_at_next_frame();
+    test_retire_waits_for_frame();
+    test_stress();
+    test_reloader();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("config_snapshot_test: all checks passed\n");
+    return 0;
+}
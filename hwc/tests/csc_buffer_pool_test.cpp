@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host test for IntelCscBufferPool: pools never hold more than their
+ * capacity, buffers returned to a pool that was trimmed or re-created
+ * meanwhile are freed, and only idle pools of other sizes are trimmed.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IntelCscBufferPool.h>
+#include <IntelHWComposerCfg.h>
+
+/* defined by IntelHWComposerModule.cpp in the HAL */
+hwc_cfg cfg;
+
+static int failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+// stands in for GraphicBuffer, counts the buffers alive
+class FakeBuffer : public android::RefBase {
+public:
+    static int live;
+    uint32_t width;
+    uint32_t height;
+    FakeBuffer(uint32_t w, uint32_t h) : width(w), height(h) { live++; }
+    virtual ~FakeBuffer() { live--; }
+};
+
+int FakeBuffer::live;
+
+typedef IntelCscBufferPool<FakeBuffer> Pool;
+
+struct Held {
+    android::sp<FakeBuffer> buffer;
+    uint32_t generation;
+};
+
+static nsecs_t ms(int64_t t)
+{
+    return ms2ns(t);
+}
+
+static void fill(Pool& pool, uint32_t w, uint32_t h, nsecs_t now)
+{
+    uint32_t generation;
+    int count = pool.reserve(w, h, now, &generation);
+
+    for (int i = 0; i < count; i++)
+        pool.put(Pool::key(w, h), generation, new FakeBuffer(w, h));
+}
+
+static void put(Pool& pool, Held& held)
+{
+    pool.put(Pool::key(held.buffer->width, held.buffer->height),
+             held.generation, held.buffer);
+    held.buffer.clear();
+}
+
+static void test_capacity()
+{
+    Pool pool;
+    Held held[Pool::CAPACITY + 1];
+    uint32_t generation;
+    bool allocate;
+
+    fill(pool, 1280, 720, ms(0));
+    CHECK(pool.available(1280, 720) == Pool::CAPACITY);
+    CHECK(FakeBuffer::live == Pool::CAPACITY);
+
+    // a second fill has nothing left to allocate
+    CHECK(pool.reserve(1280, 720, ms(0), &generation) == 0);
+
+    for (int i = 0; i < Pool::CAPACITY; i++) {
+        held[i].buffer = pool.get(1280, 720, ms(16), &held[i].generation, &allocate);
+        CHECK(held[i].buffer != NULL && !allocate);
+    }
+    // all handed out, the frame is dropped rather than allocating more
+    held[Pool::CAPACITY].buffer =
+        pool.get(1280, 720, ms(16), &held[Pool::CAPACITY].generation, &allocate);
+    CHECK(held[Pool::CAPACITY].buffer == NULL && !allocate);
+
+    for (int i = 0; i < Pool::CAPACITY; i++)
+        put(pool, held[i]);
+    CHECK(pool.available(1280, 720) == Pool::CAPACITY);
+    CHECK(FakeBuffer::live == Pool::CAPACITY);
+}
+
+static void test_fallback_allocation()
+{
+    Pool pool;
+    Held held[Pool::CAPACITY];
+    uint32_t generation;
+    bool allocate;
+
+    // a failed allocation gives its slot back
+    CHECK(pool.get(640, 480, ms(0), &generation, &allocate) == NULL);
+    CHECK(allocate);
+    pool.put(Pool::key(640, 480), generation, NULL);
+
+    // not filled, the frame path allocates up to the capacity
+    for (int i = 0; i < Pool::CAPACITY; i++) {
+        CHECK(pool.get(640, 480, ms(0), &held[i].generation, &allocate) == NULL);
+        CHECK(allocate);
+        held[i].buffer = new FakeBuffer(640, 480);
+    }
+    CHECK(pool.get(640, 480, ms(0), &generation, &allocate) == NULL);
+    CHECK(!allocate);
+
+    for (int i = 0; i < Pool::CAPACITY; i++)
+        put(pool, held[i]);
+    CHECK(pool.available(640, 480) == Pool::CAPACITY);
+    CHECK(FakeBuffer::live == Pool::CAPACITY);
+}
+
+static void test_stale_return()
+{
+    Pool pool;
+    Held held;
+    bool allocate;
+    Pool::BufferList freed;
+
+    fill(pool, 1280, 720, ms(0));
+    held.buffer = pool.get(1280, 720, ms(0), &held.generation, &allocate);
+    CHECK(held.buffer != NULL);
+
+    // switch to another size and let the first pool go idle
+    fill(pool, 1920, 1080, ms(100));
+    pool.trim(ms(100 + Pool::IDLE_MS + 1), &freed);
+    CHECK(pool.poolCount() == 1);
+    CHECK(freed.size() == Pool::CAPACITY - 1);
+    freed.clear();
+
+    // back to the first size, its pool is created again
+    fill(pool, 1280, 720, ms(3000));
+    CHECK(pool.available(1280, 720) == Pool::CAPACITY);
+
+    // the buffer still held from the old pool is freed, not added
+    CHECK(!pool.put(Pool::key(1280, 720), held.generation, held.buffer));
+    held.buffer.clear();
+    CHECK(pool.available(1280, 720) == Pool::CAPACITY);
+    CHECK(FakeBuffer::live == 2 * Pool::CAPACITY);
+}
+
+static void test_trim()
+{
+    Pool pool;
+    Pool::BufferList freed;
+
+    fill(pool, 1280, 720, ms(0));
+    fill(pool, 1920, 1080, ms(1000));
+
+    // not idle long enough
+    pool.trim(ms(Pool::IDLE_MS), &freed);
+    CHECK(pool.poolCount() == 2);
+    CHECK(freed.isEmpty());
+
+    pool.trim(ms(Pool::IDLE_MS + 1), &freed);
+    CHECK(pool.poolCount() == 1);
+    CHECK(pool.available(1920, 1080) == Pool::CAPACITY);
+    CHECK(freed.size() == Pool::CAPACITY);
+
+    // the size in use is kept however long it is idle
+    pool.trim(ms(60000), &freed);
+    CHECK(pool.poolCount() == 1);
+
+    freed.clear();
+    CHECK(FakeBuffer::live == Pool::CAPACITY);
+}
+
+int main()
+{
+    test_capacity();
+    test_fallback_allocation();
+    test_stale_return();
+    test_trim();
+    CHECK(FakeBuffer::live == 0);
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("csc_buffer_pool_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Replay test for the hardware cursor. Pointer sessions are replayed
+ * through IntelCursorTracker, which must never let a frame skip GLES
+ * composition when anything but the cursor changed. The cursor register
+ * writes of the same kind of session are replayed against a fake
+ * register file through IntelCursorRegState, with DPMS cycles that
+ * clear the registers, and after every flip the registers must show
+ * the cursor wanted, written only when something changed.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <IntelCursorTracker.h>
+#include <IntelCursorRegState.h>
+
+#define FRAMES          20000
+#define SLOT_SIZE       (128 * 128 * 4)
+#define SLOT_COUNT      2
+#define SLOT_BASE       0x100000
+
+static int failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+static int buffers[64];
+
+static void set_rect(hwc_rect_t& r, int left, int top, int right, int bottom)
+{
+    r.left = left;
+    r.top = top;
+    r.right = right;
+    r.bottom = bottom;
+}
+
+// wallpaper, app, status bar and the cursor on top
+static void test_tracker_replay()
+{
+    size_t size = sizeof(hwc_display_contents_1_t) + 5 * sizeof(hwc_layer_1_t);
+    hwc_display_contents_1_t *list = (hwc_display_contents_1_t*)calloc(1, size);
+    IntelCursorTracker tracker;
+    uint32_t skipped = 0;
+    int x = 100, y = 100, appBuffer = 0, cursorBuffer = 0;
+
+    list->numHwLayers = 5;
+    for (int i = 0; i < 4; i++) {
+        hwc_layer_1_t& layer = list->hwLayers[i];
+        set_rect(layer.displayFrame, 0, 0, 1280, 800);
+        set_rect(layer.sourceCrop, 0, 0, 1280, 800);
+        layer.handle = (buffer_handle_t)&buffers[i];
+        layer.blending = HWC_BLENDING_PREMULT;
+    }
+    set_rect(list->hwLayers[2].displayFrame, 0, 0, 1280, 25);
+    hwc_layer_1_t& cursor = list->hwLayers[3];
+    set_rect(cursor.sourceCrop, 0, 0, 32, 32);
+    list->hwLayers[4].compositionType = HWC_FRAMEBUFFER_TARGET;
+
+    srand(7);
+    for (int f = 0; f < FRAMES; f++) {
+        int event = rand() % 100;
+        bool changed = f == 0;
+
+        if (event < 70) {
+            // pointer move
+            x = (x + rand() % 21 - 10 + 1280) % 1248;
+            y = (y + rand() % 21 - 10 + 800) % 768;
+        } else if (event < 85) {
+            // app frame
+            list->hwLayers[1].handle =
+                (buffer_handle_t)&buffers[10 + appBuffer++ % 3];
+            changed = true;
+        } else if (event < 88) {
+            // cursor shape
+            cursor.handle = (buffer_handle_t)&buffers[40 + cursorBuffer++ % 2];
+        } else if (event < 90) {
+            list->hwLayers[2].flags ^= HWC_SKIP_LAYER;
+            changed = true;
+        } else if (event < 92) {
+            // status bar moved
+            list->hwLayers[2].displayFrame.bottom ^= 1;
+            changed = true;
+        }
+        set_rect(cursor.displayFrame, x, y, x + 32, y + 32);
+
+        // what the HAL sets on a geometry change
+        for (int i = 0; i < 3; i++)
+            list->hwLayers[i].compositionType = HWC_FRAMEBUFFER;
+        cursor.compositionType = HWC_OVERLAY;
+
+        bool same = tracker.update(list, 4, 3);
+        if (same && changed) {
+            fprintf(stderr, "frame %d skipped composition of a change\n", f);
+            failures++;
+        }
+        skipped += same;
+    }
+
+    printf("tracker: %u frames, %u compositions avoided\n",
+           tracker.getFrames(), skipped);
+    CHECK(tracker.getFrames() == FRAMES);
+    CHECK(tracker.getCursorOnlyFrames() == skipped);
+    // cursor only frames right after a change still compose once
+    CHECK(skipped > FRAMES / 3);
+
+    // a different cursor layer invalidates the reuse
+    CHECK(!tracker.update(list, 4, 2));
+    CHECK(tracker.update(list, 4, 2));
+    CHECK(!tracker.update(list, 4, -1));
+
+    free(list);
+}
+
+// register file the cursor registers are written to
+struct FakeHw {
+    IntelCursorRegState::Regs regs;
+    uint32_t writes;
+};
+
+static bool same_regs(const IntelCursorRegState::Regs& a,
+                      const IntelCursorRegState::Regs& b)
+{
+    if (!a.enabled || !b.enabled)
+        return a.enabled == b.enabled;
+    return a.addr == b.addr && a.x == b.x && a.y == b.y && a.size == b.size;
+}
+
+// what IntelCursorPlane::writeRegs() does once the ioctl went through
+static void write_regs(FakeHw& hw, IntelCursorRegState& state,
+                       const IntelCursorRegState::Regs& regs)
+{
+    hw.regs = regs;
+    hw.writes++;
+    state.written(regs);
+}
+
+static void test_register_replay()
+{
+    IntelCursorRegState state;
+    FakeHw hw;
+    IntelCursorRegState::Regs want;
+    uint32_t writes = 0, moves = 0, dpms = 0;
+    bool shown = true;
+    int slot = 0;
+
+    memset(&hw, 0, sizeof(hw));
+    memset(&want, 0, sizeof(want));
+    want.enabled = true;
+    want.addr = SLOT_BASE;
+    want.size = 64;
+
+    srand(11);
+    for (int f = 0; f < FRAMES; f++) {
+        int event = rand() % 100;
+
+        if (event < 60) {
+            want.x = (want.x + rand() % 21 - 10 + 1280) % 1248;
+            want.y = (want.y + rand() % 21 - 10 + 800) % 768;
+            shown = true;
+        } else if (event < 70) {
+            // a new image never goes to the slot being scanned out
+            slot = state.getFreeSlot(SLOT_BASE, SLOT_SIZE, SLOT_COUNT);
+            CHECK(slot >= 0 && slot < SLOT_COUNT);
+            if (hw.regs.enabled)
+                CHECK(hw.regs.addr != (uint32_t)(SLOT_BASE + slot * SLOT_SIZE));
+            want.addr = SLOT_BASE + slot * SLOT_SIZE;
+            want.size = rand() % 2 ? 64 : 128;
+            shown = true;
+        } else if (event < 73) {
+            // disable()
+            if (state.isEnabled())
+                write_regs(hw, state, IntelCursorRegState::Regs());
+            shown = false;
+            CHECK(!hw.regs.enabled);
+            continue;
+        } else if (event < 75) {
+            // DPMS off and on clears the registers, onDpmsChange()
+            memset(&hw.regs, 0, sizeof(hw.regs));
+            state.invalidate();
+            dpms++;
+        }
+
+        if (!shown)
+            continue;
+
+        // flip()
+        IntelCursorRegState::Regs before = hw.regs;
+        uint32_t hwWrites = hw.writes;
+
+        if (state.needsWrite(want)) {
+            if (state.isMove(want)) {
+                // only the position differs
+                CHECK(before.enabled && before.addr == want.addr &&
+                      before.size == want.size);
+                moves++;
+            }
+            write_regs(hw, state, want);
+            writes++;
+        }
+
+        if (!same_regs(hw.regs, want)) {
+            fprintf(stderr, "frame %d: cursor registers not what was wanted\n", f);
+            failures++;
+        }
+        // written exactly when the hardware held something else
+        CHECK((hw.writes != hwWrites) == !same_regs(before, want));
+    }
+
+    printf("registers: %d frames, %u writes, %u moves, %u dpms cycles\n",
+           FRAMES, writes, moves, dpms);
+    CHECK(dpms > 0);
+    CHECK(moves > 0);
+}
+
+static void test_dpms()
+{
+    IntelCursorRegState state;
+    IntelCursorRegState::Regs regs;
+
+    memset(&regs, 0, sizeof(regs));
+    regs.enabled = true;
+    regs.addr = SLOT_BASE + SLOT_SIZE;
+    regs.x = 10;
+    regs.y = 20;
+    regs.size = 64;
+
+    CHECK(state.needsWrite(regs));
+    CHECK(!state.isMove(regs));
+    state.written(regs);
+    CHECK(!state.needsWrite(regs));
+    CHECK(state.getFreeSlot(SLOT_BASE, SLOT_SIZE, SLOT_COUNT) == 0);
+
+    regs.x = 11;
+    CHECK(state.isMove(regs));
+    state.written(regs);
+
+    // the same cursor is written again after DPMS, as a full update
+    state.invalidate();
+    CHECK(!state.isEnabled());
+    CHECK(state.needsWrite(regs));
+    CHECK(!state.isMove(regs));
+    CHECK(state.getFreeSlot(SLOT_BASE, SLOT_SIZE, SLOT_COUNT) == 0);
+
+    // nothing to disable when it's off
+    IntelCursorRegState::Regs off;
+    memset(&off, 0, sizeof(off));
+    CHECK(!state.needsWrite(off));
+    state.written(regs);
+    CHECK(state.needsWrite(off));
+}
+
+int main()
+{
+    test_tracker_replay();
+    test_register_replay();
+    test_dpms();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("cursor_replay_test: all checks passed\n");
+    return 0;
+}
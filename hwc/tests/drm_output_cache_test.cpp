@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host test for IntelDrmOutputCache. libdrm is replaced by the fake
+ * device of fake_drm.c, which counts the ioctls each call would issue
+ * and the objects still allocated, so the test can check that the
+ * cache reads DRM once per invalidation and that nothing handed out
+ * refers to freed state.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <IntelDrmOutputCache.h>
+#include <IntelHWComposerCfg.h>
+
+#include "fake_drm.h"
+
+/* defined by IntelHWComposerModule.cpp in the HAL */
+hwc_cfg cfg;
+
+static int failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+/* resources, two connectors, two encoders */
+#define LOAD_IOCTLS         5
+
+static void test_load_once(void)
+{
+    IntelDrmOutputCache cache;
+    intel_drm_connector_info_t info;
+    drmModeModeInfo mode;
+
+    fake_drm_reset();
+    cache.setDrmFd(FAKE_DRM_FD);
+    CHECK(fake_drm.ioctls == 0);
+
+    CHECK(cache.getConnector(OUTPUT_MIPI0, &info));
+    CHECK(info.connector_id == FAKE_DRM_CONNECTOR_MIPI0);
+    CHECK(info.connection == DRM_MODE_CONNECTED);
+    CHECK(fake_drm.ioctls == LOAD_IOCTLS);
+
+    /* everything else comes from the same load */
+    for (int i = 0; i < 100; i++) {
+        CHECK(cache.getConnector(OUTPUT_HDMI, &info));
+        CHECK(cache.getCrtcId(OUTPUT_HDMI) == FAKE_DRM_CRTC_HDMI);
+        CHECK(cache.getMode(OUTPUT_HDMI, NULL, &mode));
+    }
+    CHECK(fake_drm.ioctls == LOAD_IOCTLS);
+
+    /* the DPMS property is looked up once */
+    CHECK(cache.getDpmsPropId(OUTPUT_MIPI0) == FAKE_DRM_PROP_DPMS);
+    CHECK(fake_drm.ioctls == LOAD_IOCTLS + 2);
+    CHECK(cache.getDpmsPropId(OUTPUT_MIPI0) == FAKE_DRM_PROP_DPMS);
+    CHECK(fake_drm.ioctls == LOAD_IOCTLS + 2);
+
+    /* no MIPI1 on this device, and asking again does not reload */
+    CHECK(!cache.getConnector(OUTPUT_MIPI1, &info));
+    CHECK(!cache.getConnector(OUTPUT_MAX, &info));
+    CHECK(fake_drm.ioctls == LOAD_IOCTLS + 2);
+
+    /* only the objects held by the cache are left */
+    CHECK(fake_drm.allocated == 2);
+}
+
+static void test_invalidate(void)
+{
+    IntelDrmOutputCache cache;
+    intel_drm_connector_info_t info;
+
+    fake_drm_reset();
+    cache.setDrmFd(FAKE_DRM_FD);
+    CHECK(cache.getConnector(OUTPUT_HDMI, &info));
+    CHECK(info.count_modes == 4);
+
+    /* a copy taken before a reload stays intact */
+    fake_drm.hdmi_connection = DRM_MODE_DISCONNECTED;
+    cache.invalidate();
+    CHECK(fake_drm.allocated == 0);
+    CHECK(info.connector_id == FAKE_DRM_CONNECTOR_HDMI);
+    CHECK(info.connection == DRM_MODE_CONNECTED);
+
+    CHECK(cache.getConnector(OUTPUT_HDMI, &info));
+    CHECK(info.connection == DRM_MODE_DISCONNECTED);
+    CHECK(fake_drm.ioctls == 2 * LOAD_IOCTLS);
+
+    /* invalidations without a reader in between cost one reload */
+    cache.invalidate();
+    cache.invalidate();
+    CHECK(cache.getConnector(OUTPUT_HDMI, &info));
+    CHECK(fake_drm.ioctls == 3 * LOAD_IOCTLS);
+
+    /* a new fd drops the old state, a closed one loads nothing */
+    cache.setDrmFd(-1);
+    CHECK(fake_drm.allocated == 0);
+    CHECK(!cache.getConnector(OUTPUT_HDMI, &info));
+    CHECK(fake_drm.ioctls == 3 * LOAD_IOCTLS);
+}
+
+static void test_modes(void)
+{
+    IntelDrmOutputCache cache;
+    intel_display_mode_t requested;
+    drmModeModeInfo mode;
+
+    fake_drm_reset();
+    cache.setDrmFd(FAKE_DRM_FD);
+
+    /* biggest, then fastest, when nothing is preferred */
+    CHECK(cache.getMode(OUTPUT_HDMI, NULL, &mode));
+    CHECK(mode.hdisplay == 1920 && mode.vdisplay == 1080 && mode.vrefresh == 60);
+
+    /* the requested timing when the sink has it */
+    memset(&requested, 0, sizeof(requested));
+    requested.hdisplay = 1280;
+    requested.vdisplay = 720;
+    requested.vrefresh = 60;
+    CHECK(cache.getMode(OUTPUT_HDMI, &requested, &mode));
+    CHECK(mode.hdisplay == 1280 && mode.vrefresh == 60);
+
+    /* an unknown timing or aspect ratio falls back to the best mode */
+    requested.ratio = 2;
+    CHECK(cache.getMode(OUTPUT_HDMI, &requested, &mode));
+    CHECK(mode.hdisplay == 1920 && mode.vrefresh == 60);
+
+    /* a preferred mode wins over size */
+    fake_drm.hdmi_modes[3].type = DRM_MODE_TYPE_PREFERRED;
+    cache.invalidate();
+    CHECK(cache.getMode(OUTPUT_HDMI, NULL, &mode));
+    CHECK(mode.hdisplay == 720 && mode.vdisplay == 480);
+
+    /* the returned mode is a copy */
+    cache.invalidate();
+    CHECK(mode.hdisplay == 720 && !strcmp(mode.name, "720x480"));
+}
+
+static void test_crtc_fallback(void)
+{
+    IntelDrmOutputCache cache;
+
+    /* the HDMI encoder is not bound yet, take the first idle CRTC */
+    fake_drm_reset();
+    fake_drm.hdmi_encoder_crtc = 0;
+    fake_drm.crtc_buffers[0] = 7;
+    cache.setDrmFd(FAKE_DRM_FD);
+
+    CHECK(cache.getCrtcId(OUTPUT_HDMI) == FAKE_DRM_CRTC_HDMI);
+    CHECK(fake_drm.ioctls == LOAD_IOCTLS + 3);
+    CHECK(cache.getCrtcId(OUTPUT_HDMI) == FAKE_DRM_CRTC_HDMI);
+    CHECK(fake_drm.ioctls == LOAD_IOCTLS + 3);
+
+    /* no idle CRTC is remembered as well */
+    cache.invalidate();
+    fake_drm.crtc_buffers[1] = 8;
+    CHECK(cache.getCrtcId(OUTPUT_HDMI) == 0);
+    CHECK(cache.getCrtcId(OUTPUT_HDMI) == 0);
+    CHECK(fake_drm.ioctls == 2 * LOAD_IOCTLS + 6);
+    CHECK(fake_drm.allocated == 2);
+}
+
+int main(void)
+{
+    test_load_once();
+    test_invalidate();
+    test_modes();
+    test_crtc_fallback();
+    CHECK(fake_drm.allocated == 0);
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("drm_output_cache_test: all checks passed\n");
+    return 0;
+}
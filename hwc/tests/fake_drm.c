@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Stand-in for libdrm on the build host: a MIPI panel and an HDMI port
+ * on two CRTCs. Every object read from the device is counted as an
+ * ioctl and as allocated until it is freed, and freed connectors are
+ * poisoned so a stale pointer reads garbage. Probing a connected HDMI
+ * sink and setting a mode take as long as the test asks for.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "fake_drm.h"
+
+/*as IntelDrmOutputCache.h, which C can not include*/
+#define DRM_MODE_CONNECTOR_MIPI     15
+
+struct fake_drm_state fake_drm;
+
+static uint32_t res_connectors[] = {
+    FAKE_DRM_CONNECTOR_MIPI0, FAKE_DRM_CONNECTOR_HDMI,
+};
+static uint32_t res_encoders[] = { 30, 31 };
+static uint32_t res_crtcs[] = { FAKE_DRM_CRTC_MIPI0, FAKE_DRM_CRTC_HDMI };
+static uint32_t mipi_props[] = { FAKE_DRM_PROP_EDID, FAKE_DRM_PROP_DPMS };
+
+static void *fake_alloc(size_t size)
+{
+    fake_drm.ioctls++;
+    fake_drm.allocated++;
+    return calloc(1, size);
+}
+
+static void fake_free(void *ptr)
+{
+    if (ptr)
+        fake_drm.allocated--;
+    free(ptr);
+}
+
+static void set_mode(drmModeModeInfo *mode, int w, int h, int hz, uint32_t type)
+{
+    memset(mode, 0, sizeof(*mode));
+    mode->hdisplay = w;
+    mode->vdisplay = h;
+    mode->vrefresh = hz;
+    mode->type = type;
+    snprintf(mode->name, sizeof(mode->name), "%dx%d", w, h);
+}
+
+void fake_drm_reset(void)
+{
+    memset(&fake_drm, 0, sizeof(fake_drm));
+    fake_drm.hdmi_connection = DRM_MODE_CONNECTED;
+    fake_drm.hdmi_encoder_crtc = FAKE_DRM_CRTC_HDMI;
+    set_mode(&fake_drm.hdmi_modes[0], 1280, 720, 60, 0);
+    set_mode(&fake_drm.hdmi_modes[1], 1920, 1080, 30, 0);
+    set_mode(&fake_drm.hdmi_modes[2], 1920, 1080, 60, 0);
+    set_mode(&fake_drm.hdmi_modes[3], 720, 480, 60, 0);
+    fake_drm.hdmi_count_modes = 4;
+}
+
+drmModeResPtr drmModeGetResources(int fd)
+{
+    drmModeResPtr res;
+
+    if (fd != FAKE_DRM_FD)
+        return NULL;
+    res = (drmModeResPtr)fake_alloc(sizeof(*res));
+    res->count_connectors = 2;
+    res->connectors = res_connectors;
+    res->count_encoders = 2;
+    res->encoders = res_encoders;
+    res->count_crtcs = 2;
+    res->crtcs = res_crtcs;
+    return res;
+}
+
+void drmModeFreeResources(drmModeResPtr ptr)
+{
+    fake_free(ptr);
+}
+
+drmModeConnectorPtr drmModeGetConnector(int fd, uint32_t connectorId)
+{
+    drmModeConnectorPtr connector;
+
+    if (fd != FAKE_DRM_FD)
+        return NULL;
+    connector = (drmModeConnectorPtr)fake_alloc(sizeof(*connector));
+    connector->connector_id = connectorId;
+    if (connectorId == FAKE_DRM_CONNECTOR_MIPI0) {
+        connector->connector_type = DRM_MODE_CONNECTOR_MIPI;
+        connector->connector_type_id = 1;
+        connector->connection = DRM_MODE_CONNECTED;
+        connector->count_modes = 1;
+        connector->modes = (drmModeModeInfoPtr)calloc(1, sizeof(drmModeModeInfo));
+        set_mode(&connector->modes[0], 1024, 600, 60, DRM_MODE_TYPE_PREFERRED);
+        connector->count_props = 2;
+        connector->props = mipi_props;
+    } else {
+        if (fake_drm.hdmi_connection == DRM_MODE_CONNECTED &&
+            fake_drm.hdmi_probe_us)
+            usleep(fake_drm.hdmi_probe_us);
+        connector->connector_type = DRM_MODE_CONNECTOR_DVID;
+        connector->connector_type_id = 1;
+        connector->connection = fake_drm.hdmi_connection;
+        connector->count_modes = fake_drm.hdmi_count_modes;
+        connector->modes = (drmModeModeInfoPtr)calloc(fake_drm.hdmi_count_modes,
+                                                      sizeof(drmModeModeInfo));
+        memcpy(connector->modes, fake_drm.hdmi_modes,
+               fake_drm.hdmi_count_modes * sizeof(drmModeModeInfo));
+    }
+    return connector;
+}
+
+void drmModeFreeConnector(drmModeConnectorPtr ptr)
+{
+    if (ptr) {
+        /*poison what a stale pointer would read*/
+        memset(ptr->modes, 0xa5, ptr->count_modes * sizeof(drmModeModeInfo));
+        free(ptr->modes);
+        memset(ptr, 0xa5, sizeof(*ptr));
+    }
+    fake_free(ptr);
+}
+
+drmModeEncoderPtr drmModeGetEncoder(int fd, uint32_t encoder_id)
+{
+    drmModeEncoderPtr encoder;
+
+    if (fd != FAKE_DRM_FD)
+        return NULL;
+    encoder = (drmModeEncoderPtr)fake_alloc(sizeof(*encoder));
+    encoder->encoder_id = encoder_id;
+    if (encoder_id == res_encoders[0]) {
+        encoder->encoder_type = DRM_MODE_ENCODER_MIPI;
+        encoder->crtc_id = FAKE_DRM_CRTC_MIPI0;
+    } else {
+        encoder->encoder_type = DRM_MODE_ENCODER_TMDS;
+        encoder->crtc_id = fake_drm.hdmi_encoder_crtc;
+    }
+    return encoder;
+}
+
+void drmModeFreeEncoder(drmModeEncoderPtr ptr)
+{
+    fake_free(ptr);
+}
+
+drmModeCrtcPtr drmModeGetCrtc(int fd, uint32_t crtcId)
+{
+    drmModeCrtcPtr crtc;
+
+    if (fd != FAKE_DRM_FD)
+        return NULL;
+    crtc = (drmModeCrtcPtr)fake_alloc(sizeof(*crtc));
+    crtc->crtc_id = crtcId;
+    crtc->buffer_id = fake_drm.crtc_buffers[crtcId == FAKE_DRM_CRTC_MIPI0 ? 0 : 1];
+    return crtc;
+}
+
+void drmModeFreeCrtc(drmModeCrtcPtr ptr)
+{
+    fake_free(ptr);
+}
+
+int drmModeSetCrtc(int fd, uint32_t crtcId, uint32_t bufferId,
+                   uint32_t x, uint32_t y, uint32_t *connectors, int count,
+                   drmModeModeInfoPtr mode)
+{
+    if (fd != FAKE_DRM_FD)
+        return -1;
+    if (crtcId != FAKE_DRM_CRTC_MIPI0 && crtcId != FAKE_DRM_CRTC_HDMI)
+        return -1;
+    fake_drm.ioctls++;
+    fake_drm.modesets++;
+    if (fake_drm.modeset_us)
+        usleep(fake_drm.modeset_us);
+    fake_drm.crtc_buffers[crtcId == FAKE_DRM_CRTC_MIPI0 ? 0 : 1] = bufferId;
+    return 0;
+}
+
+drmModePropertyPtr drmModeGetProperty(int fd, uint32_t propertyId)
+{
+    drmModePropertyPtr prop;
+
+    if (fd != FAKE_DRM_FD)
+        return NULL;
+    prop = (drmModePropertyPtr)fake_alloc(sizeof(*prop));
+    prop->prop_id = propertyId;
+    strcpy(prop->name, propertyId == FAKE_DRM_PROP_DPMS ? "DPMS" : "EDID");
+    return prop;
+}
+
+void drmModeFreeProperty(drmModePropertyPtr ptr)
+{
+    fake_free(ptr);
+}
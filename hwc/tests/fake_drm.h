@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __FAKE_DRM_H__
+#define __FAKE_DRM_H__
+
+#include <stdint.h>
+
+#include "xf86drm.h"
+#include "xf86drmMode.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#define FAKE_DRM_FD                 42
+#define FAKE_DRM_CONNECTOR_MIPI0    10
+#define FAKE_DRM_CONNECTOR_HDMI     11
+#define FAKE_DRM_PROP_EDID          20
+#define FAKE_DRM_PROP_DPMS          21
+#define FAKE_DRM_CRTC_MIPI0         40
+#define FAKE_DRM_CRTC_HDMI          41
+
+/*the device, reset by fake_drm_reset()*/
+struct fake_drm_state {
+    int ioctls;
+    int allocated;              /*objects handed out and not freed yet*/
+    int modesets;               /*drmModeSetCrtc() calls*/
+    drmModeConnection hdmi_connection;
+    uint32_t hdmi_encoder_crtc;
+    uint32_t crtc_buffers[2];
+    drmModeModeInfo hdmi_modes[4];
+    int hdmi_count_modes;
+    /*time the calling thread spends in the kernel, 0 by default*/
+    unsigned int hdmi_probe_us; /*DDC EDID read of a connected sink*/
+    unsigned int modeset_us;    /*link training and the vblanks waited*/
+};
+
+extern struct fake_drm_state fake_drm;
+
+/*MIPI0 at 1024x600, a connected HDMI sink with 4 modes, no preferred*/
+void fake_drm_reset(void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /*__FAKE_DRM_H__*/
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Stand-in for the libwsbm wrapper on the build host. Wrapped buffers
+ * are plain allocations, a buffer marked busy stays busy until it is
+ * waited for, like a buffer the decoder is still writing.
+ */
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <IntelWsbmWrapper.h>
+
+#include "fake_wsbm.h"
+
+struct fake_buffer {
+    uint32_t handle;
+    uint32_t size;
+    void *cpu;
+    int busy;
+};
+
+struct fake_wsbm_stats fake_wsbm_stats;
+static int query_error;
+
+void fake_wsbm_set_busy(void *buf, int busy)
+{
+    ((struct fake_buffer *)buf)->busy = busy;
+}
+
+void fake_wsbm_set_query_error(int err)
+{
+    query_error = err;
+}
+
+int pvrWsbmInitialize(int drmFD)
+{
+    return drmFD < 0 ? -EINVAL : 0;
+}
+
+void pvrWsbmTakedown()
+{
+}
+
+int pvrWsbmAllocateTTMBuffer(uint32_t size, uint32_t align, void **buf)
+{
+    struct fake_buffer *b = calloc(1, sizeof(*b));
+
+    if (!b)
+        return -ENOMEM;
+    b->size = size;
+    b->cpu = calloc(1, size);
+    *buf = b;
+    return 0;
+}
+
+int pvrWsbmDestroyTTMBuffer(void *buf)
+{
+    struct fake_buffer *b = buf;
+
+    if (!b)
+        return -EINVAL;
+    free(b->cpu);
+    free(b);
+    return 0;
+}
+
+void *pvrWsbmGetCPUAddress(void *buf)
+{
+    return buf ? ((struct fake_buffer *)buf)->cpu : NULL;
+}
+
+uint32_t pvrWsbmGetGttOffset(void *buf)
+{
+    return 0;
+}
+
+int pvrWsbmWrapTTMBuffer(uint32_t handle, void **buf)
+{
+    struct fake_buffer *b = calloc(1, sizeof(*b));
+
+    if (!b)
+        return -ENOMEM;
+    b->handle = handle;
+    *buf = b;
+    fake_wsbm_stats.wraps++;
+    return 0;
+}
+
+int pvrWsbmUnReference(void *buf)
+{
+    if (!buf)
+        return -EINVAL;
+    free(buf);
+    fake_wsbm_stats.unreferences++;
+    return 0;
+}
+
+int pvrWsbmWaitIdle(void *buf)
+{
+    struct fake_buffer *b = buf;
+
+    if (!b)
+        return -EINVAL;
+    if (b->busy) {
+        fake_wsbm_stats.waits++;
+        b->busy = 0;
+    }
+    return 0;
+}
+
+int pvrWsbmIsIdle(void *buf)
+{
+    struct fake_buffer *b = buf;
+
+    fake_wsbm_stats.queries++;
+    if (!b)
+        return -EINVAL;
+    if (query_error)
+        return query_error;
+    return !b->busy;
+}
+
+uint32_t pvrWsbmGetKBufHandle(void *buf)
+{
+    return buf ? ((struct fake_buffer *)buf)->handle : 0;
+}
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host test for IntelFormatTraits and IntelBufferLayout: every format
+ * the composer handles is classified as before the table, and the
+ * strides, chroma offsets and plane eligibility of a layout match what
+ * the overlay programs for the buffer.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IntelFormatTraits.h>
+
+static int failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+struct FormatCase {
+    int format;
+    bool yuv;
+    int bpp;
+    int planes;
+    uint32_t flags;
+};
+
+static const FormatCase sFormats[] = {
+    { HAL_PIXEL_FORMAT_INTEL_HWC_NV12_VED, true, 8, 2,
+      IntelFormatTraits::FORMAT_OVERLAY | IntelFormatTraits::FORMAT_NV12 },
+    { HAL_PIXEL_FORMAT_INTEL_HWC_NV12_TILE, true, 8, 2,
+      IntelFormatTraits::FORMAT_OVERLAY | IntelFormatTraits::FORMAT_NV12 },
+    { HAL_PIXEL_FORMAT_INTEL_HWC_NV12, true, 8, 2,
+      IntelFormatTraits::FORMAT_OVERLAY | IntelFormatTraits::FORMAT_NV12 },
+    { HAL_PIXEL_FORMAT_YV12, true, 8, 3, IntelFormatTraits::FORMAT_OVERLAY },
+    { HAL_PIXEL_FORMAT_INTEL_HWC_I420, true, 8, 3,
+      IntelFormatTraits::FORMAT_OVERLAY },
+    { HAL_PIXEL_FORMAT_INTEL_HWC_YUY2, true, 16, 1,
+      IntelFormatTraits::FORMAT_OVERLAY },
+    { HAL_PIXEL_FORMAT_INTEL_HWC_UYVY, true, 16, 1,
+      IntelFormatTraits::FORMAT_OVERLAY },
+    { HAL_PIXEL_FORMAT_RGBA_8888, false, 32, 1,
+      IntelFormatTraits::FORMAT_SPRITE | IntelFormatTraits::FORMAT_ALPHA },
+    { HAL_PIXEL_FORMAT_RGBX_8888, false, 32, 1,
+      IntelFormatTraits::FORMAT_SPRITE },
+    { HAL_PIXEL_FORMAT_BGRA_8888, false, 32, 1,
+      IntelFormatTraits::FORMAT_SPRITE | IntelFormatTraits::FORMAT_ALPHA },
+    { HAL_PIXEL_FORMAT_BGRX_8888, false, 32, 1,
+      IntelFormatTraits::FORMAT_SPRITE },
+    { HAL_PIXEL_FORMAT_RGB_565, false, 16, 1,
+      IntelFormatTraits::FORMAT_SPRITE },
+};
+
+static void test_traits()
+{
+    for (size_t i = 0; i < sizeof(sFormats) / sizeof(sFormats[0]); i++) {
+        const FormatCase& c = sFormats[i];
+        const IntelFormatTraits *traits = IntelFormatTraits::get(c.format);
+
+        CHECK(traits != 0);
+        if (!traits)
+            continue;
+        CHECK(traits->format == c.format);
+        CHECK(traits->isYUV() == c.yuv);
+        CHECK(traits->isRGB() == !c.yuv);
+        CHECK(traits->bpp == c.bpp);
+        CHECK(traits->planes == c.planes);
+        CHECK(traits->flags == c.flags);
+        CHECK(traits->strideAlign == 64);
+    }
+
+    // the composer leaves formats it doesn't know to GLES
+    CHECK(IntelFormatTraits::get(HAL_PIXEL_FORMAT_RGB_888) == 0);
+    CHECK(IntelFormatTraits::get(0) == 0);
+}
+
+struct LayoutCase {
+    int format;
+    uint32_t stride;
+    uint32_t width;
+    uint32_t height;
+    uint32_t yStride;
+    uint32_t uvStride;
+    uint32_t uOffset;
+    uint32_t vOffset;
+    uint32_t flags;
+};
+
+#define OVERLAY         IntelBufferLayout::LAYOUT_OVERLAY
+#define SPRITE          IntelBufferLayout::LAYOUT_SPRITE
+#define TILED           IntelBufferLayout::LAYOUT_TILED
+#define PACKED          IntelBufferLayout::LAYOUT_PACKED
+
+static const LayoutCase sLayouts[] = {
+    // planar, V before U in YV12
+    { HAL_PIXEL_FORMAT_YV12, 1280, 1280, 720,
+      1280, 640, 1280 * 720 + 640 * 360, 1280 * 720, OVERLAY },
+    { HAL_PIXEL_FORMAT_INTEL_HWC_I420, 1280, 1280, 720,
+      1280, 640, 1280 * 720, 1280 * 720 + 640 * 360, OVERLAY },
+    // strides are aligned to 64 bytes, the chroma one after halving
+    { HAL_PIXEL_FORMAT_YV12, 1000, 1000, 500,
+      1024, 512, 1024 * 500 + 512 * 250, 1024 * 500, OVERLAY },
+    // semi-planar
+    { HAL_PIXEL_FORMAT_INTEL_HWC_NV12, 1920, 1920, 1080,
+      1920, 1920, 1920 * 1080, 0, OVERLAY },
+    // decoded frames have their height aligned to 32
+    { HAL_PIXEL_FORMAT_INTEL_HWC_NV12_VED, 1920, 1920, 1080,
+      1920, 1920, 1920 * 1088, 0, OVERLAY },
+    { HAL_PIXEL_FORMAT_INTEL_HWC_NV12_TILE, 1920, 1920, 1080,
+      1920, 1920, 1920 * 1088, 0, OVERLAY | TILED },
+    // packed
+    { HAL_PIXEL_FORMAT_INTEL_HWC_YUY2, 1920, 1920, 1080,
+      3840, 0, 0, 0, OVERLAY | PACKED },
+    { HAL_PIXEL_FORMAT_INTEL_HWC_UYVY, 720, 720, 480,
+      1472, 0, 0, 0, OVERLAY | PACKED },
+    // overlay stride limits: 8k for packed, 4k for the others, 512 min
+    { HAL_PIXEL_FORMAT_INTEL_HWC_YUY2, 4096, 4096, 64,
+      8192, 0, 0, 0, OVERLAY | PACKED },
+    { HAL_PIXEL_FORMAT_INTEL_HWC_YUY2, 4160, 4160, 64,
+      8320, 0, 0, 0, PACKED },
+    { HAL_PIXEL_FORMAT_INTEL_HWC_NV12, 4096, 4096, 64,
+      4096, 4096, 4096 * 64, 0, OVERLAY },
+    { HAL_PIXEL_FORMAT_INTEL_HWC_NV12, 4160, 4160, 64,
+      4160, 4160, 4160 * 64, 0, 0 },
+    { HAL_PIXEL_FORMAT_INTEL_HWC_NV12, 512, 320, 240,
+      512, 512, 512 * 240, 0, OVERLAY },
+    { HAL_PIXEL_FORMAT_INTEL_HWC_NV12, 256, 176, 144,
+      256, 256, 256 * 144, 0, 0 },
+    // RGB goes to the sprite planes only
+    { HAL_PIXEL_FORMAT_RGBA_8888, 1280, 1280, 800,
+      5120, 0, 0, 0, SPRITE },
+    { HAL_PIXEL_FORMAT_RGB_565, 600, 600, 1024,
+      1216, 0, 0, 0, SPRITE },
+};
+
+static void test_layout()
+{
+    for (size_t i = 0; i < sizeof(sLayouts) / sizeof(sLayouts[0]); i++) {
+        const LayoutCase& c = sLayouts[i];
+        IntelBufferLayout layout;
+
+        if (!layout.setup(c.format, c.stride, c.width, c.height)) {
+            fprintf(stderr, "layout %zu: setup failed\n", i);
+            failures++;
+            continue;
+        }
+        if (layout.yStride != c.yStride || layout.uvStride != c.uvStride ||
+            layout.uOffset != c.uOffset || layout.vOffset != c.vOffset ||
+            layout.flags != c.flags) {
+            fprintf(stderr, "layout %zu: strides %u/%u offsets %u/%u "
+                    "flags 0x%x, expected %u/%u %u/%u 0x%x\n", i,
+                    layout.yStride, layout.uvStride,
+                    layout.uOffset, layout.vOffset, layout.flags,
+                    c.yStride, c.uvStride, c.uOffset, c.vOffset, c.flags);
+            failures++;
+        }
+        CHECK(layout.traits == IntelFormatTraits::get(c.format));
+        CHECK(layout.matches(c.format, c.stride, c.width, c.height));
+    }
+}
+
+static void test_matches()
+{
+    IntelBufferLayout layout;
+
+    layout.setup(HAL_PIXEL_FORMAT_YV12, 1280, 1280, 720);
+    CHECK(layout.matches(HAL_PIXEL_FORMAT_YV12, 1280, 1280, 720));
+    // a buffer reallocated with another size or format is set up again
+    CHECK(!layout.matches(HAL_PIXEL_FORMAT_INTEL_HWC_I420, 1280, 1280, 720));
+    CHECK(!layout.matches(HAL_PIXEL_FORMAT_YV12, 1344, 1280, 720));
+    CHECK(!layout.matches(HAL_PIXEL_FORMAT_YV12, 1280, 1280, 736));
+    CHECK(!layout.matches(HAL_PIXEL_FORMAT_YV12, 1280, 1264, 720));
+
+    // an unknown format leaves an empty layout that never matches
+    CHECK(!layout.setup(HAL_PIXEL_FORMAT_RGB_888, 1280, 1280, 720));
+    CHECK(layout.traits == 0 && layout.flags == 0 && layout.yStride == 0);
+    CHECK(!layout.matches(HAL_PIXEL_FORMAT_RGB_888, 1280, 1280, 720));
+}
+
+int main()
+{
+    test_traits();
+    test_layout();
+    test_matches();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("format_traits_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host test for IntelFrameCadence: a video composed at a higher rate
+ * than its own is flipped once per frame, new frames queued in the same
+ * buffer are told apart by their timestamps, and the content rate and
+ * pulldown are detected from the timestamps.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IntelFrameCadence.h>
+
+static int failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+enum {
+    DECODER_BUFFERS = 6,
+};
+
+/* Composes seconds of fps content at refresh Hz, the way the player
+ * queues it: each refresh shows the newest frame due. Returns the
+ * number of refreshes flipped.
+ */
+static int play(IntelFrameCadence& cadence, int fps, int refresh, int seconds,
+                bool timestamps, int64_t start = 0)
+{
+    int flips = 0;
+    for (int r = 0; r < refresh * seconds; r++) {
+        int frame = (int)((int64_t)r * fps / refresh);
+        uint32_t handle = 0x100 + frame % DECODER_BUFFERS;
+        int64_t ts = timestamps ? start + (int64_t)frame * 1000000 / fps : -1;
+        if (cadence.update(handle, ts))
+            flips++;
+    }
+    return flips;
+}
+
+static void test_pulldown()
+{
+    static const struct {
+        int fps;
+        int first;
+        int second;
+    } cases[] = {
+        { 24, 3, 2 },
+        { 25, 3, 2 },
+        { 30, 2, 2 },
+        { 60, 1, 1 },
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        IntelFrameCadence cadence;
+        int first, second;
+
+        int flips = play(cadence, cases[i].fps, 60, 10, true);
+        CHECK(flips == cases[i].fps * 10);
+        CHECK((int)cadence.getFrames() == cases[i].fps * 10);
+        CHECK((int)cadence.getDuplicates() == (60 - cases[i].fps) * 10);
+        CHECK(cadence.getFrameRate() == cases[i].fps);
+        cadence.getPulldown(60, &first, &second);
+        CHECK(first == cases[i].first && second == cases[i].second);
+        if (i == 0)
+            printf("24fps at 60Hz: %d flips, %u skipped, %d:%d pulldown\n",
+                   flips, cadence.getDuplicates(), first, second);
+    }
+}
+
+static void test_ntsc_rate()
+{
+    IntelFrameCadence cadence;
+    int flips = 0;
+
+    // 23.976fps snaps to 24
+    for (int f = 0; f < 240; f++)
+        if (cadence.update(0x100 + f % DECODER_BUFFERS, (int64_t)f * 1001000 / 24))
+            flips++;
+    CHECK(flips == 240);
+    CHECK(cadence.getFrameRate() == 24);
+}
+
+static void test_same_buffer()
+{
+    IntelFrameCadence cadence;
+
+    // a decoder with a single output buffer, every frame is new
+    for (int f = 0; f < 30; f++)
+        CHECK(cadence.update(0x100, (int64_t)f * 33333));
+    CHECK(cadence.getDuplicates() == 0);
+    CHECK(cadence.getFrameRate() == 30);
+
+    // the same frame shown again
+    CHECK(!cadence.update(0x100, 29 * 33333));
+    CHECK(cadence.getDuplicates() == 1);
+
+    // without timestamps only the buffer tells
+    cadence.reset();
+    CHECK(play(cadence, 24, 60, 2, false) == 48);
+    CHECK(cadence.getFrameRate() == 0);
+    CHECK(!cadence.update(0x100 + 47 % DECODER_BUFFERS, -1));
+}
+
+static void test_seek()
+{
+    IntelFrameCadence cadence;
+
+    CHECK(play(cadence, 24, 60, 2, true) == 48);
+    CHECK(cadence.getFrameRate() == 24);
+
+    // seeking back keeps the rate, then frames keep coming at 24fps
+    CHECK(play(cadence, 24, 60, 2, true, 0) == 48);
+    CHECK(cadence.getFrameRate() == 24);
+
+    // a pause longer than a second, then the content is 30fps
+    CHECK(play(cadence, 30, 60, 2, true, 10000000) == 60);
+    CHECK(cadence.getFrameRate() == 30);
+
+    cadence.reset();
+    CHECK(cadence.getFrames() == 0 && cadence.getFrameRate() == 0);
+    int first, second;
+    cadence.getPulldown(60, &first, &second);
+    CHECK(first == 1 && second == 1);
+}
+
+int main()
+{
+    test_pulldown();
+    test_ntsc_rate();
+    test_same_buffer();
+    test_seek();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("frame_cadence_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,384 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host test for IntelHotplugHandler: events reach the listener in
+ * order on the handler thread, and the thread exits and joins promptly
+ * whether it is idle or in the middle of an event.
+ *
+ * With -b it also runs a 60 Hz prepare/set loop while HDMI events
+ * arrive, once handling them inline on the composition thread as the
+ * composer used to and once through the handler, and reports the
+ * longest frame of each. The events are handled the way IntelHWComposer
+ * does, through IntelDrmOutputCache and the fake DRM device of
+ * fake_drm.c, which takes as long as a sink probe and a modeset do.
+ *
+ * usage: hotplug_handler_test [-b]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <IntelHotplugHandler.h>
+#include <IntelHWComposerCfg.h>
+
+#include "fake_drm.h"
+
+#define MAX_EVENTS          64
+/* FB allocation, mode set and waiting for SF to drop the display */
+#define HANDLE_MS           200
+/* EDID read over DDC, and link training plus the vblanks of a modeset */
+#define PROBE_MS            60
+#define MODESET_MS          50
+#define HDMI_FB_ID          7
+#define FRAME_MS            16
+#define COMPOSE_MS          3
+#define BENCH_FRAMES        120
+#define HOTPLUG_EVERY       30
+
+/* defined by IntelHWComposerModule.cpp in the HAL */
+hwc_cfg cfg;
+
+static int failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+static nsecs_t now(void)
+{
+    return systemTime(CLOCK_MONOTONIC);
+}
+
+class FakeComposer : public IntelHotplugListener {
+public:
+    android::Mutex lock;
+    int events[MAX_EVENTS];
+    int count;
+    unsigned int handleMs;
+    bool inside;
+
+    FakeComposer(unsigned int ms) : count(0), handleMs(ms), inside(false) {}
+
+    void record(int event) {
+        {
+            android::Mutex::Autolock _l(lock);
+            if (count < MAX_EVENTS)
+                events[count++] = event;
+            inside = true;
+        }
+        usleep(handleMs * 1000);
+        android::Mutex::Autolock _l(lock);
+        inside = false;
+    }
+    int handled() {
+        android::Mutex::Autolock _l(lock);
+        return count;
+    }
+    bool busy() {
+        android::Mutex::Autolock _l(lock);
+        return inside;
+    }
+
+    virtual bool handleHotplugEvent(int hpd, void *data) {
+        record(hpd ? IntelHotplugHandler::EVENT_PLUG_IN :
+                     IntelHotplugHandler::EVENT_PLUG_OUT);
+        return true;
+    }
+    virtual bool handleDynamicModeSetting(void *data) {
+        intel_display_mode_t *mode = (intel_display_mode_t *)data;
+        CHECK(mode && mode->hdisplay == 1920 && mode->vrefresh == 50);
+        record(IntelHotplugHandler::EVENT_MODE_CHANGE);
+        return true;
+    }
+};
+
+static bool wait_handled(FakeComposer *composer, int count, unsigned int ms)
+{
+    nsecs_t deadline = now() + ms2ns(ms);
+
+    while (composer->handled() < count) {
+        if (now() > deadline)
+            return false;
+        usleep(1000);
+    }
+    return true;
+}
+
+static void test_order(void)
+{
+    FakeComposer composer(1);
+    android::sp<IntelHotplugHandler> handler = new IntelHotplugHandler(&composer);
+    intel_display_mode_t mode;
+
+    memset(&mode, 0, sizeof(mode));
+    mode.hdisplay = 1920;
+    mode.vdisplay = 1080;
+    mode.vrefresh = 50;
+
+    CHECK(handler->post(IntelHotplugHandler::EVENT_PLUG_IN, NULL));
+    CHECK(handler->post(IntelHotplugHandler::EVENT_MODE_CHANGE, &mode));
+    /* the event keeps its own copy of the mode */
+    mode.vrefresh = 0;
+    CHECK(handler->post(IntelHotplugHandler::EVENT_PLUG_OUT, NULL));
+
+    CHECK(wait_handled(&composer, 3, 1000));
+    CHECK(composer.events[0] == IntelHotplugHandler::EVENT_PLUG_IN);
+    CHECK(composer.events[1] == IntelHotplugHandler::EVENT_MODE_CHANGE);
+    CHECK(composer.events[2] == IntelHotplugHandler::EVENT_PLUG_OUT);
+
+    handler->requestExit();
+    handler->join();
+}
+
+static void test_exit_idle(void)
+{
+    FakeComposer composer(1);
+    android::sp<IntelHotplugHandler> handler = new IntelHotplugHandler(&composer);
+    nsecs_t start;
+
+    /* let the thread block waiting for events */
+    usleep(20 * 1000);
+
+    start = now();
+    handler->requestExit();
+    handler->join();
+    CHECK(ns2ms(now() - start) < 100);
+
+    /* nothing is queued once it is gone */
+    CHECK(!handler->post(IntelHotplugHandler::EVENT_PLUG_IN, NULL));
+    CHECK(composer.handled() == 0);
+}
+
+static void test_exit_busy(void)
+{
+    FakeComposer composer(HANDLE_MS);
+    android::sp<IntelHotplugHandler> handler = new IntelHotplugHandler(&composer);
+    nsecs_t start;
+
+    for (int i = 0; i < 4; i++)
+        handler->post(i & 1 ? IntelHotplugHandler::EVENT_PLUG_OUT :
+                              IntelHotplugHandler::EVENT_PLUG_IN, NULL);
+    while (!composer.busy())
+        usleep(1000);
+
+    /* the event in progress completes, the queued ones are dropped */
+    start = now();
+    handler->requestExit();
+    handler->join();
+    CHECK(ns2ms(now() - start) <= HANDLE_MS + 50);
+    CHECK(composer.handled() == 1);
+    CHECK(!composer.busy());
+}
+
+/*
+ * HDMI event handling of IntelHWComposer against the fake device: a
+ * plug in re-probes the connector, picks the mode and sets it, a plug
+ * out drops what was read from the sink.
+ */
+class DrmComposer : public IntelHotplugListener {
+public:
+    IntelDrmOutputCache outputs;
+    android::Mutex lock;
+    int handled;
+    int failed;
+
+    DrmComposer() : handled(0), failed(0) {
+        outputs.setDrmFd(FAKE_DRM_FD);
+    }
+
+    bool modeset(const intel_display_mode_t *requested) {
+        intel_drm_connector_info_t connector;
+        drmModeModeInfo mode;
+        uint32_t crtc;
+
+        outputs.invalidate();
+        if (!outputs.getConnector(OUTPUT_HDMI, &connector) ||
+            connector.connection != DRM_MODE_CONNECTED)
+            return false;
+        if (!outputs.getMode(OUTPUT_HDMI, requested, &mode))
+            return false;
+        crtc = outputs.getCrtcId(OUTPUT_HDMI);
+        if (!crtc)
+            return false;
+        return !drmModeSetCrtc(FAKE_DRM_FD, crtc, HDMI_FB_ID, 0, 0,
+                               &connector.connector_id, 1, &mode);
+    }
+    void done(bool ret) {
+        android::Mutex::Autolock _l(lock);
+        handled++;
+        if (!ret)
+            failed++;
+    }
+    int getHandled() {
+        android::Mutex::Autolock _l(lock);
+        return handled;
+    }
+
+    virtual bool handleHotplugEvent(int hpd, void *data) {
+        bool ret = true;
+
+        if (hpd)
+            ret = modeset((intel_display_mode_t *)data);
+        else
+            outputs.invalidate();
+        done(ret);
+        return ret;
+    }
+    virtual bool handleDynamicModeSetting(void *data) {
+        bool ret = modeset((intel_display_mode_t *)data);
+
+        done(ret);
+        return ret;
+    }
+};
+
+static bool wait_events(DrmComposer *composer, int count, unsigned int ms)
+{
+    nsecs_t deadline = now() + ms2ns(ms);
+
+    while (composer->getHandled() < count) {
+        if (now() > deadline)
+            return false;
+        usleep(1000);
+    }
+    return true;
+}
+
+/* a 60 Hz prepare/set loop with a hotplug every HOTPLUG_EVERY frames */
+static void bench(bool threaded)
+{
+    DrmComposer composer;
+    android::sp<IntelHotplugHandler> handler;
+    nsecs_t last = now(), worst = 0, worstPost = 0;
+    int posted = 0, plugins = 0;
+
+    fake_drm_reset();
+    fake_drm.hdmi_connection = DRM_MODE_DISCONNECTED;
+    fake_drm.hdmi_probe_us = PROBE_MS * 1000;
+    fake_drm.modeset_us = MODESET_MS * 1000;
+
+    if (threaded)
+        handler = new IntelHotplugHandler(&composer);
+
+    for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+        nsecs_t start = now(), t;
+
+        if (frame % HOTPLUG_EVERY == HOTPLUG_EVERY - 1) {
+            int event = posted++ & 1 ? IntelHotplugHandler::EVENT_PLUG_OUT :
+                                       IntelHotplugHandler::EVENT_PLUG_IN;
+
+            /* the sink changes before the uevent is sent */
+            if (event == IntelHotplugHandler::EVENT_PLUG_IN) {
+                fake_drm.hdmi_connection = DRM_MODE_CONNECTED;
+                plugins++;
+            } else {
+                fake_drm.hdmi_connection = DRM_MODE_DISCONNECTED;
+            }
+            if (threaded)
+                handler->post(event, NULL);
+            else
+                composer.handleHotplugEvent(event, NULL);
+            t = now() - start;
+            if (t > worstPost)
+                worstPost = t;
+        }
+
+        /* prepare + set */
+        usleep(COMPOSE_MS * 1000);
+
+        t = now();
+        if (t - last > worst)
+            worst = t - last;
+        last = t;
+        t = ms2ns(FRAME_MS) - (t - start);
+        if (t > 0)
+            usleep(ns2us(t));
+    }
+
+    if (threaded) {
+        CHECK(wait_events(&composer, posted, 1000));
+        handler->requestExit();
+        handler->join();
+    }
+
+    printf("%-8s %d hotplugs, %d modesets, %d ioctls: event delivery up "
+           "to %lld us, longest frame %lld ms\n",
+           threaded ? "handler" : "inline", posted, fake_drm.modesets,
+           fake_drm.ioctls, (long long)ns2us(worstPost),
+           (long long)ns2ms(worst));
+
+    /* inline, a plug in stalls its frame for the probe and the modeset */
+    if (threaded)
+        CHECK(ns2ms(worst) < (PROBE_MS + MODESET_MS) / 2);
+    else
+        CHECK(ns2ms(worst) >= PROBE_MS + MODESET_MS);
+    CHECK(composer.getHandled() == posted);
+    CHECK(composer.failed == 0);
+    CHECK(fake_drm.modesets == plugins);
+    CHECK(fake_drm.crtc_buffers[1] == HDMI_FB_ID);
+}
+
+int main(int argc, char **argv)
+{
+    bool benchmark = argc > 1 && !strcmp(argv[1], "-b");
+
+    test_order();
+    test_exit_idle();
+    test_exit_busy();
+    if (benchmark) {
+        bench(false);
+        bench(true);
+    }
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("hotplug_handler_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,395 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host test for IntelLayerGeometry: the overlap masks the sweep builds,
+ * and everything answered from them, match testing every pair of
+ * display frames, for random lists both below and above MAX_LAYERS.
+ * A layer reported occluded must be covered pixel for pixel by the
+ * opaque layers above it.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <IntelLayerGeometry.h>
+#include <IntelHWComposerCfg.h>
+
+/* defined by IntelHWComposerModule.cpp in the HAL */
+hwc_cfg cfg;
+
+#define MAX_LIST        130
+#define GRID_SIZE       64
+
+static int failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+static IMG_native_handle_t rgba = { HAL_PIXEL_FORMAT_RGBA_8888 };
+static IMG_native_handle_t rgbx = { HAL_PIXEL_FORMAT_RGBX_8888 };
+
+static hwc_display_contents_1_t* alloc_list()
+{
+    size_t size = sizeof(hwc_display_contents_1_t) +
+                  MAX_LIST * sizeof(hwc_layer_1_t);
+    return (hwc_display_contents_1_t*)calloc(1, size);
+}
+
+static bool empty(const hwc_rect_t& r)
+{
+    return r.right <= r.left || r.bottom <= r.top;
+}
+
+static bool overlap(const hwc_rect_t& a, const hwc_rect_t& b)
+{
+    if (empty(a) || empty(b))
+        return false;
+    return a.left < b.right && b.left < a.right &&
+           a.top < b.bottom && b.top < a.bottom;
+}
+
+static bool covers(const hwc_rect_t& outer, const hwc_rect_t& inner)
+{
+    return outer.left <= inner.left && outer.top <= inner.top &&
+           outer.right >= inner.right && outer.bottom >= inner.bottom;
+}
+
+static bool opaque(const hwc_layer_1_t& layer)
+{
+    if (layer.planeAlpha != 0xff)
+        return false;
+    return layer.blending == HWC_BLENDING_NONE || layer.handle == &rgbx;
+}
+
+static void set_frame(hwc_layer_1_t& layer, int l, int t, int r, int b)
+{
+    layer.displayFrame.left = l;
+    layer.displayFrame.top = t;
+    layer.displayFrame.right = r;
+    layer.displayFrame.bottom = b;
+}
+
+// n layers and a framebuffer target of size x size. Coarse grids give
+// frames sharing edges, some frames are empty and some cover it all
+static void random_list(hwc_display_contents_1_t *list, int n, int size)
+{
+    list->numHwLayers = n + 1;
+
+    for (int i = 0; i < n; i++) {
+        hwc_layer_1_t& layer = list->hwLayers[i];
+        int grid = rand() % 3 ? size / 10 : 8;
+        int step = size / grid;
+        int l = rand() % grid * step;
+        int t = rand() % grid * step;
+
+        memset(&layer, 0, sizeof(layer));
+        set_frame(layer, l, t, l + rand() % (grid / 2 + 1) * step,
+                  t + rand() % (grid / 2 + 1) * step);
+        if (rand() % 20 == 0)
+            set_frame(layer, 0, 0, size, size);
+        if (rand() % 30 == 0)
+            set_frame(layer, l, t, l - step, t + step);
+        layer.blending = rand() % 2 ? HWC_BLENDING_NONE : HWC_BLENDING_PREMULT;
+        layer.handle = (buffer_handle_t)(rand() % 2 ? &rgba : &rgbx);
+        layer.planeAlpha = rand() % 8 ? 0xff : 0x80;
+    }
+
+    hwc_layer_1_t& target = list->hwLayers[n];
+    memset(&target, 0, sizeof(target));
+    target.compositionType = HWC_FRAMEBUFFER_TARGET;
+    set_frame(target, 0, 0, size, size);
+}
+
+static void check_list(hwc_display_contents_1_t *list, int n)
+{
+    IntelLayerGeometry geometry;
+    geometry.update(list, n);
+
+    const hwc_rect_t& display = list->hwLayers[n].displayFrame;
+    int cover = -1;
+    for (int i = n - 1; i >= 0 && cover < 0; i--) {
+        if (opaque(list->hwLayers[i]) &&
+            covers(list->hwLayers[i].displayFrame, display))
+            cover = i;
+    }
+    CHECK(geometry.getOpaqueCover() == cover);
+
+    uint32_t pairs = 0;
+    for (int i = 0; i < n; i++) {
+        const hwc_rect_t& r = list->hwLayers[i].displayFrame;
+        uint64_t below = 0, above = 0;
+
+        for (int j = 0; j < n; j++) {
+            if (j == i)
+                continue;
+            bool x = overlap(r, list->hwLayers[j].displayFrame);
+            if (geometry.intersects(i, j) != x) {
+                fprintf(stderr, "%d layers: %d and %d\n", n, i, j);
+                failures++;
+            }
+            if (!x || j >= IntelLayerGeometry::MAX_LAYERS)
+                continue;
+            if (j < i)
+                below |= IntelLayerGeometry::bit(j);
+            else
+                above |= IntelLayerGeometry::bit(j);
+            if (j > i)
+                pairs++;
+        }
+
+        if (i < IntelLayerGeometry::MAX_LAYERS) {
+            CHECK(geometry.getOverlapsBelow(i) == below);
+            CHECK(geometry.getOverlapsAbove(i) == above);
+            CHECK(geometry.getOverlaps(i) == (below | above));
+            CHECK(geometry.isSandwiched(i) == (below && above));
+        }
+    }
+
+    if (n <= IntelLayerGeometry::MAX_LAYERS)
+        CHECK(geometry.getOverlapPairs() == pairs);
+
+    // out of range
+    CHECK(!geometry.intersects(-1, 0));
+    CHECK(!geometry.intersects(0, n));
+    CHECK(geometry.getOverlaps(n) == 0);
+}
+
+static void test_random()
+{
+    hwc_display_contents_1_t *list = alloc_list();
+
+    srand(7);
+    for (int iter = 0; iter < 20000; iter++) {
+        // one list in ten past MAX_LAYERS
+        int n = 1 + rand() % (iter % 10 ? 30 : MAX_LIST - 1);
+        random_list(list, n, 1000);
+        check_list(list, n);
+    }
+
+    free(list);
+}
+
+static void test_edges()
+{
+    hwc_display_contents_1_t *list = alloc_list();
+    IntelLayerGeometry geometry;
+
+    // frames that only touch don't overlap
+    list->numHwLayers = 4;
+    memset(list->hwLayers, 0, 4 * sizeof(hwc_layer_1_t));
+    set_frame(list->hwLayers[0], 0, 0, 100, 100);
+    set_frame(list->hwLayers[1], 100, 0, 200, 100);
+    set_frame(list->hwLayers[2], 0, 100, 100, 200);
+    list->hwLayers[3].compositionType = HWC_FRAMEBUFFER_TARGET;
+    set_frame(list->hwLayers[3], 0, 0, 200, 200);
+    geometry.update(list, 3);
+    CHECK(!geometry.intersects(0, 1));
+    CHECK(!geometry.intersects(0, 2));
+    CHECK(!geometry.intersects(1, 2));
+    CHECK(geometry.getOverlapPairs() == 0);
+
+    // a frame spanning the others' rows is sandwiched
+    set_frame(list->hwLayers[1], 50, 50, 60, 150);
+    set_frame(list->hwLayers[2], 55, 140, 300, 145);
+    geometry.update(list, 3);
+    CHECK(geometry.isSandwiched(1));
+    CHECK(!geometry.isSandwiched(0));
+    CHECK(!geometry.isSandwiched(2));
+    CHECK(geometry.getOverlapPairs() == 2);
+
+    // nothing to do without a list
+    geometry.update(0, 3);
+    CHECK(!geometry.intersects(0, 1));
+    CHECK(geometry.getOpaqueCover() == -1);
+
+    free(list);
+}
+
+// pixel exact: every pixel of the frame under an opaque layer above it
+static bool covered(hwc_display_contents_1_t *list, int n, int index)
+{
+    // random frames reach past the display, up to half its size
+    static unsigned char grid[GRID_SIZE * 2][GRID_SIZE * 2];
+    const hwc_rect_t& r = list->hwLayers[index].displayFrame;
+
+    if (empty(r))
+        return false;
+
+    memset(grid, 0, sizeof(grid));
+    for (int j = index + 1; j < n; j++) {
+        const hwc_rect_t& s = list->hwLayers[j].displayFrame;
+        if (!opaque(list->hwLayers[j]))
+            continue;
+        for (int y = s.top; y < s.bottom; y++)
+            for (int x = s.left; x < s.right; x++)
+                grid[y][x] = 1;
+    }
+
+    for (int y = r.top; y < r.bottom; y++)
+        for (int x = r.left; x < r.right; x++)
+            if (!grid[y][x])
+                return false;
+    return true;
+}
+
+static void test_occlusion_random()
+{
+    hwc_display_contents_1_t *list = alloc_list();
+    uint32_t checks = 0, occluded = 0, kept = 0;
+
+    srand(3);
+    for (int iter = 0; iter < 20000; iter++) {
+        int n = 1 + rand() % (iter % 20 ? 12 : 90);
+        random_list(list, n, GRID_SIZE);
+
+        IntelLayerGeometry geometry;
+        geometry.update(list, n);
+
+        for (int i = 0; i < n; i++) {
+            bool hidden = covered(list, n, i);
+            bool got = geometry.isOccluded(i);
+
+            // culling a visible layer loses pixels, keeping a hidden
+            // one only costs bandwidth
+            if (got && !hidden) {
+                fprintf(stderr, "%d layers: %d occluded but visible\n", n, i);
+                failures++;
+            }
+            checks++;
+            occluded += got;
+            kept += hidden && !got;
+        }
+    }
+
+    printf("occlusion: %u layers, %u occluded, %u covered but kept\n",
+           checks, occluded, kept);
+    CHECK(occluded > 0);
+    CHECK(kept < checks / 100);
+
+    free(list);
+}
+
+static void test_occlusion_cases()
+{
+    hwc_display_contents_1_t *list = alloc_list();
+    IntelLayerGeometry geometry;
+
+    list->numHwLayers = 4;
+    memset(list->hwLayers, 0, 4 * sizeof(hwc_layer_1_t));
+    for (int i = 0; i < 3; i++) {
+        list->hwLayers[i].blending = HWC_BLENDING_NONE;
+        list->hwLayers[i].planeAlpha = 0xff;
+        list->hwLayers[i].handle = (buffer_handle_t)&rgba;
+    }
+    list->hwLayers[3].compositionType = HWC_FRAMEBUFFER_TARGET;
+    set_frame(list->hwLayers[3], 0, 0, 200, 200);
+
+    // wallpaper under two opaque halves, neither covers it alone
+    set_frame(list->hwLayers[0], 0, 0, 200, 200);
+    set_frame(list->hwLayers[1], 0, 0, 200, 100);
+    set_frame(list->hwLayers[2], 0, 100, 200, 200);
+    geometry.update(list, 3);
+    CHECK(geometry.isOccluded(0));
+    CHECK(!geometry.isOccluded(1));
+    CHECK(!geometry.isOccluded(2));
+    CHECK(geometry.getOpaqueCover() == 0);
+
+    // a one pixel gap keeps it
+    set_frame(list->hwLayers[2], 0, 101, 200, 200);
+    geometry.update(list, 3);
+    CHECK(!geometry.isOccluded(0));
+
+    // translucent layers don't hide anything
+    set_frame(list->hwLayers[2], 0, 100, 200, 200);
+    list->hwLayers[2].planeAlpha = 0x80;
+    geometry.update(list, 3);
+    CHECK(!geometry.isOccluded(0));
+    list->hwLayers[2].planeAlpha = 0xff;
+
+    // blending only matters with per pixel alpha
+    list->hwLayers[2].blending = HWC_BLENDING_PREMULT;
+    geometry.update(list, 3);
+    CHECK(!geometry.isOccluded(0));
+    list->hwLayers[2].handle = (buffer_handle_t)&rgbx;
+    geometry.update(list, 3);
+    CHECK(geometry.isOccluded(0));
+    list->hwLayers[2].handle = 0;
+    geometry.update(list, 3);
+    CHECK(!geometry.isOccluded(0));
+
+    // layers below don't hide the ones above
+    list->hwLayers[2].blending = HWC_BLENDING_NONE;
+    set_frame(list->hwLayers[0], 50, 50, 60, 60);
+    set_frame(list->hwLayers[1], 0, 0, 200, 200);
+    geometry.update(list, 3);
+    CHECK(geometry.isOccluded(0));
+    CHECK(!geometry.isOccluded(1));
+    CHECK(!geometry.isOccluded(2));
+
+    // an empty frame is never occluded
+    set_frame(list->hwLayers[0], 50, 50, 50, 60);
+    geometry.update(list, 3);
+    CHECK(!geometry.isOccluded(0));
+
+    free(list);
+}
+
+int main()
+{
+    test_edges();
+    test_random();
+    test_occlusion_cases();
+    test_occlusion_random();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("layer_geometry_test: all checks passed\n");
+    return 0;
+}
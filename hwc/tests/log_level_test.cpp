@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host test for the merrifield log level cache against a counting
+ * property_get. A suppressed VLOG/DLOG/ILOG/WLOG must not look up a
+ * property nor evaluate its arguments, and a level published by
+ * HwcConfig::reload() must apply to the next call.
+ *
+ * With -b it also times suppressed calls through the old path, a
+ * property_get() and atoi() per call as Log::v() used to do, against
+ * Log::isLoggable(), and reports the cost and property lookups per
+ * call of each.
+ *
+ * usage: log_level_test [-b]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cutils/properties.h>
+#include <utils/Timers.h>
+
+#include <HwcConfig.h>
+#include <Log.h>
+
+using namespace android;
+using namespace android::intel;
+
+#define CALLS           1000
+#define BENCH_CALLS     1000000
+
+static int failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+static char logLevel[PROPERTY_VALUE_MAX] = "4";
+static volatile int propReads;
+
+extern "C" int property_get(const char *key, char *value,
+                            const char *default_value)
+{
+    propReads++;
+    if (!strcmp(key, HWC_CONFIG_DEBUG_LOG_LEVEL)) {
+        strcpy(value, logLevel);
+        return strlen(value);
+    }
+    strcpy(value, default_value);
+    return strlen(value);
+}
+
+static Log& log = Log::getInstance();
+static int evaluated;
+
+static int arg()
+{
+    return ++evaluated;
+}
+
+// what Log::v() did for every call before the level was cached
+static void oldVerbose(const char *fmt, ...)
+{
+    char value[PROPERTY_VALUE_MAX];
+
+    property_get(HWC_CONFIG_DEBUG_LOG_LEVEL, value,
+                 HWC_CONFIG_DEFAULT_LOG_LEVEL);
+    if (atoi(value) <= HwcConfig::DEBUG_LOG_VERBOSE)
+        fprintf(stderr, "unexpected\n");
+}
+
+static void setLevel(const char *level)
+{
+    strcpy(logLevel, level);
+    // the frame before moves off the old snapshot, so it is not deferred
+    HwcConfig::getInstance().beginFrame();
+    HwcConfig::getInstance().reload();
+    HwcConfig::getInstance().beginFrame();
+}
+
+static void test_suppressed()
+{
+    setLevel("4");
+    CHECK(!Log::isLoggable(HwcConfig::DEBUG_LOG_WARNING));
+    CHECK(Log::isLoggable(HwcConfig::DEBUG_LOG_ERROR));
+
+    int before = propReads;
+    evaluated = 0;
+    for (int i = 0; i < CALLS; i++) {
+        VLOG("verbose %d", arg());
+        DLOG("debug %d", arg());
+        ILOG("info %d", arg());
+        WLOG("warning %d", arg());
+    }
+    CHECK(propReads == before);
+    CHECK(evaluated == 0);
+
+    // direct calls check the cached level too
+    for (int i = 0; i < CALLS; i++)
+        log.v("verbose %d", i);
+    CHECK(propReads == before);
+}
+
+static void test_level_change()
+{
+    setLevel("0");
+    CHECK(Log::isLoggable(HwcConfig::DEBUG_LOG_VERBOSE));
+
+    evaluated = 0;
+    VLOG("verbose %d", arg());
+    CHECK(evaluated == 1);
+
+    setLevel("3");
+    CHECK(!Log::isLoggable(HwcConfig::DEBUG_LOG_INFO));
+    CHECK(Log::isLoggable(HwcConfig::DEBUG_LOG_WARNING));
+
+    evaluated = 0;
+    ILOG("info %d", arg());
+    WLOG("warning %d", arg());
+    CHECK(evaluated == 1);
+}
+
+static void bench()
+{
+    nsecs_t start, oldTime, newTime;
+    int before, oldReads, newReads;
+
+    setLevel("4");
+
+    before = propReads;
+    start = systemTime(SYSTEM_TIME_MONOTONIC);
+    for (int i = 0; i < BENCH_CALLS; i++)
+        oldVerbose("verbose %d", i);
+    oldTime = systemTime(SYSTEM_TIME_MONOTONIC) - start;
+    oldReads = propReads - before;
+
+    before = propReads;
+    start = systemTime(SYSTEM_TIME_MONOTONIC);
+    for (int i = 0; i < BENCH_CALLS; i++)
+        VLOG("verbose %d", i);
+    newTime = systemTime(SYSTEM_TIME_MONOTONIC) - start;
+    newReads = propReads - before;
+
+    printf("suppressed call, property_get: %.1f ns, %.2f lookups\n",
+           (double)oldTime / BENCH_CALLS, (double)oldReads / BENCH_CALLS);
+    printf("suppressed call, isLoggable:   %.1f ns, %.2f lookups\n",
+           (double)newTime / BENCH_CALLS, (double)newReads / BENCH_CALLS);
+    CHECK(oldReads == BENCH_CALLS);
+    CHECK(newReads == 0);
+}
+
+int main(int argc, char **argv)
+{
+    bool benchmark = argc > 1 && !strcmp(argv[1], "-b");
+
+    test_suppressed();
+    test_level_change();
+    if (benchmark)
+        bench();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("log_level_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host test for IntelLruCache as WiDi uses it for the decoder payload
+ * mappings: a decoder cycling through its surfaces only misses on the
+ * first round, the least recently used mapping is the one unmapped,
+ * and a mapping still held by the WiDi stack outlives its eviction.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IntelLruCache.h>
+
+static int failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+enum {
+    CACHE_SIZE = 24,
+    DECODER_SURFACES = 16,
+};
+
+// stands in for a payload mapping, counts the ones still mapped
+class FakeMapping : public android::RefBase {
+public:
+    static int mapped;
+    uint64_t stamp;
+    FakeMapping(uint64_t s) : stamp(s) { mapped++; }
+    virtual ~FakeMapping() { mapped--; }
+};
+
+int FakeMapping::mapped;
+
+typedef IntelLruCache<uint64_t, FakeMapping> Cache;
+
+// what WidiDisplayDevice::getMappedBuffer() does
+static android::sp<FakeMapping> map(Cache& cache, uint64_t stamp)
+{
+    android::sp<FakeMapping> mapping = cache.get(stamp);
+    if (mapping == NULL) {
+        mapping = new FakeMapping(stamp);
+        cache.add(stamp, mapping);
+    }
+    return mapping;
+}
+
+static void test_decoder_cycle()
+{
+    Cache cache(CACHE_SIZE);
+
+    for (int round = 0; round < 10; round++)
+        for (uint64_t s = 1; s <= DECODER_SURFACES; s++)
+            CHECK(map(cache, s)->stamp == s);
+
+    CHECK(cache.stats().misses == DECODER_SURFACES);
+    CHECK(cache.stats().hits == 9 * DECODER_SURFACES);
+    CHECK(cache.stats().evictions == 0);
+    CHECK(FakeMapping::mapped == DECODER_SURFACES);
+
+    // the decoder reallocates its surfaces, new stamps even where the
+    // fd numbers come back the same
+    for (int round = 0; round < 2; round++)
+        for (uint64_t s = 101; s <= 100 + DECODER_SURFACES; s++)
+            map(cache, s);
+
+    CHECK(cache.size() == CACHE_SIZE);
+    CHECK(FakeMapping::mapped == CACHE_SIZE);
+    CHECK(cache.stats().misses == 2 * DECODER_SURFACES);
+    CHECK(cache.stats().evictions == 2 * DECODER_SURFACES - CACHE_SIZE);
+
+    // the old surfaces went first, all of the new ones are kept
+    for (uint64_t s = 101; s <= 100 + DECODER_SURFACES; s++)
+        CHECK(cache.get(s) != NULL);
+
+    cache.clear();
+    CHECK(FakeMapping::mapped == 0);
+}
+
+static void test_lru_order()
+{
+    Cache cache(3);
+
+    map(cache, 1);
+    map(cache, 2);
+    map(cache, 3);
+    // 1 used again, 2 is now the least recently used
+    map(cache, 1);
+    map(cache, 4);
+
+    CHECK(cache.get(2) == NULL);
+    CHECK(cache.get(1) != NULL);
+    CHECK(cache.get(3) != NULL);
+    CHECK(cache.get(4) != NULL);
+    CHECK(cache.stats().evictions == 1);
+
+    // adding a key already present replaces it without evicting
+    cache.add(4, new FakeMapping(4));
+    CHECK(cache.size() == 3);
+    CHECK(cache.stats().evictions == 1);
+}
+
+static void test_held_past_eviction()
+{
+    Cache cache(2);
+    android::sp<FakeMapping> held;
+    int before = FakeMapping::mapped;
+
+    // the widi stack still holds the frame of stamp 1
+    held = map(cache, 1);
+    map(cache, 2);
+    map(cache, 3);
+
+    CHECK(cache.get(1) == NULL);
+    CHECK(held->stamp == 1);
+    CHECK(FakeMapping::mapped == before + 3);
+
+    // returned, now unmapped
+    held.clear();
+    CHECK(FakeMapping::mapped == before + 2);
+}
+
+int main()
+{
+    test_decoder_cycle();
+    test_lru_order();
+    test_held_past_eviction();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("lru_cache_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host test for IntelOverlayBackBufferSync: after every sync the
+ * hardware back buffer holds exactly what rewriting all of it would
+ * have left there, only changed registers are written, and the
+ * coefficients are reloaded when they changed, when the overlay is
+ * turned on and after the state was invalidated.
+ */
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <IntelOverlayBackBufferSync.h>
+
+static int failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+enum {
+    REG_COUNT = offsetof(intel_overlay_back_buffer_t, RESERVEDC) / sizeof(uint32_t),
+    OCMD = offsetof(intel_overlay_back_buffer_t, OCMD) / sizeof(uint32_t),
+};
+
+static uint32_t* regs(intel_overlay_back_buffer_t *buf)
+{
+    return (uint32_t*)buf;
+}
+
+static bool identical(const intel_overlay_back_buffer_t *a,
+                      const intel_overlay_back_buffer_t *b)
+{
+    return !memcmp(a, b, sizeof(*a));
+}
+
+static void test_unchanged()
+{
+    static intel_overlay_back_buffer_t shadow, hw;
+    IntelOverlayBackBufferSync sync;
+
+    memset(&shadow, 0, sizeof(shadow));
+    memset(&hw, 0, sizeof(hw));
+    sync.reset(&hw);
+
+    shadow.OCMD = OVERLAY_ENABLE;
+    shadow.DWINPOS = (100 << 16) | 20;
+    shadow.Y_VCOEFS[0] = 0x3000;
+    CHECK(sync.sync(&shadow, &hw));
+    CHECK(identical(&shadow, &hw));
+    CHECK(sync.getLastDirtyRegCount() == 2);
+
+    // same frame again: nothing written, no reload
+    CHECK(!sync.sync(&shadow, &hw));
+    CHECK(sync.getLastDirtyRegCount() == 0);
+
+    // a move only writes the position
+    shadow.DWINPOS = (120 << 16) | 20;
+    CHECK(!sync.sync(&shadow, &hw));
+    CHECK(sync.getLastDirtyRegCount() == 1);
+    CHECK(identical(&shadow, &hw));
+
+    CHECK(sync.getSyncCount() == 3);
+    CHECK(sync.getDirtySyncCount() == 2);
+    CHECK(sync.getDirtyRegCount() == 3);
+    CHECK(sync.getCoeffLoadCount() == 1);
+}
+
+static void test_random()
+{
+    static intel_overlay_back_buffer_t shadow, hw;
+    IntelOverlayBackBufferSync sync;
+    bool enabled = false;
+    int mismatches = 0, reloadErrors = 0;
+
+    srand(44);
+    memset(&shadow, 0, sizeof(shadow));
+    memset(&hw, 0, sizeof(hw));
+    sync.reset(&hw);
+
+    for (int frame = 0; frame < 20000; frame++) {
+        bool coeffChanged = false, turnedOn = false, invalidated = false;
+
+        // a few registers per frame, like a move or a new buffer
+        int n = rand() % 4;
+        for (int i = 0; i < n; i++) {
+            int reg = rand() % REG_COUNT;
+            if (reg != OCMD)
+                regs(&shadow)[reg] = rand() % 3 ? rand() : regs(&shadow)[reg];
+        }
+
+        // scaling changes reprogram the filter, sometimes to the same values
+        if (rand() % 20 == 0) {
+            uint16_t c = rand() % 4 ? rand() : shadow.UV_HCOEFS[5];
+            coeffChanged = c != shadow.UV_HCOEFS[5];
+            shadow.UV_HCOEFS[5] = c;
+        }
+
+        if (rand() % 50 == 0) {
+            enabled = !enabled;
+            turnedOn = enabled;
+            if (enabled)
+                shadow.OCMD |= OVERLAY_ENABLE;
+            else
+                shadow.OCMD &= ~OVERLAY_ENABLE;
+        }
+
+        // DPMS off: the hardware copy no longer holds what was synced
+        if (rand() % 200 == 0) {
+            memset(&hw, 0xa5, offsetof(intel_overlay_back_buffer_t, RESERVEDC));
+            sync.invalidate();
+            invalidated = true;
+        }
+
+        bool reload = sync.sync(&shadow, &hw);
+        if (!identical(&shadow, &hw))
+            mismatches++;
+        if (reload != (coeffChanged || turnedOn || invalidated))
+            reloadErrors++;
+    }
+
+    CHECK(mismatches == 0);
+    CHECK(reloadErrors == 0);
+}
+
+static void test_invalidate()
+{
+    static intel_overlay_back_buffer_t shadow, hw;
+    IntelOverlayBackBufferSync sync;
+
+    memset(&shadow, 0, sizeof(shadow));
+    memset(&hw, 0, sizeof(hw));
+    sync.reset(&hw);
+
+    shadow.OCMD = OVERLAY_ENABLE;
+    shadow.OSTRIDE = 1920;
+    shadow.Y_HCOEFS[3] = 0x1234;
+    CHECK(sync.sync(&shadow, &hw));
+
+    // without invalidating, nothing changed means nothing written and
+    // the coefficients aren't reloaded, even if the overlay lost them
+    memset(&hw, 0, sizeof(hw));
+    CHECK(!sync.sync(&shadow, &hw));
+    CHECK(!identical(&shadow, &hw));
+
+    sync.invalidate();
+    CHECK(sync.sync(&shadow, &hw));
+    CHECK(identical(&shadow, &hw));
+    CHECK(sync.getLastDirtyRegCount() == REG_COUNT);
+
+    // and back to writing only what changes
+    CHECK(!sync.sync(&shadow, &hw));
+    CHECK(sync.getLastDirtyRegCount() == 0);
+}
+
+static void test_reset()
+{
+    static intel_overlay_back_buffer_t shadow, hw;
+    IntelOverlayBackBufferSync sync;
+
+    // a context opened by the overlay HAL starts from what the creator
+    // programmed, the same shadow writes nothing
+    memset(&hw, 0, sizeof(hw));
+    hw.OCMD = OVERLAY_ENABLE;
+    hw.OSTRIDE = 1280;
+    hw.Y_VCOEFS[1] = 0x2222;
+    memcpy(&shadow, &hw, sizeof(hw));
+    sync.reset(&hw);
+
+    CHECK(!sync.sync(&shadow, &hw));
+    CHECK(sync.getLastDirtyRegCount() == 0);
+
+    // an empty sync doesn't crash
+    CHECK(!sync.sync(0, &hw));
+    CHECK(!sync.sync(&shadow, 0));
+}
+
+int main()
+{
+    test_unchanged();
+    test_random();
+    test_invalidate();
+    test_reset();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("overlay_back_buffer_sync_test: all checks passed\n");
+    return 0;
+}
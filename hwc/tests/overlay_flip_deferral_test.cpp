@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host test for the overlay flip deferral, run against fake_wsbm.c: a
+ * busy video buffer keeps the frame shown at most once in a row, no
+ * flip is deferred before a frame is shown or after the plane was
+ * disabled, and a failed idle query doesn't block.
+ */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <IntelWsbm.h>
+#include <IntelFlipDeferral.h>
+
+#include "fake_wsbm.h"
+
+static int failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+enum {
+    DECODER_BUFFERS = 4,
+};
+
+/* The part of IntelOverlayPlane::setDataBuffer() and flip() this is
+ * about: the plane posts the buffer it shows after every flip.
+ */
+struct Plane {
+    IntelWsbm& wsbm;
+    IntelFlipDeferral deferral;
+    void *shown;
+
+    Plane(IntelWsbm& w) : wsbm(w), shown(0) {}
+
+    // returns the buffer posted for this frame
+    void* present(void *buf) {
+        switch (deferral.check(wsbm.isIdleTTMBuffer(buf))) {
+        case IntelFlipDeferral::FLIP_DEFERRED:
+            break;
+        case IntelFlipDeferral::FLIP_AFTER_WAIT:
+            wsbm.waitIdleTTMBuffer(buf);
+            // fall through
+        default:
+            shown = buf;
+            deferral.flipped();
+            break;
+        }
+        return shown;
+    }
+
+    void disable() {
+        shown = 0;
+        deferral.reset();
+    }
+};
+
+static void test_first_frame()
+{
+    IntelWsbm wsbm(0);
+    Plane plane(wsbm);
+    void *buf;
+    struct fake_wsbm_stats before = fake_wsbm_stats;
+
+    wsbm.wrapTTMBuffer(0x100, &buf);
+    fake_wsbm_set_busy(buf, 1);
+
+    // nothing on screen to keep, the first frame is waited for
+    CHECK(plane.present(buf) == buf);
+    CHECK(plane.deferral.getDeferrals() == 0);
+    CHECK(fake_wsbm_stats.waits - before.waits == 1);
+
+    wsbm.unreferenceTTMBuffer(buf);
+}
+
+static void test_one_deferral_in_a_row()
+{
+    IntelWsbm wsbm(0);
+    Plane plane(wsbm);
+    void *buf[DECODER_BUFFERS];
+    struct fake_wsbm_stats before = fake_wsbm_stats;
+
+    for (int i = 0; i < DECODER_BUFFERS; i++)
+        wsbm.wrapTTMBuffer(0x100 + i, &buf[i]);
+
+    CHECK(plane.present(buf[0]) == buf[0]);
+
+    // busy: the shown buffer is posted again, it stays pinned
+    fake_wsbm_set_busy(buf[1], 1);
+    CHECK(plane.present(buf[1]) == buf[0]);
+    CHECK(plane.deferral.isDeferred());
+    CHECK(fake_wsbm_stats.waits == before.waits);
+
+    // still busy on the next frame: waited for, not deferred again
+    CHECK(plane.present(buf[1]) == buf[1]);
+    CHECK(!plane.deferral.isDeferred());
+    CHECK(fake_wsbm_stats.waits - before.waits == 1);
+
+    // a deferred frame followed by an idle one flips right away
+    fake_wsbm_set_busy(buf[2], 1);
+    CHECK(plane.present(buf[2]) == buf[1]);
+    fake_wsbm_set_busy(buf[2], 0);
+    CHECK(plane.present(buf[2]) == buf[2]);
+    CHECK(fake_wsbm_stats.waits - before.waits == 1);
+    CHECK(plane.deferral.getDeferrals() == 2);
+
+    for (int i = 0; i < DECODER_BUFFERS; i++)
+        wsbm.unreferenceTTMBuffer(buf[i]);
+}
+
+static void test_playback()
+{
+    IntelWsbm wsbm(0);
+    Plane plane(wsbm);
+    void *buf[DECODER_BUFFERS];
+    int deferredInARow = 0, maxDeferredInARow = 0;
+    struct fake_wsbm_stats before = fake_wsbm_stats;
+
+    for (int i = 0; i < DECODER_BUFFERS; i++)
+        wsbm.wrapTTMBuffer(0x100 + i, &buf[i]);
+
+    // the decoder is late with every other frame, and the frame after
+    // the first late one of a pair is late as well
+    for (int frame = 0; frame < 300; frame++) {
+        void *b = buf[frame % DECODER_BUFFERS];
+        void *prev = plane.shown;
+        bool busy = frame % 2 || frame % 12 == 4;
+
+        fake_wsbm_set_busy(b, busy);
+        void *posted = plane.present(b);
+        if (posted != b) {
+            CHECK(posted == prev);
+            deferredInARow++;
+        } else {
+            deferredInARow = 0;
+        }
+        if (deferredInARow > maxDeferredInARow)
+            maxDeferredInARow = deferredInARow;
+        // nothing posted is still being written
+        CHECK(wsbm.isIdleTTMBuffer(posted));
+    }
+
+    CHECK(maxDeferredInARow == 1);
+    CHECK(plane.deferral.getDeferrals() > 0);
+    CHECK(plane.deferral.getWaits() == fake_wsbm_stats.waits - before.waits);
+
+    for (int i = 0; i < DECODER_BUFFERS; i++)
+        wsbm.unreferenceTTMBuffer(buf[i]);
+}
+
+static void test_disable()
+{
+    IntelWsbm wsbm(0);
+    Plane plane(wsbm);
+    void *buf[2];
+    struct fake_wsbm_stats before = fake_wsbm_stats;
+
+    wsbm.wrapTTMBuffer(0x100, &buf[0]);
+    wsbm.wrapTTMBuffer(0x101, &buf[1]);
+
+    CHECK(plane.present(buf[0]) == buf[0]);
+    plane.disable();
+
+    // the frame shown before is gone, nothing to keep
+    fake_wsbm_set_busy(buf[1], 1);
+    CHECK(plane.present(buf[1]) == buf[1]);
+    CHECK(plane.deferral.getDeferrals() == 0);
+    CHECK(fake_wsbm_stats.waits - before.waits == 1);
+
+    wsbm.unreferenceTTMBuffer(buf[0]);
+    wsbm.unreferenceTTMBuffer(buf[1]);
+}
+
+static void test_query_error()
+{
+    IntelWsbm wsbm(0);
+    Plane plane(wsbm);
+    void *buf[2];
+    struct fake_wsbm_stats before = fake_wsbm_stats;
+
+    wsbm.wrapTTMBuffer(0x100, &buf[0]);
+    wsbm.wrapTTMBuffer(0x101, &buf[1]);
+    CHECK(plane.present(buf[0]) == buf[0]);
+
+    // a failed query is taken as idle: neither deferred nor waited for
+    fake_wsbm_set_busy(buf[1], 1);
+    fake_wsbm_set_query_error(-EIO);
+    CHECK(wsbm.isIdleTTMBuffer(buf[1]));
+    CHECK(plane.present(buf[1]) == buf[1]);
+    CHECK(plane.deferral.getDeferrals() == 0);
+    CHECK(fake_wsbm_stats.waits == before.waits);
+    CHECK(fake_wsbm_stats.queries - before.queries == 3);
+    fake_wsbm_set_query_error(0);
+
+    wsbm.unreferenceTTMBuffer(buf[0]);
+    wsbm.unreferenceTTMBuffer(buf[1]);
+}
+
+int main()
+{
+    test_first_frame();
+    test_one_deferral_in_a_row();
+    test_playback();
+    test_disable();
+    test_query_error();
+
+    CHECK(fake_wsbm_stats.wraps == fake_wsbm_stats.unreferences);
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("overlay_flip_deferral_test: all checks passed\n");
+    return 0;
+}
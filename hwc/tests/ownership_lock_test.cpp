@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Multi-process stress test for IntelOwnershipLock. Forked writers
+ * update a record in shared memory under the lock, some of them nested,
+ * while readers read it without the lock and check that a read the
+ * generation lets through is never torn. Owners that exit with the lock
+ * held are taken over by writers and by readers, which must leave the
+ * lock free with an even generation.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include <IntelOwnershipLock.h>
+
+#define WRITERS         4
+#define READERS         2
+#define WRITES          20000
+#define READS           50000
+#define FIELDS          8
+
+typedef struct {
+    volatile int32_t owner;
+    volatile int32_t generation;
+    volatile uint32_t fields[FIELDS];
+    volatile uint32_t writes;
+    volatile uint32_t reads;
+    volatile uint32_t torn;
+    volatile uint32_t takeovers;
+} shared_t;
+
+static int failures;
+static shared_t *shared;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+static void writer(int id)
+{
+    IntelOwnershipLock lock;
+    lock.attach(&shared->owner, &shared->generation);
+
+    for (int i = 0; i < WRITES; i++) {
+        uint32_t value = (id << 24) | i;
+
+        lock.lock();
+        // nested like disable() from setDataBuffer()
+        if (i % 7 == 0)
+            lock.lock();
+        for (int f = 0; f < FIELDS; f++) {
+            shared->fields[f] = value;
+            if (f == FIELDS / 2 && i % 16 == 0)
+                sched_yield();
+        }
+        shared->writes++;
+        if (i % 7 == 0) {
+            lock.unlock();
+            if (!lock.isHeld())
+                __sync_fetch_and_add(&shared->torn, 1);
+        }
+        lock.unlock();
+    }
+
+    __sync_fetch_and_add(&shared->takeovers, lock.getTakeoverCount());
+}
+
+static void reader()
+{
+    IntelOwnershipLock lock;
+    lock.attach(&shared->owner, &shared->generation);
+
+    for (int i = 0; i < READS; i++) {
+        uint32_t values[FIELDS];
+        int32_t generation;
+
+        do {
+            generation = lock.readBegin();
+            for (int f = 0; f < FIELDS; f++)
+                values[f] = shared->fields[f];
+        } while (lock.readRetry(generation));
+
+        for (int f = 1; f < FIELDS; f++) {
+            if (values[f] != values[0]) {
+                __sync_fetch_and_add(&shared->torn, 1);
+                break;
+            }
+        }
+        __sync_fetch_and_add(&shared->reads, 1);
+    }
+
+    __sync_fetch_and_add(&shared->takeovers, lock.getTakeoverCount());
+}
+
+// takes the lock, leaves an update half done and exits
+static void dying_owner()
+{
+    IntelOwnershipLock lock;
+    lock.attach(&shared->owner, &shared->generation);
+
+    lock.lock();
+    shared->fields[0] = 0xdead;
+    _exit(0);
+}
+
+static pid_t spawn(void (*fn)(int), int id)
+{
+    pid_t pid = fork();
+    if (!pid) {
+        fn(id);
+        _exit(0);
+    }
+    return pid;
+}
+
+static void run_reader(int)
+{
+    reader();
+}
+
+static void run_dying_owner(int)
+{
+    dying_owner();
+}
+
+static void wait_all(pid_t *pids, int count)
+{
+    for (int i = 0; i < count; i++) {
+        int status;
+        CHECK(waitpid(pids[i], &status, 0) == pids[i]);
+        CHECK(WIFEXITED(status) && !WEXITSTATUS(status));
+    }
+}
+
+static void reset_shared()
+{
+    memset((void*)shared, 0, sizeof(*shared));
+}
+
+static void test_contention()
+{
+    pid_t pids[WRITERS + READERS + 1];
+    int count = 0;
+
+    reset_shared();
+
+    // one owner dies holding the lock before the others start
+    pids[count++] = spawn(run_dying_owner, 0);
+    wait_all(pids, 1);
+    count = 0;
+    CHECK(shared->owner != 0);
+    CHECK(shared->generation & 1);
+
+    for (int i = 0; i < WRITERS; i++)
+        pids[count++] = spawn(writer, i + 1);
+    for (int i = 0; i < READERS; i++)
+        pids[count++] = spawn(run_reader, 0);
+    wait_all(pids, count);
+
+    printf("contention: %u writes, %u reads, %u torn, %u takeovers\n",
+           shared->writes, shared->reads, shared->torn, shared->takeovers);
+
+    CHECK(shared->writes == WRITERS * WRITES);
+    CHECK(shared->reads == READERS * READS);
+    CHECK(shared->torn == 0);
+    CHECK(shared->takeovers == 1);
+    CHECK(shared->owner == 0);
+    CHECK(!(shared->generation & 1));
+}
+
+static void test_reader_takeover()
+{
+    pid_t pids[READERS];
+
+    reset_shared();
+
+    pid_t dead = spawn(run_dying_owner, 0);
+    wait_all(&dead, 1);
+
+    // only readers left, one of them has to free the lock
+    for (int i = 0; i < READERS; i++)
+        pids[i] = spawn(run_reader, 0);
+    wait_all(pids, READERS);
+
+    CHECK(shared->reads == READERS * READS);
+    CHECK(shared->takeovers >= 1);
+    CHECK(shared->owner == 0);
+    CHECK(!(shared->generation & 1));
+
+    // and a writer gets it afterwards without a takeover
+    IntelOwnershipLock lock;
+    lock.attach(&shared->owner, &shared->generation);
+    lock.lock();
+    CHECK(lock.isHeld());
+    CHECK(shared->generation & 1);
+    lock.unlock();
+    CHECK(lock.getTakeoverCount() == 0);
+    CHECK(shared->owner == 0);
+    CHECK(!(shared->generation & 1));
+}
+
+static void test_detached()
+{
+    IntelOwnershipLock lock;
+
+    // no context mapped, nothing to do
+    lock.lock();
+    CHECK(!lock.isHeld());
+    lock.unlock();
+    CHECK(lock.getAcquireCount() == 0);
+}
+
+int main()
+{
+    shared = (shared_t*)mmap(NULL, sizeof(shared_t), PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    test_detached();
+    test_contention();
+    test_reader_takeover();
+
+    munmap(shared, sizeof(shared_t));
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("ownership_lock_test: all checks passed\n");
+    return 0;
+}
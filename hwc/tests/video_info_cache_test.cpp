@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host test for IntelVideoInfoCache against a stub of the MultiDisplay
+ * service: one query per video state change, failed queries retried
+ * with a growing delay instead of being cached, and answers that raced
+ * with a state change dropped.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <IntelVideoInfoCache.h>
+#include <IntelHWComposerCfg.h>
+
+/* defined by IntelHWComposerModule.cpp in the HAL */
+hwc_cfg cfg;
+
+static int failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+class StubMds : public IntelVideoInfoSource {
+public:
+    int calls;
+    bool fail;
+    int fps;
+    // invalidate this cache from inside the query, as a video status
+    // notification arriving during the binder call would
+    IntelVideoInfoCache *raceWith;
+
+    StubMds() : calls(0), fail(false), fps(24), raceWith(NULL) {}
+
+    virtual bool queryVideoInfo(intel_video_info_t *info) {
+        calls++;
+        if (raceWith) {
+            raceWith->invalidate();
+            raceWith = NULL;
+        }
+        if (fail)
+            return false;
+        info->displayW = 1920;
+        info->displayH = 1080;
+        info->fps = fps;
+        info->isInterlace = 0;
+        return true;
+    }
+};
+
+static void test_cached(void)
+{
+    IntelVideoInfoCache cache;
+    StubMds mds;
+    intel_video_info_t info;
+
+    CHECK(cache.get(&mds, &info));
+    CHECK(info.displayW == 1920 && info.fps == 24);
+    for (int i = 0; i < 100; i++)
+        CHECK(cache.get(&mds, &info));
+    CHECK(mds.calls == 1);
+
+    /* a video status change is picked up on the next frame */
+    mds.fps = 30;
+    cache.invalidate();
+    CHECK(cache.get(&mds, &info));
+    CHECK(info.fps == 30);
+    CHECK(mds.calls == 2);
+
+    /* no service yet */
+    cache.invalidate();
+    CHECK(!cache.get(NULL, &info));
+    CHECK(cache.get(&mds, &info));
+    CHECK(mds.calls == 3);
+}
+
+static void test_retry(void)
+{
+    IntelVideoInfoCache cache;
+    StubMds mds;
+    intel_video_info_t info;
+    nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+    int frames = 0;
+
+    /* MDS keeps failing for half a second of 1 ms frames */
+    mds.fail = true;
+    while (systemTime(SYSTEM_TIME_MONOTONIC) - start < ms2ns(500)) {
+        CHECK(!cache.get(&mds, &info));
+        frames++;
+        usleep(1000);
+    }
+    /* 0, 16, 48, 112, 240, 496 ms */
+    printf("%d frames, %d queries while MDS failed\n", frames, mds.calls);
+    CHECK(mds.calls >= 4 && mds.calls <= 7);
+
+    /* the failure was not cached, the next retry gets the answer */
+    mds.fail = false;
+    start = systemTime(SYSTEM_TIME_MONOTONIC);
+    while (!cache.get(&mds, &info) &&
+           systemTime(SYSTEM_TIME_MONOTONIC) - start < ms2ns(1500))
+        usleep(1000);
+    CHECK(info.fps == 24);
+    int calls = mds.calls;
+    CHECK(cache.get(&mds, &info));
+    CHECK(mds.calls == calls);
+
+    /* a state change queries at once, whatever the previous backoff */
+    mds.fail = true;
+    cache.invalidate();
+    CHECK(!cache.get(&mds, &info));
+    CHECK(!cache.get(&mds, &info));
+    CHECK(mds.calls == calls + 1);
+    mds.fail = false;
+    cache.invalidate();
+    CHECK(cache.get(&mds, &info));
+    CHECK(mds.calls == calls + 2);
+}
+
+static void test_race(void)
+{
+    IntelVideoInfoCache cache;
+    StubMds mds;
+    intel_video_info_t info;
+
+    /* the answer predates the notification, it is not kept */
+    mds.raceWith = &cache;
+    CHECK(!cache.get(&mds, &info));
+    mds.fps = 50;
+    CHECK(cache.get(&mds, &info));
+    CHECK(info.fps == 50);
+    CHECK(mds.calls == 2);
+}
+
+int main(void)
+{
+    test_cached();
+    test_retry();
+    test_race();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("video_info_cache_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,379 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host test for IntelWidiStreamState: the layer WiDi streams for the
+ * list shapes prepare() sees, when the video fast path is taken and
+ * left, and which decoder frames count as already sent.
+ *
+ * With -b it also replays the streamed layer of a composition sequence
+ * through a stand-in for the per frame work of sendToWidi(), once
+ * sending every frame as before and once skipping the frames that
+ * kept the buffer sent last, and reports the CPU time per frame.
+ *
+ * usage: widi_stream_state_test [-b]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <utils/KeyedVector.h>
+#include <utils/RefBase.h>
+#include <utils/Timers.h>
+
+#include <IntelWidiStreamState.h>
+
+static int failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+enum {
+    MAX_LAYERS = 8,
+};
+
+static char handles[MAX_LAYERS];
+static const buffer_handle_t video = &handles[MAX_LAYERS - 1];
+
+// numLayers app layers plus the FRAMEBUFFER_TARGET
+static hwc_display_contents_1_t *make_list(size_t numLayers)
+{
+    size_t size = sizeof(hwc_display_contents_1_t) +
+                  (numLayers + 1) * sizeof(hwc_layer_1_t);
+    hwc_display_contents_1_t *list = (hwc_display_contents_1_t*)calloc(1, size);
+
+    list->numHwLayers = numLayers + 1;
+    list->flags = HWC_GEOMETRY_CHANGED;
+    for (size_t i = 0; i < numLayers; i++) {
+        list->hwLayers[i].compositionType = HWC_FRAMEBUFFER;
+        list->hwLayers[i].blending = HWC_BLENDING_PREMULT;
+        list->hwLayers[i].handle = &handles[i];
+    }
+    list->hwLayers[numLayers].compositionType = HWC_FRAMEBUFFER_TARGET;
+    return list;
+}
+
+static void test_layer_choice()
+{
+    IntelWidiStreamState stream;
+    hwc_display_contents_1_t *list;
+    bool fastPath;
+
+    // a lone opaque untransformed layer is sent as is
+    list = make_list(1);
+    list->hwLayers[0].blending = HWC_BLENDING_NONE;
+    CHECK(stream.select(list, NULL, false, &fastPath) == 0 && !fastPath);
+
+    // blended or rotated it is composited first
+    list->hwLayers[0].blending = HWC_BLENDING_PREMULT;
+    CHECK(stream.select(list, NULL, false, &fastPath) == 1);
+    list->hwLayers[0].blending = HWC_BLENDING_NONE;
+    list->hwLayers[0].transform = HAL_TRANSFORM_ROT_90;
+    CHECK(stream.select(list, NULL, false, &fastPath) == 1);
+    free(list);
+
+    // several layers without extended mode, the composited image
+    list = make_list(3);
+    CHECK(stream.select(list, NULL, false, &fastPath) == 3 && !fastPath);
+
+    // extended mode video layer not in the list
+    CHECK(stream.select(list, video, false, &fastPath) == 3 && !fastPath);
+    // nor does that arm the fast path
+    list->flags = 0;
+    CHECK(stream.select(list, video, false, &fastPath) == 3 && !fastPath);
+
+    // video layer in the list
+    list->hwLayers[1].handle = video;
+    list->flags = HWC_GEOMETRY_CHANGED;
+    CHECK(stream.select(list, video, false, &fastPath) == 1 && !fastPath);
+    free(list);
+}
+
+static void test_fast_path()
+{
+    IntelWidiStreamState stream;
+    hwc_display_contents_1_t *list = make_list(3);
+    bool fastPath;
+
+    list->hwLayers[2].handle = video;
+    CHECK(stream.select(list, video, false, &fastPath) == 2 && !fastPath);
+
+    // unchanged lists only forward the frame
+    list->flags = 0;
+    for (int frame = 0; frame < 10; frame++) {
+        CHECK(stream.select(list, video, false, &fastPath) == 2);
+        CHECK(fastPath);
+    }
+
+    // a forced notify takes the full path once, then back to fast
+    CHECK(stream.select(list, video, true, &fastPath) == 2 && !fastPath);
+    CHECK(stream.select(list, video, false, &fastPath) == 2 && fastPath);
+
+    // geometry change
+    list->flags = HWC_GEOMETRY_CHANGED;
+    CHECK(stream.select(list, video, false, &fastPath) == 2 && !fastPath);
+    list->flags = 0;
+    CHECK(stream.select(list, video, false, &fastPath) == 2 && fastPath);
+
+    // the video moved to another slot without a geometry change
+    list->hwLayers[2].handle = &handles[2];
+    list->hwLayers[0].handle = video;
+    CHECK(stream.select(list, video, false, &fastPath) == 0 && !fastPath);
+    CHECK(stream.select(list, video, false, &fastPath) == 0 && fastPath);
+
+    // extended mode ended
+    CHECK(stream.select(list, NULL, false, &fastPath) == 3 && !fastPath);
+    CHECK(stream.select(list, NULL, false, &fastPath) == 3 && !fastPath);
+
+    // the list shrank under the remembered slot
+    CHECK(stream.select(list, video, false, &fastPath) == 0 && !fastPath);
+    free(list);
+    list = make_list(0);
+    list->flags = 0;
+    CHECK(stream.select(list, video, false, &fastPath) == 0 && !fastPath);
+
+    // reset forgets the fast path
+    free(list);
+    list = make_list(3);
+    list->hwLayers[1].handle = video;
+    stream.select(list, video, false, &fastPath);
+    list->flags = 0;
+    stream.reset();
+    CHECK(stream.select(list, video, false, &fastPath) == 1 && !fastPath);
+    free(list);
+}
+
+static void test_repeat()
+{
+    IntelWidiStreamState stream;
+
+    CHECK(!stream.isRepeat(0x10, 0));
+    stream.frameSent(0x10, 33000);
+    CHECK(stream.isRepeat(0x10, 33000));
+    // same surface with a new frame, or a new surface
+    CHECK(!stream.isRepeat(0x10, 66000));
+    CHECK(!stream.isRepeat(0x20, 33000));
+
+    // no khandle is never a repeat
+    stream.frameSent(0, 0);
+    CHECK(!stream.isRepeat(0, 0));
+
+    stream.frameSent(0x10, 33000);
+    stream.clearLastFrame();
+    CHECK(!stream.isRepeat(0x10, 33000));
+}
+
+static void test_same_buffer()
+{
+    IntelWidiStreamState stream;
+    hwc_layer_1_t layer;
+    hwc_rect_t crop = { 0, 0, 1280, 720 };
+
+    memset(&layer, 0, sizeof(layer));
+    layer.handle = &handles[0];
+    layer.sourceCrop = crop;
+
+    CHECK(!stream.isSameBuffer(layer, 1, 640, 360));
+    stream.bufferSent(layer, 1, 640, 360);
+    CHECK(stream.isSameBuffer(layer, 1, 640, 360));
+
+    // another allocation behind the same handle
+    CHECK(!stream.isSameBuffer(layer, 2, 640, 360));
+    // new output size from setResolution()
+    CHECK(!stream.isSameBuffer(layer, 1, 1280, 720));
+    // cropped differently
+    layer.sourceCrop.right = 1270;
+    CHECK(!stream.isSameBuffer(layer, 1, 640, 360));
+    layer.sourceCrop = crop;
+    // next buffer of the queue
+    layer.handle = &handles[1];
+    CHECK(!stream.isSameBuffer(layer, 1, 640, 360));
+
+    // no handle never matches
+    layer.handle = NULL;
+    stream.bufferSent(layer, 0, 640, 360);
+    CHECK(!stream.isSameBuffer(layer, 0, 640, 360));
+
+    layer.handle = &handles[0];
+    stream.bufferSent(layer, 1, 640, 360);
+    stream.clearLastFrame();
+    CHECK(!stream.isSameBuffer(layer, 1, 640, 360));
+    stream.bufferSent(layer, 1, 640, 360);
+    stream.reset();
+    CHECK(!stream.isSameBuffer(layer, 1, 640, 360));
+}
+
+enum {
+    BENCH_FRAMES = 60 * 60,
+    // buffers in the layer's queue
+    BENCH_BUFFERS = 3,
+};
+
+// stand-in for the FrameInfo sendToWidi() fills and compares
+struct frame_info {
+    int32_t fields[16];
+};
+
+struct held_buffer : public android::RefBase {
+    frame_info info;
+};
+
+struct bench_sink {
+    frame_info lastInput;
+    frame_info lastOutput;
+    android::KeyedVector<uint32_t, android::sp<android::RefBase> > held;
+    int sent;
+};
+
+// what sendToWidi() does for a frame it sends: frame info filled and
+// compared, a buffer hold allocated and kept until the sink returns it
+static void bench_send(bench_sink *sink, const hwc_layer_1_t& layer)
+{
+    frame_info input, output;
+    uint32_t handle = (uint32_t)(uintptr_t)layer.handle;
+
+    memset(&input, 0, sizeof(input));
+    input.fields[0] = layer.sourceCrop.right - layer.sourceCrop.left;
+    input.fields[1] = layer.sourceCrop.bottom - layer.sourceCrop.top;
+    input.fields[2] = 60;
+    output = input;
+    output.fields[3] = 640;
+    output.fields[4] = 360;
+    if (memcmp(&input, &sink->lastInput, sizeof(input)))
+        sink->lastInput = input;
+    if (memcmp(&output, &sink->lastOutput, sizeof(output)))
+        sink->lastOutput = output;
+
+    held_buffer *hold = new held_buffer;
+    hold->info = output;
+    sink->held.add(handle, android::sp<android::RefBase>(hold));
+    // the sink returns the previous frame
+    if (sink->held.size() > BENCH_BUFFERS - 1)
+        sink->held.removeItemsAt(0, 1);
+    sink->sent++;
+}
+
+// the streamed layer gets a new buffer on these frames: 24 fps video
+// in a 60 Hz composition, then a UI that mostly redraws other layers
+static bool bench_new_buffer(int frame)
+{
+    if (frame < BENCH_FRAMES / 2)
+        return (frame * 24) / 60 != ((frame - 1) * 24) / 60;
+    return frame % 10 == 0;
+}
+
+static nsecs_t bench_replay(bool skipSame, int *sent)
+{
+    IntelWidiStreamState stream;
+    bench_sink *sink = new bench_sink;
+    hwc_layer_1_t layer;
+    hwc_rect_t crop = { 0, 0, 1280, 720 };
+    uint64_t stamp = 1;
+    int slot = 0;
+    // the first frame sends the buffer the layer starts with
+    int changes = 1;
+
+    memset(&sink->lastInput, 0, sizeof(sink->lastInput));
+    memset(&sink->lastOutput, 0, sizeof(sink->lastOutput));
+    sink->sent = 0;
+    memset(&layer, 0, sizeof(layer));
+    layer.sourceCrop = crop;
+    layer.handle = &handles[slot];
+
+    nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+    for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+        if (bench_new_buffer(frame)) {
+            slot = (slot + 1) % BENCH_BUFFERS;
+            layer.handle = &handles[slot];
+            stamp++;
+            changes++;
+        }
+        if (skipSame && stream.isSameBuffer(layer, stamp, 640, 360))
+            continue;
+        bench_send(sink, layer);
+        stream.bufferSent(layer, stamp, 640, 360);
+    }
+    nsecs_t elapsed = systemTime(SYSTEM_TIME_MONOTONIC) - start;
+
+    *sent = sink->sent;
+    delete sink;
+    if (skipSame)
+        CHECK(*sent == changes);
+    return elapsed;
+}
+
+static void bench()
+{
+    int sentAll, sentChanged;
+    nsecs_t all = bench_replay(false, &sentAll);
+    nsecs_t changed = bench_replay(true, &sentChanged);
+
+    printf("%d frames, send every frame:     %d sent, %.2f us/frame\n",
+           BENCH_FRAMES, sentAll, ns2us(all) / (double)BENCH_FRAMES);
+    printf("%d frames, skip the same buffer: %d sent, %.2f us/frame\n",
+           BENCH_FRAMES, sentChanged, ns2us(changed) / (double)BENCH_FRAMES);
+    CHECK(sentAll == BENCH_FRAMES);
+    CHECK(sentChanged < sentAll);
+}
+
+int main(int argc, char **argv)
+{
+    bool benchmark = argc > 1 && !strcmp(argv[1], "-b");
+
+    test_layer_choice();
+    test_fast_path();
+    test_repeat();
+    test_same_buffer();
+    if (benchmark)
+        bench();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("widi_stream_state_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,372 @@
+/*
+ * Copyright (c) 2008-2012, Intel Corporation. All rights reserved.
+ *
+ * Redistribution.
+ * Redistribution and use in binary form, without modification, are
+ * permitted provided that the following conditions are met:
+ *  * Redistributions must reproduce the above copyright notice and
+ * the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ *  * Neither the name of Intel Corporation nor the names of its
+ * suppliers may be used to endorse or promote products derived from
+ * this software without specific  prior written permission.
+ *  * No reverse engineering, decompilation, or disassembly of this
+ * software is permitted.
+ *
+ * Limited patent license.
+ * Intel Corporation grants a world-wide, royalty-free, non-exclusive
+ * license under patents it now or hereafter owns or controls to make,
+ * have made, use, import, offer to sell and sell ("Utilize") this
+ * software, but solely to the extent that any such patent is necessary
+ * to Utilize the software alone, or in combination with an operating
+ * system licensed under an approved Open Source license as listed by
+ * the Open Source Initiative at http://opensource.org/licenses.
+ * The patent license shall not apply to any other combinations which
+ * include this software. No hardware per se is licensed hereunder.
+ *
+ * DISCLAIMER.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host test for IntelZOrderSolver. A table of typical layouts with the
+ * overlay layers and framebuffer position expected for each, then
+ * random lists where the solution must be legal pixel for pixel and no
+ * legal choice among the candidates may cost less.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <IntelZOrderSolver.h>
+#include <IntelHWComposerCfg.h>
+
+/* defined by IntelHWComposerModule.cpp in the HAL */
+hwc_cfg cfg;
+
+#define MAX_TABLE_LAYERS    4
+#define GRID_SIZE           64
+
+static int failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+static IMG_native_handle_t rgba = { HAL_PIXEL_FORMAT_RGBA_8888 };
+static IMG_native_handle_t rgbx = { HAL_PIXEL_FORMAT_RGBX_8888 };
+static IMG_native_handle_t nv12 = { HAL_PIXEL_FORMAT_INTEL_HWC_NV12 };
+
+enum {
+    UI,         // RGBA, premultiplied
+    OPAQUE,     // RGBX, no blending
+    VIDEO,      // NV12, no blending
+};
+
+struct layer_desc {
+    int left, top, right, bottom;
+    int type;
+};
+
+struct solver_case {
+    const char *name;
+    int numLayers;
+    layer_desc layers[MAX_TABLE_LAYERS];
+    uint64_t candidates;
+    uint64_t fixed;
+    int numOverlays;
+    uint64_t overlays;
+    bool fbOnTop;
+};
+
+#define B(n)    ((uint64_t)1 << (n))
+
+static const solver_case cases[] = {
+    { "video alone", 1,
+      { { 0, 0, 1000, 1000, VIDEO } },
+      B(0), 0, 1, B(0), true },
+    { "video under status bar", 2,
+      { { 0, 0, 1000, 1000, VIDEO },
+        { 0, 0, 1000, 50, UI } },
+      B(0), 0, 1, B(0), true },
+    { "video over wallpaper", 2,
+      { { 0, 0, 1000, 1000, OPAQUE },
+        { 100, 100, 900, 600, VIDEO } },
+      B(1), 0, 1, B(1), false },
+    { "video between wallpaper and controls", 3,
+      { { 0, 0, 1000, 1000, OPAQUE },
+        { 100, 100, 900, 600, VIDEO },
+        { 100, 500, 900, 600, UI } },
+      B(1), 0, 1, 0, true },
+    { "controls beside the video", 3,
+      { { 0, 0, 1000, 1000, OPAQUE },
+        { 100, 100, 900, 600, VIDEO },
+        { 100, 700, 900, 800, UI } },
+      B(1), 0, 1, B(1), false },
+    { "cursor over video between wallpaper and cursor", 3,
+      { { 0, 0, 1000, 1000, OPAQUE },
+        { 100, 100, 900, 600, VIDEO },
+        { 400, 300, 464, 364, UI } },
+      B(1), B(2), 1, B(1), false },
+    { "two disjoint videos, two overlays", 2,
+      { { 0, 0, 500, 500, VIDEO },
+        { 500, 500, 1000, 1000, VIDEO } },
+      B(0) | B(1), 0, 2, B(0) | B(1), true },
+    { "two disjoint videos, one overlay takes the larger", 2,
+      { { 0, 0, 400, 400, VIDEO },
+        { 500, 500, 1000, 1000, VIDEO } },
+      B(0) | B(1), 0, 1, B(1), true },
+    { "overlapping videos can't both go, the larger goes under", 2,
+      { { 0, 0, 600, 600, VIDEO },
+        { 500, 500, 1000, 1000, VIDEO } },
+      B(0) | B(1), 0, 2, B(0), true },
+    { "overlapping videos can't both go, the larger goes over", 2,
+      { { 0, 0, 500, 500, VIDEO },
+        { 400, 400, 1000, 1000, VIDEO } },
+      B(0) | B(1), 0, 2, B(1), false },
+    { "not a candidate", 1,
+      { { 0, 0, 1000, 1000, VIDEO } },
+      0, 0, 1, 0, true },
+    { "hidden candidate", 2,
+      { { 100, 100, 900, 600, VIDEO },
+        { 0, 0, 1000, 1000, OPAQUE } },
+      B(0), 0, 1, 0, true },
+    { "no overlays", 1,
+      { { 0, 0, 1000, 1000, VIDEO } },
+      B(0), 0, 0, 0, true },
+};
+
+static hwc_display_contents_1_t* alloc_list(int numLayers)
+{
+    size_t size = sizeof(hwc_display_contents_1_t) +
+                  (numLayers + 1) * sizeof(hwc_layer_1_t);
+    return (hwc_display_contents_1_t*)calloc(1, size);
+}
+
+static void set_rect(hwc_rect_t& r, int left, int top, int right, int bottom)
+{
+    r.left = left;
+    r.top = top;
+    r.right = right;
+    r.bottom = bottom;
+}
+
+static void set_layer(hwc_layer_1_t& layer, const layer_desc& desc)
+{
+    memset(&layer, 0, sizeof(layer));
+    set_rect(layer.displayFrame, desc.left, desc.top, desc.right, desc.bottom);
+    set_rect(layer.sourceCrop, 0, 0, desc.right - desc.left,
+             desc.bottom - desc.top);
+    layer.planeAlpha = 0xff;
+    switch (desc.type) {
+    case UI:
+        layer.handle = (buffer_handle_t)&rgba;
+        layer.blending = HWC_BLENDING_PREMULT;
+        break;
+    case OPAQUE:
+        layer.handle = (buffer_handle_t)&rgbx;
+        layer.blending = HWC_BLENDING_NONE;
+        break;
+    default:
+        layer.handle = (buffer_handle_t)&nv12;
+        layer.blending = HWC_BLENDING_NONE;
+        break;
+    }
+}
+
+static void set_target(hwc_display_contents_1_t *list, int n, int size)
+{
+    hwc_layer_1_t& target = list->hwLayers[n];
+
+    memset(&target, 0, sizeof(target));
+    target.compositionType = HWC_FRAMEBUFFER_TARGET;
+    set_rect(target.displayFrame, 0, 0, size, size);
+    list->numHwLayers = n + 1;
+}
+
+static void test_table()
+{
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        const solver_case& t = cases[c];
+        hwc_display_contents_1_t *list = alloc_list(t.numLayers);
+        IntelLayerGeometry geometry;
+        IntelBandwidthModel bandwidth;
+        IntelZOrderSolver solver;
+
+        for (int i = 0; i < t.numLayers; i++)
+            set_layer(list->hwLayers[i], t.layers[i]);
+        set_target(list, t.numLayers, 1000);
+
+        geometry.update(list, t.numLayers);
+        bandwidth.update(list, t.numLayers, geometry);
+        bool ret = solver.solve(t.numLayers, geometry, bandwidth,
+                                t.candidates, t.fixed, t.numOverlays);
+
+        if (!ret || solver.getOverlayLayers() != t.overlays ||
+            solver.isFbOnTop() != t.fbOnTop) {
+            fprintf(stderr, "%s: overlays 0x%llx fb %s, expected 0x%llx fb %s\n",
+                    t.name, (unsigned long long)solver.getOverlayLayers(),
+                    solver.isFbOnTop() ? "on top" : "at bottom",
+                    (unsigned long long)t.overlays,
+                    t.fbOnTop ? "on top" : "at bottom");
+            failures++;
+        }
+
+        // never worse than composing everything
+        CHECK(solver.getFrameBytes() <= solver.getGlesBytes());
+        CHECK(solver.getFrameBytes() ==
+              bandwidth.getFrameBytes(solver.getOverlayLayers() | t.fixed));
+        if (t.overlays)
+            CHECK(solver.getFrameBytes() < solver.getGlesBytes());
+
+        free(list);
+    }
+}
+
+// no GLES pixel between an overlay and the framebuffer, no two
+// overlays on the same pixel
+static bool legal(hwc_display_contents_1_t *list, int n,
+                  const IntelBandwidthModel& bandwidth,
+                  uint64_t overlays, bool fbOnTop)
+{
+    static unsigned char grid[GRID_SIZE * 2][GRID_SIZE * 2];
+
+    memset(grid, 0, sizeof(grid));
+    for (int i = 0; i < n; i++) {
+        if (!(overlays & B(i)))
+            continue;
+        const hwc_rect_t& r = list->hwLayers[i].displayFrame;
+        for (int y = r.top; y < r.bottom; y++) {
+            for (int x = r.left; x < r.right; x++) {
+                if (grid[y][x])
+                    return false;
+                grid[y][x] = 1;
+            }
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (!(overlays & B(i)))
+            continue;
+        const hwc_rect_t& r = list->hwLayers[i].displayFrame;
+        for (int j = 0; j < n; j++) {
+            if ((overlays & B(j)) || !bandwidth.isVisible(j))
+                continue;
+            // GLES layers on the framebuffer's side are fine
+            if (fbOnTop ? j > i : j < i)
+                continue;
+            const hwc_rect_t& s = list->hwLayers[j].displayFrame;
+            if (s.left < r.right && r.left < s.right &&
+                s.top < r.bottom && r.top < s.bottom)
+                return false;
+        }
+    }
+    return true;
+}
+
+static void test_random()
+{
+    hwc_display_contents_1_t *list = alloc_list(IntelZOrderSolver::MAX_CANDIDATES);
+    uint32_t solved = 0, withOverlays = 0;
+
+    srand(5);
+    for (int iter = 0; iter < 20000; iter++) {
+        int n = 1 + rand() % IntelZOrderSolver::MAX_CANDIDATES;
+
+        for (int i = 0; i < n; i++) {
+            int l = rand() % 48, t = rand() % 48;
+            layer_desc desc = { l, t, l + rand() % 24, t + rand() % 24,
+                                rand() % 3 };
+            if (rand() % 6 == 0) {
+                desc.left = desc.top = 0;
+                desc.right = desc.bottom = GRID_SIZE;
+            }
+            set_layer(list->hwLayers[i], desc);
+        }
+        set_target(list, n, GRID_SIZE);
+
+        IntelLayerGeometry geometry;
+        IntelBandwidthModel bandwidth;
+        IntelZOrderSolver solver;
+        uint64_t candidates = rand() % (1 << n);
+        int numOverlays = 1 + rand() % 2;
+
+        geometry.update(list, n);
+        bandwidth.update(list, n, geometry);
+        CHECK(solver.solve(n, geometry, bandwidth, candidates, 0, numOverlays));
+
+        uint64_t overlays = solver.getOverlayLayers();
+        CHECK(!(overlays & ~candidates));
+        CHECK(__builtin_popcountll(overlays) <= numOverlays);
+        if (!legal(list, n, bandwidth, overlays, solver.isFbOnTop())) {
+            fprintf(stderr, "iteration %d: illegal overlays 0x%llx\n", iter,
+                    (unsigned long long)overlays);
+            failures++;
+        }
+
+        uint64_t best = bandwidth.getFrameBytes(0);
+        for (uint64_t m = 1; m < ((uint64_t)1 << n); m++) {
+            if ((m & ~candidates) || __builtin_popcountll(m) > numOverlays)
+                continue;
+            uint64_t cost = bandwidth.getFrameBytes(m);
+            if (cost < best &&
+                (legal(list, n, bandwidth, m, true) ||
+                 legal(list, n, bandwidth, m, false)))
+                best = cost;
+        }
+        if (solver.getFrameBytes() != best) {
+            fprintf(stderr, "iteration %d: %llu bytes, best %llu\n", iter,
+                    (unsigned long long)solver.getFrameBytes(),
+                    (unsigned long long)best);
+            failures++;
+        }
+
+        solved++;
+        withOverlays += overlays != 0;
+    }
+
+    printf("random: %u layouts, %u with overlays\n", solved, withOverlays);
+    free(list);
+}
+
+static void test_invalid()
+{
+    IntelLayerGeometry geometry;
+    IntelBandwidthModel bandwidth;
+    IntelZOrderSolver solver;
+
+    // no bandwidth model, nothing solved
+    CHECK(!solver.solve(1, geometry, bandwidth, 1, 0, 1));
+    CHECK(!solver.isValid());
+    CHECK(!solver.isOverlayLayer(0));
+}
+
+int main()
+{
+    test_table();
+    test_random();
+    test_invalid();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("zorder_solver_test: all checks passed\n");
+    return 0;
+}
@@ -21,6 +21,9 @@
 
 #include <fcntl.h>
 #include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
 
 #include <cutils/log.h>
 #include <cutils/atomic.h>
@@ -96,23 +99,6 @@ bool PVROverlayHAL::createSharedContext()
     memset(sharedContext, 0, size);
     sharedContext->refCount = 1;
 
-    if (pthread_mutexattr_init(&sharedContext->attr)) {
-        LOGE("%s: Initialize overlay mutex attr failed\n", __func__);
-        goto mutexattr_init_err;
-    }
-
-    if (pthread_mutexattr_setpshared(&sharedContext->attr,
-                                     PTHREAD_PROCESS_SHARED)) {
-        LOGE("%s: set pshared error\n", __func__);
-        goto pshared_err;
-    }
-
-
-    if (pthread_mutex_init(&sharedContext->lock, &sharedContext->attr)) {
-        LOGE("%s: shared block lock init failed\n", __func__);
-        goto mutex_init_err;
-    }
-
     mSharedContext = sharedContext;
     mSharedFd = fd;
     mSharedSize = size;
@@ -122,14 +108,6 @@ bool PVROverlayHAL::createSharedContext()
     LOGV("%s: create succussfully fd %d\n", __func__, fd);
 
     return true;
-mutex_init_err:
-pshared_err:
-    pthread_mutexattr_destroy(&sharedContext->attr);
-mutexattr_init_err:
-    munmap(sharedContext, size);
-    close(fd);
-    this->unlock();
-    return false;
 }
 
 void PVROverlayHAL::destroySharedContext(bool closeFd)
@@ -144,18 +122,7 @@ void PVROverlayHAL::destroySharedContext(bool closeFd)
         return;
     }
 
-    if (android_atomic_dec(&mSharedContext->refCount) == 1) {
-        LOGV("%s: destroying mutex...\n", __func__);
-
-        /*destroy it since only control device is using it*/
-        if (pthread_mutex_destroy(&mSharedContext->lock)) {
-            LOGE("%s: destroy share context lock failed\n", __func__);
-        }
-
-        if (pthread_mutexattr_destroy(&mSharedContext->attr)) {
-            LOGE("%s: destroy mutex attr failed\n", __func__);
-        }
-    }
+    android_atomic_dec(&mSharedContext->refCount);
 
     if (munmap(mSharedContext, mSharedSize)) {
         LOGE("%s: Unmap shared context failed\n", __func__);
@@ -234,7 +201,30 @@ bool PVROverlayHAL::sharedContextLock()
         return false;
     }
 
-    pthread_mutex_lock(&mSharedContext->lock);
+    int32_t self = gettid();
+    int32_t owner;
+    uint32_t spins = 0;
+
+    /*
+     * no process-shared mutex here: a holder that crashes would wedge
+     * hwcomposer and every overlay client. the lock is an ownership word
+     * that is taken over once its owner no longer exists.
+     */
+    while (android_atomic_acquire_cas(0, self, &mSharedContext->owner)) {
+        owner = android_atomic_acquire_load(&mSharedContext->owner);
+        if (owner && !(++spins % 64) &&
+            kill(owner, 0) < 0 && errno == ESRCH &&
+            !android_atomic_acquire_cas(owner, self, &mSharedContext->owner)) {
+            LOGW("%s: owner %d is gone, taking over\n", __func__, owner);
+            /*close the update the dead owner left open*/
+            if (mSharedContext->generation & 1)
+                android_atomic_inc(&mSharedContext->generation);
+            break;
+        }
+        sched_yield();
+    }
+
+    android_atomic_inc(&mSharedContext->generation);
 
     return true;
 }
@@ -248,7 +238,8 @@ void PVROverlayHAL::sharedContextUnlock()
         return;
     }
 
-    pthread_mutex_unlock(&mSharedContext->lock);
+    android_atomic_inc(&mSharedContext->generation);
+    android_atomic_release_store(0, &mSharedContext->owner);
 }
 
 void PVROverlayHAL::setPipe(int overlayIndex, int pipe)
@@ -122,8 +122,10 @@ typedef struct intel_drm_mode_info {
 } IntelDrmModeInfo;
 
 typedef struct intel_overlay_shared_context {
-    pthread_mutex_t lock;
-    pthread_mutexattr_t attr;
+    /*thread id of the lock holder, 0 if free*/
+    volatile int32_t owner;
+    /*odd while an update is in progress*/
+    volatile int32_t generation;
     volatile int32_t refCount;
     /*overlay-pipe mapping*/
     IntelDCPipe pipe[MDFLD_OVERLAY_MAX];
@@ -21,11 +21,26 @@ LOCAL_CFLAGS := -D_POSIX_C_SOURCE=200809
 LOCAL_MODULE := audio.hs_usb.$(TARGET_DEVICE)
 LOCAL_MODULE_PATH := $(TARGET_OUT_SHARED_LIBRARIES)/hw
 LOCAL_SRC_FILES := \
-        audio_hw.c
+        audio_hw.c \
+        usb_cards.c
 LOCAL_C_INCLUDES += \
-        $(call include-path-for, tinyalsa)
+        $(call include-path-for, tinyalsa) \
+        $(LOCAL_PATH)/../audiommap
+LOCAL_STATIC_LIBRARIES := libaudio_mmap_intel
 LOCAL_SHARED_LIBRARIES := liblog libcutils libtinyalsa
 LOCAL_MODULE_TAGS := optional
 
 include $(BUILD_SHARED_LIBRARY)
 
+# card discovery against a fake sysfs tree on the build host
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+        usb_cards_test.c \
+        usb_cards.c
+
+LOCAL_STATIC_LIBRARIES := liblog
+LOCAL_MODULE := usb_cards_test
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_HOST_EXECUTABLE)
@@ -17,11 +17,19 @@
 #define LOG_TAG "usb_dock_audio_hw"
 //#define LOG_NDEBUG 0
 
+#include <dirent.h>
 #include <errno.h>
+#include <limits.h>
+#include <poll.h>
 #include <pthread.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <sys/socket.h>
 #include <sys/time.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/netlink.h>
 
 #include <cutils/log.h>
 #include <cutils/str_parms.h>
@@ -34,9 +42,23 @@
 #include <sound/asound.h>
 #include <tinyalsa/asoundlib.h>
 
+#include "audio_mmap.h"
+#include "usb_cards.h"
+
 #define DEFAULT_CARD       3
 #define DEFAULT_DEVICE     0
 
+#define UEVENT_MSG_LEN     4096
+
+/* MMAP playback writes straight into the DMA buffer. It starts with
+ * short periods and doubles them on every underrun up to the default
+ * period size. */
+#define MMAP_PROPERTY           "usbdock.audio.mmap"
+#define MMAP_PERIOD_SIZE_MIN    256
+#define MMAP_PERIOD_COUNT       4
+#define MMAP_START_PERIODS      2
+#define MMAP_WAIT_TIMEOUT_MS    100
+
 struct pcm_config pcm_config_default = {
     .channels = 2,
     .rate = 48000,
@@ -45,6 +67,17 @@ struct pcm_config pcm_config_default = {
     .format = PCM_FORMAT_S16_LE,
 };
 
+struct card_registry {
+    pthread_mutex_t lock;
+    bool dirty;                 /*set by the uevent thread*/
+    int count;
+    struct usb_card cards[MAX_USB_CARDS];
+
+    pthread_t thread;
+    bool thread_running;
+    int wake_fds[2];
+};
+
 struct audio_device {
     struct audio_hw_device hw_device;
 
@@ -52,6 +85,7 @@ struct audio_device {
     int card;
     int device;
     bool standby;
+    struct card_registry registry;
 };
 
 struct stream_out {
@@ -71,6 +105,10 @@ struct stream_out {
     uint32_t   channels;
     uint32_t   latency;
 
+    /* MMAP mode */
+    bool       use_mmap;
+    struct audio_mmap mmap;
+
     struct audio_device *dev;
 };
 
@@ -81,75 +119,176 @@ struct stream_out {
 
 /* Helper functions */
 
-static char* get_card_name_from_substr(const char*name)
+/* Rebuild the list of USB playback cards from sysfs. Capabilities
+ * already probed are kept for cards that are still present.
+ * must be called with registry mutex locked
+ */
+static void registry_scan(struct card_registry *reg)
 {
-    FILE *fp;
-    char alsacard[500];
-    char* substr;
-    int found = 0;
+    struct usb_card found[MAX_USB_CARDS];
+    int count, i;
 
-    if((fp = fopen("/proc/asound/cards","r")) == NULL) {
-        ALOGE("Cannot open /proc/asound/cards file to get sound card info");
-    } else {
-        while((fgets(alsacard, sizeof(alsacard), fp) != NULL)) {
-              ALOGV("alsacard %s", alsacard);
-              if (strstr(alsacard, "USB-Audio")) {
-                  found = 1;
-                  break;
-              } else if (strstr(alsacard, "USB Audio")) {
-                  found = 1;
-                  break;
-              }
-         }
-         fclose(fp);
+    count = usb_cards_scan(SOUND_SYSFS_PATH, found, MAX_USB_CARDS,
+                           reg->cards, reg->count);
+    for (i = 0; i < count; i++)
+        reg->cards[i] = found[i];
+    reg->count = count;
+    reg->dirty = false;
+}
+
+/* Probe the rate, channel and sample size range of a card once.
+ * must be called with registry mutex locked
+ */
+static void registry_probe_caps(struct usb_card *usb)
+{
+    struct pcm_params *params;
+
+    if (usb->caps_probed)
+        return;
+
+    params = pcm_params_get(usb->card, usb->device, PCM_OUT);
+    if (!params) {
+        ALOGW("%s: cannot probe card %d device %d", __func__, usb->card, usb->device);
+        return;
     }
-    ALOGD("Found USB card %s",alsacard);
 
-    substr = strtok(alsacard,"[");
-    substr = strtok(NULL,"]");
-    ALOGV("filter 1 substr %s",substr);
-    // remove spaces if any in the stripped name
-    substr = strtok(substr," ");
-    ALOGV("usb string substr %s",substr);
+    usb->min_rate     = pcm_params_get_min(params, PCM_PARAM_RATE);
+    usb->max_rate     = pcm_params_get_max(params, PCM_PARAM_RATE);
+    usb->min_channels = pcm_params_get_min(params, PCM_PARAM_CHANNELS);
+    usb->max_channels = pcm_params_get_max(params, PCM_PARAM_CHANNELS);
+    usb->min_bits     = pcm_params_get_min(params, PCM_PARAM_SAMPLE_BITS);
+    usb->max_bits     = pcm_params_get_max(params, PCM_PARAM_SAMPLE_BITS);
+    usb->caps_probed  = true;
+    pcm_params_free(params);
 
-    if(found)
-      return substr;
-    else
-      return NULL;
+    ALOGD("%s: card %d rates %u-%u channels %u-%u bits %u-%u", __func__,
+          usb->card, usb->min_rate, usb->max_rate, usb->min_channels,
+          usb->max_channels, usb->min_bits, usb->max_bits);
 }
 
-// This function return the card number associated with the card ID (name)
-// passed as argument
-static int get_card_number_by_name(const char* name)
+/* Return a copy of the current USB playback card, rescanning sysfs
+ * only if a sound uevent arrived since the last lookup.
+ * Returns false when no USB card is present.
+ */
+static bool registry_get_card(struct card_registry *reg, struct usb_card *usb)
 {
-    char id_filepath[PATH_MAX] = {0};
-    char number_filepath[PATH_MAX] = {0};
-    ssize_t written;
-    char* opstr = NULL;
+    bool found = false;
 
-    //find the card containing USB Audio short/long name
-    opstr= get_card_name_from_substr(name);
-    if(opstr == NULL) {
-       ALOGE("Sound card substr %s does not exist - setting default", name);
-       return DEFAULT_CARD;
+    pthread_mutex_lock(&reg->lock);
+    if (reg->dirty)
+        registry_scan(reg);
+    if (reg->count > 0) {
+        registry_probe_caps(&reg->cards[0]);
+        *usb = reg->cards[0];
+        found = true;
+    }
+    pthread_mutex_unlock(&reg->lock);
+
+    return found;
+}
+
+static bool uevent_is_sound(const char *msg, int len)
+{
+    const char *end = msg + len;
+
+    while (msg < end) {
+        if (!strcmp(msg, "SUBSYSTEM=sound"))
+            return true;
+        msg += strlen(msg) + 1;
+    }
+    return false;
+}
+
+static void *registry_uevent_loop(void *data)
+{
+    struct card_registry *reg = data;
+    char msg[UEVENT_MSG_LEN];
+    struct sockaddr_nl addr;
+    int sz = 64 * 1024;
+    int fd;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_pid = 0;
+    addr.nl_groups = 0xffffffff;
+
+    fd = socket(PF_NETLINK, SOCK_DGRAM, NETLINK_KOBJECT_UEVENT);
+    if (fd < 0) {
+        ALOGE("%s: failed to open uevent socket", __func__);
+        return NULL;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &sz, sizeof(sz));
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        ALOGE("%s: failed to bind uevent socket", __func__);
+        close(fd);
+        return NULL;
+    }
+
+    for (;;) {
+        struct pollfd fds[2];
+        int count;
+
+        fds[0].fd = fd;
+        fds[0].events = POLLIN;
+        fds[1].fd = reg->wake_fds[0];
+        fds[1].events = POLLIN;
+
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (fds[1].revents)
+            break;
+        if (!(fds[0].revents & POLLIN))
+            continue;
+
+        count = recv(fd, msg, sizeof(msg) - 2, 0);
+        if (count <= 0)
+            continue;
+        msg[count] = '\0';
+        msg[count + 1] = '\0';
+
+        if (uevent_is_sound(msg, count)) {
+            ALOGV("%s: %s", __func__, msg);
+            pthread_mutex_lock(&reg->lock);
+            reg->dirty = true;
+            pthread_mutex_unlock(&reg->lock);
+        }
     }
 
-    ALOGD("Found USB card opstr = %s",opstr);
+    close(fd);
+    ALOGD("%s: exited", __func__);
+    return NULL;
+}
 
-    snprintf(id_filepath, sizeof(id_filepath), "/proc/asound/%s", opstr);
-    written = readlink(id_filepath, number_filepath, sizeof(number_filepath));
-    if (written < 0) {
-        ALOGE("Sound card %s does not exist - setting default", opstr);
-        return DEFAULT_CARD;
-    } else if (written >= (ssize_t)sizeof(id_filepath)) {
-        ALOGE("Sound card %s name is too long - setting default", opstr);
-        return DEFAULT_CARD;
+static void registry_init(struct card_registry *reg)
+{
+    pthread_mutex_init(&reg->lock, NULL);
+    reg->dirty = true;
+    reg->count = 0;
+
+    if (pipe(reg->wake_fds) < 0) {
+        ALOGE("%s: no uevent thread, rescanning on every open", __func__);
+        reg->wake_fds[0] = reg->wake_fds[1] = -1;
+        return;
     }
+    if (pthread_create(&reg->thread, NULL, registry_uevent_loop, reg) == 0)
+        reg->thread_running = true;
+}
 
-    // We are assured, because of the check in the previous elseif, that this
-    // buffer is null-terminated.  So this call is safe.
-    // 4 == strlen("card")
-    return atoi(number_filepath + 4);
+static void registry_release(struct card_registry *reg)
+{
+    if (reg->thread_running) {
+        write(reg->wake_fds[1], "x", 1);
+        pthread_join(reg->thread, NULL);
+        reg->thread_running = false;
+    }
+    if (reg->wake_fds[0] >= 0) {
+        close(reg->wake_fds[0]);
+        close(reg->wake_fds[1]);
+    }
+    pthread_mutex_destroy(&reg->lock);
 }
 
 /**
@@ -163,6 +302,7 @@ static int get_card_number_by_name(const char* name)
 static int start_output_stream(struct stream_out *out)
 {
     struct audio_device *adev = out->dev;
+    struct usb_card usb;
     int i;
 
     ALOGV("%s enter card %d device %d",__func__, adev->card, adev->device);
@@ -183,24 +323,77 @@ static int start_output_stream(struct stream_out *out)
     out->pcm_config.stop_threshold = 0;
     out->pcm_config.silence_threshold = 0;
 
-    /*TODO - this needs to be updated once the device connect intent sends
-      card, device id*/
-    adev->card = get_card_number_by_name("USB Audio");
-    ALOGD("%s: USB card number = %d, device = %d",__func__,adev->card,adev->device);
+    if (out->use_mmap) {
+        /*start as soon as a couple of periods are queued*/
+        out->pcm_config.start_threshold = out->pcm_config.period_size * MMAP_START_PERIODS;
+        out->pcm_config.avail_min = out->pcm_config.period_size;
+    }
+
+    /*the discovered card wins, the one set through parameters is kept as fallback*/
+    if (registry_get_card(&adev->registry, &usb)) {
+        out->card = usb.card;
+        out->device = usb.device;
+    } else {
+        ALOGE("%s: no USB audio card - setting default", __func__);
+        out->card = adev->card;
+        out->device = adev->device;
+    }
+    ALOGD("%s: USB card number = %d, device = %d",__func__,out->card,out->device);
 
-    out->pcm = pcm_open(adev->card, adev->device, PCM_OUT, &out->pcm_config);
+    out->pcm = pcm_open(out->card, out->device,
+                        out->use_mmap ? PCM_OUT | PCM_MMAP : PCM_OUT,
+                        &out->pcm_config);
 
     if (out->pcm && !pcm_is_ready(out->pcm)) {
         ALOGE("pcm_open() failed: %s", pcm_get_error(out->pcm));
         pcm_close(out->pcm);
+        out->pcm = NULL;
         return -ENOMEM;
     }
 
+    if (out->use_mmap)
+        audio_mmap_set_pcm(&out->mmap, out->pcm, out->pcm_config.start_threshold);
+
     ALOGV("Initialized PCM device for channels %d",out->pcm_config.channels);
     ALOGV("%s exit",__func__);
     return 0;
 }
 
+/* Underrun in MMAP mode: grow the period, up to the default one, and
+ * reopen the PCM with it so the rest of the write goes out right away.
+ * must be called with hw device and output stream mutexes locked
+ */
+static int out_mmap_xrun(struct audio_mmap *mmap, void *cookie)
+{
+    struct stream_out *out = cookie;
+    int ret;
+
+    if (out->pcm_config.period_size >= pcm_config_default.period_size) {
+        ALOGW("%s: underrun #%u", __func__, mmap->xruns);
+        return pcm_prepare(out->pcm);
+    }
+
+    out->pcm_config.period_size *= 2;
+    ALOGW("%s: underrun #%u, period size raised to %u", __func__,
+          mmap->xruns, out->pcm_config.period_size);
+    pcm_close(out->pcm);
+    out->pcm = NULL;
+    audio_mmap_set_pcm(mmap, NULL, 0);
+
+    ret = start_output_stream(out);
+    if (ret != 0)
+        out->standby = true;
+    return ret;
+}
+
+static bool mmap_enabled()
+{
+    char value[PROPERTY_VALUE_MAX];
+
+    property_get(MMAP_PROPERTY, value, "0");
+    return atoi(value) != 0;
+}
+
 /* API functions */
 
 static uint32_t out_get_sample_rate(const struct audio_stream *stream)
@@ -349,7 +542,10 @@ static ssize_t out_write(struct audio_stream_out *stream, const void* buffer,
        ALOGD("%s: null handle to write - device already closed",__func__);
        goto err;
     }
-    ret = pcm_write(out->pcm, (void *)buffer, bytes);
+    if (out->use_mmap)
+        ret = audio_mmap_write(&out->mmap, buffer, bytes);
+    else
+        ret = pcm_write(out->pcm, (void *)buffer, bytes);
 
     ALOGV("%s: pcm_write returned = %d",__func__,ret);
 
@@ -400,6 +596,7 @@ static int adev_open_output_stream(struct audio_hw_device *dev,
 {
     struct audio_device *adev = (struct audio_device *)dev;
     struct stream_out *out;
+    struct usb_card usb;
     int ret;
     ALOGV("%s enter card %d device %d ",__func__, adev->card, adev->device);
 
@@ -410,6 +607,18 @@ static int adev_open_output_stream(struct audio_hw_device *dev,
     out->channel_mask = AUDIO_CHANNEL_OUT_STEREO;
     if (config->sample_rate == 0)
         config->sample_rate = pcm_config_default.rate;
+
+    /*keep the stream within what the card can play*/
+    if (registry_get_card(&adev->registry, &usb) && usb.caps_probed &&
+        (config->sample_rate < usb.min_rate || config->sample_rate > usb.max_rate)) {
+        ALOGD("%s: rate %d not supported by card %d", __func__,
+              config->sample_rate, usb.card);
+        if (pcm_config_default.rate >= usb.min_rate &&
+            pcm_config_default.rate <= usb.max_rate)
+            config->sample_rate = pcm_config_default.rate;
+        else
+            config->sample_rate = usb.max_rate;
+    }
     if (config->channel_mask == 0)
         config->channel_mask = AUDIO_CHANNEL_OUT_STEREO;
 
@@ -421,6 +630,14 @@ static int adev_open_output_stream(struct audio_hw_device *dev,
     out->pcm_config.period_count           = pcm_config_default.period_count;
     out->pcm_config.format                 = pcm_config_default.format;
 
+    out->use_mmap                          = mmap_enabled();
+    if (out->use_mmap) {
+        out->pcm_config.period_size        = MMAP_PERIOD_SIZE_MIN;
+        out->pcm_config.period_count       = MMAP_PERIOD_COUNT;
+        ALOGD("%s: MMAP playback, period size %d", __func__, MMAP_PERIOD_SIZE_MIN);
+        audio_mmap_init(&out->mmap, MMAP_WAIT_TIMEOUT_MS, out_mmap_xrun, out);
+    }
+
     out->stream.common.get_sample_rate     = out_get_sample_rate;
     out->stream.common.set_sample_rate     = out_set_sample_rate;
     out->stream.common.get_buffer_size     = out_get_buffer_size;
@@ -543,6 +760,7 @@ static int adev_close(hw_device_t *device)
 {
     struct audio_device *adev = (struct audio_device *)device;
 
+    registry_release(&adev->registry);
     free(device);
     return 0;
 }
@@ -582,6 +800,8 @@ static int adev_open(const hw_module_t* module, const char* name,
     adev->hw_device.close_input_stream = adev_close_input_stream;
     adev->hw_device.dump = adev_dump;
 
+    registry_init(&adev->registry);
+
     *device = &adev->hw_device.common;
 
     ALOGV("%s exit",__func__);
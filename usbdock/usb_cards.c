@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "usb_dock_audio_hw"
+//#define LOG_NDEBUG 0
+
+#include <dirent.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cutils/log.h>
+
+#include "usb_cards.h"
+
+bool usb_card_is_usb(const char *sysfs, int card)
+{
+    char path[PATH_MAX];
+    char target[PATH_MAX];
+    const char *bus;
+
+    /*snd-usb-audio exposes the vendor:product of the device*/
+    snprintf(path, sizeof(path), "%s/card%d/usbid", sysfs, card);
+    if (access(path, F_OK) == 0)
+        return true;
+
+    /*otherwise go by the bus of the parent device, links are relative*/
+    snprintf(path, sizeof(path), "%s/card%d/device/subsystem", sysfs, card);
+    if (!realpath(path, target))
+        return false;
+
+    bus = strrchr(target, '/');
+    return bus && !strcmp(bus, "/usb");
+}
+
+static int card_first_playback_device(const char *sysfs, int card)
+{
+    char path[PATH_MAX];
+    int device;
+
+    for (device = 0; device < 32; device++) {
+        snprintf(path, sizeof(path), "%s/pcmC%dD%dp", sysfs, card, device);
+        if (access(path, F_OK) == 0)
+            return device;
+    }
+    return -1;
+}
+
+static void card_read_id(const char *sysfs, int card, char *id, size_t size)
+{
+    char path[PATH_MAX];
+    FILE *fp;
+
+    id[0] = '\0';
+    snprintf(path, sizeof(path), "%s/card%d/id", sysfs, card);
+    fp = fopen(path, "r");
+    if (!fp)
+        return;
+    if (fgets(id, size, fp))
+        id[strcspn(id, "\n")] = '\0';
+    fclose(fp);
+}
+
+int usb_cards_scan(const char *sysfs, struct usb_card *cards, int max,
+                   const struct usb_card *known, int known_count)
+{
+    struct dirent *entry;
+    int count = 0, j;
+    DIR *dir;
+
+    dir = opendir(sysfs);
+    if (!dir) {
+        ALOGE("%s: cannot open %s", __func__, sysfs);
+        return 0;
+    }
+
+    while ((entry = readdir(dir)) != NULL && count < max) {
+        int card, device;
+
+        if (sscanf(entry->d_name, "card%d", &card) != 1)
+            continue;
+        if (!usb_card_is_usb(sysfs, card))
+            continue;
+        device = card_first_playback_device(sysfs, card);
+        if (device < 0)
+            continue;
+
+        memset(&cards[count], 0, sizeof(cards[count]));
+        cards[count].card = card;
+        cards[count].device = device;
+        card_read_id(sysfs, card, cards[count].id, sizeof(cards[count].id));
+
+        for (j = 0; j < known_count; j++) {
+            if (known[j].card == card && known[j].device == device &&
+                !strcmp(known[j].id, cards[count].id)) {
+                cards[count] = known[j];
+                break;
+            }
+        }
+
+        ALOGD("%s: USB card %d (%s) playback device %d", __func__,
+              card, cards[count].id, device);
+        count++;
+    }
+    closedir(dir);
+
+    return count;
+}
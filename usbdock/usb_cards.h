@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef USB_CARDS_H
+#define USB_CARDS_H
+
+#include <stdbool.h>
+
+/*sound cards are discovered from sysfs, rescanned on sound uevents*/
+#ifndef SOUND_SYSFS_PATH
+#define SOUND_SYSFS_PATH   "/sys/class/sound"
+#endif
+#define MAX_USB_CARDS      4
+
+/* Playback capabilities of a card, probed once per card lifetime */
+struct usb_card {
+    int card;
+    int device;                 /*first playback pcm*/
+    char id[32];
+    bool caps_probed;
+    unsigned int min_rate, max_rate;
+    unsigned int min_channels, max_channels;
+    unsigned int min_bits, max_bits;
+};
+
+/*true if the card hangs off a USB interface (snd-usb-audio)*/
+bool usb_card_is_usb(const char *sysfs, int card);
+
+/* List the USB cards with a playback pcm under sysfs (normally
+ * SOUND_SYSFS_PATH) into cards. Entries of known[] for the same card,
+ * device and id are carried over so their probed caps survive.
+ * Returns the number of cards found, at most max.
+ */
+int usb_cards_scan(const char *sysfs, struct usb_card *cards, int max,
+                   const struct usb_card *known, int known_count);
+
+#endif /*USB_CARDS_H*/
@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Host test for the USB card discovery. Builds a fake sysfs tree laid
+ * out like /sys on a Medfield/Clovertrail device, with relative device
+ * links, and checks which cards are picked up.
+ */
+#define LOG_TAG "usb_cards_test"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "usb_cards.h"
+
+static int failures;
+static char root[PATH_MAX];
+static char sound[PATH_MAX];
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__,   \
+                    #cond);                                             \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+static void mkdirs(const char *fmt, const char *arg)
+{
+    char path[PATH_MAX], *p;
+
+    snprintf(path, sizeof(path), "%s/", root);
+    snprintf(path + strlen(path), sizeof(path) - strlen(path), fmt, arg);
+    for (p = path + strlen(root) + 1; *p; p++) {
+        if (*p == '/') {
+            *p = '\0';
+            mkdir(path, 0755);
+            *p = '/';
+        }
+    }
+    mkdir(path, 0755);
+}
+
+static void write_file(const char *rel, const char *content)
+{
+    char path[PATH_MAX];
+    FILE *fp;
+
+    snprintf(path, sizeof(path), "%s/%s", root, rel);
+    fp = fopen(path, "w");
+    if (!fp) {
+        perror(path);
+        exit(1);
+    }
+    fputs(content, fp);
+    fclose(fp);
+}
+
+static void link_to(const char *target, const char *rel)
+{
+    char path[PATH_MAX];
+
+    snprintf(path, sizeof(path), "%s/%s", root, rel);
+    if (symlink(target, path)) {
+        perror(path);
+        exit(1);
+    }
+}
+
+/* card<n> under class/sound is a link into the device tree, its device
+ * link points back up to the parent and the parent subsystem link to
+ * bus/<bus>, all with relative paths as in sysfs.
+ */
+static void add_card(int card, const char *parent, const char *bus, const char *id,
+                     bool usbid, int playback_device)
+{
+    char rel[PATH_MAX], buf[PATH_MAX];
+    const char *p;
+
+    snprintf(rel, sizeof(rel), "%s/sound/card%d", parent, card);
+    mkdirs("devices/%s", rel);
+
+    snprintf(buf, sizeof(buf), "devices/%s/subsystem", parent);
+    strcpy(rel, "../");
+    for (p = parent; *p; p++) {
+        if (*p == '/')
+            strcat(rel, "../");
+    }
+    strcat(rel, "../bus/");
+    strcat(rel, bus);
+    mkdirs("bus/%s", bus);
+    link_to(rel, buf);
+    snprintf(rel, sizeof(rel), "%s/sound/card%d", parent, card);
+
+    snprintf(buf, sizeof(buf), "devices/%s/id", rel);
+    snprintf(rel, sizeof(rel), "%s\n", id);
+    write_file(buf, rel);
+
+    snprintf(rel, sizeof(rel), "%s/sound/card%d", parent, card);
+    snprintf(buf, sizeof(buf), "devices/%s/device", rel);
+    link_to("../..", buf);
+
+    if (usbid) {
+        snprintf(buf, sizeof(buf), "devices/%s/usbid", rel);
+        write_file(buf, "0d8c:000c\n");
+    }
+
+    snprintf(buf, sizeof(buf), "../../devices/%s", rel);
+    snprintf(rel, sizeof(rel), "class/sound/card%d", card);
+    link_to(buf, rel);
+
+    if (playback_device >= 0) {
+        snprintf(rel, sizeof(rel), "class/sound/pcmC%dD%dp", card, playback_device);
+        mkdirs("%s", rel);
+    }
+}
+
+static void rm_tree(void)
+{
+    char cmd[PATH_MAX + 16];
+
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", root);
+    if (system(cmd))
+        fprintf(stderr, "could not remove %s\n", root);
+}
+
+static const struct usb_card *find(const struct usb_card *cards, int count, int card)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if (cards[i].card == card)
+            return &cards[i];
+    }
+    return NULL;
+}
+
+static void test_scan(void)
+{
+    struct usb_card cards[MAX_USB_CARDS], again[MAX_USB_CARDS];
+    const struct usb_card *c;
+    int count;
+
+    /*on board codec and HDMI, neither is USB*/
+    add_card(0, "pci0000:00/0000:00:05.0", "pci", "medfieldaudio", false, 0);
+    add_card(1, "pci0000:00/0000:00:02.0", "pci", "IntelHDMI", false, 0);
+    /*USB headset, detected through its usbid*/
+    add_card(2, "pci0000:00/0000:00:14.0/usb1/1-1/1-1:1.0", "usb", "Headset", true, 0);
+    /*USB dock on an older kernel without usbid, only the bus tells*/
+    add_card(3, "pci0000:00/0000:00:14.0/usb1/1-2/1-2:1.0", "usb", "Dock", false, 1);
+    /*USB microphone, no playback pcm*/
+    add_card(4, "pci0000:00/0000:00:14.0/usb1/1-3/1-3:1.0", "usb", "Mic", true, -1);
+    /*platform codec whose name merely contains usb*/
+    add_card(5, "platform/usb_codec", "platform", "UsbCodec", false, 0);
+
+    CHECK(!usb_card_is_usb(sound, 0));
+    CHECK(!usb_card_is_usb(sound, 1));
+    CHECK(usb_card_is_usb(sound, 2));
+    CHECK(usb_card_is_usb(sound, 3));
+    CHECK(usb_card_is_usb(sound, 4));
+    CHECK(!usb_card_is_usb(sound, 5));
+    CHECK(!usb_card_is_usb(sound, 7));
+
+    count = usb_cards_scan(sound, cards, MAX_USB_CARDS, NULL, 0);
+    CHECK(count == 2);
+
+    c = find(cards, count, 2);
+    CHECK(c && c->device == 0 && !strcmp(c->id, "Headset"));
+    c = find(cards, count, 3);
+    CHECK(c && c->device == 1 && !strcmp(c->id, "Dock"));
+    CHECK(!find(cards, count, 4));
+
+    /*probed caps survive a rescan of the same cards*/
+    cards[0].caps_probed = true;
+    cards[0].max_rate = 96000;
+    count = usb_cards_scan(sound, again, MAX_USB_CARDS, cards, 2);
+    CHECK(count == 2);
+    c = find(again, count, cards[0].card);
+    CHECK(c && c->caps_probed && c->max_rate == 96000);
+    c = find(again, count, cards[1].card);
+    CHECK(c && !c->caps_probed);
+
+    /*no more than max cards are returned*/
+    CHECK(usb_cards_scan(sound, cards, 1, NULL, 0) == 1);
+
+    /*missing sysfs*/
+    CHECK(usb_cards_scan("/nonexistent/sound", cards, MAX_USB_CARDS, NULL, 0) == 0);
+}
+
+int main(void)
+{
+    snprintf(root, sizeof(root), "%s/usb_cards_test.XXXXXX",
+             getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp");
+    if (!mkdtemp(root)) {
+        perror(root);
+        return 1;
+    }
+    snprintf(sound, sizeof(sound), "%s/class/sound", root);
+    mkdirs("class/sound", "");
+
+    test_scan();
+    rm_tree();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("usb_cards_test: all checks passed\n");
+    return 0;
+}
@@ -24,9 +24,10 @@ LOCAL_CFLAGS := -D_POSIX_C_SOURCE=200809
 LOCAL_SRC_FILES := \
         audio_hw.c
 LOCAL_C_INCLUDES += \
-        $(call include-path-for, alsa-lib)
+        $(call include-path-for, alsa-lib) \
+        $(LOCAL_PATH)/../audiosrc
 
-LOCAL_STATIC_LIBRARIES := libmedia_helper
+LOCAL_STATIC_LIBRARIES := libmedia_helper libaudio_src_intel
 LOCAL_SHARED_LIBRARIES := liblog libcutils libasound
 
 LOCAL_MODULE := audio.widi.$(TARGET_DEVICE)
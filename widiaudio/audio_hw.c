@@ -33,6 +33,8 @@
 
 #include <alsa/asoundlib.h>
 
+#include "audio_src.h"
+
 #ifndef DEFAULT_SAMPLING_RATE
   #define DEFAULT_SAMPLING_RATE    48000
 #endif
@@ -51,6 +53,10 @@
 /*this is used to avoid starvation*/
 #define LATENCY_TO_BUFFER_SIZE_RATIO 2
 
+/*quality of the in-HAL rate conversion to the sink rate (0 - 3)*/
+#define SRC_QUALITY_PROPERTY       "widi.audio.src.quality"
+#define DEFAULT_SRC_QUALITY        AUDIO_SRC_QUALITY_HIGH
+
 /* Configuration for a stream */
 struct pcm_config {
     unsigned int channels;
@@ -112,6 +118,13 @@ struct widi_stream_out {
     uint32_t   latency;
     bool       display_connected;
 
+/* The sink is always opened at its native rate, other stream rates are
+ * converted in the HAL instead of by the ALSA rate plugin */
+    uint32_t   hw_rate;
+    struct audio_src *src;
+    int16_t   *src_buf;
+    size_t     src_buf_frames;
+
     struct audio_device *dev;
 };
 
@@ -143,13 +156,42 @@ static int close_device(struct widi_stream_out *stream)
     return err;
 }
 
+static enum audio_src_quality get_src_quality();
+
+/* The device may settle on another rate than the one asked for, convert
+ * to the negotiated rate instead of playing at the wrong speed.
+ * must be called with hw device and output stream mutexes locked
+ */
+static int set_negotiated_rate(struct widi_stream_out *out, unsigned int hw_rate)
+{
+    if (hw_rate == out->hw_rate)
+        return 0;
+
+    ALOGW("%s: device runs at %u instead of %u", __func__, hw_rate, out->hw_rate);
+    audio_src_destroy(out->src);
+    out->src = NULL;
+    out->hw_rate = hw_rate;
+
+    if (hw_rate == out->pcm_config.rate)
+        return 0;
+
+    out->src = audio_src_create(out->pcm_config.rate, hw_rate,
+                                out->pcm_config.channels, get_src_quality());
+    if (!out->src) {
+        ALOGE("%s: no rate conversion %d -> %d", __func__,
+              out->pcm_config.rate, hw_rate);
+        return -EINVAL;
+    }
+    return 0;
+}
+
 static int set_hardware_params(struct widi_stream_out *out)
 {
     snd_pcm_hw_params_t *hardware_params;
 
     int err                       = 0;
     snd_pcm_uframes_t buffer_size = out->buffer_size;
-    unsigned int requested_rate   = out->pcm_config.rate;
+    unsigned int requested_rate   = out->hw_rate;
     unsigned int channels         = out->pcm_config.channels;
 
     ALOGV("%s: Entered", __func__);
@@ -193,12 +235,16 @@ static int set_hardware_params(struct widi_stream_out *out)
     err = snd_pcm_hw_params_set_rate_near(out->handle, hardware_params,
                                           &requested_rate, 0);
     if (err < 0) {
-        ALOGE("Unable to set sample rate to %u: %s", out->pcm_config.rate,
-                        snd_strerror(err));
-        out->sample_rate = requested_rate;
+        ALOGE("Unable to set sample rate to %u: %s", out->hw_rate,
+                     snd_strerror(err));
+        goto error_exit;
     }
     ALOGV("sampling rate : %d\n", requested_rate);
 
+    err = set_negotiated_rate(out, requested_rate);
+    if (err < 0)
+        goto error_exit;
+
     // Setup buffers for latency
 
     buffer_size = out->pcm_config.period_size * out->pcm_config.period_count;
@@ -398,6 +444,47 @@ static int start_output_stream(struct widi_stream_out *out)
     return 0;
 }
 
+static enum audio_src_quality get_src_quality()
+{
+    char value[PROPERTY_VALUE_MAX];
+    int quality;
+
+    property_get(SRC_QUALITY_PROPERTY, value, "");
+    if (!value[0])
+        return DEFAULT_SRC_QUALITY;
+
+    quality = atoi(value);
+    if (quality < AUDIO_SRC_QUALITY_LOW || quality > AUDIO_SRC_QUALITY_VERY_HIGH)
+        return DEFAULT_SRC_QUALITY;
+    return (enum audio_src_quality)quality;
+}
+
+/* Convert one write worth of frames to the sink rate into out->src_buf.
+ * Returns the number of bytes to send to the hw device.
+ * must be called with output stream mutex locked
+ */
+static ssize_t apply_rate_conversion(struct widi_stream_out *out,
+                                     const void *buffer, size_t bytes)
+{
+    size_t frame_size = out->pcm_config.channels * sizeof(int16_t);
+    size_t in_frames = bytes / frame_size;
+    size_t out_frames = audio_src_get_out_frames(out->src, in_frames);
+
+    if (out_frames > out->src_buf_frames) {
+        int16_t *buf = realloc(out->src_buf, out_frames * frame_size);
+        if (!buf) {
+            ALOGE("%s: memory allocation failed", __func__);
+            return -ENOMEM;
+        }
+        out->src_buf = buf;
+        out->src_buf_frames = out_frames;
+    }
+
+    out_frames = audio_src_process(out->src, (const int16_t *)buffer, in_frames,
+                                   out->src_buf, out_frames);
+    return out_frames * frame_size;
+}
+
 /* API functions */
 
 static uint32_t out_get_sample_rate(const struct audio_stream *stream)
@@ -472,6 +559,8 @@ static int out_standby(struct audio_stream *stream)
 
     if (!out->standby) {
         close_device(out);
+        if (out->src)
+            audio_src_reset(out->src);
         out->standby = true;
     }
 
@@ -507,7 +596,7 @@ static uint32_t out_get_latency(const struct audio_stream_out *stream)
     uint32_t latency;
 
     latency =  (out->pcm_config.period_size * out->pcm_config.period_count * 1000) /
-            out_get_sample_rate(&stream->common);
+            out->hw_rate;
 
     ALOGV("%s: latency : %d", __func__, latency);
     out->latency = latency;
@@ -532,6 +621,8 @@ static ssize_t out_write(struct audio_stream_out *stream, const void* buffer,
     snd_pcm_sframes_t frames = 0;
     int it = 0;
     unsigned int totalSleepTime;
+    const void *hw_buffer = buffer;
+    size_t hw_bytes = ip_bytes;
 
     ALOGV("%s out->standby = %d", __func__,out->standby);
 
@@ -564,16 +655,25 @@ static ssize_t out_write(struct audio_stream_out *stream, const void* buffer,
 
     ALOGV("write data : channels : %d", out->channel_mask);
 
+    if (out->src) {
+        ret = apply_rate_conversion(out, buffer, ip_bytes);
+        if (ret < 0)
+            goto err_write;
+        hw_buffer = out->src_buf;
+        hw_bytes = ret;
+        ret = 0;
+    }
+
     frames = 0;
 
     do {
         frames = snd_pcm_writei(out->handle,
-                           (char *)buffer + sent_bytes,
-                           snd_pcm_bytes_to_frames(out->handle, ip_bytes - sent_bytes));
+                           (char *)hw_buffer + sent_bytes,
+                           snd_pcm_bytes_to_frames(out->handle, hw_bytes - sent_bytes));
 
         if ((frames == -EAGAIN) ||
            ((frames >= 0) &&
-           ((snd_pcm_frames_to_bytes(out->handle, frames) + sent_bytes) < ip_bytes))) {
+           ((snd_pcm_frames_to_bytes(out->handle, frames) + sent_bytes) < hw_bytes))) {
             it++;
             if (it > MAX_AGAIN_RETRY){
                 ALOGE("write err: EAGAIN breaking...");
@@ -615,7 +715,7 @@ static ssize_t out_write(struct audio_stream_out *stream, const void* buffer,
             sent_bytes += snd_pcm_frames_to_bytes(out->handle, frames);
         }
 
-    } while (sent_bytes < ip_bytes);
+    } while (sent_bytes < hw_bytes);
 
     ALOGV("%s: frames %ld to bytes %ld",
         __func__,
@@ -632,6 +732,9 @@ err_write:
     pthread_mutex_unlock(&out->lock);
     pthread_mutex_unlock(&out->dev->lock);
 
+    /*report the stream side byte count when converting the rate*/
+    if (ret == 0 && sent_bytes == hw_bytes)
+        sent_bytes = ip_bytes;
     return ret == 0 ? (ssize_t) sent_bytes : ret;
 
 silence_write:
@@ -712,6 +815,17 @@ static int widi_dev_open_output_stream(struct audio_hw_device *dev,
     out->pcm_config.period_count           = pcm_config_default.period_count;
     out->pcm_config.format                 = pcm_config_default.format;
 
+    out->hw_rate                           = pcm_config_default.rate;
+    if (out->pcm_config.rate != out->hw_rate) {
+        out->src = audio_src_create(out->pcm_config.rate, out->hw_rate,
+                                    out->pcm_config.channels, get_src_quality());
+        if (!out->src) {
+            ALOGW("%s: no rate conversion %d -> %d, using stream rate", __func__,
+                  out->pcm_config.rate, out->hw_rate);
+            out->hw_rate = out->pcm_config.rate;
+        }
+    }
+
     out->stream.common.get_sample_rate     = out_get_sample_rate;
     out->stream.common.set_sample_rate     = out_set_sample_rate;
     out->stream.common.get_buffer_size     = out_get_buffer_size;
@@ -772,6 +886,7 @@ err_open:
     ALOGE("%s: Failed", __func__);
     pthread_mutex_unlock(&out->lock);
     pthread_mutex_unlock(&out->dev->lock);
+    audio_src_destroy(out->src);
     free(out);
     *stream_out = NULL;
     return ret;
@@ -786,6 +901,8 @@ static void widi_dev_close_output_stream(struct audio_hw_device *dev,
 
     out->standby = false;
     out_standby(&stream->common);
+    audio_src_destroy(out->src);
+    free(out->src_buf);
     free(stream);
     ALOGV("%s Exit",__func__);
 }